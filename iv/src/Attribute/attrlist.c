@@ -312,6 +312,9 @@ AttributeValueList::AttributeValueList (AttributeValueList* s) {
 #endif
     _alist = new AList;
     _count = 0;
+    _index = nil;
+    _indexsize = 0;
+    _indexed = false;
     if (s != nil) {
         ALIterator i;
 
@@ -333,6 +336,7 @@ AttributeValueList::~AttributeValueList () {
 	}
 	delete _alist; 
     }
+    delete [] _index;
 }
 
 AttributeValue* AttributeValueList::AttrVal (AList* r) {
@@ -342,23 +346,39 @@ AttributeValue* AttributeValueList::AttrVal (AList* r) {
 AList* AttributeValueList::Elem (ALIterator i) { return (AList*) i.GetValue(); }
 
 void AttributeValueList::Append (AttributeValue* v) {
-    _alist->Append(new AList(v));
+    AList* elem = new AList(v);
+    _alist->Append(elem);
+    if (_indexed) {
+        if (_count == _indexsize) {
+            _indexsize = _indexsize ? _indexsize * 2 : 16;
+            AList** index = new AList*[_indexsize];
+            for (unsigned int i = 0; i < _count; ++i) {
+                index[i] = _index[i];
+            }
+            delete [] _index;
+            _index = index;
+        }
+        _index[_count] = elem;
+    }
     ++_count;
 }
 
 void AttributeValueList::Prepend (AttributeValue* v) {
     _alist->Prepend(new AList(v));
     ++_count;
+    Unindex();
 }
 
 void AttributeValueList::InsertAfter (ALIterator i, AttributeValue* v) {
     Elem(i)->Prepend(new AList(v));
     ++_count;
+    Unindex();
 }
 
 void AttributeValueList::InsertBefore (ALIterator i, AttributeValue* v) {
     Elem(i)->Append(new AList(v));
     ++_count;
+    Unindex();
 }
 
 void AttributeValueList::Remove (ALIterator& i) {
@@ -368,6 +388,7 @@ void AttributeValueList::Remove (ALIterator& i) {
     _alist->Remove(doomed);
     delete doomed;
     --_count;
+    Unindex();
 }	
     
 void AttributeValueList::Remove (AttributeValue* p) {
@@ -377,7 +398,21 @@ void AttributeValueList::Remove (AttributeValue* p) {
 	_alist->Remove(temp);
         delete temp;
 	--_count;
+        Unindex();
+    }
+}
+
+void AttributeValueList::Index () {
+    if (_indexsize < _count) {
+        delete [] _index;
+        _indexsize = _count < 16 ? 16 : _count;
+        _index = new AList*[_indexsize];
+    }
+    unsigned int n = 0;
+    for (AList* r = _alist->First(); r != _alist->End(); r = r->Next()) {
+        _index[n++] = r;
     }
+    _indexed = true;
 }
 
 AttributeValue* AttributeValueList::GetAttrVal (ALIterator i) { return AttrVal
@@ -472,26 +507,27 @@ void AttributeValueList::clear() {
 
 AttributeValue* AttributeValueList::Get(unsigned int index) {
   if (Number()<=index) return nil;
-  Iterator it;
-  First(it);
-  for (int i=0; i<index; i++) Next(it);
-  return GetAttrVal(it);
+  if (!_indexed) Index();
+  return AttrVal(_index[index]);
 }
 
 AttributeValue* AttributeValueList::Set(unsigned int index, AttributeValue* av) {
+  if (!_indexed) Index();
   if (Number()<=index) {
-    Iterator it;
-    Last(it);
     int padding = index-Number();
     for (int i=0; i<padding; i++) Append(new AttributeValue());
     Append(av);
     return nil;
   }
   else {
-    Iterator it;
-    First(it);
-    for (int i=0; i<index; i++) Next(it);
-    AttributeValue* oldv = Replace(it, av);
+    /* swap in a new element in place, keeping the index */
+    AList* doomed = _index[index];
+    AttributeValue* oldv = AttrVal(doomed);
+    AList* elem = new AList(av);
+    doomed->Append(elem);
+    _alist->Remove(doomed);
+    delete doomed;
+    _index[index] = elem;
     return oldv;
   }
 }
@@ -503,6 +539,7 @@ AttributeValue* AttributeValueList::Replace (ALIterator& i, AttributeValue* av)
     _alist->Remove(doomed);
     delete doomed;
     Elem(i)->Append(new AList(av));
+    Unindex();
     return removed;
 }	
     
@@ -167,6 +167,11 @@ protected:
 //
 // An AttributeValueList assumes responsibility for the memory of its member
 // AttributeValue objects.
+//
+// Alongside the linked list it keeps an array of its elements by position,
+// built on the first Get or Set and kept up to date by Append and Set, so
+// indexed access is constant time.  Inserting or removing anywhere else
+// drops the array until the next indexed access.
 class AttributeValueList : public Resource {
 public:
     AttributeValueList(AttributeValueList* = nil);
@@ -220,10 +225,11 @@ public:
     // check if list includes AttributeValue by pointer-comparison.
 
     AttributeValue* Get(unsigned int index);
-    // retrieve value by index, return nil if not there
+    // retrieve value by index in constant time, return nil if not there
     AttributeValue* Set(unsigned int index, AttributeValue* av);
-    // set value by index, increase list length if necessary with nil padding,
-    // take responsibility for the memory (and return responsibility for old memory)
+    // set value by index in constant time, increase list length if necessary
+    // with nil padding, take responsibility for the memory (and return 
+    // responsibility for old memory)
 
     AList* Elem(ALIterator); 
     // return AList (UList) pointed to by ALIterator (Iterator).
@@ -243,9 +249,17 @@ public:
     // get flag to insert in a nested fashion
 
 protected:
+    void Index();
+    // build the array of elements by position.
+    void Unindex() { _indexed = false; }
+    // drop the array after an insert or removal.
+
     AList* _alist;
     unsigned int _count;
     boolean _nested_insert;
+    AList** _index;
+    unsigned int _indexsize;
+    boolean _indexed;
 
 #ifdef LEAKCHECK
  public:
@@ -27,6 +27,7 @@
 #include <Attribute/attribute.h>
 #include <Attribute/attrvalue.h>
 #include <Attribute/attrlist.h>
+#include <Attribute/attrvector.h>
 
 #ifdef RESOURCE_COMPVIEW
 #include <Unidraw/Components/component.h>
@@ -50,6 +51,16 @@ LeakChecker* AttributeValue::_leakchecker = nil;
 /*****************************************************************************/
 
 int* AttributeValue::_type_syms = nil;
+unsigned long AttributeValue::_allocations = 0;
+
+void* AttributeValue::operator new(size_t size) {
+    _allocations++;
+    return ::operator new(size);
+}
+
+void AttributeValue::operator delete(void* ptr) {
+    ::operator delete(ptr);
+}
 
 AttributeValue::AttributeValue(ValueType valtype) {
 #ifdef LEAKCHECK
@@ -249,7 +260,8 @@ AttributeValue::AttributeValue(int classid, void* ptr) {
     _type = AttributeValue::ObjectType;
     _v.objval.ptr = ptr;
     _v.objval.type = classid;
-    _object_compview = false;
+    _object_ref = NoRef;
+    ref_as_needed();
 }
 
 AttributeValue::AttributeValue(ComponentView* view, int compid) { 
@@ -260,10 +272,22 @@ AttributeValue::AttributeValue(ComponentView* view, int compid) {
     _type = AttributeValue::ObjectType;
     _v.objval.ptr = view;
     _v.objval.type = compid;
-    _object_compview = true;
+    _object_ref = CompViewRef;
     Resource::ref(view);
 }
 
+AttributeValue::AttributeValue(Resource* obj, int classid) { 
+#ifdef LEAKCHECK
+    if(!_leakchecker) _leakchecker = new LeakChecker("AttributeValue");
+    _leakchecker->create();
+#endif
+    _type = AttributeValue::ObjectType;
+    _v.objval.ptr = obj;
+    _v.objval.type = classid;
+    _object_ref = ResourceRef;
+    Resource::ref(obj);
+}
+
 AttributeValue::AttributeValue(AttributeValueList* ptr) { 
 #ifdef LEAKCHECK
     if(!_leakchecker) _leakchecker = new LeakChecker("AttributeValue");
@@ -1011,7 +1035,10 @@ ostream& operator<< (ostream& out, const AttributeValue& sv) {
 	    break;
 	    
 	case AttributeValue::ObjectType:
-	  out << "<" << symbol_pntr(svp->class_symid()) << ">";
+	  if (svp->is_vector())
+	    out << "{" << *svp->vector_val() << "}";
+	  else
+	    out << "<" << symbol_pntr(svp->class_symid()) << ">";
 	  break;
 
 	case AttributeValue::StreamType:
@@ -1167,10 +1194,14 @@ void AttributeValue::ref_as_needed() {
       Resource::ref(_v.arrayval.ptr);
     else if (_type == AttributeValue::StreamType)
       Resource::ref(_v.streamval.listptr);
+    else if (is_vector())
+      Resource::ref((AttributeValueVector*)_v.objval.ptr);
 #ifdef RESOURCE_COMPVIEW
     else if (_type == AttributeValue::ObjectType && object_compview())
       Resource::ref((ComponentView*)_v.objval.ptr);
 #endif
+    else if (object_resource())
+      Resource::ref((Resource*)_v.objval.ptr);
 }
 
 void AttributeValue::dup_as_needed() {
@@ -1184,7 +1215,12 @@ void AttributeValue::dup_as_needed() {
     _v.streamval.listptr = new AttributeValueList(avl);
     Resource::ref(_v.streamval.listptr);
     Resource::unref(avl);
-  } 
+  } else if (is_vector()) {
+    AttributeValueVector* vec = (AttributeValueVector*)_v.objval.ptr;
+    _v.objval.ptr = new AttributeValueVector(vec, vec->Type());
+    Resource::ref((AttributeValueVector*)_v.objval.ptr);
+    Resource::unref(vec);
+  }
 #ifdef RESOURCE_COMPVIEW
   else if (_type == AttributeValue::ObjectType && object_compview()) {
     ComponentView* oldview = (ComponentView*)_v.objval.ptr;
@@ -1209,10 +1245,14 @@ void AttributeValue::unref_as_needed() {
   }
   else if (_type == AttributeValue::StreamType)
       Resource::unref(_v.streamval.listptr);
+  else if (is_vector())
+      Resource::unref((AttributeValueVector*)_v.objval.ptr);
 #ifdef RESOURCE_COMPVIEW
   else if (_type == AttributeValue::ObjectType && object_compview()) 
        Resource::unref((ComponentView*)_v.objval.ptr);
 #endif
+  else if (object_resource())
+       Resource::unref((Resource*)_v.objval.ptr);
 }
 
 boolean AttributeValue::same_list(const AttributeValue& av) {
@@ -1220,10 +1260,14 @@ boolean AttributeValue::same_list(const AttributeValue& av) {
     return _v.arrayval.ptr == av._v.arrayval.ptr;
   else if (_type == AttributeValue::StreamType)
     return _v.streamval.listptr == av._v.streamval.listptr;
+  else if (is_vector())
+    return _v.objval.ptr == av._v.objval.ptr;
 #ifdef RESOURCE_COMPVIEW
   else if (_type == AttributeValue::ObjectType && object_compview())
     return _v.objval.ptr == av._v.objval.ptr;
 #endif
+  else if (object_resource())
+    return _v.objval.ptr == av._v.objval.ptr;
   else
     return false;
 }
@@ -1262,6 +1306,14 @@ void AttributeValue::state(int val) {
     _state = val;
 }
 
+boolean AttributeValue::is_vector() { 
+  return is_object(AttributeValueVector::class_symid());
+}
+
+AttributeValueVector* AttributeValue::vector_val() { 
+  return is_vector() ? (AttributeValueVector*)_v.objval.ptr : nil;
+}
+
 boolean AttributeValue::is_object(int class_symid) { 
   if (!is_type(ObjectType)) return false;
   if (this->class_symid() == class_symid) return true;
@@ -1270,7 +1322,7 @@ boolean AttributeValue::is_object(int class_symid) {
 
 #if 0
 void AttributeValue::object_compview(boolean flag) { 
-  _object_compview = flag; 
+  _object_ref = flag ? CompViewRef : NoRef; 
   if(flag) Resource::ref((ComponentView*)_v.objval.ptr);
 }
 #endif
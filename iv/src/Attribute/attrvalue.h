@@ -46,7 +46,9 @@ extern "C" {
 }
 
 class AttributeValueList;
+class AttributeValueVector;
 class ComponentView;
+class Resource;
 
 #include <iosfwd>
 
@@ -121,6 +123,9 @@ public:
     enum ValueState { UnknownState, OctState, HexState };
     // enum for states
 
+    enum ObjectRef { NoRef, CompViewRef, ResourceRef };
+    // enum for the reference an ObjectType value holds on its object.
+
     AttributeValue(ValueType type);
     // construct with specified type and unitialized value.
     AttributeValue(ValueType type, attr_value value);
@@ -164,6 +169,8 @@ public:
     // StringType constructor.
     AttributeValue(ComponentView* view, int compid);
     // ComponentView constructor.
+    AttributeValue(Resource* obj, int classid);
+    // ObjectType constructor for a Resource, referenced while held.
 
     virtual ~AttributeValue();
     // set to UnknownType and unref pointer if ArrayType/ListType or StreamType.
@@ -252,8 +259,10 @@ public:
     boolean command_alias();
     // returns true if command is an alias, not the first name.
 
-    boolean object_compview() { return is_object() && _object_compview; }
+    boolean object_compview() { return is_object() && _object_ref==CompViewRef; }
     // true if object is wrapped with a ComponentView
+    boolean object_resource() { return is_object() && _object_ref==ResourceRef; }
+    // true if object is a Resource referenced by this value
 #if 0
     void object_compview(boolean flag);
     // true if object is wrapped with a ComponentView
@@ -335,6 +344,10 @@ public:
     // returns true if ObjectType.
     boolean is_object(int class_symid);
     // returns true if ObjectType and class_symid matches or belongs to a parent class.
+    boolean is_vector();
+    // returns true if ObjectType with an AttributeValueVector object.
+    AttributeValueVector* vector_val();
+    // AttributeValueVector by value, nil if not a vector.
 
     static boolean is_char(ValueType t) 
       { return t==CharType || t==UCharType; }
@@ -384,17 +397,26 @@ public:
     boolean same_list(const AttributeValue& av);
     // check if arrayval or streamval are the same
 
+    void* operator new(size_t);
+    // allocate from the heap, counting the allocation.
+    void operator delete(void*);
+    // free heap storage.
+    static unsigned long allocations() { return _allocations; }
+    // number of AttributeValue objects (ComValue's included) allocated
+    // with new so far, for use by profilers.
+
 protected:
 
     ValueType _type;
     attr_value _v;
     union { 
       int _command_symid; // used for CommandType.
-      boolean _object_compview; // used for ObjectType.
+      int _object_ref; // used for ObjectType.
       int _stream_mode; // used for StreamType
       int _state; // useful for any type other than CommandType, ObjectType, or StreamType
     };
     static int* _type_syms;
+    static unsigned long _allocations;
 
 #ifdef LEAKCHECK
  public:
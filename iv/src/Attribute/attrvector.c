@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * Implementation of AttributeValueVector class.
+ */
+
+#include <Attribute/aliterator.h>
+#include <Attribute/attrlist.h>
+#include <Attribute/attrvalue.h>
+#include <Attribute/attrvector.h>
+
+#include <iostream.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************/
+
+int AttributeValueVector::_symid = -1;
+
+static int element_size (AttributeValue::ValueType type) {
+    switch (type) {
+    case AttributeValue::IntType:
+        return sizeof(int);
+    case AttributeValue::FloatType:
+        return sizeof(float);
+    default:
+        return sizeof(double);
+    }
+}
+
+AttributeValueVector::AttributeValueVector (
+    AttributeValue::ValueType type, int n, int rows
+) {
+    _type = ElementType(type);
+    if (_type == AttributeValue::UnknownType) {
+        _type = AttributeValue::DoubleType;
+    }
+    _n = n > 0 ? n : 0;
+    _rows = rows > 0 && _n % rows == 0 ? rows : 0;
+    _data = calloc(_n ? _n : 1, element_size(_type));
+}
+
+AttributeValueVector::AttributeValueVector (
+    AttributeValueVector* v, AttributeValue::ValueType type
+) {
+    _type = ElementType(type);
+    if (_type == AttributeValue::UnknownType) {
+        _type = v->Type();
+    }
+    _n = v->Number();
+    _rows = v->Rows();
+    _data = malloc((_n ? _n : 1) * element_size(_type));
+
+    if (_type == v->Type()) {
+        memcpy(_data, v->Data(), _n * element_size(_type));
+        return;
+    }
+    int i;
+    switch (_type) {
+    case AttributeValue::IntType:
+        if (v->Type() == AttributeValue::FloatType) {
+            const float* s = v->Floats();
+            int* d = Ints();
+            for (i = 0; i < _n; ++i) d[i] = (int)s[i];
+        } else {
+            const double* s = v->Doubles();
+            int* d = Ints();
+            for (i = 0; i < _n; ++i) d[i] = (int)s[i];
+        }
+        break;
+    case AttributeValue::FloatType:
+        if (v->Type() == AttributeValue::IntType) {
+            const int* s = v->Ints();
+            float* d = Floats();
+            for (i = 0; i < _n; ++i) d[i] = (float)s[i];
+        } else {
+            const double* s = v->Doubles();
+            float* d = Floats();
+            for (i = 0; i < _n; ++i) d[i] = (float)s[i];
+        }
+        break;
+    default:
+        if (v->Type() == AttributeValue::IntType) {
+            const int* s = v->Ints();
+            double* d = Doubles();
+            for (i = 0; i < _n; ++i) d[i] = (double)s[i];
+        } else {
+            const float* s = v->Floats();
+            double* d = Doubles();
+            for (i = 0; i < _n; ++i) d[i] = (double)s[i];
+        }
+        break;
+    }
+}
+
+AttributeValueVector::~AttributeValueVector () {
+    free(_data);
+}
+
+AttributeValue::ValueType AttributeValueVector::ElementType (
+    AttributeValue::ValueType type
+) {
+    if (AttributeValue::is_floatingpoint(type)) {
+        return type;
+    } else if (
+        AttributeValue::is_integer(type) || type == AttributeValue::BooleanType
+    ) {
+        return AttributeValue::IntType;
+    } else {
+        return AttributeValue::UnknownType;
+    }
+}
+
+AttributeValue::ValueType AttributeValueVector::Wider (
+    AttributeValue::ValueType t1, AttributeValue::ValueType t2
+) {
+    if (t1 == AttributeValue::DoubleType || t2 == AttributeValue::DoubleType) {
+        return AttributeValue::DoubleType;
+    } else if (
+        t1 == AttributeValue::FloatType || t2 == AttributeValue::FloatType
+    ) {
+        return AttributeValue::FloatType;
+    } else {
+        return AttributeValue::IntType;
+    }
+}
+
+/*
+ * scan_list checks that every element of 'list' is a number, or that
+ * every element is a list of 'cols' numbers, widening 'type' as it goes.
+ */
+
+static boolean scan_list (
+    AttributeValueList* list, int& cols, AttributeValue::ValueType& type
+) {
+    ALIterator i;
+    for (list->First(i); !list->Done(i); list->Next(i)) {
+        AttributeValue* av = list->GetAttrVal(i);
+        if (av->is_array() && cols != 0) {
+            AttributeValueList* row = av->array_val();
+            if (row->Number() == 0 || (cols > 0 && row->Number() != cols)) {
+                return false;
+            }
+            cols = row->Number();
+            ALIterator j;
+            for (row->First(j); !row->Done(j); row->Next(j)) {
+                AttributeValue::ValueType t = AttributeValueVector::ElementType(
+                    row->GetAttrVal(j)->type()
+                );
+                if (t == AttributeValue::UnknownType) {
+                    return false;
+                }
+                type = AttributeValueVector::Wider(type, t);
+            }
+        } else {
+            AttributeValue::ValueType t =
+                AttributeValueVector::ElementType(av->type());
+            if (t == AttributeValue::UnknownType || cols > 0) {
+                return false;
+            }
+            cols = 0;
+            type = AttributeValueVector::Wider(type, t);
+        }
+    }
+    return true;
+}
+
+AttributeValueVector* AttributeValueVector::FromList (
+    AttributeValueList* list, AttributeValue::ValueType type
+) {
+    AttributeValue::ValueType widest = AttributeValue::IntType;
+    int cols = -1;
+    if (list == nil || !scan_list(list, cols, widest)) {
+        return nil;
+    }
+    if (ElementType(type) != AttributeValue::UnknownType) {
+        widest = ElementType(type);
+    }
+    int rows = cols > 0 ? list->Number() : 0;
+    int n = cols > 0 ? rows * cols : list->Number();
+    AttributeValueVector* v = new AttributeValueVector(widest, n, rows);
+
+    int k = 0;
+    ALIterator i;
+    for (list->First(i); !list->Done(i); list->Next(i)) {
+        AttributeValue* av = list->GetAttrVal(i);
+        if (av->is_array()) {
+            AttributeValueList* row = av->array_val();
+            ALIterator j;
+            for (row->First(j); !row->Done(j); row->Next(j)) {
+                v->SetAttrVal(k++, *row->GetAttrVal(j));
+            }
+        } else {
+            v->SetAttrVal(k++, *av);
+        }
+    }
+    return v;
+}
+
+AttributeValueList* AttributeValueVector::List () {
+    AttributeValueList* list = new AttributeValueList();
+    int cols = Cols();
+    for (int r = 0; r < (_rows ? _rows : 1); ++r) {
+        AttributeValueList* row = list;
+        if (_rows) {
+            row = new AttributeValueList();
+            list->Append(new AttributeValue(row));
+        }
+        for (int c = 0; c < cols; ++c) {
+            AttributeValue* av = new AttributeValue(AttributeValue::UnknownType);
+            GetAttrVal(r * cols + c, *av);
+            row->Append(av);
+        }
+    }
+    return list;
+}
+
+void AttributeValueVector::GetAttrVal (int index, AttributeValue& av) {
+    switch (_type) {
+    case AttributeValue::IntType:
+        av = AttributeValue(Ints()[index], AttributeValue::IntType);
+        break;
+    case AttributeValue::FloatType:
+        av = AttributeValue(Floats()[index]);
+        break;
+    default:
+        av = AttributeValue(Doubles()[index]);
+        break;
+    }
+}
+
+void AttributeValueVector::SetAttrVal (int index, AttributeValue& av) {
+    switch (_type) {
+    case AttributeValue::IntType:
+        Ints()[index] = av.int_val();
+        break;
+    case AttributeValue::FloatType:
+        Floats()[index] = av.float_val();
+        break;
+    default:
+        Doubles()[index] = av.double_val();
+        break;
+    }
+}
+
+double AttributeValueVector::Get (int index) {
+    switch (_type) {
+    case AttributeValue::IntType:
+        return Ints()[index];
+    case AttributeValue::FloatType:
+        return Floats()[index];
+    default:
+        return Doubles()[index];
+    }
+}
+
+ostream& operator<< (ostream& out, const AttributeValueVector& vec) {
+    AttributeValueVector* v = (AttributeValueVector*)&vec;
+    int cols = v->Cols();
+    for (int i = 0; i < v->Number(); ++i) {
+        if (i > 0) {
+            out << ",";
+        }
+        if (v->Rows() && i % cols == 0) {
+            out << "{";
+        }
+        switch (v->Type()) {
+        case AttributeValue::IntType:
+            out << v->Ints()[i];
+            break;
+        case AttributeValue::FloatType:
+            out << v->Floats()[i];
+            break;
+        default:
+            out << v->Doubles()[i];
+            break;
+        }
+        if (v->Rows() && i % cols == cols - 1) {
+            out << "}";
+        }
+    }
+    return out;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * AttributeValueVector - a dense vector of numbers
+ */
+
+#ifndef attr_vector_h
+#define attr_vector_h
+
+#include <InterViews/resource.h>
+#include <Attribute/attrvalue.h>
+
+class AttributeValueList;
+
+//: dense vector of int, float or double values.
+// An AttributeValueVector holds its elements in one contiguous block, so
+// arithmetic over it runs as plain loops instead of walking the boxed
+// AttributeValue objects of an AttributeValueList.  It is derived from
+// Resource, and an AttributeValue of ObjectType with this class_symid()
+// references and unreferences it the same way it does an
+// AttributeValueList.
+//
+// A vector with a non-zero row count is a row-major matrix of
+// Rows() x Cols() elements.
+class AttributeValueVector : public Resource {
+public:
+    AttributeValueVector(AttributeValue::ValueType type, int n, int rows = 0);
+    // construct a zero-filled vector of 'n' IntType, FloatType or DoubleType
+    // elements, or a matrix of 'rows' rows if 'rows' is non-zero.
+    AttributeValueVector(AttributeValueVector*, AttributeValue::ValueType type);
+    // construct a copy converted to another element type.
+    virtual ~AttributeValueVector();
+    // do not call directly.
+
+    static AttributeValueVector* FromList(
+        AttributeValueList*,
+        AttributeValue::ValueType type = AttributeValue::UnknownType
+    );
+    // construct from a list of numbers, or from a list of equal-length
+    // lists of numbers (a matrix).  The element type defaults to the widest
+    // type in the list.  Returns nil if the list is not all numbers.
+    AttributeValueList* List();
+    // construct a list of the elements, a list of rows for a matrix.
+
+    static AttributeValue::ValueType ElementType(AttributeValue::ValueType);
+    // vector element type that holds a number of the given type,
+    // UnknownType if it is not a number.
+    static AttributeValue::ValueType Wider(
+        AttributeValue::ValueType, AttributeValue::ValueType
+    );
+    // wider of two element types.
+
+    AttributeValue::ValueType Type() { return _type; }
+    // element type.
+    int Number() { return _n; }
+    // number of elements.
+    int Rows() { return _rows; }
+    // number of rows, 0 if not a matrix.
+    int Cols() { return _rows ? _n / _rows : _n; }
+    // number of columns (elements per row).
+
+    void* Data() { return _data; }
+    // pointer to the elements.
+    int* Ints() { return (int*)_data; }
+    // pointer to IntType elements.
+    float* Floats() { return (float*)_data; }
+    // pointer to FloatType elements.
+    double* Doubles() { return (double*)_data; }
+    // pointer to DoubleType elements.
+
+    void GetAttrVal(int index, AttributeValue&);
+    // store element 'index' in an AttributeValue.
+    void SetAttrVal(int index, AttributeValue&);
+    // convert an AttributeValue into element 'index'.
+    double Get(int index);
+    // element 'index' as a double.
+
+    friend ostream& operator << (ostream& s, const AttributeValueVector&);
+    // print as a (nested) list to ostream.
+
+protected:
+    AttributeValue::ValueType _type;
+    int _n;
+    int _rows;
+    void* _data;
+
+    CLASS_SYMID("AttributeValueVector");
+};
+
+#endif
@@ -125,6 +125,20 @@ void * ParamStruct::addr4(void* base) {
 
 LexScan* ParamList::_lexscan = nil;
 ParamStruct* ParamList::_currstruct = nil;
+void (*ParamList::_release)() = nil;
+void (*ParamList::_acquire)() = nil;
+
+/*
+ * a ParamParse spans one of the methods that only parse, calling the
+ * release hook when it is constructed and the acquire hook when it goes
+ * out of scope.
+ */
+
+class ParamParse {
+public:
+    ParamParse() { if (ParamList::_release) (*ParamList::_release)(); }
+    ~ParamParse() { if (ParamList::_acquire) (*ParamList::_acquire)(); }
+};
 
 ParamList::ParamList (ParamList* s) {
     _alist = new AList;
@@ -157,6 +171,11 @@ LexScan* ParamList::lexscan() {
     return _lexscan;
 }
 
+void ParamList::parse_hooks(void (*release)(), void (*acquire)()) {
+    _release = release;
+    _acquire = acquire;
+}
+
 void ParamList::add_param(const char* name, ParamStruct::ParamFormat format, param_callback ifunc, 
 			  void* base, void* addr1, void* addr2, void* addr3, void* addr4) {
     ParamStruct* ps = new ParamStruct(
@@ -627,6 +646,7 @@ int ParamList::parse_string (istream& in, char* buf, int buflen, boolean keep_ba
 }
 
 int ParamList::parse_points (istream& in, Coord*& x, Coord*& y, int& n) {
+    ParamParse parse;
     char delim;
 
     int bufsiz = 1024;
@@ -666,6 +686,7 @@ int ParamList::parse_points (istream& in, Coord*& x, Coord*& y, int& n) {
 }
 
 int ParamList::parse_fltpts (istream& in, float*& x, float*& y, int& n) {
+    ParamParse parse;
     char delim;
 
     int bufsiz = 1024;
@@ -705,6 +726,7 @@ int ParamList::parse_fltpts (istream& in, float*& x, float*& y, int& n) {
 }
 
 int ParamList::parse_dblpts (istream& in, double*& x, double*& y, int& n) {
+    ParamParse parse;
     char delim;
 
     int bufsiz = 1024;
@@ -744,6 +766,7 @@ int ParamList::parse_dblpts (istream& in, double*& x, double*& y, int& n) {
 }
 
 int ParamList::parse_text(istream& in, char* buffer, int buflen) {
+    ParamParse parse;
     TextBuffer stext(buffer, 0, buflen);
     char null = '\0';
     char c = ',';
@@ -779,6 +802,7 @@ int ParamList::parse_text(istream& in, char* buffer, int buflen) {
 }
 
 char* ParamList::parse_textbuf(istream& in) {
+    ParamParse parse;
     int buflen = BUFSIZ;
     char* buffer = new char[buflen];
 
@@ -239,6 +239,12 @@ public:
     static ParamStruct* CurrParamStruct() { return _currstruct; }
     // last ParamStruct from ::GetStruct
 
+    static void parse_hooks(void (*release)(), void (*acquire)());
+    // functions called on entry to and exit from the parse_*pts and
+    // parse_text* methods, which touch nothing but the istream and the
+    // buffers they allocate.  A caller parsing on several threads can drop
+    // its lock there.  Both nil (the default) for none.
+
 protected:
     void insert(ParamStruct*);
     void insert_first(ParamStruct*);
@@ -275,6 +281,10 @@ protected:
 
     static LexScan* _lexscan;
     static ParamStruct* _currstruct;
+    static void (*_release)();
+    static void (*_acquire)();
+
+friend class ParamParse;
 };
 
 #include <IV-2_6/_leave.h>
@@ -27,6 +27,7 @@
 #include <ComTerp/boolfunc.h>
 #include <ComTerp/comvalue.h>
 #include <ComTerp/comterp.h>
+#include <ComTerp/vecfunc.h>
 #include <string.h>
 
 #define TITLE "BoolFunc"
@@ -203,6 +204,7 @@ void EqualFunc::execute() {
 
     ComValue& operand1 = stack_arg(0, symflag);
     ComValue& operand2 = stack_arg(1, symflag);
+    if (vector_op(VectorFunc::Eq, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
     result.type(ComValue::BooleanType);
@@ -291,6 +293,7 @@ void NotEqualFunc::execute() {
 
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::NotEq, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
     result.type(ComValue::BooleanType);
@@ -376,6 +379,7 @@ void GreaterThanFunc::execute() {
 
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::Gt, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
     result.type(ComValue::BooleanType);
@@ -433,6 +437,7 @@ void GreaterThanOrEqualFunc::execute() {
 
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::GtOrEq, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
     result.type(ComValue::BooleanType);
@@ -490,6 +495,7 @@ void LessThanFunc::execute() {
 
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::Lt, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
     result.type(ComValue::BooleanType);
@@ -547,6 +553,7 @@ void LessThanOrEqualFunc::execute() {
 
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::LtOrEq, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
     result.type(ComValue::BooleanType);
@@ -197,6 +197,27 @@ ComValue& ComFunc::stack_arg_post(int n, boolean symbol, ComValue& dflt) {
   return comterp()->_pfcomvals[loc];
 }
 
+int ComFunc::stack_arg_post_tokens(int n, ComValue*& first) {
+  ComValue argoff(comterp()->stack_top());
+  int offtop = argoff.int_val()-comterp()->_pfnum;
+  int argcnt;
+  for (int i=0; i<nkeys(); i++) {
+    argcnt = 0;
+    skip_key_in_expr(offtop, argcnt);
+  }
+
+  first = nil;
+  if (n>=nargsfixed()) return 0;
+
+  for (int j=nargsfixed(); j>n; j--) {
+    argcnt = 0;
+    skip_arg_in_expr(offtop, argcnt);
+  }
+
+  first = &comterp()->_pfcomvals[comterp()->_pfnum + offtop];
+  return argcnt;
+}
+
 ComValue& ComFunc::stack_key_post
 (int id, boolean symbol, ComValue& dflt, boolean use_dflt_for_no_key) {
   ComValue argoff(comterp()->stack_top());
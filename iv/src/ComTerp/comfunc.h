@@ -191,6 +191,11 @@ protected:
     // of a post-eval ComFunc that represents the start of the
     // code for the nth argument (prior to any keywords).
 
+    int stack_arg_post_tokens(int n, ComValue*& first);
+    // find the unevaluated input arguments of a post-eval ComFunc that
+    // make up the code for the nth argument (prior to any keywords).
+    // Returns how many there are, and sets 'first' to the first of them.
+
     ComValue& stack_key_post(int id, boolean symbol=false, 
 			     ComValue& dflt=ComValue::trueval(), 
 			     boolean use_dflt_for_no_key=false);
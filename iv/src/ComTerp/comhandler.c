@@ -218,8 +218,16 @@ ComterpHandler::handle_input (ACE_HANDLE fd)
 #endif
 	return -1;
     }
+    return handle_command(inbuf, fd);
+}
+
+// Run one command line received on 'fd', or only echo it in logger mode.
+
+int
+ComterpHandler::handle_command (const char* inbuf, ACE_HANDLE fd)
+{
     if (!ComterpHandler::logger_mode()) {
-      comterp_->load_string(inbuf);
+      comterp_->load_view(inbuf, strlen(inbuf));
       if (fd>0 && (!comterp_->_muted || strncmp(inbuf, "ready", 5)!=0))
 	cerr << "(" << fd << "):  " << inbuf << "\n";
       comterp_->_fd = fd;
@@ -230,7 +238,7 @@ ComterpHandler::handle_input (ACE_HANDLE fd)
 	delete comterp_;
 	comterp_ = nil;
       }
-      return input_good&&(status==0||status==3||status==2) ? 0 : -1;
+      return (status==0||status==3||status==2) ? 0 : -1;
     } else {
       if (inbuf[0]!='\004')
 	cout << inbuf << "\n";
@@ -245,7 +253,7 @@ ComterpHandler::handle_input (ACE_HANDLE fd)
       ostr << "\n";
       ostr.flush();
 #endif
-      return (input_good && inbuf[0]!='\004') ? 0 : -1;
+      return inbuf[0]!='\004' ? 0 : -1;
     }
 }
 
@@ -106,6 +106,8 @@ protected:
   virtual int handle_timeout (const ACE_Time_Value &tv, 
 			      const void *arg); 
   // called when timer goes off.
+  virtual int handle_command (const char* inbuf, ACE_HANDLE fd);
+  // run one command line received on 'fd'.
 
   char peer_name_[MAXHOSTNAMELEN + 1];
   // Host we are connected to.
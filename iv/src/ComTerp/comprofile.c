@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * ComProfile implementation.
+ */
+
+#include <ComTerp/comprofile.h>
+#include <Attribute/attrvalue.h>
+
+#include <iostream.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+/*****************************************************************************/
+
+struct ComProfileEntry {
+    unsigned long calls;
+    unsigned long allocs;        // exclusive
+    double total;                // inclusive, counted once through recursion
+    double self;                 // exclusive
+    int active;                  // calls in progress
+};
+
+struct ComProfileNode {
+    int funcid;
+    unsigned long calls;
+    double self;
+    ComProfileNode* child;
+    ComProfileNode* sibling;
+};
+
+struct ComProfileFrame {
+    ComProfileNode* node;
+    int funcid;
+    unsigned int linenum;
+    double start;
+    double child;                // inclusive time of the calls made from here
+    unsigned long allocs;        // allocation count at entry
+    unsigned long childallocs;
+};
+
+static void delete_nodes(ComProfileNode* node) {
+    while (node) {
+        ComProfileNode* next = node->sibling;
+        delete_nodes(node->child);
+        delete node;
+        node = next;
+    }
+}
+
+/*****************************************************************************/
+
+ComProfile::ComProfile() {
+    _running = false;
+    _entries = nil;
+    _nentries = 0;
+    _linetime = nil;
+    _linecalls = nil;
+    _nlines = 0;
+    _root = nil;
+    _frames = nil;
+    _depth = 0;
+    _maxdepth = 0;
+    clear();
+}
+
+ComProfile::~ComProfile() {
+    delete_nodes(_root);
+    free(_entries);
+    free(_linetime);
+    free(_linecalls);
+    free(_frames);
+}
+
+void ComProfile::clear() {
+    _root = new ComProfileNode;
+    memset(_root, 0, sizeof(ComProfileNode));
+    _root->funcid = -1;
+}
+
+void ComProfile::reset() {
+    delete_nodes(_root);
+    clear();
+    free(_entries);
+    _entries = nil;
+    _nentries = 0;
+    free(_linetime);
+    free(_linecalls);
+    _linetime = nil;
+    _linecalls = nil;
+    _nlines = 0;
+    _depth = 0;
+}
+
+double ComProfile::now() {
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+#endif
+    struct timeval tv;
+    gettimeofday(&tv, nil);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+ComProfileEntry* ComProfile::entry(int funcid) {
+    if (funcid >= _nentries) {
+        int n = _nentries ? _nentries : 64;
+        while (n <= funcid) n *= 2;
+        _entries = (ComProfileEntry*)realloc(_entries, n*sizeof(ComProfileEntry));
+        memset(_entries + _nentries, 0, (n-_nentries)*sizeof(ComProfileEntry));
+        _nentries = n;
+    }
+    return _entries + funcid;
+}
+
+void ComProfile::enter(int funcid, unsigned int linenum) {
+    if (funcid < 0) return;
+    if (_depth == _maxdepth) {
+        _maxdepth = _maxdepth ? _maxdepth*2 : 64;
+        _frames = (ComProfileFrame*)realloc(
+            _frames, _maxdepth*sizeof(ComProfileFrame)
+        );
+    }
+    ComProfileNode* parent = _depth ? _frames[_depth-1].node : _root;
+    ComProfileNode* node = parent->child;
+    while (node && node->funcid != funcid) node = node->sibling;
+    if (!node) {
+        node = new ComProfileNode;
+        memset(node, 0, sizeof(ComProfileNode));
+        node->funcid = funcid;
+        node->sibling = parent->child;
+        parent->child = node;
+    }
+    entry(funcid)->active++;
+
+    ComProfileFrame& f = _frames[_depth++];
+    f.node = node;
+    f.funcid = funcid;
+    f.linenum = linenum;
+    f.child = 0.0;
+    f.childallocs = 0;
+    f.allocs = AttributeValue::allocations();
+    f.start = now();
+}
+
+void ComProfile::leave() {
+    double end = now();
+    if (_depth == 0) return;
+    ComProfileFrame& f = _frames[--_depth];
+    double elapsed = end - f.start;
+    double self = elapsed - f.child;
+    unsigned long allocs = AttributeValue::allocations() - f.allocs;
+
+    ComProfileEntry* e = entry(f.funcid);
+    e->calls++;
+    e->self += self;
+    e->allocs += allocs - f.childallocs;
+    if (--e->active == 0) e->total += elapsed;
+
+    f.node->calls++;
+    f.node->self += self;
+
+    if (f.linenum >= _nlines) {
+        unsigned int n = _nlines ? _nlines : 256;
+        while (n <= f.linenum) n *= 2;
+        _linetime = (double*)realloc(_linetime, n*sizeof(double));
+        _linecalls = (unsigned long*)realloc(_linecalls, n*sizeof(unsigned long));
+        memset(_linetime + _nlines, 0, (n-_nlines)*sizeof(double));
+        memset(_linecalls + _nlines, 0, (n-_nlines)*sizeof(unsigned long));
+        _nlines = n;
+    }
+    _linetime[f.linenum] += self;
+    _linecalls[f.linenum]++;
+
+    if (_depth) {
+        _frames[_depth-1].child += elapsed;
+        _frames[_depth-1].childallocs += allocs;
+    }
+}
+
+/*****************************************************************************/
+
+static ComProfileEntry* sort_entries;
+static double* sort_times;
+
+static int entry_compare(const void* a, const void* b) {
+    double sa = sort_entries[*(const int*)a].self;
+    double sb = sort_entries[*(const int*)b].self;
+    return sa < sb ? 1 : sa > sb ? -1 : 0;
+}
+
+static int time_compare(const void* a, const void* b) {
+    double ta = sort_times[*(const unsigned int*)a];
+    double tb = sort_times[*(const unsigned int*)b];
+    return ta < tb ? 1 : ta > tb ? -1 : 0;
+}
+
+void ComProfile::report(ostream& out, int top) {
+    char buf[BUFSIZ];
+    int i, n = 0;
+    double sum = 0.0;
+    unsigned long ncalls = 0;
+    int* order = new int[_nentries+1];
+    for (i = 0; i < _nentries; ++i) {
+        if (_entries[i].calls) {
+            order[n++] = i;
+            sum += _entries[i].self;
+            ncalls += _entries[i].calls;
+        }
+    }
+    sort_entries = _entries;
+    qsort(order, n, sizeof(int), &entry_compare);
+    if (top > 0 && top < n) n = top;
+
+    snprintf(buf, BUFSIZ, "# %.6f s in %lu calls\n", sum, ncalls);
+    out << buf;
+    snprintf(buf, BUFSIZ, "# %10s %12s %12s %6s %10s  %s\n",
+             "calls", "total(s)", "self(s)", "self%", "allocs", "command");
+    out << buf;
+    for (i = 0; i < n; ++i) {
+        ComProfileEntry& e = _entries[order[i]];
+        snprintf(buf, BUFSIZ, "  %10lu %12.6f %12.6f %6.2f %10lu  %s\n",
+                 e.calls, e.total, e.self, sum > 0.0 ? 100.0*e.self/sum : 0.0,
+                 e.allocs, symbol_pntr(order[i]));
+        out << buf;
+    }
+    delete [] order;
+
+    unsigned int* lines = new unsigned int[_nlines+1];
+    unsigned int l, nl = 0;
+    for (l = 0; l < _nlines; ++l) {
+        if (_linecalls[l]) lines[nl++] = l;
+    }
+    sort_times = _linetime;
+    qsort(lines, nl, sizeof(unsigned int), &time_compare);
+    if (top > 0 && (unsigned int)top < nl) nl = top;
+
+    snprintf(buf, BUFSIZ, "# %10s %12s %12s %6s\n",
+             "line", "calls", "self(s)", "self%");
+    out << buf;
+    for (l = 0; l < nl; ++l) {
+        unsigned int line = lines[l];
+        snprintf(buf, BUFSIZ, "  %10u %12lu %12.6f %6.2f\n",
+                 line, _linecalls[line], _linetime[line],
+                 sum > 0.0 ? 100.0*_linetime[line]/sum : 0.0);
+        out << buf;
+    }
+    delete [] lines;
+    out.flush();
+}
+
+void ComProfile::folded(ostream& out, ComProfileNode* node, char* path, int len) {
+    for (; node; node = node->sibling) {
+        const char* name = symbol_pntr(node->funcid);
+        int nlen = name ? strlen(name) : 0;
+        if (len + nlen + 2 >= BUFSIZ) continue;
+        int plen = len;
+        if (plen) path[plen++] = ';';
+        if (nlen) memcpy(path + plen, name, nlen);
+        plen += nlen;
+        path[plen] = '\0';
+
+        long usec = (long)(node->self * 1e6 + 0.5);
+        if (usec > 0) {
+            out << path << " " << usec << "\n";
+        }
+        folded(out, node->child, path, plen);
+    }
+}
+
+void ComProfile::folded(ostream& out) {
+    char path[BUFSIZ];
+    path[0] = '\0';
+    folded(out, _root->child, path, 0);
+    out.flush();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * ComProfile - per-command profile of ComTerp execution
+ */
+
+#if !defined(_comprofile_h)
+#define _comprofile_h
+
+#include <OS/enter-scope.h>
+
+#include <iosfwd>
+
+struct ComProfileEntry;
+struct ComProfileFrame;
+struct ComProfileNode;
+
+//: per-command profile of ComTerp execution.
+// A running ComProfile attached to a ComTerp (see ComTerp::profile()) is
+// told when each command's execute() starts and when it returns.  For each
+// command it keeps the number of calls, the time spent inside it with and
+// without the commands it called, and the number of AttributeValue's
+// allocated while it ran; for each input line the time spent on it; and for
+// each distinct stack of nested commands the time spent at its top.  The
+// cost per call is two clock reads and a short walk of the call tree, small
+// enough to leave on while a script runs.
+class ComProfile {
+public:
+    ComProfile();
+    virtual ~ComProfile();
+
+    void enter(int funcid, unsigned int linenum);
+    // note the start of a call to the command 'funcid' on line 'linenum'.
+    void leave();
+    // note the return of the innermost call entered.
+
+    boolean running() { return _running; }
+    // true if recording.
+    void running(boolean flag) { _running = flag; }
+    // start or stop recording.  Calls in progress are still charged on return.
+    void reset();
+    // discard everything recorded so far.
+
+    void report(ostream&, int top = 0);
+    // write a flat report: commands by descending exclusive time, then lines
+    // by descending time.  'top' limits the rows in each table, 0 for all.
+    void folded(ostream&);
+    // write one "outer;inner;innermost microseconds" line per distinct stack
+    // of commands, the folded-stack format read by flame graph tools.
+
+    static double now();
+    // seconds from a monotonic clock.
+protected:
+    ComProfileEntry* entry(int funcid);
+    void folded(ostream&, ComProfileNode*, char* path, int len);
+    void clear();
+
+    boolean _running;
+    ComProfileEntry* _entries;   // per-command totals, indexed by funcid
+    int _nentries;
+    double* _linetime;           // exclusive time per line, indexed by linenum
+    unsigned long* _linecalls;
+    unsigned int _nlines;
+    ComProfileNode* _root;       // call tree, one node per distinct stack
+    ComProfileFrame* _frames;    // calls in progress
+    int _depth;
+    int _maxdepth;
+};
+
+#endif /* !defined(_comprofile_h) */
@@ -0,0 +1,718 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+#include <ComTerp/comshm.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#define COMSHM_EVENTFD
+#endif
+
+#if defined(__GLIBC__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+    defined(__OpenBSD__) || defined(__APPLE__)
+#define COMSHM_SUPPORTED
+#endif
+
+#define COMSHM_BARRIER() __sync_synchronize()
+
+static const int cacheline = 64;
+
+struct ComterpRingHdr {
+    volatile unsigned long head;     // advanced by the reader
+    char pad0[cacheline - sizeof(unsigned long)];
+    volatile unsigned long tail;     // advanced by the writer
+    char pad1[cacheline - sizeof(unsigned long)];
+    volatile int sleeping;           // reader waits for a signal
+    char pad2[cacheline - sizeof(int)];
+    volatile int waiting;            // writer waits for room
+    char pad3[cacheline - sizeof(int)];
+};
+
+/*****************************************************************************/
+
+ComterpRing::ComterpRing() {
+    _hdr = nil;
+    _data = nil;
+    _size = 0;
+    _rfd = _wfd = -1;
+}
+
+unsigned long ComterpRing::hdrsize() { return sizeof(ComterpRingHdr); }
+
+void ComterpRing::attach(void* base, unsigned long size, int rfd, int wfd) {
+    _hdr = (ComterpRingHdr*)base;
+    _data = (char*)base + hdrsize();
+    _size = size;
+    _rfd = rfd;
+    _wfd = wfd;
+}
+
+unsigned long ComterpRing::available() {
+    return _hdr->tail - _hdr->head;
+}
+
+int ComterpRing::write(const char* buf, int len) {
+    unsigned long head = _hdr->head;
+    unsigned long tail = _hdr->tail;
+    COMSHM_BARRIER();  /* the reader is done with what lies before head */
+    unsigned long room = _size - (tail - head);
+    unsigned long n = (unsigned long)len < room ? len : room;
+    if (n == 0) return 0;
+
+    unsigned long off = tail & (_size - 1);
+    unsigned long first = n < _size - off ? n : _size - off;
+    memcpy(_data + off, buf, first);
+    memcpy(_data, buf + first, n - first);
+
+    COMSHM_BARRIER();  /* publish the bytes before the new tail */
+    _hdr->tail = tail + n;
+    COMSHM_BARRIER();  /* pairs with the barrier in sleep() */
+    if (_hdr->sleeping) {
+	_hdr->sleeping = 0;
+	signal();
+    }
+    return (int)n;
+}
+
+int ComterpRing::read(char* buf, int len) {
+    unsigned long tail = _hdr->tail;
+    unsigned long head = _hdr->head;
+    COMSHM_BARRIER();  /* see the bytes published before tail */
+    unsigned long n = tail - head;
+    if ((unsigned long)len < n) n = len;
+    if (n == 0) return 0;
+
+    unsigned long off = head & (_size - 1);
+    unsigned long first = n < _size - off ? n : _size - off;
+    memcpy(buf, _data + off, first);
+    memcpy(buf + first, _data, n - first);
+
+    COMSHM_BARRIER();  /* finish copying before giving the room back */
+    _hdr->head = head + n;
+    return (int)n;
+}
+
+boolean ComterpRing::sleep() {
+    _hdr->sleeping = 1;
+    COMSHM_BARRIER();
+    return _hdr->tail == _hdr->head;
+}
+
+boolean ComterpRing::wait_room() {
+    _hdr->waiting = 1;
+    COMSHM_BARRIER();  /* pairs with the barrier in room_wanted() */
+    return _hdr->tail - _hdr->head == _size;
+}
+
+boolean ComterpRing::room_wanted() {
+    COMSHM_BARRIER();  /* the new head is visible before the flag is read */
+    if (!_hdr->waiting) return false;
+    _hdr->waiting = 0;
+    return true;
+}
+
+void ComterpRing::signal() {
+#ifdef COMSHM_EVENTFD
+    eventfd_t one = 1;
+    ::write(_wfd, &one, sizeof(one));
+#else
+    char ch = 0;
+    ::write(_wfd, &ch, 1);  /* a full pipe already holds a wakeup */
+#endif
+}
+
+void ComterpRing::drain() {
+#ifdef COMSHM_EVENTFD
+    eventfd_t count;
+    ::read(_rfd, &count, sizeof(count));
+#else
+    char buf[64];
+    while (::read(_rfd, buf, sizeof(buf)) == sizeof(buf));
+#endif
+}
+
+/*****************************************************************************/
+
+unsigned long ComterpShm::_ringsize = 1 << 20;
+
+static const unsigned long min_ringsize = 1 << 12;
+static const unsigned long max_ringsize = 1 << 30;
+
+void ComterpShm::ringsize(unsigned long n) {
+    unsigned long size = min_ringsize;
+    while (size < n && size < max_ringsize) size <<= 1;
+    _ringsize = size;
+}
+
+/* the rings index with a mask */
+static boolean ringsize_ok(unsigned long n) {
+    return n >= min_ringsize && n <= max_ringsize && (n & (n - 1)) == 0;
+}
+
+/* 
+ * true if the process at the other end of local socket 'fd' runs as
+ * this user.
+ */
+static boolean same_user(int fd) {
+#if defined(SO_PEERCRED)
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 &&
+	cred.uid == geteuid();
+#elif defined(COMSHM_SUPPORTED)
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(fd, &uid, &gid) == 0 && uid == geteuid();
+#else
+    return false;
+#endif
+}
+
+/* 
+ * true if 'dir' is a directory of this user's that nobody else can
+ * use, creating it if asked to and it does not exist.
+ */
+static boolean private_dir(const char* dir, boolean create) {
+    struct stat st;
+    if (lstat(dir, &st) < 0) {
+	if (errno != ENOENT || !create || mkdir(dir, 0700) < 0 ||
+	    lstat(dir, &st) < 0)
+	    return false;
+    }
+    return S_ISDIR(st.st_mode) && st.st_uid == geteuid() &&
+	(st.st_mode & 077) == 0;
+}
+
+/* 
+ * make a wakeup descriptor, fds[0] to wait on and fds[1] to signal,
+ * which for an eventfd are the same.
+ */
+static int wakeup_pair(int fds[2]) {
+#ifdef COMSHM_EVENTFD
+    fds[0] = fds[1] = eventfd(0, EFD_NONBLOCK);
+    return fds[0] < 0 ? -1 : 0;
+#else
+    if (pipe(fds) < 0) return -1;
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    return 0;
+#endif
+}
+
+static void wakeup_close(int fds[2]) {
+    close(fds[0]);
+    if (fds[1] != fds[0]) close(fds[1]);
+}
+
+ComterpShm::ComterpShm(int fd, void* base, unsigned long size, 
+		       int infd, int outfd, boolean server) {
+    _fd = fd;
+    _base = base;
+    _mapsize = 2 * (ComterpRing::hdrsize() + size);
+    _infd = infd;
+    _outfd = outfd;
+
+    /* the first ring carries requests, the second replies */
+    char* requests = (char*)base;
+    char* replies = requests + ComterpRing::hdrsize() + size;
+    _in.attach(server ? requests : replies, size, infd, -1);
+    _out.attach(server ? replies : requests, size, -1, outfd);
+
+    _linesiz = BUFSIZ;
+    _line = new char[_linesiz];
+    _linelen = _linepos = _scanned = 0;
+}
+
+ComterpShm::~ComterpShm() {
+    munmap((char*)_base, _mapsize);
+    close(_fd);
+    close(_infd);
+    if (_outfd != _infd) close(_outfd);
+    delete [] _line;
+}
+
+boolean ComterpShm::supported() {
+#ifdef COMSHM_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* ComterpShm::path(int port, boolean create) {
+    static char buf[sizeof(((struct sockaddr_un*)nil)->sun_path)];
+    const char* rundir = getenv("XDG_RUNTIME_DIR");
+    if (rundir && *rundir && private_dir(rundir, false) &&
+	snprintf(buf, sizeof(buf), "%s/comterp-%d", rundir, port) < (int)sizeof(buf))
+	return buf;
+
+    char tmpdir[64];
+    snprintf(tmpdir, sizeof(tmpdir), "/tmp/comterp-%lu", (unsigned long)geteuid());
+    if (!private_dir(tmpdir, create))
+	return nil;
+    snprintf(buf, sizeof(buf), "%s/%d", tmpdir, port);
+    return buf;
+}
+
+boolean ComterpShm::loopback(const char* host) {
+    if (!host || !*host || strcmp(host, "localhost") == 0 ||
+	strncmp(host, "127.", 4) == 0 || strcmp(host, "::1") == 0)
+	return true;
+    char hostname[256];
+    return gethostname(hostname, sizeof(hostname)) == 0 &&
+	strcmp(host, hostname) == 0;
+}
+
+int ComterpShm::listen(int port) {
+#ifdef COMSHM_SUPPORTED
+    const char* sockpath = path(port, true);
+    if (!sockpath) {
+	fprintf(stderr, "comterp: no private directory for the shared-memory "
+		"socket of port %d\n", port);
+	return -1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+	fprintf(stderr, "comterp: socket: %s\n", strerror(errno));
+	return -1;
+    }
+
+    /* take over a socket left behind, but not one a server still answers */
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+	fprintf(stderr, "comterp: %s is in use by another server\n", sockpath);
+	close(fd);
+	return -1;
+    }
+    close(fd);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+	fprintf(stderr, "comterp: socket: %s\n", strerror(errno));
+	return -1;
+    }
+    unlink(addr.sun_path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+	::listen(fd, 5) < 0) {
+	fprintf(stderr, "comterp: unable to listen on %s: %s\n", 
+		sockpath, strerror(errno));
+	close(fd);
+	return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+ComterpShm* ComterpShm::accept(int listenfd) {
+    int fd = ::accept(listenfd, nil, nil);
+    if (fd < 0) return nil;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (!same_user(fd)) {
+	close(fd);
+	return nil;
+    }
+
+    unsigned long size = _ringsize;
+    unsigned long mapsize = 2 * (ComterpRing::hdrsize() + size);
+    char segpath[] = "/tmp/comterpXXXXXX";
+    int segfd = mkstemp(segpath);
+    if (segfd < 0) {
+	close(fd);
+	return nil;
+    }
+    unlink(segpath);
+
+    void* base = MAP_FAILED;
+    if (ftruncate(segfd, mapsize) == 0)
+	base = mmap(nil, mapsize, PROT_READ|PROT_WRITE, MAP_SHARED, segfd, 0);
+    int requests[2], replies[2];
+    if (base == MAP_FAILED || wakeup_pair(requests) < 0) {
+	if (base != MAP_FAILED) munmap((char*)base, mapsize);
+	close(segfd);
+	close(fd);
+	return nil;
+    }
+    if (wakeup_pair(replies) < 0) {
+	wakeup_close(requests);
+	munmap((char*)base, mapsize);
+	close(segfd);
+	close(fd);
+	return nil;
+    }
+
+    /* 
+     * a freshly truncated file reads as zeros, so both rings start empty,
+     * with readers that want the first write signalled.
+     */
+    ((ComterpRingHdr*)base)->sleeping = 1;
+    ((ComterpRingHdr*)((char*)base + ComterpRing::hdrsize() + size))->sleeping = 1;
+
+    /* send the ring size, the segment, and the client's wakeup ends */
+    int sendfds[3];
+    sendfds[0] = segfd;
+    sendfds[1] = requests[1];
+    sendfds[2] = replies[0];
+    char cbuf[CMSG_SPACE(sizeof(sendfds))];
+    memset(cbuf, 0, sizeof(cbuf));
+    struct iovec iov;
+    iov.iov_base = (char*)&size;
+    iov.iov_len = sizeof(size);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(sendfds));
+    memcpy(CMSG_DATA(cmsg), sendfds, sizeof(sendfds));
+    int sent = sendmsg(fd, &msg, 0);
+    close(segfd);
+
+    if (sent != sizeof(size)) {
+	wakeup_close(requests);
+	wakeup_close(replies);
+	munmap((char*)base, mapsize);
+	close(fd);
+	return nil;
+    }
+    if (requests[1] != requests[0]) close(requests[1]);
+    if (replies[0] != replies[1]) close(replies[0]);
+    return new ComterpShm(fd, base, size, requests[0], replies[1], true);
+}
+
+ComterpShm* ComterpShm::connect(int port) {
+#ifdef COMSHM_SUPPORTED
+    const char* sockpath = path(port);
+    if (!sockpath || access(sockpath, F_OK) != 0) return nil;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return nil;
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+	!same_user(fd)) {
+	close(fd);
+	return nil;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    unsigned long size = 0;
+    int recvfds[3];
+    char cbuf[CMSG_SPACE(sizeof(recvfds))];
+    struct iovec iov;
+    iov.iov_base = (char*)&size;
+    iov.iov_len = sizeof(size);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    int got;
+    do 
+	got = recvmsg(fd, &msg, 0);
+    while (got < 0 && errno == EINTR);
+    struct cmsghdr* cmsg = got == sizeof(size) ? CMSG_FIRSTHDR(&msg) : nil;
+    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || 
+	cmsg->cmsg_len != CMSG_LEN(sizeof(recvfds))) {
+	close(fd);
+	return nil;
+    }
+    memcpy(recvfds, CMSG_DATA(cmsg), sizeof(recvfds));
+
+    /* the segment must hold both rings of the size the server chose */
+    unsigned long mapsize = 2 * (ComterpRing::hdrsize() + size);
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (ringsize_ok(size) && fstat(recvfds[0], &st) == 0 && 
+	(unsigned long)st.st_size >= mapsize)
+	base = mmap(nil, mapsize, PROT_READ|PROT_WRITE, MAP_SHARED, recvfds[0], 0);
+    close(recvfds[0]);
+    if (base == MAP_FAILED) {
+	close(recvfds[1]);
+	close(recvfds[2]);
+	close(fd);
+	return nil;
+    }
+    return new ComterpShm(fd, base, size, recvfds[2], recvfds[1], false);
+#else
+    return nil;
+#endif
+}
+
+boolean ComterpShm::closed() {
+    char ch;
+    int n = recv(_fd, &ch, 1, MSG_PEEK|MSG_DONTWAIT);
+    return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+int ComterpShm::write(const char* buf, int len) {
+    int done = 0;
+    while (done < len) {
+	done += _out.write(buf + done, len - done);
+	if (done == len || !_out.wait_room()) 
+	    continue;
+
+	/* 
+	 * the reader is behind; it signals the wakeup of the other ring 
+	 * once it makes room.
+	 */
+	struct pollfd fds[2];
+	fds[0].fd = _in.rfd();
+	fds[0].events = POLLIN;
+	fds[1].fd = _fd;
+	fds[1].events = POLLIN;
+	fds[0].revents = fds[1].revents = 0;
+	if (poll(fds, 2, -1) < 0 && errno != EINTR) 
+	    return -1;
+	if (fds[1].revents && closed())
+	    return -1;
+	_in.drain();
+    }
+    return len;
+}
+
+int ComterpShm::puts(const char* s) {
+    int len = strlen(s);
+    if (write(s, len) < 0) return -1;
+    if (len == 0 || s[len-1] != '\n')
+	return write("\n", 1) < 0 ? -1 : len + 1;
+    return len;
+}
+
+char* ComterpShm::getline() {
+    /* drop the line returned last time */
+    if (_linepos) {
+	memmove(_line, _line + _linepos, _linelen - _linepos);
+	_linelen -= _linepos;
+	_scanned -= _linepos;
+	_linepos = 0;
+    }
+
+    for (;;) {
+	char* nl = (char*)memchr(_line + _scanned, '\n', _linelen - _scanned);
+	if (nl) {
+	    *nl = '\0';
+	    _linepos = nl - _line + 1;
+	    _scanned = _linepos;
+	    return _line;
+	}
+	_scanned = _linelen;
+
+	unsigned long avail = _in.available();
+	if (avail == 0) return nil;
+	if (_linelen + avail >= (unsigned long)_linesiz) {
+	    int newsiz = _linesiz;
+	    while (_linelen + avail >= (unsigned long)newsiz) newsiz *= 2;
+	    char* newline = new char[newsiz];
+	    memcpy(newline, _line, _linelen);
+	    delete [] _line;
+	    _line = newline;
+	    _linesiz = newsiz;
+	}
+	_linelen += _in.read(_line + _linelen, avail);
+	if (_in.room_wanted()) _out.signal();
+    }
+}
+
+char* ComterpShm::gets() {
+    for (;;) {
+	char* line = getline();
+	if (line) return line;
+	if (!_in.sleep()) continue;
+
+	struct pollfd fds[2];
+	fds[0].fd = _in.rfd();
+	fds[0].events = POLLIN;
+	fds[1].fd = _fd;
+	fds[1].events = POLLIN;
+	fds[0].revents = fds[1].revents = 0;
+	if (poll(fds, 2, -1) < 0 && errno != EINTR) 
+	    return nil;
+	if (fds[1].revents && closed() && _in.available() == 0)
+	    return nil;
+	_in.drain();
+    }
+}
+
+/*****************************************************************************/
+
+#ifdef HAVE_ACE
+
+#include <ComTerp/comterpserv.h>
+
+#if defined(__GLIBC__)
+static ssize_t comshm_fwrite(void* cookie, const char* buf, size_t len) {
+    return ((ComterpShm*)cookie)->write(buf, len) < 0 ? -1 : len;
+}
+#elif defined(COMSHM_SUPPORTED)
+static int comshm_fwrite(void* cookie, const char* buf, int len) {
+    return ((ComterpShm*)cookie)->write(buf, len);
+}
+#endif
+
+/* 
+ * stdio stream that writes into the reply ring, which is what 
+ * ComTerp::run and friends print results to.
+ */
+static FILE* comshm_fopen(ComterpShm* shm) {
+    FILE* fptr = nil;
+#if defined(__GLIBC__)
+    cookie_io_functions_t io = { nil, &comshm_fwrite, nil, nil };
+    fptr = fopencookie(shm, "w", io);
+#elif defined(COMSHM_SUPPORTED)
+    fptr = funopen(shm, nil, &comshm_fwrite, nil, nil);
+#endif
+    if (fptr) setvbuf(fptr, nil, _IOLBF, BUFSIZ);
+    return fptr;
+}
+
+ComterpShmHandler::ComterpShmHandler(ComterpShm* shm, ComTerpServ* serv) 
+: ComterpHandler(serv)
+{
+    _shm = shm;
+    this->peer().set_handle(shm->handle());
+    _wrfptr = comshm_fopen(shm);
+    strcpy(peer_name_, "localhost (shared memory)");
+}
+
+ComterpShmHandler::~ComterpShmHandler() {
+    delete _shm;
+}
+
+int ComterpShmHandler::open(void*) {
+    ACE_Reactor* reactor = ComterpHandler::reactor_singleton();
+    if (!_wrfptr ||
+	reactor->register_handler
+	(_shm->wakeup_handle(), this, ACE_Event_Handler::READ_MASK) == -1 ||
+	reactor->register_handler
+	(_shm->handle(), this, ACE_Event_Handler::READ_MASK) == -1)
+	ACE_ERROR_RETURN ((LM_ERROR, 
+			   "(%P|%t) can't register with reactor\n"), -1);
+    if (ComterpHandler::logger_mode()==0) 
+	ACE_DEBUG ((LM_DEBUG, 
+		    "(%P|%t) connected with %s\n", this->peer_name_));
+    return 0;
+}
+
+int ComterpShmHandler::close(u_long) {
+    return handle_close(ACE_INVALID_HANDLE, ACE_Event_Handler::ALL_EVENTS_MASK);
+}
+
+// Unregister the other descriptor and clean up once either one is
+// removed from the reactor.
+
+int ComterpShmHandler::handle_close(ACE_HANDLE, ACE_Reactor_Mask) {
+    if (!_shm) return 0;
+    ACE_Reactor* reactor = ComterpHandler::reactor_singleton();
+    ACE_Reactor_Mask mask = 
+	ACE_Event_Handler::READ_MASK | ACE_Event_Handler::DONT_CALL;
+    reactor->remove_handler(_shm->wakeup_handle(), mask);
+    reactor->remove_handler(_shm->handle(), mask);
+
+    /* the ComterpShm owns the local socket */
+    this->peer().set_handle(ACE_INVALID_HANDLE);
+    ComterpHandler::destroy();
+    delete _shm;
+    _shm = nil;
+    return 0;
+}
+
+int ComterpShmHandler::handle_input(ACE_HANDLE fd) {
+    if (!_shm) return -1;
+    if (fd == _shm->handle())
+	return _shm->closed() ? -1 : 0;
+
+    _shm->drain();
+    do {
+	char* line;
+	while ((line = _shm->getline())) {
+	    if (!*line) continue;
+	    if (!comterp_ || handle_command(line, _shm->handle()) < 0)
+		return -1;
+	}
+    } while (!_shm->sleep());
+    return 0;
+}
+
+/*****************************************************************************/
+
+ComterpShmAcceptor::ComterpShmAcceptor() {
+    _fd = -1;
+    _port = -1;
+}
+
+ComterpShmAcceptor::~ComterpShmAcceptor() {
+    if (_fd >= 0) {
+	close(_fd);
+	const char* sockpath = ComterpShm::path(_port);
+	if (sockpath) unlink(sockpath);
+    }
+}
+
+int ComterpShmAcceptor::open(int port, ACE_Reactor* reactor) {
+    _fd = ComterpShm::listen(port);
+    if (_fd < 0) return -1;
+    _port = port;
+    return reactor->register_handler(this, ACE_Event_Handler::READ_MASK);
+}
+
+int ComterpShmAcceptor::handle_input(ACE_HANDLE) {
+    ComterpShm* shm = ComterpShm::accept(_fd);
+    if (shm) {
+	ComterpShmHandler* handler = make_handler(shm);
+	if (handler->open(nil) == -1)
+	    handler->close(0);
+    }
+    return 0;
+}
+
+ComterpShmHandler* ComterpShmAcceptor::make_handler(ComterpShm* shm) {
+    return new ComterpShmHandler(shm);
+}
+
+#endif /* HAVE_ACE */
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+
+/*
+ * ComterpShm - shared-memory transport between co-located comterp's
+ */
+
+#if !defined(_comshm_h)
+#define _comshm_h
+
+#include <OS/enter-scope.h>
+
+struct ComterpRingHdr;
+
+//: single-producer single-consumer byte ring in shared memory.
+// One process writes and the other reads, each advancing its own
+// free-running position in the ring's header, so neither ever takes a
+// lock.  The reader sets a flag before it sleeps on its wakeup
+// descriptor (an eventfd where there is one, otherwise a pipe), and the
+// writer only signals the descriptor when it finds that flag set.  A
+// writer that finds the ring full sets a flag of its own, and the reader
+// answers it through the descriptor of the ring going the other way.
+class ComterpRing {
+public:
+    ComterpRing();
+
+    void attach(void* base, unsigned long size, int rfd, int wfd);
+    // use the header and 'size' bytes of data at 'base', waiting for the
+    // writer on 'rfd' when reading and waking the reader through 'wfd'
+    // when writing; -1 for the one not used.
+
+    int write(const char*, int len);
+    // copy as much of 'len' bytes as fits, waking the reader if it
+    // sleeps; return the number of bytes copied.
+    int read(char*, int len);
+    // copy up to 'len' buffered bytes out; return the number copied.
+    unsigned long available();
+    // number of bytes buffered for reading.
+
+    boolean sleep();
+    // tell the writer to signal the next write; false if bytes arrived
+    // in the meantime and there is no need to wait.
+    boolean wait_room();
+    // tell the reader to signal once it reads; false if room was made
+    // in the meantime and there is no need to wait.
+    boolean room_wanted();
+    // true, once, if the writer waits for room since the last call.
+    void signal();
+    // wake whoever waits on the read descriptor.
+    void drain();
+    // consume pending wakeups on the read descriptor.
+    int rfd() { return _rfd; }
+    // descriptor that becomes readable when the writer signals.
+
+    static unsigned long hdrsize();
+    // bytes taken by the header in front of the data.
+protected:
+    ComterpRingHdr* _hdr;
+    char* _data;
+    unsigned long _size;
+    int _rfd;
+    int _wfd;
+};
+
+//: one end of a shared-memory connection to a comterp server.
+// Commands and replies travel as newline-terminated text, as they do over
+// a socket, through a pair of ComterpRing's in one shared segment.  The
+// segment and wakeup descriptors are handed over on a local socket named
+// after the server's port, which stays open to tell each end when the
+// other goes away.  Servers offer the transport with ComterpShmAcceptor;
+// clients on the same host get it through connect().
+class ComterpShm {
+public:
+    virtual ~ComterpShm();
+
+    static ComterpShm* connect(int port);
+    // connect to the server on 'port' of this host, nil if there is none
+    // accepting shared-memory connections.
+    static ComterpShm* accept(int listenfd);
+    // accept a connection on 'listenfd' and set up the segment for it.
+    static int listen(int port);
+    // open the local socket connect() looks for; -1, after saying why,
+    // on failure.
+    static const char* path(int port, boolean create=false);
+    // name of the local socket for 'port', in $XDG_RUNTIME_DIR or else
+    // in /tmp/comterp-<uid>, which is made mode 0700 if 'create' is set;
+    // nil if neither is private to this user.
+    static boolean loopback(const char* host);
+    // true if 'host' names this host.
+    static boolean supported();
+    // true where this platform can pass a segment between processes.
+
+    int write(const char*, int len);
+    // write 'len' bytes, sleeping until the peer makes room as needed; -1
+    // if the peer is gone.
+    int puts(const char*);
+    // write a string, adding a newline if it does not end with one.
+    char* getline();
+    // next complete line without its newline, or nil if none has arrived.
+    // The line is good until the next call.
+    char* gets();
+    // wait for and return the next line, or nil if the peer went away.
+
+    int handle() { return _fd; }
+    // local socket, which reads end-of-file once the peer is gone.
+    int wakeup_handle() { return _in.rfd(); }
+    // descriptor that becomes readable when lines may have arrived.
+    boolean sleep() { return _in.sleep(); }
+    // arm the wakeup descriptor; false if input is already waiting.
+    void drain() { _in.drain(); }
+    // consume pending wakeups.
+    boolean closed();
+    // true once the peer has closed its end.
+
+    static unsigned long ringsize() { return _ringsize; }
+    // bytes of data in each direction.
+    static void ringsize(unsigned long n);
+    // set the ring size for connections accepted from now on, rounded up
+    // to a power of 2 between 4K and 1G.
+protected:
+    ComterpShm(int fd, void* base, unsigned long size, 
+	       int infd, int outfd, boolean server);
+
+    int _fd;
+    void* _base;
+    unsigned long _mapsize;
+    ComterpRing _in;
+    ComterpRing _out;
+    int _infd;
+    int _outfd;
+    char* _line;
+    int _linesiz;
+    int _linelen;
+    int _linepos;
+    int _scanned;
+
+    static unsigned long _ringsize;
+};
+
+#ifdef HAVE_ACE
+
+#include <ComTerp/comhandler.h>
+
+//: ComterpHandler that reads commands from a ComterpShm.
+// Registers the connection's wakeup descriptor and local socket with the
+// reactor, runs each line that arrives through the same path as the
+// socket handler, and writes results back into the reply ring.
+class ComterpShmHandler : public ComterpHandler {
+public:
+    ComterpShmHandler(ComterpShm*, ComTerpServ* serv=NULL);
+    virtual ~ComterpShmHandler();
+
+    virtual int open (void *);
+    // register with the reactor.
+    virtual int close (u_long);
+    // close handler hook.
+    virtual int handle_close (ACE_HANDLE, ACE_Reactor_Mask);
+    // called when either descriptor is removed from the reactor.
+
+    ComterpShm* shm() { return _shm; }
+    // connection to the client.
+protected:
+    virtual int handle_input (ACE_HANDLE);
+    // run every complete line that has arrived.
+
+    ComterpShm* _shm;
+};
+
+//: accepts shared-memory connections for a comterp server.
+class ComterpShmAcceptor : public ACE_Event_Handler {
+public:
+    ComterpShmAcceptor();
+    virtual ~ComterpShmAcceptor();
+
+    int open(int port, ACE_Reactor*);
+    // listen for clients of the server on 'port' and register with the
+    // reactor; -1 on failure.
+    virtual ACE_HANDLE get_handle() const { return _fd; }
+protected:
+    virtual int handle_input (ACE_HANDLE);
+    // accept a client and start a ComterpShmHandler for it.
+    virtual ComterpShmHandler* make_handler(ComterpShm*);
+    // new handler for an accepted connection.
+
+    int _fd;
+    int _port;
+};
+
+#endif /* HAVE_ACE */
+
+#endif /* !defined(_comshm_h) */
@@ -43,6 +43,7 @@
 #include <ComTerp/bquotefunc.h>
 #include <ComTerp/charfunc.h>
 #include <ComTerp/comfunc.h>
+#include <ComTerp/comprofile.h>
 #include <ComTerp/comterp.h>
 #include <ComTerp/comterpserv.h>
 #include <ComTerp/comvalue.h>
@@ -55,12 +56,14 @@
 #include <ComTerp/listfunc.h>
 #include <ComTerp/mathfunc.h>
 #include <ComTerp/numfunc.h>
+#include <ComTerp/parfunc.h>
 #include <ComTerp/postfunc.h>
 #include <ComTerp/randfunc.h>
 #include <ComTerp/statfunc.h>
 #include <ComTerp/strmfunc.h>
 #include <ComTerp/symbolfunc.h>
 #include <ComTerp/typefunc.h>
+#include <ComTerp/vecfunc.h>
 #include <ComTerp/xformfunc.h>
 #include <Attribute/attrlist.h>
 #include <Attribute/attribute.h>
@@ -158,6 +161,7 @@ void ComTerp::init() {
     _val_for_next_func = nil;
     _func_for_next_expr = nil;
     _trace_mode = 0;
+    _profile = nil;
     _npause = 0;
     _stepflag = 0;
     _echo_postfix = 0;
@@ -176,6 +180,7 @@ ComTerp::~ComTerp() {
 	KANRET ("error in call to dmm_free");
 
     delete _errbuf;
+    delete _profile;
 }
 
 const ComValue* ComTerp::stack(unsigned int &top) const {
@@ -363,7 +368,10 @@ void ComTerp::eval_expr_internals(int pedepth) {
     else
       stack_base -= 1;
 
+    ComProfile* profile = _profile && _profile->running() ? _profile : nil;
+    if (profile) profile->enter(func->funcid(), _linenum);
     func->execute();
+    if (profile) profile->leave();
     func->pop_funcstate();
 
     if (_just_reset && !_func_for_next_expr) {
@@ -1132,6 +1140,9 @@ void ComTerp::add_defaults() {
     add_command("next", new NextFunc(this));
     add_command("each", new EachFunc(this));
     add_command("filter", new FilterFunc(this));
+    add_command("pmap", new ParMapFunc(this));
+    add_command("pfilter", new ParFilterFunc(this));
+    add_command("preduce", new ParReduceFunc(this));
 
     add_command("dot", new DotFunc(this));
     add_command("attrname", new DotNameFunc(this));
@@ -1141,6 +1152,7 @@ void ComTerp::add_defaults() {
     add_command("at", new ListAtFunc(this));
     add_command("size", new ListSizeFunc(this));
     add_command("tuple", new TupleFunc(this));
+    add_command("vector", new VectorFunc(this));
 
     add_command("sum", new SumFunc(this));
     add_command("mean", new MeanFunc(this));
@@ -1182,6 +1194,7 @@ void ComTerp::add_defaults() {
     add_command("help", new HelpFunc(this));
     add_command("optable", new OptableFunc(this));
     add_command("trace", new ComterpTraceFunc(this));
+    add_command("profile", new ComterpProfileFunc(this));
     add_command("pause", new ComterpPauseFunc(this));
     add_command("step", new ComterpStepFunc(this));
     add_command("stackheight", new ComterpStackHeightFunc(this));
@@ -1311,6 +1324,11 @@ void ComTerp::handler(ComterpHandler* handler) {
     _handler = handler;
 }
 
+void ComTerp::profile(ComProfile* profile) {
+    if (profile != _profile) delete _profile;
+    _profile = profile;
+}
+
 
 void ComTerp::load_postfix(postfix_token* tokens, int toklen, int tokoff) {
     if (toklen>_pfsiz) {
@@ -1509,6 +1527,7 @@ void ComTerp::pop_servstate() {
 
     /* restore copies of everything */
     _pfbuf = cts_state->pfbuf();
+    _pfsiz = cts_state->pfsiz();
     _pfnum = cts_state->pfnum();
     _pfoff = cts_state->pfoff();
     _bufptr = cts_state->bufptr();
@@ -1530,6 +1549,7 @@ void ComTerp::push_servstate() {
 
   /* save copies of everything */
   cts_state.pfbuf() = _pfbuf;
+  cts_state.pfsiz() = _pfsiz;
   cts_state.pfnum() = _pfnum;
   cts_state.pfoff() = _pfoff;
   cts_state.bufptr() = _bufptr;
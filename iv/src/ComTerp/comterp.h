@@ -43,6 +43,7 @@ class AttributeList;
 class AttributeValue;
 class ComFunc;
 class ComFuncState;
+class ComProfile;
 class ComTerpState;
 class ComValue;
 #include <iosfwd>
@@ -246,6 +247,11 @@ public:
     int trace_mode() { return _trace_mode; }
     // return trace mode
 
+    ComProfile* profile() { return _profile; }
+    // return profiler, nil if none.
+    void profile(ComProfile*);
+    // set profiler, which is told of every command call while it is running.
+
     int& npause() { return _npause; }
     // return (reference to) number of pauses
 
@@ -349,6 +355,9 @@ protected:
     int _trace_mode;
     // trace mode
 
+    ComProfile* _profile;
+    // profiler
+
     int _npause;
     // depth of pause
 
@@ -373,6 +382,7 @@ protected:
     friend class ComFunc;
     friend class ComterpHandler;
     friend class ComTerpIOHandler;
+    friend class ParallelFunc;
 };
 
 //: object for holding ComTerp state
@@ -385,6 +395,7 @@ public:
   // copy constructor.
 
   postfix_token*& pfbuf() { return _pfbuf; }
+  unsigned& pfsiz() { return _pfsiz; }
   int& pfnum() { return _pfnum; }
   int& pfoff() { return _pfoff; }
   int& bufptr() { return _bufptr; }
@@ -401,6 +412,7 @@ public:
 protected:
 
   postfix_token* _pfbuf;
+  unsigned _pfsiz;
   int _pfnum;
   int _pfoff;
   int _bufptr;
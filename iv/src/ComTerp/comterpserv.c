@@ -30,7 +30,12 @@
 #include <ComTerp/ctrlfunc.h>
 #include <OS/math.h>
 #include <iostream.h>
+#include <ctype.h>
+#include <fcntl.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #if __GNUC__>=3
 #include <fstream.h>
 #endif
@@ -45,7 +50,11 @@ ComTerpServ::ComTerpServ(int bufsize, int fd)
 {
     _bufsiz = bufsize;
     _instr = new char[_bufsiz];
+    _instr[0] = '\0';
+    _inview = _instr;
+    _inlen = _inpos = 0;
     _outstr = new char[_bufsiz];
+    _outpos = 0;
     _inptr = this;
     _infunc = (infuncptr)&ComTerpServ::s_fgets;
     _eoffunc = (eoffuncptr)&ComTerpServ::s_feof;
@@ -97,25 +106,74 @@ void ComTerpServ::load_string(const char* expr) {
             *(inptr) = '\n';
 	    *(inptr+1) = '\0';
     }
+    _inview = _instr;
+    _inlen = _bufsiz-1;
+}
+
+void ComTerpServ::load_view(const char* buf, int len) {
+    _inview = buf;
+    _inlen = len;
+    _inpos = 0;
 }
 
 char* ComTerpServ::s_fgets(char* s, int n, void* serv) {
     ComTerpServ* server = (ComTerpServ*)serv;
-    char* instr = server->_instr;
+    const char* instr = server->_inview;
     char* outstr = s;
     int& inpos = server->_inpos;
-    int& bufsize = server->_bufsiz;
+    int inlen = server->_inlen;
 
     int outpos;
+    int cut = 0;
+    char quote = '\0';
+    boolean escaped = false;
+
+    /* copy characters until n-2 characters are transferred, */
+    /* the input buffer is exhausted, or a newline is found, */
+    /* noting the last whitespace, or comma before an operand, */
+    /* outside of a string or character constant.  That is */
+    /* where a line too long can be cut between tokens. */
+    for (outpos = 0; outpos < n-2 && inpos+outpos < inlen; outpos++) {
+	char ch = instr[inpos+outpos];
+	char next = inpos+outpos+1 < inlen ? instr[inpos+outpos+1] : '\0';
+	if (ch == '\n' || ch == '\0')
+	    break;
+	outstr[outpos] = ch;
+	if (escaped)
+	    escaped = false;
+	else if (quote) {
+	    if (ch == '\\')
+		escaped = true;
+	    else if (ch == quote)
+		quote = '\0';
+	} else if (ch == '"' || ch == '\'')
+	    quote = ch;
+	else if (isspace(ch) || (ch == ',' && 
+		 (isalnum(next) || next == '.' || next == '"' || next == '(' ||
+		  next == '-' || next == '+')))
+	    cut = outpos+1;
+    }
+    boolean more = inpos+outpos < inlen && instr[inpos+outpos] != '\0';
 
-    /* copy characters until n-1 characters are transferred, */
-    /* the input buffer is exhausted, or a newline is found. */
-    for (outpos = 0; outpos < n-1 && inpos < bufsize-1 && instr[inpos] != '\n' && instr[inpos] != '\0';)
-	outstr[outpos++] = instr[inpos++];
+    /* copy the newline character */
+    if (more && instr[inpos+outpos] == '\n')
+	outstr[outpos++] = '\n';
 
-    /* copy the newline character if there is room */
-    if (outpos < n-1 && inpos < bufsize-1 && instr[inpos] == '\n')
-	outstr[outpos++] = instr[inpos++];
+    /* or leave the rest of a line too long for the next call, */
+    /* unless it would be taken for a comment line */
+    else if (more && cut > 0 && instr[inpos+cut] != '#')
+	outpos = cut;
+
+    /* or overfill so the scanner reports the line too long */
+    else if (more) {
+	outstr[outpos] = instr[inpos+outpos];
+	outpos++;
+    }
+    inpos += outpos;
+
+    /* end the last line with a newline */
+    if (!more && outpos > 0)
+	outstr[outpos++] = '\n';
 
     /* append a null byte */
     outstr[outpos] = '\0';
@@ -301,17 +359,36 @@ int ComTerpServ::runfile(const char* filename) {
     _outfunc = nil;
     _linenum = 0;
 
-    const int bufsiz = BUFSIZ*BUFSIZ;
-    char inbuf[bufsiz];
-    char outbuf[bufsiz];
-    inbuf[0] = '\0';
-#if __GNUC__<3
-    filebuf ibuf;
-    ibuf.open(filename, "r");
-#else
-    fileptr_filebuf ibuf(fopen(filename, "r"), ios_base::in);
-#endif
-    istream istr(&ibuf);
+    /* map the file into memory, or read all of it where it cannot be */
+    char* text = nil;
+    int len = 0;
+    boolean mapped = false;
+    int fd = open(filename, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = mmap(nil, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                text = (char*)p;
+                len = st.st_size;
+                mapped = true;
+            }
+        }
+        if (!mapped) {
+            int size = BUFSIZ;
+            int nread;
+            text = new char[size];
+            while ((nread = read(fd, text+len, size-len)) > 0)
+                if ((len += nread) == size) {
+                    char* bigger = new char[size*2];
+                    memcpy(bigger, text, len);
+                    delete [] text;
+                    text = bigger;
+                    size *= 2;
+                }
+        }
+        close(fd);
+    }
     ComValue* retval = nil;
     int status = 0;
    
@@ -321,12 +398,20 @@ int ComTerpServ::runfile(const char* filename) {
     postfix_token* tokbuf = copy_postfix_tokens(toklen);
     int tokoff = _pfoff;
     
-    while( istr.good()) {
-        istr.getline(inbuf, bufsiz-1);
-	if (istr.eof())
-	  break;
-	if (*inbuf) load_string(inbuf);
-	if (*inbuf && read_expr()) {
+    /* interpret each line where it lies, passing blank lines */
+    /* with the line that follows them so they are counted */
+    const char* end = text+len;
+    for (const char* line = text; line < end;) {
+        const char* start = line;
+	while (line < end && *line == '\n')
+	    line++;
+	if (line == end)
+	    break;
+        const char* eol = (const char*)memchr(line, '\n', end-line);
+	int linelen = (eol ? eol : end) - line;
+	load_view(start, line+linelen - start);
+	line += linelen+1;
+	if (read_expr()) {
 	    if (eval_expr(true)) {
 	        err_print( stderr, "comterp" );
 #if __GNUC__<3
@@ -355,7 +440,7 @@ int ComTerpServ::runfile(const char* filename) {
 	        /* save last thing on stack */
 	        retval = new ComValue(pop_stack());
 	    }
-	} else 	if (*inbuf) {
+	} else {
 	  err_print( stderr, "comterp" );
 #if __GNUC__<3
 	  filebuf obuf(handler() ? handler()->get_handle() : 1);
@@ -380,6 +465,11 @@ int ComTerpServ::runfile(const char* filename) {
 	}
     }
 
+    if (mapped)
+        munmap(text, len);
+    else
+        delete [] text;
+
     load_postfix(tokbuf, toklen, tokoff);
     delete tokbuf;
 
@@ -432,24 +522,7 @@ ComValue ComTerpServ::run(const char* expression, boolean nested) {
     _pfcomvals = nil;
 
     if (expression) {
-        load_string(expression);
-#if 0
-	infuncptr save_infunc = _infunc;
-	eoffuncptr save_eoffunc = _eoffunc;
-	errfuncptr save_errfunc = _errfunc;
-	void* save_inptr = _inptr;
-#endif
-	_infunc = (infuncptr)&ComTerpServ::s_fgets;
-	_eoffunc = (eoffuncptr)&ComTerpServ::s_feof;
-	_errfunc = (errfuncptr)&ComTerpServ::s_ferror;
-	_inptr = this;
-        read_expr();
-#if 0
-	_infunc = save_infunc;
-	_eoffunc = save_eoffunc;
-	_errfunc = save_errfunc;
-	_inptr = save_inptr;
-#endif
+        read_in_place(expression);
         err_str(_errbuf, BUFSIZ, "comterp");
     }
     if (!*_errbuf) {
@@ -513,10 +586,29 @@ ComValue ComTerpServ::run(postfix_token* tokens, int ntokens) {
     return retval;
 }
 
+boolean ComTerpServ::read_in_place(const char* expression) {
+    /* let the scanner work on the string itself, taking its */
+    /* null byte for end-of-file, rather than copying in lines */
+    char* save_buffer = _buffer;
+    _buffer = (char*)expression;
+    _bufptr = 0;
+    _linenum = 0;
+    _infunc = nil;
+    _inptr = this;
+    boolean status = read_expr();
+    _buffer = save_buffer;
+    _bufptr = 0;
+    _buffer[_bufptr] = '\0';
+
+    /* drop the end-of-file of an empty string */
+    if (_pfnum && _pfbuf[_pfnum-1].type == TOK_EOF)
+        _pfnum--;
+    return status;
+}
+
 postfix_token* ComTerpServ::gen_code(const char* script, int& ntoken) {
     push_servstate();
-    load_string(script);
-    read_expr();
+    read_in_place(script);
     postfix_token* copied_tokens = copy_postfix_tokens(ntoken);
     pop_servstate();
     return copied_tokens;
@@ -532,6 +624,8 @@ void ComTerpServ::add_defaults() {
     ComTerp::add_defaults();
     add_command("remote", new RemoteFunc(this));
     add_command("socket", new SocketFunc(this));
+    add_command("wait", new WaitFunc(this));
+    add_command("waitall", new WaitAllFunc(this));
     add_command("eval", new EvalFunc(this));
   }
 }
@@ -48,6 +48,11 @@ public:
 
     void load_string(const char*);
     // load string to be interpreted into buffer.
+    void load_view(const char* buf, int len);
+    // arrange to interpret the 'len' bytes at 'buf' without copying
+    // them first.  They are handed to the scanner a line at a time, a
+    // line too long for its buffer cut between tokens, so 'buf' must
+    // outlive the reading.
     void read_string(const char*);
     // load string to be interpreted into buffer, and read postfix
     // tokens from it.
@@ -65,7 +70,8 @@ public:
     // execute a buffer of postfix tokens and return the value.
     
     virtual int runfile(const char*);
-    // run interpreter on commands read from a file.
+    // run interpreter on commands read a line at a time from a file,
+    // mapped into memory where it can be.
 
     void add_defaults();
     // add a default list of ComFunc objects to this interpreter.
@@ -77,6 +83,9 @@ public:
     boolean delete_later() { return _delete_later; }
 
 protected:
+    boolean read_in_place(const char*);
+    // read postfix tokens for the first expression in a null-terminated
+    // string, scanning it where it lies rather than a line at a time.
 
     static char* s_fgets(char* s, int n, void* serv);
     // signature like fgets used to copy input from a buffer.
@@ -93,6 +102,8 @@ protected:
 
 protected:
     char* _instr;
+    const char* _inview;
+    int _inlen;
     int _inpos;
     char* _outstr;
     int _outpos;
@@ -28,6 +28,7 @@
 #include <ComTerp/comterp.h>
 #include <Attribute/attrlist.h>
 #include <Attribute/attribute.h>
+#include <Attribute/attrvector.h>
 #include <Attribute/aliterator.h>
 #include <Attribute/paramlist.h>
 
@@ -92,6 +93,7 @@ ComValue::ComValue(void* funcptr, AttributeValueList* listptr) : AttributeValue(
 ComValue::ComValue(const char* string) : AttributeValue(string) {zero_vals();}
 ComValue::ComValue(ComFunc* func) : AttributeValue(ComFunc::class_symid(), func) {zero_vals(); type(ComValue::CommandType); command_symid(func->funcid()); }
 ComValue::ComValue(ComponentView* view, int compid) : AttributeValue(view, compid) {zero_vals();}
+ComValue::ComValue(Resource* obj, int classid) : AttributeValue(obj, classid) {zero_vals();}
 
 ComValue::~ComValue() {
 }
@@ -338,7 +340,13 @@ ostream& operator<< (ostream& out, const ComValue& sv) {
 	case ComValue::ObjectType:
 	  if (svp->class_symid() == Attribute::class_symid())
 	    out << *((Attribute*)svp->obj_val())->Value();
-	  else
+	  else if (svp->is_vector()) {
+	    AttributeValueVector* vec = svp->vector_val();
+	    if (brief)
+	      out << "{" << *vec << "}";
+	    else
+	      out << "vector of length " << vec->Number() << "\n\t" << *vec;
+	  } else
             out << /* "<" << */ symbol_pntr(svp->class_symid()) /* << ">" */ ;
 	  break;
 
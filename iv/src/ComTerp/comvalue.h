@@ -92,6 +92,8 @@ public:
     // CommandType constructor.
     ComValue(ComponentView* view, int compid);
     // ComponentView constructor.
+    ComValue(Resource* obj, int classid);
+    // ObjectType constructor for a Resource, referenced while held.
 
     void init();
     // initialize member variables.
@@ -26,14 +26,29 @@
 #include <ComTerp/comhandler.h>
 
 #include <ComTerp/ctrlfunc.h>
+#include <ComTerp/comshm.h>
 #include <ComTerp/comterpserv.h>
 #include <ComTerp/comvalue.h>
+#include <Attribute/aliterator.h>
 #include <Attribute/attrlist.h>
 
+#include <OS/string.h>
+#include <OS/table.h>
+
 #ifdef HAVE_ACE
 #include <ace/SOCK_Connector.h>
 #endif
 
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
 #define TITLE "CtrlFunc"
 
 #if __GNUC__>=3
@@ -121,8 +136,25 @@ void RemoteFunc::execute() {
   ComValue arg3v(stack_arg(2));
   static int nowait_sym = symbol_add("nowait");
   ComValue nowaitv(stack_key(nowait_sym));
+  static int async_sym = symbol_add("async");
+  ComValue asyncv(stack_key(async_sym));
   reset_stack();
 
+  /* send on a pooled connection and hand back a future */
+  if (asyncv.is_true()) {
+    RemoteFuture* future = nil;
+    if (arg1v.is_string() && arg2v.is_num() && arg3v.is_string()) {
+      RemoteConn* rconn = RemoteConn::get(arg1v.string_ptr(), arg2v.ushort_val());
+      if (rconn) future = rconn->send(arg3v.string_ptr());
+    }
+    if (future) {
+      ComValue retval(future, RemoteFuture::class_symid());
+      push_stack(retval);
+    } else
+      push_stack(ComValue::nullval());
+    return;
+  }
+
 #ifdef HAVE_ACE
 
 #if __GNUC__==3&&__GNUC_MINOR__<1
@@ -133,6 +165,7 @@ void RemoteFunc::execute() {
 
   ACE_SOCK_STREAM *socket = nil;
   ACE_SOCK_Connector *conn = nil;
+  ComterpShm* shm = nil;
   SocketObj* socketobj = nil;
   const char* cmdstr = nil;
   if (arg1v.is_string() && arg2v.is_num() && arg3v.is_string()) {
@@ -141,24 +174,44 @@ void RemoteFunc::execute() {
     const char* hoststr = arg1v.string_ptr();
     const char* portstr = arg2v.is_string() ? arg2v.string_ptr() : nil;
     u_short portnum = portstr ? atoi(portstr) : arg2v.ushort_val();
-    ACE_INET_Addr addr (portnum, hoststr);
-    socket = new ACE_SOCK_STREAM;
-    conn = new ACE_SOCK_Connector;
-    if (conn->connect (*socket, addr) == -1) {
-      ACE_ERROR ((LM_ERROR, "%p\n", "open"));
-      push_stack(ComValue::nullval());
-      return;
+    if (ComterpShm::loopback(hoststr))
+      shm = ComterpShm::connect(portnum);
+    if (!shm) {
+      ACE_INET_Addr addr (portnum, hoststr);
+      socket = new ACE_SOCK_STREAM;
+      conn = new ACE_SOCK_Connector;
+      if (conn->connect (*socket, addr) == -1) {
+	ACE_ERROR ((LM_ERROR, "%p\n", "open"));
+	push_stack(ComValue::nullval());
+	return;
+      }
     }
 
   } else if (arg1v.is_object() && arg2v.is_string()) {
     
     cmdstr = arg2v.string_ptr();
     socketobj = (SocketObj*)arg1v.geta(SocketObj::class_symid());
-    if (socketobj) 
+    if (socketobj) {
+      shm = socketobj->shm();
       socket = socketobj->socket();
+    }
     
   } else
     return;
+
+  /* a server on this host can be reached through shared memory */
+  if (shm) {
+    char* buf = nil;
+    if (shm->puts(cmdstr) >= 0 && nowaitv.is_false())
+      buf = shm->gets();
+    if (buf) {
+      ComValue retval(comterpserv()->run(buf, true));
+      push_stack(retval);
+    } else if (nowaitv.is_false())
+      push_stack(ComValue::nullval());
+    if (!socketobj) delete shm;
+    return;
+  }
   
 #if 0
 #if __GNUC__<3
@@ -227,11 +280,13 @@ int SocketObj::_symid = -1;
 SocketObj::SocketObj(const char* host, unsigned short port) {
   _socket = nil; 
   _conn = nil; 
+  _shm = nil;
   _host = strnew(host); 
   _port = port; 
 }
 
 SocketObj::~SocketObj() { 
+  delete _shm;
   if( _socket ) {
     _socket->close();
     delete _socket;
@@ -240,6 +295,8 @@ SocketObj::~SocketObj() {
 }
 
 int SocketObj::connect() { 
+  if (ComterpShm::loopback(_host) && (_shm = ComterpShm::connect(_port)))
+    return 0;
   ACE_INET_Addr addr(_port, _host); 
   _socket = new ACE_SOCK_STREAM;
   _conn = new ACE_SOCK_Connector; 
@@ -247,14 +304,295 @@ int SocketObj::connect() {
 }
 
 int SocketObj::close() { 
+  if (_shm) {
+    delete _shm;
+    _shm = nil;
+    return 0;
+  }
   return _socket->close(); 
 }
 
 int SocketObj::get_handle() { 
-  return _socket->get_handle(); 
+  return _shm ? _shm->handle() : _socket->get_handle(); 
 }
 #endif
 
+/*****************************************************************************/
+declareTable(RemoteConnTable,int,RemoteConn*)
+implementTable(RemoteConnTable,int,RemoteConn*)
+
+static RemoteConnTable* remote_conns = nil;
+
+/* echoed by the server after each command sent with :async */
+static const char* remote_marker = "#remote-reply ";
+
+int RemoteFuture::_symid = -1;
+
+RemoteFuture::RemoteFuture(RemoteConn* conn, unsigned long id) {
+  _conn = conn;
+  _next = nil;
+  _id = id;
+  _reply = nil;
+  _done = false;
+}
+
+RemoteFuture::~RemoteFuture() {
+  delete [] _reply;
+}
+
+RemoteConn::RemoteConn(int key) {
+  _key = key;
+  _shm = nil;
+  _fd = -1;
+  _insiz = BUFSIZ;
+  _in = new char[_insiz];
+  _inlen = 0;
+  _last = nil;
+  _nextid = 0;
+  _head = _tail = nil;
+}
+
+RemoteConn::~RemoteConn() {
+  delete _shm;
+  if (_fd >= 0) ::close(_fd);
+  delete [] _in;
+  delete [] _last;
+}
+
+RemoteConn* RemoteConn::get(const char* host, unsigned short port) {
+  char keystr[BUFSIZ];
+  snprintf(keystr, BUFSIZ, "%s:%d", host, port);
+  int key = symbol_add(keystr);
+  if (!remote_conns) remote_conns = new RemoteConnTable(32);
+
+  RemoteConn* conn;
+  if (remote_conns->find(conn, key)) {
+    symbol_del(key);
+    return conn;
+  }
+  conn = new RemoteConn(key);
+  if (!conn->connect(host, port)) {
+    delete conn;
+    symbol_del(key);
+    return nil;
+  }
+  remote_conns->insert(key, conn);
+  return conn;
+}
+
+boolean RemoteConn::connect(const char* host, unsigned short port) {
+  if (ComterpShm::loopback(host) && (_shm = ComterpShm::connect(port)))
+    return true;
+
+  struct sockaddr_in name;
+  memset(&name, 0, sizeof(name));
+  name.sin_family = AF_INET;
+  name.sin_port = htons(port);
+  name.sin_addr.s_addr = inet_addr(host);
+  if (name.sin_addr.s_addr == INADDR_NONE) {
+    struct hostent* hp = gethostbyname(host);
+    if (!hp || hp->h_addrtype != AF_INET) {
+      cerr << "remote: no such host " << host << "\n";
+      return false;
+    }
+    memcpy(&name.sin_addr, hp->h_addr, sizeof(name.sin_addr));
+  }
+  _fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (_fd < 0 || ::connect(_fd, (struct sockaddr*)&name, sizeof(name)) < 0) {
+    cerr << "remote: unable to connect to " << host << ":" << port 
+	 << ": " << strerror(errno) << "\n";
+    return false;
+  }
+  return true;
+}
+
+static int remote_write(int fd, const char* buf, int len) {
+  for (int done = 0; done < len;) {
+    int status = ::write(fd, buf + done, len - done);
+    if (status < 0 && errno == EINTR) continue;
+    if (status < 0) return -1;
+    done += status;
+  }
+  return len;
+}
+
+RemoteFuture* RemoteConn::send(const char* cmdstr) {
+  RemoteFuture* future = new RemoteFuture(this, ++_nextid);
+  Resource::ref(future);    /* until its reply arrives */
+  if (_tail)
+    _tail->_next = future;
+  else
+    _head = future;
+  _tail = future;
+
+  /* the command, then a string for the server to echo when it is done */
+  char marker[64];
+  snprintf(marker, sizeof(marker), "\"%s%lu\"\n", remote_marker, future->_id);
+  int len = strlen(cmdstr);
+  int status;
+  if (_shm) {
+    status = _shm->puts(cmdstr);
+    if (status >= 0) status = _shm->puts(marker);
+  } else {
+    status = remote_write(_fd, cmdstr, len);
+    if (status >= 0 && (len == 0 || cmdstr[len-1] != '\n'))
+      status = remote_write(_fd, "\n", 1);
+    if (status >= 0) status = remote_write(_fd, marker, strlen(marker));
+  }
+  if (status < 0) {
+    fail();    /* which releases the future with the rest */
+    return nil;
+  }
+  return future;
+}
+
+boolean RemoteConn::line(char* str) {
+  /* anything but an end marker is output of the oldest command */
+  int mlen = strlen(remote_marker);
+  int len = strlen(str);
+  if (len < mlen + 3 || str[0] != '"' || str[len-1] != '"' ||
+      strncmp(str + 1, remote_marker, mlen) != 0) {
+    delete [] _last;
+    _last = strnew(str);
+    return true;
+  }
+
+  RemoteFuture* future = _head;
+  if (!future || strtoul(str + 1 + mlen, nil, 10) != future->_id)
+    return false;
+  _head = future->_next;
+  if (!_head) _tail = nil;
+  future->_conn = nil;
+  future->_next = nil;
+  future->_reply = _last;
+  future->_done = true;
+  _last = nil;
+  Resource::unref(future);
+  return true;
+}
+
+void RemoteConn::fail() {
+  while (_head) {
+    RemoteFuture* future = _head;
+    _head = future->_next;
+    future->_conn = nil;
+    future->_next = nil;
+    future->_done = true;
+    Resource::unref(future);
+  }
+  _tail = nil;
+  remote_conns->remove(_key);
+  symbol_del(_key);
+  delete this;
+}
+
+boolean RemoteConn::read() {
+  if (_shm) {
+    _shm->drain();
+    char* str;
+    while ((str = _shm->getline())) 
+      if (!line(str)) {
+	fail();
+	return false;
+      }
+    if (_head && _shm->closed()) {
+      fail();
+      return false;
+    }
+    return true;
+  }
+
+  for (;;) {
+    if (_inlen == _insiz) {
+      char* in = new char[_insiz * 2];
+      memcpy(in, _in, _inlen);
+      delete [] _in;
+      _in = in;
+      _insiz *= 2;
+    }
+    int got = recv(_fd, _in + _inlen, _insiz - _inlen, MSG_DONTWAIT);
+    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      fail();
+      return false;
+    }
+    if (got < 0) break;
+
+    /* hand over each line that arrived */
+    int start = 0;
+    for (int i = _inlen; i < _inlen + got; i++) 
+      if (_in[i] == '\n') {
+	_in[i] = '\0';
+	if (!line(_in + start)) {
+	  fail();
+	  return false;
+	}
+	start = i + 1;
+      }
+    _inlen += got;
+    memmove(_in, _in + start, _inlen - start);
+    _inlen -= start;
+  }
+  return true;
+}
+
+int RemoteConn::pollfds(struct pollfd* fds, int& timeout) {
+  if (_shm) {
+    if (!_shm->sleep()) timeout = 0;   /* input is already waiting */
+    fds[0].fd = _shm->wakeup_handle();
+    fds[1].fd = _shm->handle();
+    fds[0].events = fds[1].events = POLLIN;
+    return 2;
+  }
+  fds[0].fd = _fd;
+  fds[0].events = POLLIN;
+  return 1;
+}
+
+static double remote_now() {
+  struct timeval tv;
+  gettimeofday(&tv, nil);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+boolean RemoteConn::wait(RemoteFuture** futures, int n, double timeout) {
+  double deadline = remote_now() + timeout;
+  RemoteConn** conns = new RemoteConn*[n];
+  struct pollfd* fds = new struct pollfd[2*n];
+  boolean alldone;
+
+  for (;;) {
+    /* read what has arrived, then see which connections still owe replies */
+    for (int i = 0; i < n; i++) 
+      if (!futures[i]->done()) futures[i]->_conn->read();
+
+    int nconns = 0;
+    for (int i = 0; i < n; i++) {
+      RemoteConn* conn = futures[i]->_conn;
+      if (futures[i]->done()) continue;
+      int j;
+      for (j = 0; j < nconns && conns[j] != conn; j++);
+      if (j == nconns) conns[nconns++] = conn;
+    }
+    alldone = nconns == 0;
+    if (alldone) break;
+
+    int ms = -1;
+    if (timeout >= 0) {
+      double left = deadline - remote_now();
+      if (left <= 0) break;
+      ms = (int)(left * 1000) + 1;
+    }
+    int nfds = 0;
+    for (int j = 0; j < nconns; j++) 
+      nfds += conns[j]->pollfds(fds + nfds, ms);
+    if (poll(fds, nfds, ms) < 0 && errno != EINTR) break;
+  }
+
+  delete [] conns;
+  delete [] fds;
+  return alldone;
+}
+
 /*****************************************************************************/
 
 SocketFunc::SocketFunc(ComTerp* comterp) : ComFunc(comterp) {
@@ -302,6 +640,75 @@ void SocketFunc::execute() {
 
 /*****************************************************************************/
 
+WaitFunc::WaitFunc(ComTerp* comterp) : ComFunc(comterp) {
+}
+
+void WaitFunc::execute() {
+  ComValue futurev(stack_arg(0));
+  static int timeout_sym = symbol_add("timeout");
+  ComValue timeoutv(stack_key(timeout_sym));
+  reset_stack();
+
+  RemoteFuture* future = futurev.is_object() 
+    ? (RemoteFuture*)futurev.geta(RemoteFuture::class_symid()) : nil;
+  double timeout = timeoutv.is_num() ? timeoutv.double_val() : -1.0;
+  if (future && RemoteConn::wait(&future, 1, timeout) && future->reply()) {
+    ComValue retval(comterpserv()->run(future->reply(), true));
+    push_stack(retval);
+  } else
+    push_stack(ComValue::nullval());
+}
+
+/*****************************************************************************/
+
+WaitAllFunc::WaitAllFunc(ComTerp* comterp) : ComFunc(comterp) {
+}
+
+void WaitAllFunc::execute() {
+  static int timeout_sym = symbol_add("timeout");
+  ComValue timeoutv(stack_key(timeout_sym));
+
+  /* gather the futures from a list or the fixed arguments */
+  AttributeValueList* args = new AttributeValueList();
+  Resource::ref(args);
+  ComValue firstv(stack_arg(0));
+  if (nargsfixed()==1 && firstv.is_array()) {
+    AttributeValueList* avl = firstv.array_val();
+    Iterator it;
+    for (avl->First(it); !avl->Done(it); avl->Next(it))
+      args->Append(new ComValue(*avl->GetAttrVal(it)));
+  } else 
+    for (int i=0; i<nargsfixed(); i++)
+      args->Append(new ComValue(stack_arg(i)));
+  reset_stack();
+
+  int n = 0;
+  RemoteFuture** futures = new RemoteFuture*[args->Number()];
+  Iterator it;
+  for (args->First(it); !args->Done(it); args->Next(it)) {
+    AttributeValue* av = args->GetAttrVal(it);
+    RemoteFuture* future = av->is_object() 
+      ? (RemoteFuture*)av->geta(RemoteFuture::class_symid()) : nil;
+    if (future) futures[n++] = future;
+  }
+
+  double timeout = timeoutv.is_num() ? timeoutv.double_val() : -1.0;
+  if (RemoteConn::wait(futures, n, timeout)) {
+    AttributeValueList* avl = new AttributeValueList();
+    for (int i=0; i<n; i++) 
+      avl->Append(futures[i]->reply() 
+		  ? new ComValue(comterpserv()->run(futures[i]->reply(), true))
+		  : new ComValue(ComValue::nullval()));
+    ComValue retval(avl);
+    push_stack(retval);
+  } else
+    push_stack(ComValue::nullval());
+  delete [] futures;
+  Resource::unref(args);
+}
+
+/*****************************************************************************/
+
 EvalFunc::EvalFunc(ComTerp* comterp) : ComFunc(comterp) {
 }
 
@@ -25,6 +25,7 @@
 #define _ctrlfunc_h
 
 #include <ComTerp/comfunc.h>
+#include <InterViews/resource.h>
 
 class ComTerp;
 
@@ -85,19 +86,23 @@ public:
 
     virtual void execute();
     virtual const char* docstring() { 
-      return "%s(hoststr|sockobj [portnum] cmdstr :nowait) -- remotely evaluate command string then locally evaluate result string"; }
+      return "%s(hoststr|sockobj [portnum] cmdstr :nowait :async) -- remotely evaluate command string then locally evaluate result string\n:async -- send on a pooled connection and return a future for wait or waitall"; }
 
 };
 
 #ifdef HAVE_ACE
 class ACE_SOCK_STREAM;
 class ACE_SOCK_Connector;
+class ComterpShm;
 
 class SocketObj {
  public:
   SocketObj(const char* host, unsigned short port); 
   virtual ~SocketObj();
   ACE_SOCK_STREAM* socket() { return _socket; }
+  ComterpShm* shm() { return _shm; }
+  // shared-memory connection used instead of the socket for a server on
+  // this host that offers one.
   int connect();
   int close();
   const char* host() { return _host; }
@@ -106,12 +111,89 @@ class SocketObj {
 
   ACE_SOCK_STREAM* _socket;
   ACE_SOCK_Connector* _conn;
+  ComterpShm* _shm;
   char* _host;
   unsigned short _port;
 
   CLASS_SYMID("SocketObj");
 };
+
 #endif
+
+class ComterpShm;
+class RemoteConn;
+
+//: result of a command sent with remote(... :async).
+// Reference counted: the connection holds a reference until the reply
+// arrives, and each ComValue that holds the future holds another.
+class RemoteFuture : public Resource {
+ public:
+  virtual ~RemoteFuture();
+
+  boolean done() { return _done; }
+  // true once the reply has arrived or the connection was lost.
+  const char* reply() { return _reply; }
+  // last line the command printed, which holds its value, or nil if it
+  // printed nothing or the connection was lost first.
+
+  CLASS_SYMID("RemoteFuture");
+ protected:
+  RemoteFuture(RemoteConn*, unsigned long id);
+
+  RemoteConn* _conn;
+  RemoteFuture* _next;
+  unsigned long _id;
+  char* _reply;
+  boolean _done;
+
+  friend class RemoteConn;
+};
+
+//: pooled connection to a comterp server for pipelined remote commands.
+// One connection is kept per host and port, through shared memory when
+// the server is on this host and offers it, otherwise over TCP.  Commands
+// are written as soon as they are sent, each followed by a line that
+// makes the server echo an end marker carrying the command's id, since a
+// command may print any number of lines.  The server runs them in order,
+// so each marker completes the oldest outstanding RemoteFuture.  All the
+// commands sent on one connection run in the same interpreter on the
+// server, one after another.
+class RemoteConn {
+ public:
+  static RemoteConn* get(const char* host, unsigned short port);
+  // pooled connection to 'host' and 'port', opened on first use; nil if
+  // it cannot be opened.
+  RemoteFuture* send(const char* cmdstr);
+  // send a command and return the future of its result.
+  boolean read();
+  // complete the futures whose replies have arrived, without blocking.
+  // Once the connection is lost its futures fail, it is deleted and
+  // false is returned.
+
+  static boolean wait(RemoteFuture** futures, int n, double timeout);
+  // wait until each of the 'n' futures is done, or 'timeout' seconds
+  // pass (forever if negative), reading replies from all their
+  // connections at once; true if all are done.
+ protected:
+  RemoteConn(int key);
+  ~RemoteConn();
+
+  boolean connect(const char* host, unsigned short port);
+  boolean line(char*);
+  void fail();
+  int pollfds(struct pollfd*, int& timeout);
+
+  int _key;
+  ComterpShm* _shm;
+  int _fd;
+  char* _in;
+  int _insiz;
+  int _inlen;
+  char* _last;
+  unsigned long _nextid;
+  RemoteFuture* _head;
+  RemoteFuture* _tail;
+};
   
 //: create socket object
 // sockobj=socket(hoststr portnum) -- create and open socket object
@@ -125,6 +207,31 @@ public:
       return "%s(hoststr portnum ) -- create and open socket object"; }
 };
 
+//: wait command for ComTerp.
+// val=wait(future :timeout secs) -- wait for the result of remote(... :async) and evaluate it.
+class WaitFunc : public ComFunc {
+public:
+    WaitFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() { 
+      return "val=%s(future :timeout secs) -- wait for the result of remote(... :async) and evaluate it, nil on timeout"; }
+
+};
+
+//: waitall command for ComTerp.
+// lst=waitall(futurelst|future [future ...] :timeout secs) -- wait for the results of 
+// several remote(... :async) commands at once and evaluate them.
+class WaitAllFunc : public ComFunc {
+public:
+    WaitAllFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() { 
+      return "lst=%s(futurelst|future [future ...] :timeout secs) -- wait for the results of several remote(... :async) commands at once and evaluate them, nil on timeout"; }
+
+};
+
 //: eval string command for ComTerp.
 // str|lst=eval(cmdstr [cmdstr ...] :symret) -- evaluate string as commands, optionally returning symbol instead of nil.
 class EvalFunc : public ComFunc {
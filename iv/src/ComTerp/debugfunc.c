@@ -31,6 +31,7 @@
 #endif
 
 #include <ComTerp/comhandler.h>
+#include <ComTerp/comprofile.h>
 
 #include <ComTerp/debugfunc.h>
 #include <ComTerp/comterpserv.h>
@@ -74,6 +75,71 @@ void ComterpTraceFunc::execute() {
 
 /*****************************************************************************/
 
+ComterpProfileFunc::ComterpProfileFunc(ComTerp* comterp) : ComFunc(comterp) {
+}
+
+void ComterpProfileFunc::execute() {
+  static int get_symid = symbol_add("get");
+  static int reset_symid = symbol_add("reset");
+  static int report_symid = symbol_add("report");
+  static int folded_symid = symbol_add("folded");
+  static int top_symid = symbol_add("top");
+  static int file_symid = symbol_add("file");
+  int nfixed = nargsfixed();
+  ComValue flagv(stack_arg(0));
+  boolean get_flag = stack_key(get_symid).is_true();
+  boolean reset_flag = stack_key(reset_symid).is_true();
+  boolean report_flag = stack_key(report_symid).is_true();
+  boolean folded_flag = stack_key(folded_symid).is_true();
+  ComValue topv(stack_key(top_symid));
+  ComValue filev(stack_key(file_symid));
+  reset_stack();
+
+  ComProfile* profile = comterp()->profile();
+  if (!profile) {
+    profile = new ComProfile();
+    comterp()->profile(profile);
+  }
+
+  if (reset_flag) 
+    profile->reset();
+
+  if (report_flag || folded_flag) {
+    if (filev.is_string()) {
+      std::ofstream out(filev.string_ptr());
+      if (!out) {
+	push_stack(ComValue::nullval());
+	return;
+      }
+      if (report_flag) profile->report(out, topv.int_val());
+      if (folded_flag) profile->folded(out);
+    } else {
+#if __GNUC__<3
+      filebuf fbufout;
+      if (comterp()->handler()) {
+	int fd = max(1, comterp()->handler()->get_handle());
+	fbufout.attach(fd);
+      } else
+	fbufout.attach(fileno(stdout));
+#else
+      fileptr_filebuf fbufout(comterp()->handler() && comterp()->handler()->wrfptr()
+			      ? comterp()->handler()->wrfptr() : stdout, ios_base::out);
+#endif
+      ostream out(&fbufout);
+      if (report_flag) profile->report(out, topv.int_val());
+      if (folded_flag) profile->folded(out);
+    }
+  } else if (nfixed>0) 
+    profile->running(flagv.is_true());
+  else if (!get_flag && !reset_flag)
+    profile->running(!profile->running());
+
+  ComValue retval(profile->running(), ComValue::IntType);
+  push_stack(retval);
+}
+
+/*****************************************************************************/
+
 ComterpPauseFunc::ComterpPauseFunc(ComTerp* comterp) : ComFunc(comterp) {
 }
 
@@ -44,6 +44,24 @@ public:
       return "val=%s([flag] :get) -- toggle or set trace mode"; }
 };
 
+//: command for profiling commands
+// val=profile([flag] :get :reset :report :folded :top n :file pathname) --
+// toggle or set profiling, or write the profile so far.
+//
+// With :report a table of commands and a table of lines is written, ordered
+// by exclusive time; :top limits the rows of each.  With :folded one line is
+// written per distinct stack of nested commands, the input format of flame
+// graph tools.  Output goes to 'pathname' or else to the interpreter's
+// output.
+class ComterpProfileFunc : public ComFunc {
+public:
+    ComterpProfileFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() { 
+      return "val=%s([flag] :get :reset :report :folded :top n :file pathname) -- toggle or set profiling, or write profile"; }
+};
+
 //: command to pause script execution until C/R
 // pause -- pause script execution until C/R
 class ComterpPauseFunc : public ComFunc {
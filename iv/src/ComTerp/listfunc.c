@@ -30,6 +30,7 @@
 #include <Attribute/aliterator.h>
 #include <Attribute/attrlist.h>
 #include <Attribute/attribute.h>
+#include <Attribute/attrvector.h>
 #include <iostream.h>
 
 #define TITLE "ListFunc"
@@ -49,6 +50,8 @@ void ListFunc::execute() {
 
   if (listv.is_array()) 
     avl = new AttributeValueList(listv.array_val());
+  else if (listv.is_vector())
+    avl = listv.vector_val()->List();
   else {
     avl = new AttributeValueList();
     if (listv.is_stream()) {
@@ -132,6 +135,17 @@ void ListAtFunc::execute() {
       }
     }
     #endif
+  } else if (listv.is_vector() && !nv.is_nil() && nv.int_val()>=0) {
+    AttributeValueVector* vec = listv.vector_val();
+    if (nv.int_val()<vec->Number()) {
+      if (setflag && setv.is_num())
+	vec->SetAttrVal(nv.int_val(), setv);
+      ComValue retval(ComValue::UnknownType);
+      vec->GetAttrVal(nv.int_val(), retval);
+      push_stack(retval);
+    } else
+      push_stack(ComValue::blankval());
+    return;
   } else if (listv.is_object(AttributeList::class_symid())) {
     AttributeList* al = (AttributeList*)listv.obj_val();
     if (al && nv.int_val()<al->Number()) {
@@ -168,6 +182,10 @@ void ListSizeFunc::execute() {
       push_stack(retval);
       return;			  
     }
+  } else if (listv.is_vector()) {
+    ComValue retval(listv.vector_val()->Number());
+    push_stack(retval);
+    return;
   } else if (listv.is_object(AttributeList::class_symid())) {
     AttributeList* al = (AttributeList*)listv.obj_val();
     if (al) {
@@ -36,7 +36,7 @@ class ComTerp;
 class ComValue;
 
 //: create list command for ComTerp.
-// lst=list([olst|strm|val] :strmlst) -- create list, copy list, or convert stream
+// lst=list([olst|strm|vec|val] :strmlst) -- create list, copy list, or convert stream or vector
 class ListFunc : public ComFunc {
 public:
     ListFunc(ComTerp*);
@@ -44,29 +44,29 @@ public:
     virtual void execute();
     virtual boolean post_eval() { return true; }
     virtual const char* docstring() { 
-      return "lst=%s([olst|strm|val] :strmlst) -- create list, copy list, or convert stream"; }
+      return "lst=%s([olst|strm|vec|val] :strmlst) -- create list, copy list, or convert stream or vector"; }
 };
 
 //: list member command for ComTerp.
-// val=at(list|attrlist n :set val) -- return (or set) the nth item in a list.
+// val=at(list|attrlist|vector n :set val) -- return (or set) the nth item in a list.
 class ListAtFunc : public ComFunc {
 public:
     ListAtFunc(ComTerp*);
 
     virtual void execute();
     virtual const char* docstring() { 
-      return "val=at(list|attrlist n :set val) -- return (or set) the nth item in a list"; }
+      return "val=at(list|attrlist|vector n :set val) -- return (or set) the nth item in a list"; }
 };
 
 //: list size command for ComTerp.
-// num=size(list|attrlist) -- return size of a list.
+// num=size(list|attrlist|vector) -- return size of a list.
 class ListSizeFunc : public ComFunc {
 public:
     ListSizeFunc(ComTerp*);
 
     virtual void execute();
     virtual const char* docstring() { 
-      return "val=size(list|attrlist) -- return the size of the list"; }
+      return "val=size(list|attrlist|vector) -- return the size of the list"; }
 };
 
 //: , (tuple) operator.
@@ -25,6 +25,7 @@
 #include <ComTerp/numfunc.h>
 #include <ComTerp/comvalue.h>
 #include <ComTerp/comterp.h>
+#include <ComTerp/vecfunc.h>
 #include <Unidraw/iterator.h>
 #include <Attribute/attrlist.h>
 #include <OS/math.h>
@@ -178,6 +179,14 @@ void NumFunc::promote(ComValue& op1, ComValue& op2) {
     return;
 }
 
+boolean NumFunc::vector_op(int op, ComValue& operand1, ComValue& operand2) {
+    if (!operand1.is_vector() && !operand2.is_vector()) return false;
+    ComValue result(VectorFunc::binary(op, operand1, operand2));
+    reset_stack();
+    push_stack(result);
+    return true;
+}
+
 /*****************************************************************************/
 
 AddFunc::AddFunc(ComTerp* comterp) : NumFunc(comterp) {
@@ -186,6 +195,7 @@ AddFunc::AddFunc(ComTerp* comterp) : NumFunc(comterp) {
 void AddFunc::execute() {
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::Add, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
 
@@ -283,6 +293,7 @@ SubFunc::SubFunc(ComTerp* comterp) : NumFunc(comterp) {
 void SubFunc::execute() {
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::Sub, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
 
@@ -333,6 +344,7 @@ MinusFunc::MinusFunc(ComTerp* comterp) : NumFunc(comterp) {
 
 void MinusFunc::execute() {
     ComValue& operand1 = stack_arg(0);
+    if (vector_op(VectorFunc::Sub, ComValue::zeroval(), operand1)) return;
     ComValue result(operand1);
 
     if (operand1.is_unknown()) {
@@ -383,6 +395,7 @@ MpyFunc::MpyFunc(ComTerp* comterp) : NumFunc(comterp) {
 void MpyFunc::execute() {
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::Mpy, operand1, operand2)) return;
     promote(operand1, operand2);
     ComValue result(operand1);
 
@@ -516,22 +529,16 @@ AttributeValueList* MpyFunc::matrix_mpy(AttributeValueList* list1,
 	for (int n=0; n<Math::max(j1max,1); n++) {
 	  
 	  /* locate the value from the second matrix */
-	  Iterator iti2, itj2;
-	  list2->First(iti2);
-	  for (int i=0; i<n; i++) list2->Next(iti2);
-	  AttributeValue* row2v = list1->GetAttrVal(iti2);
+	  AttributeValue* row2v = list2->Get(n);
 	  AttributeValueList* row2 = row2v && row2v->is_array() ? 
 	    row2v->array_val() : nil;
-	  if (row2) {
-	    row2->First(itj2);
-	    for (int j=0; j<j3; j++) row2->Next(itj2);
-	  }
-	  if ((row1 || !j1max) && row2) {
+	  AttributeValue* val2v = row2 ? row2->Get(j3) : nil;
+	  if ((row1 || !j1max) && val2v) {
 	    if (row1) 
 	      comterp()->push_stack(*row1->GetAttrVal(itj1));
 	    else
 	      comterp()->push_stack(*row1v);
-	    comterp()->push_stack(*row2->GetAttrVal(itj2));
+	    comterp()->push_stack(*val2v);
 	    exec(2,0);
 	    if (n) addfunc.exec(2,0);
 	  }
@@ -553,10 +560,7 @@ AttributeValueList* MpyFunc::matrix_mpy(AttributeValueList* list1,
       for (int n=0; n<Math::max(j1max,1); n++) {
 	  
 	/* locate the value from the lhs vector */
-	Iterator iti2;
-	list2->First(iti2);
-	for (int i=0; i<n; i++) list2->Next(iti2);
-	AttributeValue* val2v = list1->GetAttrVal(iti2);
+	AttributeValue* val2v = list2->Get(n);
 	if ((row1 || !j1max) && val2v) {
 	  if (row1) 
 	    comterp()->push_stack(*row1->GetAttrVal(itj1));
@@ -588,6 +592,7 @@ DivFunc::DivFunc(ComTerp* comterp) : NumFunc(comterp) {
 void DivFunc::execute() {
     ComValue& operand1 = stack_arg(0);
     ComValue& operand2 = stack_arg(1);
+    if (vector_op(VectorFunc::Div, operand1, operand2)) return;
     promote(operand1, operand2);
 
     if (operand1.is_unknown() || operand2.is_unknown()) {
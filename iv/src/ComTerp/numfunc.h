@@ -42,6 +42,10 @@ public:
     void promote(ComValue&, ComValue&);
     // method to do C-style promotion of operand types.
 
+    boolean vector_op(int op, ComValue&, ComValue&);
+    // if either operand is a dense vector, replace the stack with the
+    // result of VectorFunc::binary and return true.
+
 };
 
 //: + (plus) operator.
@@ -0,0 +1,586 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <ComTerp/parfunc.h>
+#include <ComTerp/comvalue.h>
+#include <ComTerp/comterp.h>
+#include <ComTerp/strmfunc.h>
+#include <Attribute/attrlist.h>
+#include <Attribute/attrvector.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define TITLE "ParallelFunc"
+
+/*****************************************************************************/
+
+/*
+ * ParallelJob is the state of one pmap, pfilter or preduce, kept off the
+ * ComFunc so that a body which calls the same command again works.
+ */
+
+struct ParallelJob {
+  ParallelFunc* func;         // command the job is for
+  AttributeValueList* list;   // list input, or nil
+  AttributeValueVector* vec;  // vector input, or nil
+  int n;                      // number of elements
+  int varid;                  // symbol bound to each element
+  int accid;                  // symbol bound to the preduce accumulator
+  ComValue* oldvar;           // binding of varid before, or nil
+  ComValue* oldacc;           // binding of accid before, or nil
+  int jobs;                   // :jobs argument, 0 for ParallelFunc::Jobs()
+  int nchunks;                // number of chunks run() split elements into
+  ComValue* vals;             // one result per element
+  ComTerp* terp;              // interpreter evaluating the body, nil for comterp()
+  ComValue* body;             // body tokens for terp
+  int nbody;                  // number of body tokens
+};
+
+/*
+ * ParallelWorker is one thread of the pool, with the interpreter it
+ * evaluates in.  It is handed a copy of the job bound to that
+ * interpreter and a range of elements, and clears busy when done.
+ */
+
+struct ParallelWorker {
+  ComTerp* terp;
+  ParallelJob job;
+  int lo, hi;
+  boolean busy;
+};
+
+static ParallelWorker** pool = nil;
+static int npool = 0;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+
+/*
+ * pool_worker returns the k'th pool thread, starting threads until there
+ * are that many, or nil if one cannot be started.
+ */
+
+static ParallelWorker* pool_worker(int k, void* (*thread)(void*)) {
+  while (npool <= k) {
+    ParallelWorker* w = new ParallelWorker;
+    w->terp = new ComTerp();
+    w->terp->add_defaults();
+    w->busy = false;
+    pthread_t tid;
+    if (pthread_create(&tid, nil, thread, w) != 0) {
+      delete w->terp;
+      delete w;
+      return nil;
+    }
+    pthread_detach(tid);
+    ParallelWorker** grown = new ParallelWorker*[npool+1];
+    for (int i=0; i<npool; i++)
+      grown[i] = pool[i];
+    grown[npool++] = w;
+    delete [] pool;
+    pool = grown;
+  }
+  return pool[k];
+}
+
+/* only these values are copied to pool threads: nothing shared or counted */
+
+static boolean plain(AttributeValue& val) {
+  return val.is_num() || val.is_type(AttributeValue::BooleanType) ||
+    val.is_unknown();
+}
+
+static void unbind(ComTerp* terp, int symid) {
+  void* oldval = nil;
+  terp->localtable()->find_and_remove(oldval, symid);
+  delete (ComValue*)oldval;
+}
+
+static int chunk_start(int j, int nchunks, int n) {
+  return (int)((long)n * j / nchunks);
+}
+
+/*****************************************************************************/
+
+int ParallelFunc::_jobs = 0;
+int ParallelFunc::_minsize = 1024;
+
+ParallelFunc::ParallelFunc(ComTerp* comterp) : ComFunc(comterp) {
+}
+
+int ParallelFunc::Jobs() {
+  if (_jobs > 0)
+    return _jobs;
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 1 ? (int)n : 1;
+}
+
+/*
+ * commands that compute their result from their arguments alone.  Reading
+ * variables is fine too, since each pool thread is given a copy of them.
+ */
+
+static const char* pure_names[] = {
+  "add", "sub", "minus", "mpy", "div", "mod", "min", "max", "abs",
+  "bit_and", "bit_xor", "bit_or", "bit_not", "lshift", "rshift",
+  "and", "or", "negate", "eq", "not_eq", "gt", "gt_or_eq", "lt", "lt_or_eq",
+  "char", "short", "int", "long", "float", "double",
+  "exp", "log", "log10", "pow", "acos", "asin", "atan", "atan2",
+  "cos", "sin", "tan", "sqrt", "pi", "radtodeg", "degtorad",
+  "floor", "ceil", "round", "sum", "mean", "var", "stddev",
+  "list", "at", "size", "tuple", "vector",
+  "if", "cond", "seq", "nil", "type", "class", "ctoi", "isspace",
+  nil
+};
+
+boolean ParallelFunc::pure_command(int funcid) {
+  static int* pure_ids = nil;
+  static int npure = 0;
+  if (!pure_ids) {
+    while (pure_names[npure]) npure++;
+    pure_ids = new int[npure];
+    for (int i=0; i<npure; i++)
+      pure_ids[i] = symbol_add((char*)pure_names[i]);
+  }
+  for (int i=0; i<npure; i++)
+    if (pure_ids[i] == funcid) return true;
+  return false;
+}
+
+boolean ParallelFunc::pure_body() {
+  ComValue* tokens;
+  int ntokens = stack_arg_post_tokens(1, tokens);
+  if (ntokens == 0)
+    return false;
+  for (int i=0; i<ntokens; i++) {
+    if (tokens[i].is_type(ComValue::CommandType)) {
+      ComFunc* func = (ComFunc*)tokens[i].obj_val();
+      if (!func || !pure_command(func->funcid()))
+	return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * threadable refuses strings and the type and class commands as well,
+ * since they add to the symbol table, which is not locked.
+ */
+
+boolean ParallelFunc::threadable(ParallelJob& job) {
+  static int type_symid = symbol_add("type");
+  static int class_symid = symbol_add("class");
+  if (comterp()->get_attributes())
+    return false;
+  if (job.list) {
+    for (int i=0; i<job.n; i++)
+      if (!plain(*job.list->Get(i)))
+	return false;
+  }
+  ComValue* tokens;
+  int ntokens = stack_arg_post_tokens(1, tokens);
+  for (int i=0; i<ntokens; i++) {
+    if (tokens[i].is_type(ComValue::StringType))
+      return false;
+    if (tokens[i].is_type(ComValue::CommandType)) {
+      ComFunc* func = (ComFunc*)tokens[i].obj_val();
+      if (func->funcid() == type_symid || func->funcid() == class_symid)
+	return false;
+    } else if (tokens[i].is_symbol()) {
+      int symid = tokens[i].symbol_val();
+      ComValue* local = comterp()->localvalue(symid);
+      ComValue* global = comterp()->globalvalue(symid);
+      if ((local && !plain(*local)) || (global && !plain(*global)))
+	return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * clone_body copies the body to a pool thread's interpreter, with its
+ * commands replaced by that interpreter's own and its depth of deferred
+ * evaluation starting again from zero, and copies the variables it reads.
+ */
+
+boolean ParallelFunc::clone_body(ParallelJob& job, ParallelWorker* w) {
+  ComTerp* terp = w->terp;
+  ComValue* tokens;
+  int ntokens = stack_arg_post_tokens(1, tokens);
+  ComValue* body = new ComValue[ntokens];
+  for (int i=0; i<ntokens; i++) {
+    body[i] = tokens[i];
+    body[i].pedepth() -= pedepth()+1;
+    if (body[i].is_type(ComValue::CommandType)) {
+      ComFunc* func = (ComFunc*)tokens[i].obj_val();
+      ComValue* cmd = terp->localvalue(func->funcid());
+      if (!cmd || !cmd->is_type(ComValue::CommandType)) {
+	delete [] body;
+	return false;
+      }
+      body[i].obj_ref() = cmd->obj_val();
+    } else if (body[i].is_symbol()) {
+      ComValue* cmd = terp->localvalue(body[i].symbol_val());
+      if (cmd && cmd->is_type(ComValue::CommandType)) {
+	delete [] body;
+	return false;
+      }
+    }
+  }
+
+  w->job = job;
+  w->job.terp = terp;
+  w->job.body = body;
+  w->job.nbody = ntokens;
+  for (int i=0; i<ntokens; i++) {
+    if (!body[i].is_symbol())
+      continue;
+    int symid = body[i].symbol_val();
+    ComValue* val = comterp()->localvalue(symid);
+    if (val && symid != job.varid && symid != job.accid)
+      bind(w->job, symid, *val);
+  }
+  return true;
+}
+
+/*
+ * pool_thread waits for a chunk, evaluates it, and drops the bindings it
+ * made, so nothing it leaves in its interpreter refers to the results.
+ */
+
+void* ParallelFunc::pool_thread(void* arg) {
+  ParallelWorker* w = (ParallelWorker*)arg;
+  pthread_mutex_lock(&pool_lock);
+  for (;;) {
+    while (!w->busy)
+      pthread_cond_wait(&pool_work, &pool_lock);
+    pthread_mutex_unlock(&pool_lock);
+
+    ParallelJob& job = w->job;
+    job.terp->_pfcomvals = job.body;
+    job.terp->_pfnum = job.nbody;
+    job.func->chunk(job, w->lo, w->hi);
+    job.terp->_pfcomvals = nil;
+    job.terp->_pfnum = 0;
+    for (int i=0; i<job.nbody; i++)
+      if (job.body[i].is_symbol())
+	unbind(job.terp, job.body[i].symbol_val());
+    unbind(job.terp, job.varid);
+    unbind(job.terp, job.accid);
+
+    pthread_mutex_lock(&pool_lock);
+    w->busy = false;
+    pthread_cond_broadcast(&pool_done);
+  }
+  return nil;
+}
+
+boolean ParallelFunc::setup(ParallelJob& job) {
+  static int var_symid = symbol_add("var");
+  static int acc_symid = symbol_add("acc");
+  static int jobs_symid = symbol_add("jobs");
+  static int x_symid = symbol_add("x");
+  ComValue srcv(stack_arg_post_eval(0));
+  ComValue& varv = stack_key_post(var_symid);  /* unevaluated symbols */
+  ComValue& accv = stack_key_post(acc_symid);
+  ComValue jobsv(stack_key_post_eval(jobs_symid));
+
+  job.func = this;
+  job.list = nil;
+  job.vec = nil;
+  job.n = 0;
+  job.varid = varv.is_symbol() ? varv.symbol_val() : x_symid;
+  job.accid = accv.is_symbol() ? accv.symbol_val() : acc_symid;
+  job.jobs = jobsv.is_num() ? jobsv.int_val() : 0;
+  job.oldvar = job.oldacc = nil;
+  job.nchunks = 1;
+  job.vals = nil;
+  job.terp = nil;
+  job.body = nil;
+  job.nbody = 0;
+
+  if (srcv.is_vector()) {
+    job.vec = srcv.vector_val();
+    Resource::ref(job.vec);
+    job.n = job.vec->Number();
+  } else if (srcv.is_array()) {
+    job.list = srcv.array_val();
+    Resource::ref(job.list);
+    job.n = job.list->Number();
+  } else if (srcv.is_stream()) {
+
+    /* stream to list conversion */
+    job.list = new AttributeValueList();
+    Resource::ref(job.list);
+    boolean done = false;
+    while (!done) {
+      NextFunc::execute_impl(comterp(), srcv);
+      ComValue topval(comterp()->pop_stack());
+      if (topval.is_unknown())
+	done = true;
+      else
+	job.list->Append(new AttributeValue(topval));
+    }
+    job.n = job.list->Number();
+  } else
+    return false;
+
+  void* oldval = nil;
+  comterp()->localtable()->find_and_remove(oldval, job.varid);
+  job.oldvar = (ComValue*)oldval;
+  if (job.accid != job.varid) {
+    oldval = nil;
+    comterp()->localtable()->find_and_remove(oldval, job.accid);
+    job.oldacc = (ComValue*)oldval;
+  }
+  job.vals = new ComValue[job.n ? job.n : 1];
+  return true;
+}
+
+void ParallelFunc::finish(ParallelJob& job) {
+  void* oldval = nil;
+  comterp()->localtable()->find_and_remove(oldval, job.varid);
+  delete (ComValue*)oldval;
+  if (job.oldvar)
+    comterp()->localtable()->insert(job.varid, job.oldvar);
+  if (job.accid != job.varid) {
+    oldval = nil;
+    comterp()->localtable()->find_and_remove(oldval, job.accid);
+    delete (ComValue*)oldval;
+    if (job.oldacc)
+      comterp()->localtable()->insert(job.accid, job.oldacc);
+  }
+  Resource::unref(job.list);
+  Resource::unref(job.vec);
+  delete [] job.vals;
+}
+
+void ParallelFunc::bind(ParallelJob& job, int symid, AttributeValue& val) {
+  ComTerp* terp = job.terp ? job.terp : comterp();
+  unbind(terp, symid);
+  terp->localtable()->insert(symid, new ComValue(val));
+}
+
+ComValue ParallelFunc::eval_body(ParallelJob& job, int i) {
+  if (job.vec) {
+    AttributeValue av;
+    job.vec->GetAttrVal(i, av);
+    bind(job, job.varid, av);
+  } else
+    bind(job, job.varid, *job.list->Get(i));
+  if (job.terp) {
+    job.terp->post_eval_expr(job.nbody, -job.nbody, 0);
+    return job.terp->pop_stack();
+  }
+  return stack_arg_post_eval(1);
+}
+
+/*
+ * run evaluates the first chunk here and hands each of the others to a
+ * pool thread, evaluating here any chunk that no thread could take.
+ */
+
+void ParallelFunc::run(ParallelJob& job) {
+  int nchunks = job.jobs > 0 ? job.jobs : Jobs();
+  if (job.n < MinSize() || !pure_body())
+    nchunks = 1;
+  if (nchunks > job.n)
+    nchunks = job.n;
+  if (nchunks >= 2 && !threadable(job))
+    nchunks = 1;
+  if (nchunks < 2) {
+    job.nchunks = 1;
+    chunk(job, 0, job.n);
+    return;
+  }
+  job.nchunks = nchunks;
+  comterp()->globaltable();  /* made here, not on first use by a thread */
+
+  ParallelWorker** workers = new ParallelWorker*[nchunks];
+  for (int j=1; j<nchunks; j++) {
+    ParallelWorker* w = pool_worker(j-1, &pool_thread);
+    if (w && clone_body(job, w)) {
+      w->lo = chunk_start(j, nchunks, job.n);
+      w->hi = chunk_start(j+1, nchunks, job.n);
+    } else
+      w = nil;
+    workers[j] = w;
+  }
+  pthread_mutex_lock(&pool_lock);
+  for (int j=1; j<nchunks; j++)
+    if (workers[j])
+      workers[j]->busy = true;
+  pthread_cond_broadcast(&pool_work);
+  pthread_mutex_unlock(&pool_lock);
+
+  chunk(job, 0, chunk_start(1, nchunks, job.n));
+  for (int j=1; j<nchunks; j++)
+    if (!workers[j])
+      chunk(job, chunk_start(j, nchunks, job.n),
+	    chunk_start(j+1, nchunks, job.n));
+
+  pthread_mutex_lock(&pool_lock);
+  for (int j=1; j<nchunks; j++)
+    while (workers[j] && workers[j]->busy)
+      pthread_cond_wait(&pool_done, &pool_lock);
+  pthread_mutex_unlock(&pool_lock);
+  for (int j=1; j<nchunks; j++)
+    if (workers[j])
+      delete [] workers[j]->job.body;
+  delete [] workers;
+}
+
+/*****************************************************************************/
+
+ParMapFunc::ParMapFunc(ComTerp* comterp) : ParallelFunc(comterp) {
+}
+
+void ParMapFunc::chunk(ParallelJob& job, int lo, int hi) {
+  for (int i=lo; i<hi; i++)
+    job.vals[i] = eval_body(job, i);
+}
+
+void ParMapFunc::execute() {
+  ParallelJob job;
+  if (!setup(job)) {
+    reset_stack();
+    push_stack(ComValue::nullval());
+    return;
+  }
+  run(job);
+
+  AttributeValueList* avl = new AttributeValueList();
+  boolean allnum = true;
+  for (int i=0; i<job.n; i++) {
+    avl->Append(new AttributeValue(job.vals[i]));
+    allnum = allnum && job.vals[i].is_num();
+  }
+  AttributeValueVector* vec = job.vec && allnum
+    ? AttributeValueVector::FromList(avl) : nil;
+  finish(job);
+  reset_stack();
+
+  if (vec) {
+    delete avl;
+    ComValue retval(AttributeValueVector::class_symid(), (void*)vec);
+    push_stack(retval);
+  } else {
+    ComValue retval(avl);
+    push_stack(retval);
+  }
+}
+
+/*****************************************************************************/
+
+ParFilterFunc::ParFilterFunc(ComTerp* comterp) : ParallelFunc(comterp) {
+}
+
+void ParFilterFunc::chunk(ParallelJob& job, int lo, int hi) {
+  for (int i=lo; i<hi; i++)
+    job.vals[i] = eval_body(job, i).is_true()
+      ? ComValue::trueval() : ComValue::falseval();
+}
+
+void ParFilterFunc::execute() {
+  ParallelJob job;
+  if (!setup(job)) {
+    reset_stack();
+    push_stack(ComValue::nullval());
+    return;
+  }
+  run(job);
+
+  AttributeValueList* avl = new AttributeValueList();
+  for (int i=0; i<job.n; i++) {
+    if (!job.vals[i].is_true())
+      continue;
+    if (job.vec) {
+      AttributeValue* av = new AttributeValue();
+      job.vec->GetAttrVal(i, *av);
+      avl->Append(av);
+    } else
+      avl->Append(new AttributeValue(job.list->Get(i)));
+  }
+  AttributeValueVector* vec = job.vec
+    ? AttributeValueVector::FromList(avl, job.vec->Type()) : nil;
+  finish(job);
+  reset_stack();
+
+  if (vec) {
+    delete avl;
+    ComValue retval(AttributeValueVector::class_symid(), (void*)vec);
+    push_stack(retval);
+  } else {
+    ComValue retval(avl);
+    push_stack(retval);
+  }
+}
+
+/*****************************************************************************/
+
+ParReduceFunc::ParReduceFunc(ComTerp* comterp) : ParallelFunc(comterp) {
+}
+
+void ParReduceFunc::chunk(ParallelJob& job, int lo, int hi) {
+  if (lo >= hi)
+    return;
+  ComValue acc;
+  if (job.vec)
+    job.vec->GetAttrVal(lo, acc);
+  else
+    acc = ComValue(*job.list->Get(lo));
+  for (int i=lo+1; i<hi; i++) {
+    bind(job, job.accid, acc);
+    acc = eval_body(job, i);
+  }
+  job.vals[lo] = acc;
+}
+
+void ParReduceFunc::execute() {
+  ParallelJob job;
+  if (!setup(job)) {
+    reset_stack();
+    push_stack(ComValue::nullval());
+    return;
+  }
+  if (job.n == 0) {
+    finish(job);
+    reset_stack();
+    push_stack(ComValue::nullval());
+    return;
+  }
+  run(job);
+
+  /* fold the partial results of the chunks, left to right */
+  ComValue acc(job.vals[0]);
+  for (int j=1; j<job.nchunks; j++) {
+    bind(job, job.accid, acc);
+    bind(job, job.varid, job.vals[chunk_start(j, job.nchunks, job.n)]);
+    acc = stack_arg_post_eval(1);
+  }
+  finish(job);
+  reset_stack();
+  push_stack(acc);
+}
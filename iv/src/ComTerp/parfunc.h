@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * collection of data-parallel list functions
+ */
+
+#if !defined(_parfunc_h)
+#define _parfunc_h
+
+#include <ComTerp/comfunc.h>
+
+class ComTerp;
+class ComValue;
+struct ParallelJob;
+struct ParallelWorker;
+
+//: base class for data-parallel ComTerp commands.
+// The body expression of a ParallelFunc is evaluated once for each element
+// of a list, vector or stream, with the element bound to a symbol (:var,
+// x by default).  When the body calls nothing but commands known to be
+// free of side effects (see pure_command()), and every value it can reach
+// is a number, boolean or nil, the elements are split into chunks that are
+// evaluated on a pool of threads, each with an interpreter of its own
+// holding copies of the variables the body reads, and the results are
+// merged back in order.  Anything else is evaluated serially, as is a
+// chunk whose thread could not be started, so the outcome is always that
+// of a serial evaluation.
+class ParallelFunc : public ComFunc {
+public:
+    ParallelFunc(ComTerp*);
+
+    virtual boolean post_eval() { return true; }
+
+    static int Jobs();
+    // number of threads to split the elements over, counting the calling
+    // one, by default one per online processor.
+    static void Jobs(int n) { _jobs = n; }
+    // set the number of threads, 0 for one per online processor.
+    static int MinSize() { return _minsize; }
+    // fewest elements worth splitting up, 1024 by default.
+    static void MinSize(int n) { _minsize = n; }
+
+    static boolean pure_command(int funcid);
+    // true if the command named 'funcid' is known to compute its result
+    // from its arguments alone, without side effects.
+
+protected:
+    boolean setup(ParallelJob&);
+    // evaluate the input and keyword arguments into 'job', returning
+    // false if the input is not a list, vector or stream.
+    void run(ParallelJob&);
+    // evaluate chunk() over all the elements, split over threads if the
+    // body is pure and there are at least MinSize() elements.
+    void finish(ParallelJob&);
+    // restore the bindings the body symbols had before, and free 'job'.
+
+    virtual void chunk(ParallelJob&, int lo, int hi) = 0;
+    // evaluate elements 'lo' up to 'hi', storing results in the job's
+    // values at the same indices.
+    ComValue eval_body(ParallelJob&, int i);
+    // bind element 'i' and evaluate the body expression.
+    void bind(ParallelJob&, int symid, AttributeValue&);
+    // bind a body symbol to a value in the job's interpreter.
+    boolean pure_body();
+    // true if the body expression calls only pure commands.
+    boolean threadable(ParallelJob&);
+    // true if every value the body can reach is a number, boolean or nil,
+    // so that no object is shared between threads.
+    boolean clone_body(ParallelJob&, ParallelWorker*);
+    // set up a pool thread's interpreter to evaluate the body, returning
+    // false if it lacks one of the body's commands.
+    static void* pool_thread(void*);
+    // evaluate the chunks handed to one pool thread.
+
+    static int _jobs;
+    static int _minsize;
+};
+
+//: parallel map command for ComTerp.
+// lst=pmap(lst|vec|strm expr :var sym :jobs n) -- evaluate expr for every
+// element, returning a list of the results (a vector for a vector input
+// when every result is a number).
+class ParMapFunc : public ParallelFunc {
+public:
+    ParMapFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() {
+      return "lst=%s(lst|vec|strm expr :var sym :jobs n) -- evaluate expr for each element (bound to sym, x by default), in parallel when pure"; }
+protected:
+    virtual void chunk(ParallelJob&, int lo, int hi);
+};
+
+//: parallel filter command for ComTerp.
+// lst=pfilter(lst|vec|strm expr :var sym :jobs n) -- return the elements for
+// which expr is true, in order.
+class ParFilterFunc : public ParallelFunc {
+public:
+    ParFilterFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() {
+      return "lst=%s(lst|vec|strm expr :var sym :jobs n) -- return elements for which expr is true, in parallel when pure"; }
+protected:
+    virtual void chunk(ParallelJob&, int lo, int hi);
+};
+
+//: parallel reduce command for ComTerp.
+// val=preduce(lst|vec|strm expr :var sym :acc sym :jobs n) -- fold the
+// elements with expr, which combines the accumulator (acc by default) with
+// the next element.  Each chunk is folded on its own and the partial
+// results folded in order, so expr has to be associative.
+class ParReduceFunc : public ParallelFunc {
+public:
+    ParReduceFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() {
+      return "val=%s(lst|vec|strm expr :var sym :acc sym :jobs n) -- fold elements with associative expr of acc and x, in parallel when pure"; }
+protected:
+    virtual void chunk(ParallelJob&, int lo, int hi);
+};
+
+#endif /* !defined(_parfunc_h) */
@@ -26,8 +26,10 @@
 #include <ComTerp/comterp.h>
 #include <ComTerp/mathfunc.h>
 #include <ComTerp/numfunc.h>
+#include <ComTerp/vecfunc.h>
 #include <Attribute/attrlist.h>
 #include <Attribute/attribute.h>
+#include <Attribute/attrvector.h>
 #include <Unidraw/iterator.h>
 
 #define TITLE "StatFunc"
@@ -42,7 +44,10 @@ void SumFunc::execute() {
   ComValue vallist(stack_arg(0));
   reset_stack();
   
-  if (vallist.is_type(ComValue::ArrayType)) {
+  if (vallist.is_vector()) {
+    ComValue retval(VectorFunc::sum(vallist.vector_val(), _meanfunc));
+    push_stack(retval);
+  } else if (vallist.is_type(ComValue::ArrayType)) {
     AttributeValueList* avl = vallist.array_val();
     AddFunc addfunc(comterp());
     push_stack(ComValue::zeroval());
@@ -80,7 +85,10 @@ void VarFunc::execute() {
   ComValue vallist(stack_arg(0));
   reset_stack();
   
-  if (vallist.is_type(ComValue::ArrayType)) {
+  if (vallist.is_vector()) {
+    ComValue retval(VectorFunc::var(vallist.vector_val(), _stddevfunc));
+    push_stack(retval);
+  } else if (vallist.is_type(ComValue::ArrayType)) {
     AttributeValueList* avl = vallist.array_val();
     AddFunc addfunc(comterp());
     MpyFunc mpyfunc(comterp());
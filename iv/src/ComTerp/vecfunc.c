@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <ComTerp/vecfunc.h>
+#include <ComTerp/comvalue.h>
+#include <ComTerp/comterp.h>
+#include <Attribute/attrlist.h>
+#include <Attribute/attrvector.h>
+#include <math.h>
+
+#define TITLE "VectorFunc"
+
+/*****************************************************************************/
+
+VectorFunc::VectorFunc(ComTerp* comterp) : ComFunc(comterp) {
+}
+
+void VectorFunc::execute() {
+  ComValue srcv(stack_arg(0));
+  ComValue fillv(stack_arg(1, false, ComValue::zeroval()));
+  static int int_symid = symbol_add("int");
+  ComValue intflag(stack_key(int_symid));
+  static int float_symid = symbol_add("float");
+  ComValue floatflag(stack_key(float_symid));
+  static int double_symid = symbol_add("double");
+  ComValue doubleflag(stack_key(double_symid));
+  reset_stack();
+
+  ComValue::ValueType type = ComValue::UnknownType;
+  if (intflag.is_true())
+    type = ComValue::IntType;
+  else if (floatflag.is_true())
+    type = ComValue::FloatType;
+  else if (doubleflag.is_true())
+    type = ComValue::DoubleType;
+
+  AttributeValueVector* vec = nil;
+  if (srcv.is_vector())
+    vec = new AttributeValueVector(srcv.vector_val(), type);
+
+  else if (srcv.is_array())
+    vec = AttributeValueVector::FromList(srcv.array_val(), type);
+
+  else if (srcv.is_num() && srcv.int_val() >= 0) {
+    if (type == ComValue::UnknownType)
+      type = AttributeValueVector::ElementType(fillv.type());
+    vec = new AttributeValueVector(type, srcv.int_val());
+    if (!fillv.is_num() || fillv.double_val() != 0.0)
+      for (int i=0; i<vec->Number(); i++)
+	vec->SetAttrVal(i, fillv);
+  }
+
+  if (vec) {
+    ComValue retval(AttributeValueVector::class_symid(), (void*)vec);
+    push_stack(retval);
+  } else
+    push_stack(ComValue::nullval());
+}
+
+AttributeValueVector* VectorFunc::vector_arg(ComValue& val) {
+  AttributeValueVector* vec = nil;
+  if (val.is_vector())
+    vec = val.vector_val();
+  else if (val.is_array())
+    vec = AttributeValueVector::FromList(val.array_val());
+  Resource::ref(vec);
+  return vec;
+}
+
+/*
+ * VECTOR_LOOP applies EXPR to x and y, taken from 'a' and 'b' or from the
+ * scalars 'as' and 'bs', storing into 'r'.  Each case is a plain indexed
+ * loop over contiguous arrays that the compiler can vectorize.
+ */
+
+#define VECTOR_LOOP(T, R, EXPR) { \
+    const T* a = (const T*)adata; \
+    const T* b = (const T*)bdata; \
+    R* r = (R*)rdata; \
+    int i; \
+    if (a && b) \
+      for (i=0; i<n; i++) { T x = a[i]; T y = b[i]; r[i] = (EXPR); } \
+    else if (a) { \
+      T y = (T)bs; \
+      for (i=0; i<n; i++) { T x = a[i]; r[i] = (EXPR); } \
+    } else { \
+      T x = (T)as; \
+      for (i=0; i<n; i++) { T y = b[i]; r[i] = (EXPR); } \
+    } \
+  }
+
+#define VECTOR_OPS(T) \
+    switch (op) { \
+    case Add:    VECTOR_LOOP(T, T, x + y); break; \
+    case Sub:    VECTOR_LOOP(T, T, x - y); break; \
+    case Mpy:    VECTOR_LOOP(T, T, x * y); break; \
+    case Div:    VECTOR_LOOP(T, T, x / y); break; \
+    case Eq:     VECTOR_LOOP(T, int, x == y); break; \
+    case NotEq:  VECTOR_LOOP(T, int, x != y); break; \
+    case Gt:     VECTOR_LOOP(T, int, x > y); break; \
+    case GtOrEq: VECTOR_LOOP(T, int, x >= y); break; \
+    case Lt:     VECTOR_LOOP(T, int, x < y); break; \
+    case LtOrEq: VECTOR_LOOP(T, int, x <= y); break; \
+    }
+
+ComValue VectorFunc::binary(int op, ComValue& operand1, ComValue& operand2) {
+  AttributeValueVector* v1 = vector_arg(operand1);
+  AttributeValueVector* v2 = vector_arg(operand2);
+  AttributeValueVector* result = nil;
+
+  if (op == Mpy && v1 && v2 && (v1->Rows() || v2->Rows())) {
+    result = matrix_mpy(v1, v2);
+
+  } else if ((v1 || operand1.is_num()) && (v2 || operand2.is_num()) &&
+	     (!v1 || !v2 || v1->Number() == v2->Number())) {
+
+    /* convert both sides to the wider element type */
+    ComValue::ValueType type = AttributeValueVector::Wider(
+      v1 ? v1->Type() : AttributeValueVector::ElementType(operand1.type()),
+      v2 ? v2->Type() : AttributeValueVector::ElementType(operand2.type()));
+    if (v1 && v1->Type() != type) {
+      AttributeValueVector* wider = new AttributeValueVector(v1, type);
+      Resource::ref(wider);
+      Resource::unref(v1);
+      v1 = wider;
+    }
+    if (v2 && v2->Type() != type) {
+      AttributeValueVector* wider = new AttributeValueVector(v2, type);
+      Resource::ref(wider);
+      Resource::unref(v2);
+      v2 = wider;
+    }
+
+    AttributeValueVector* shape = v1 ? v1 : v2;
+    int n = shape->Number();
+    const void* adata = v1 ? v1->Data() : nil;
+    const void* bdata = v2 ? v2->Data() : nil;
+    double as = v1 ? 0.0 : operand1.double_val();
+    double bs = v2 ? 0.0 : operand2.double_val();
+
+    boolean divzero = false;
+    if (op == Div && type == ComValue::IntType) {
+      if (v2) {
+	const int* b = v2->Ints();
+	for (int i=0; i<n && !divzero; i++) divzero = b[i] == 0;
+      } else
+	divzero = operand2.int_val() == 0;
+    }
+
+    if (divzero)
+      COMERR_SET(ERR_DIV_BY_ZERO);
+    else {
+      result = new AttributeValueVector(
+        op >= Eq ? ComValue::IntType : type, n, shape->Rows());
+      void* rdata = result->Data();
+      switch (type) {
+      case ComValue::IntType:
+	VECTOR_OPS(int);
+	break;
+      case ComValue::FloatType:
+	VECTOR_OPS(float);
+	break;
+      default:
+	VECTOR_OPS(double);
+	break;
+      }
+    }
+  }
+
+  Resource::unref(v1);
+  Resource::unref(v2);
+  if (result)
+    return ComValue(AttributeValueVector::class_symid(), (void*)result);
+  else
+    return ComValue::nullval();
+}
+
+/*
+ * MATRIX_LOOP accumulates row i of the product one row of 'b' at a time,
+ * so the innermost loop runs down contiguous rows of 'b' and 'r'.
+ */
+
+#define MATRIX_LOOP(T) { \
+    const T* a = (const T*)v1->Data(); \
+    const T* b = (const T*)v2->Data(); \
+    T* r = (T*)result->Data(); \
+    for (int i=0; i<rows; i++) { \
+      T* ri = r + i*cols; \
+      for (int k=0; k<inner; k++) { \
+	T aik = a[i*inner + k]; \
+	const T* bk = b + k*cols; \
+	for (int j=0; j<cols; j++) ri[j] += aik * bk[j]; \
+      } \
+    } \
+  }
+
+AttributeValueVector* VectorFunc::matrix_mpy(AttributeValueVector* v1,
+					     AttributeValueVector* v2) {
+  /* a plain vector is a row on the left and a column on the right */
+  int rows = v1->Rows() ? v1->Rows() : 1;
+  int inner = v1->Cols();
+  int cols = v2->Rows() ? v2->Cols() : 1;
+  int inner2 = v2->Rows() ? v2->Rows() : v2->Number();
+  if (inner != inner2) return nil;
+
+  ComValue::ValueType type = AttributeValueVector::Wider(v1->Type(), v2->Type());
+  Resource::ref(v1);
+  Resource::ref(v2);
+  if (v1->Type() != type) {
+    AttributeValueVector* wider = new AttributeValueVector(v1, type);
+    Resource::ref(wider);
+    Resource::unref(v1);
+    v1 = wider;
+  }
+  if (v2->Type() != type) {
+    AttributeValueVector* wider = new AttributeValueVector(v2, type);
+    Resource::ref(wider);
+    Resource::unref(v2);
+    v2 = wider;
+  }
+
+  /* the result is a plain vector unless both dimensions exceed one */
+  AttributeValueVector* result = new AttributeValueVector(
+    type, rows*cols, v1->Rows() && v2->Rows() ? rows : 0);
+  switch (type) {
+  case ComValue::IntType:
+    MATRIX_LOOP(int);
+    break;
+  case ComValue::FloatType:
+    MATRIX_LOOP(float);
+    break;
+  default:
+    MATRIX_LOOP(double);
+    break;
+  }
+
+  Resource::unref(v1);
+  Resource::unref(v2);
+  return result;
+}
+
+/*
+ * VECTOR_SUMS keeps four running sums (and sums of squares) so the loop
+ * carries no single serial dependency and can be vectorized.
+ */
+
+#define VECTOR_SUMS(T, S) { \
+    const T* a = (const T*)vec->Data(); \
+    S s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+    double q0 = 0, q1 = 0, q2 = 0, q3 = 0; \
+    int i; \
+    for (i=0; i+4<=n; i+=4) { \
+      s0 += a[i]; s1 += a[i+1]; s2 += a[i+2]; s3 += a[i+3]; \
+      if (squares) { \
+	q0 += (double)a[i]*a[i]; q1 += (double)a[i+1]*a[i+1]; \
+	q2 += (double)a[i+2]*a[i+2]; q3 += (double)a[i+3]*a[i+3]; \
+      } \
+    } \
+    for (; i<n; i++) { \
+      s0 += a[i]; \
+      if (squares) q0 += (double)a[i]*a[i]; \
+    } \
+    sum = (s0 + s1) + (s2 + s3); \
+    sumsq = (q0 + q1) + (q2 + q3); \
+  }
+
+static void vector_sums(AttributeValueVector* vec, boolean squares,
+			long& isum, double& sum, double& sumsq) {
+  int n = vec->Number();
+  switch (vec->Type()) {
+  case ComValue::IntType:
+    VECTOR_SUMS(int, long);
+    isum = (long)sum;
+    break;
+  case ComValue::FloatType:
+    VECTOR_SUMS(float, double);
+    break;
+  default:
+    VECTOR_SUMS(double, double);
+    break;
+  }
+}
+
+ComValue VectorFunc::sum(AttributeValueVector* vec, boolean mean) {
+  long isum = 0;
+  double sum, sumsq;
+  int n = vec->Number();
+  vector_sums(vec, false, isum, sum, sumsq);
+
+  /* keep the element type, as a sum or mean over a list would */
+  switch (vec->Type()) {
+  case ComValue::IntType:
+    return ComValue((int)(mean && n ? isum / n : isum), ComValue::IntType);
+  case ComValue::FloatType:
+    return ComValue((float)(mean && n ? sum / n : sum));
+  default:
+    return ComValue(mean && n ? sum / n : sum);
+  }
+}
+
+ComValue VectorFunc::var(AttributeValueVector* vec, boolean stddev) {
+  long isum = 0;
+  double sum, sumsq;
+  int n = vec->Number();
+  if (n == 0) return ComValue::zeroval();
+  vector_sums(vec, true, isum, sum, sumsq);
+
+  double mean = (vec->Type() == ComValue::IntType ? (double)isum : sum) / n;
+  double var = sumsq / n - mean * mean;
+  if (stddev) var = sqrt(var);
+  if (vec->Type() == ComValue::DoubleType)
+    return ComValue(var);
+  else
+    return ComValue((float)var);
+}
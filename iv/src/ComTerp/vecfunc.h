@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * collection of dense vector functions
+ */
+
+#if !defined(_vecfunc_h)
+#define _vecfunc_h
+
+#include <ComTerp/comfunc.h>
+
+class AttributeValueVector;
+class ComTerp;
+class ComValue;
+
+//: create vector command for ComTerp.
+// vec=vector(lst|vec|n [val] :int :float :double) -- create dense vector
+// from a list (a matrix from a list of lists), convert a vector, or create
+// a vector of n copies of val.
+//
+// Vectors are accepted everywhere numbers are by the arithmetic, comparison
+// and statistics commands, which work on them element by element in plain
+// loops.  A list or number combined with a vector is converted to match.
+class VectorFunc : public ComFunc {
+public:
+    VectorFunc(ComTerp*);
+
+    virtual void execute();
+    virtual const char* docstring() {
+      return "vec=%s(lst|vec|n [val] :int :float :double) -- create dense vector (or matrix from list of lists)"; }
+
+    enum { Add, Sub, Mpy, Div, Eq, NotEq, Gt, GtOrEq, Lt, LtOrEq };
+
+    static ComValue binary(int op, ComValue& operand1, ComValue& operand2);
+    // element-wise operation where one operand is a vector and the other a
+    // vector, list or number.  Mpy with a matrix operand is a matrix product.
+    // Comparisons return an int vector of 0's and 1's.  Returns nil if the
+    // operands do not conform.
+    static AttributeValueVector* matrix_mpy(AttributeValueVector*,
+					    AttributeValueVector*);
+    // matrix product, treating a plain vector on the left as a row and on
+    // the right as a column.  Returns nil if the inner dimensions differ.
+    static ComValue sum(AttributeValueVector*, boolean mean);
+    // sum (or mean) of the elements.
+    static ComValue var(AttributeValueVector*, boolean stddev);
+    // variance (or standard deviation) of the elements.
+
+    static AttributeValueVector* vector_arg(ComValue&);
+    // vector of a vector value, or a new vector from a list value, with a
+    // reference the caller has to Resource::unref.  nil for anything else.
+};
+
+#endif /* !defined(_vecfunc_h) */
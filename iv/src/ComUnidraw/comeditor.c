@@ -28,6 +28,7 @@
 #include <ComUnidraw/groupfunc.h>
 #include <ComUnidraw/grstatfunc.h>
 #include <ComUnidraw/highlightfunc.h>
+#include <ComUnidraw/imagefunc.h>
 #include <ComUnidraw/comeditor.h>
 #include <ComUnidraw/comterp-iohandler.h>
 #include <ComUnidraw/dialogfunc.h>
@@ -185,6 +186,7 @@ void ComEditor::AddCommands(ComTerp* comterp) {
     comterp->add_command("tilefile", new TileFileFunc(comterp, this));
 
     comterp->add_command("update", new UpdateFunc(comterp, this));
+    comterp->add_command("historymem", new HistoryMemFunc(comterp, this));
     comterp->add_command("ncols", new NColsFunc(comterp, this));
     comterp->add_command("nrows", new NRowsFunc(comterp, this));
     comterp->add_command("handles", new HandlesFunc(comterp, this));
@@ -230,6 +232,12 @@ void ComEditor::AddCommands(ComTerp* comterp) {
     comterp->add_command("pclip", new PixelClipFunc(comterp, this));
     comterp->add_command("alpha", new AlphaTransFunc(comterp, this));
 
+    comterp->add_command("gaussian", new GaussianFunc(comterp, this));
+    comterp->add_command("boxfilter", new BoxFilterFunc(comterp, this));
+    comterp->add_command("median", new MedianFunc(comterp, this));
+    comterp->add_command("threshold", new ThresholdFunc(comterp, this));
+    comterp->add_command("conncomp", new ConnCompFunc(comterp, this));
+
     comterp->add_command("trans", new TransformerFunc(comterp, this));
 
     #ifdef LEAKCHECK
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <ComUnidraw/imagefunc.h>
+
+#include <OverlayUnidraw/grayraster.h>
+#include <OverlayUnidraw/ovcomps.h>
+#include <OverlayUnidraw/ovfilter.h>
+#include <OverlayUnidraw/ovraster.h>
+#include <OverlayUnidraw/ovviews.h>
+
+#include <Unidraw/clipboard.h>
+#include <Unidraw/Commands/edit.h>
+
+#include <ComTerp/comterp.h>
+#include <ComTerp/comvalue.h>
+
+#include <Attribute/aliterator.h>
+#include <Attribute/attrlist.h>
+
+/*****************************************************************************/
+
+ImageFunc::ImageFunc(ComTerp* comterp, Editor* ed) : UnidrawFunc(comterp, ed) {
+}
+
+OverlayRaster* ImageFunc::raster_arg(ComValue& rastcompv, RasterOvComp*& rastcomp) {
+  rastcomp = (RasterOvComp*) rastcompv.geta(RasterOvComp::class_symid());
+  OverlayRasterRect* rastrect = rastcomp ? rastcomp->GetOverlayRasterRect() : nil;
+  return rastrect ? rastrect->GetOriginal() : nil;
+}
+
+void ImageFunc::push_raster(GrayRaster* raster, RasterOvComp* original) {
+  if (!raster) {
+    push_stack(ComValue::nullval());
+    return;
+  }
+  OverlayRasterRect* rasterrect = 
+    new OverlayRasterRect(raster, original->GetOverlayRasterRect());
+  RasterOvComp* comp = new RasterOvComp(rasterrect);
+  PasteCmd* cmd = nil;
+  if (PasteModeFunc::paste_mode()==0)
+    cmd = new PasteCmd(_ed, new Clipboard(comp));
+  ComValue compval(new OverlayViewRef(comp), symbol_add("RasterComp"));
+  push_stack(compval);
+  execute_log(cmd);
+}
+
+/*****************************************************************************/
+
+GaussianFunc::GaussianFunc(ComTerp* comterp, Editor* ed) : ImageFunc(comterp, ed) {
+}
+
+void GaussianFunc::execute() {
+  ComValue rastcompv(stack_arg(0));
+  ComValue sigmav(stack_arg(1));
+  reset_stack();
+  float sigma = sigmav.is_num() ? sigmav.float_val() : 1.0;
+
+  RasterOvComp* rastcomp;
+  OverlayRaster* raster = raster_arg(rastcompv, rastcomp);
+  push_raster(raster ? OverlayFilter::Gaussian(raster, sigma) : nil, rastcomp);
+}
+
+/*****************************************************************************/
+
+BoxFilterFunc::BoxFilterFunc(ComTerp* comterp, Editor* ed) : ImageFunc(comterp, ed) {
+}
+
+void BoxFilterFunc::execute() {
+  ComValue rastcompv(stack_arg(0));
+  ComValue radiusv(stack_arg(1));
+  reset_stack();
+  int radius = radiusv.is_num() ? radiusv.int_val() : 1;
+
+  RasterOvComp* rastcomp;
+  OverlayRaster* raster = raster_arg(rastcompv, rastcomp);
+  push_raster(raster ? OverlayFilter::Box(raster, radius) : nil, rastcomp);
+}
+
+/*****************************************************************************/
+
+MedianFunc::MedianFunc(ComTerp* comterp, Editor* ed) : ImageFunc(comterp, ed) {
+}
+
+void MedianFunc::execute() {
+  ComValue rastcompv(stack_arg(0));
+  ComValue radiusv(stack_arg(1));
+  reset_stack();
+  int radius = radiusv.is_num() ? radiusv.int_val() : 1;
+
+  RasterOvComp* rastcomp;
+  OverlayRaster* raster = raster_arg(rastcompv, rastcomp);
+  push_raster(raster ? OverlayFilter::Median(raster, radius) : nil, rastcomp);
+}
+
+/*****************************************************************************/
+
+ThresholdFunc::ThresholdFunc(ComTerp* comterp, Editor* ed) : ImageFunc(comterp, ed) {
+}
+
+void ThresholdFunc::execute() {
+  ComValue rastcompv(stack_arg(0));
+  ComValue tvalv(stack_arg(1));
+  reset_stack();
+
+  RasterOvComp* rastcomp;
+  OverlayRaster* raster = raster_arg(rastcompv, rastcomp);
+  if (!raster || (!tvalv.is_num() && !tvalv.is_array())) {
+    push_stack(ComValue::nullval());
+    return;
+  }
+
+  int n = tvalv.is_array() ? tvalv.array_len() : 1;
+  float* tvals = new float[n > 0 ? n : 1];
+  if (tvalv.is_array()) {
+    ALIterator i;
+    AttributeValueList* avl = tvalv.array_val();
+    avl->First(i);
+    for (int j=0; j<n && !avl->Done(i); j++) {
+      tvals[j] = avl->GetAttrVal(i)->float_val();
+      avl->Next(i);
+    }
+  } else
+    tvals[0] = tvalv.float_val();
+
+  push_raster(OverlayFilter::Threshold(raster, tvals, n), rastcomp);
+  delete [] tvals;
+}
+
+/*****************************************************************************/
+
+ConnCompFunc::ConnCompFunc(ComTerp* comterp, Editor* ed) : ImageFunc(comterp, ed) {
+}
+
+void ConnCompFunc::execute() {
+  ComValue rastcompv(stack_arg(0));
+  reset_stack();
+
+  RasterOvComp* rastcomp;
+  OverlayRaster* raster = raster_arg(rastcompv, rastcomp);
+  int ncomps;
+  push_raster(raster ? OverlayFilter::Label(raster, ncomps) : nil, rastcomp);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * image-processing commands on raster components
+ */
+
+#if !defined(_imagefunc_h)
+#define _imagefunc_h
+
+#include <ComUnidraw/unifunc.h>
+
+class GrayRaster;
+class OverlayRaster;
+class RasterOvComp;
+
+//: base class for commands that filter a raster into a new raster.
+// the new raster component is pasted into the drawing over the original,
+// with the same transformation and graphic state, and its compview
+// returned.  See OverlayFilter for the operators themselves.
+class ImageFunc : public UnidrawFunc {
+public:
+    ImageFunc(ComTerp*,Editor*);
+protected:
+    OverlayRaster* raster_arg(ComValue&, RasterOvComp*&);
+    // raster of a raster compview, or nil.
+    void push_raster(GrayRaster*, RasterOvComp* original);
+    // paste a new component for the raster and push its compview, or push
+    // nil if there is no raster.
+};
+
+//: command to smooth a raster with a Gaussian kernel
+// compview=gaussian(compview [sigma]) -- Gaussian smoothing of raster
+class GaussianFunc : public ImageFunc {
+public:
+    GaussianFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "compview=%s(compview [sigma]) -- Gaussian smoothing of raster (default sigma 1.0)"; }
+};
+
+//: command to smooth a raster with a box (mean) filter
+// compview=boxfilter(compview [radius]) -- mean over square window
+class BoxFilterFunc : public ImageFunc {
+public:
+    BoxFilterFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "compview=%s(compview [radius]) -- mean over (2*radius+1) square window (default radius 1)"; }
+};
+
+//: command to median filter a raster
+// compview=median(compview [radius]) -- median over square window
+class MedianFunc : public ImageFunc {
+public:
+    MedianFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "compview=%s(compview [radius]) -- median over (2*radius+1) square window (default radius 1)"; }
+};
+
+//: command to threshold a raster
+// compview=threshold(compview tval|tlist) -- replace each value with the
+// largest threshold it reaches, or 0.
+class ThresholdFunc : public ImageFunc {
+public:
+    ThresholdFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "compview=%s(compview tval|tlist) -- replace each value with the largest threshold it reaches, or 0"; }
+};
+
+//: command to label the connected components of a raster
+// compview=conncomp(compview) -- label 4-connected regions of equal
+// non-zero value from 1 up, in an int raster.
+class ConnCompFunc : public ImageFunc {
+public:
+    ConnCompFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "compview=%s(compview) -- label 4-connected regions of equal non-zero value from 1 up"; }
+};
+
+#endif /* !defined(_imagefunc_h) */
@@ -113,6 +113,24 @@ void UpdateFunc::execute() {
 
 /*****************************************************************************/
 
+HistoryMemFunc::HistoryMemFunc(ComTerp* comterp, Editor* ed) : UnidrawFunc(comterp, ed) {
+}
+
+void HistoryMemFunc::execute() {
+  ComValue budgetv(stack_arg(0));
+  static int all_symid = symbol_add("all");
+  ComValue allv(stack_key(all_symid));
+  reset_stack();
+
+  if (budgetv.is_num()) 
+    unidraw->SetHistoryMemory(budgetv.ulong_val());
+  Component* comp = allv.is_false() && editor() ? editor()->GetComponent() : nil;
+  ComValue retval(unidraw->HistoryFootprint(comp));
+  push_stack(retval);
+}
+
+/*****************************************************************************/
+
 HandlesFunc::HandlesFunc(ComTerp* comterp, Editor* ed) : UnidrawFunc(comterp, ed) {
 }
 
@@ -60,6 +60,16 @@ public:
 	return "%s() -- update viewers"; }
 };
 
+//: command to query or bound the memory held by the undo history.
+// bytes=historymem([budget] :all) -- return bytes held by undo history of the editor (or all editors), optionally setting the byte budget
+class HistoryMemFunc : public UnidrawFunc {
+public:
+    HistoryMemFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "bytes=%s([budget] :all) -- return bytes held by undo history of the editor (or all editors), optionally setting the byte budget (0 for none)"; }
+};
+
 //: command to turn on or off the selection tic marks in comdraw.
 // handles(flag) -- enable/disable current selection tic marks and/or highlighting
 class HandlesFunc : public UnidrawFunc {
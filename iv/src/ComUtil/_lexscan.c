@@ -43,6 +43,7 @@ History:        Written by Scott E. Johnston, March 1989
 
 extern int _continuation_prompt;
 extern int _continuation_prompt_disabled;
+extern int _eol_eof;
 unsigned _token_state_save = TOK_WHITESPACE;
 				/* variable to save token state between calls */
 int _ignore_numerics = 0;
@@ -66,6 +67,10 @@ while( CURR_CHAR != '\n' && \
 CURR_CHAR != ( token_state == TOK_STRING ? '"' : '\'' )) \
 ADVANCE_CHAR; ADVANCE_CHAR
 
+#define IS_NUMBER_OR_IDENTIFIER( state ) \
+((state) == TOK_IDENTIFIER || (state) == TOK_DFINT || (state) == TOK_OCT || \
+(state) == TOK_HEX || (state) == TOK_DOUBLE)
+
 
 
 /*!
@@ -143,8 +148,11 @@ Description:
 
 `infunc`, `eoffunc`, and `errfunc` are a set of functions that allow `lexscan`
 to access new lines of text as required.  If `infunc` is `NULL`, scanning is
-done on the contents of `buffer` only.  In this case the contents of `buffer`
-must terminate with a '\n'.
+done on the contents of `buffer` only, in place.  In this case the null byte
+that terminates `buffer` is taken as the end of file, new-lines within it
+advance `linenum`, and lines that begin with `linecmt` are skipped.  While
+the parser looks ahead past a complete expression a new-line is taken as
+the end of file instead, the same as the end of a line read by `infunc`.
 
 
 !*/
@@ -154,6 +162,7 @@ register char ch;		/* For efficient access of latest char */
 unsigned double_state = FLOAT_INTEGER;
 				/* Extra state variable for float parsing */
 BOOLEAN long_num = FALSE;       /* Indicates long integer to be used */
+BOOLEAN cut_line;               /* Last line read was handed over in parts */
 unsigned token_state = TOK_WHITESPACE;
 				/* Internal token state variable */
 unsigned begcmt_len =           /* Number of characters in comment beginning */
@@ -193,6 +202,14 @@ char* infunc_retval;
 	 buffer[0] = '\0';
       else {
 	 *linenum = 1;
+	 while( linecmt && buffer[*bufptr] == linecmt ) {
+	    while( buffer[*bufptr] != '\n' && buffer[*bufptr] != '\0' )
+	       ++*bufptr;
+	    if( buffer[*bufptr] == '\n' ) {
+	       ++*bufptr;
+	       ++*linenum;
+	       }
+	    }
 #if 0
 	 if( outfile != NULL )
 	    if( (*outfunc)( buffer, outfile ) != 0 )
@@ -225,8 +242,10 @@ char* infunc_retval;
 
    /* ----------------- GET NEXT CHARACTER -------------------- */
 
-   /* Get New Line of Text */
-      if( CURR_CHAR == '\0' ) {
+   /* Get New Line of Text (unless scanning in place, where the null */
+   /* byte ends a number or identifier like any other delimiter)      */
+      if( CURR_CHAR == '\0' &&
+	  ( infunc != NULL || !IS_NUMBER_OR_IDENTIFIER( token_state ))) {
 
       /* If infunc is NULL, emulate end-of-file */
 	 if( infunc == NULL ) {
@@ -238,6 +257,12 @@ char* infunc_retval;
 	    return FUNCOK;
 	    }
 
+      /* A line handed over in parts continues without a prompt, */
+      /* and on the same line number                             */
+	 cut_line = *bufptr > 0 && buffer[*bufptr-1] != '\n';
+	 if( cut_line )
+	    _continuation_prompt = 0;
+
       /* Clear next to last byte for "line too long" check */
 	 buffer[bufsiz-2] = '\0';
 
@@ -279,7 +304,8 @@ char* infunc_retval;
       /* If end-of-file was encountered, yet a legimitate read */
       /* occurred, warn the user that last line in file does   */
       /* not end with new-line char                            */
-	 ++*linenum;
+	 if( !cut_line )
+	    ++*linenum;
          if( (*eoffunc)( infile ))
             return ERR_EOFNEWLINE;
 
@@ -314,7 +340,8 @@ char* infunc_retval;
 	     _token_state_save = token_state;
 	     token[*toklen] = '\0';
   	    }
-	    *linenum--;
+	    if( !cut_line )
+	       --*linenum;
 	    return  FUNCOK;
 	 }
 
@@ -342,6 +369,25 @@ char* infunc_retval;
 
       /* Still whitespace */
 	 if( isspace( CURR_CHAR )) {
+
+	 /* Count lines and skip script comments when scanning in place, */
+	 /* unless the parser is looking past the end of an expression,  */
+	 /* where the new-line ends the line of input like the null byte */
+	    if( infunc == NULL && CURR_CHAR == '\n' ) {
+	       if( _eol_eof ) {
+		  *toktype = TOK_EOF;
+		  return FUNCOK;
+		  }
+	       ++*linenum;
+	       while( linecmt && NEXT_CHAR == linecmt ) {
+		  while( NEXT_CHAR != '\n' && NEXT_CHAR != '\0' )
+		     ADVANCE_CHAR;
+		  if( NEXT_CHAR == '\n' ) {
+		     ADVANCE_CHAR;
+		     ++*linenum;
+		     }
+		  }
+	       }
 	    }
 
       /* Start of comment */
@@ -423,6 +469,8 @@ char* infunc_retval;
       /*-COMMENT-COMMENT-COMMENT-COMMENT-COMMENT-COMMENT-COMMENT-COMMENT-*/
 
       case TOK_COMMENT:
+	 if( infunc == NULL && CURR_CHAR == '\n' )
+	    ++*linenum;
 	 if( strncmp( endcmt, buffer+*bufptr, endcmt_len ) == 0 ) {
 	    token_state = TOK_WHITESPACE;
 	    for( index=1; index<endcmt_len; index++)
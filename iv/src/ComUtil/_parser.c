@@ -44,6 +44,7 @@ int _continuation_prompt;
 int _continuation_prompt_disabled = 0;
 int _skip_shell_comments = 0;
 infuncptr _oneshot_infunc = NULL;
+int _eol_eof = 0;		/* new-line is end-of-file to in place scan */
 int _detail_matched_delims = 0;
 int _sticky_matched_delims = 0;
 
@@ -158,11 +159,13 @@ if( TopOfParenStack < 0 ) infunc2 = NULL;\
 else infunc2 = infunc;\
 NextBufptr=*bufptr;\
 NextLinenum=*linenum;\
+_eol_eof = infunc2 == NULL;\
 status = get_next_token(\
    infile, infunc2, eoffunc, errfunc, outfile, outfunc,\
    buffer, bufsiz, &NextBufptr, NextToken, toksiz, \
    &NextToklen, &NextToktype, &NextTokstart, &NextLinenum,\
    NextOp_ids, OPTYPE_NUM );\
+_eol_eof = 0;\
 if( status != 0 ) goto error_return;}
 
 
@@ -492,6 +492,9 @@ void Dispatcher::detach(int fd) {
     _wtable[fd] = nil;
     _emask->clrBit(fd);
     _etable[fd] = nil;
+    _rmaskready->clrBit(fd);
+    _wmaskready->clrBit(fd);
+    _emaskready->clrBit(fd);
     if (_nfds == fd+1) {
 	while (_nfds > 0 && _rtable[_nfds-1] == nil &&
 	       _wtable[_nfds-1] == nil && _etable[_nfds-1] == nil
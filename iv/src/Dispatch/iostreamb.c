@@ -100,7 +100,7 @@ istreamb& istreamb::operator>>(char& c) {
 }
 
 istreamb& istreamb::operator>>(unsigned char& uc) {
-    get(uc);			// assume uc is 8 bits long on all machines
+    get((char&)uc);		// assume uc is 8 bits long on all machines
     return *this;
 }
 
@@ -231,7 +231,7 @@ istreamb& istreamb::operator>>(char* p) {
 istreamb& istreamb::operator>>(unsigned char* up) {
     const int MAXINT = (int)(((unsigned)-1) >> 1);
     const int w = width(0);
-    getline(up, w ? w : MAXINT, '\0');
+    getline((char*)up, w ? w : MAXINT, '\0');
     if (w && gcount() == w - 1) {
 	setstate(ios::failbit);
     }
@@ -406,14 +406,22 @@ ostreamb& ostreamb::operator<<(double d) {
 
 ostreamb& ostreamb::operator<<(const char* p) {
     fixwidth();
+#if __GNUC__>=3
+    (ostream&)*this << p;	// std::ostream inserts strings with a non-member
+#else
     ostream::operator<<(p);
+#endif
     put('\0');
     return *this;
 }
 
 ostreamb& ostreamb::operator<<(const unsigned char* up) {
     fixwidth();
+#if __GNUC__>=3
+    (ostream&)*this << (const char*)up;
+#else
     ostream::operator<<((const char*)up); // 2.0 ostream omitted unsigned char*
+#endif
     put('\0');
     return *this;
 }
@@ -454,16 +462,40 @@ iostreamb::~iostreamb() {}
 // check for streams tied to themselves.  Sigh....
 
 void iostreamb::negotiate(boolean b) {
+    int version = 0;
+    negotiate(b, version);
+    if (good() && version != 0) {
+	setstate(ios::badbit);
+    }
+}
+
+// Negotiate as above while exchanging a protocol version with the
+// peer, 0 or 1, for streams that extend the format of what they
+// exchange.  Version 0 sends the format as 'T' or 'F' like older
+// peers do, and version 1 sends it in lower case, which an older peer
+// rejects rather than misreading what follows.  Return the peer's
+// version in 'version'.
+
+void iostreamb::negotiate(boolean b, int& version) {
     if (!good()) {
 	return;
     }
 
     iosb::binary(b);
     char format = iosb::binary() ? 'T' : 'F';
+    if (version != 0) {
+	format = (format == 'T') ? 't' : 'f';
+    }
 
     *this << format; flush();
     *this >> format;
 
+    if (format == 't' || format == 'f') {
+	version = 1;
+	format = (format == 't') ? 'T' : 'F';
+    } else {
+	version = 0;
+    }
     if (format != 'T' && format != 'F') {
 	setstate(ios::badbit);
     }
@@ -38,7 +38,9 @@ extern "C" {
 #endif
 #include <stdlib.h>
 #include <stdio.h>
+#include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #ifndef SOMAXCONN
 #define SOMAXCONN 5
@@ -59,6 +61,10 @@ extern "C" {
 typedef int socklen_t;
 #endif
 
+#if __GNUC__>=3
+using std::cerr;
+#endif
+
 // I need a pointer to an iostreamb so I can insert and extract values
 // in the length field of RPC requests.  If I don't have a stream, I
 // won't allow you to call start_request().
@@ -73,16 +79,29 @@ rpcbuf::rpcbuf(iostreamb* mystream) : streambuf(),
     _opened(false),
     _close(false),
     _nonblocking(false),
-    _verbose(true) {}
+    _verbose(true),
+    _nchain(0),
+    _chainbytes(0)
+#if __GNUC__>=3
+    , _base(nil),
+    _ebuf(nil)
+#endif
+{}
 
-// Free the buffer used to store the put area.  The streambuf
-// destructor will free the buffer used to store the get area.
+// Free the buffers used to store the put area and any put areas still
+// chained.  The original streambuf destructor frees the buffer used
+// to store the get area; std::streambuf leaves that to us.
 
 rpcbuf::~rpcbuf() {
     close();
 
-    delete pbase();
+    free_chain();
+    delete [] pbase();
     setp(nil, nil);
+#if __GNUC__>=3
+    delete [] _base;
+    setg(nil, nil, nil);
+#endif
 }
 
 // Return information about the connection.
@@ -286,6 +305,7 @@ rpcbuf* rpcbuf::close() {
     }
 
     sync();
+    gbump(in_avail());
 
     int ok = 0;
     if (_close) {
@@ -436,11 +456,31 @@ int rpcbuf::read_request() {
     }
 }
 
+// Return a pointer to the next n bytes of the current request, which
+// read_request found to be completely buffered, and skip over them.
+// The bytes stay in the get area until the next call to underflow(),
+// so a reader can use a request's data without copying it; data(0)
+// only returns where the unread data begins.  Return nil if fewer
+// than n bytes are buffered.
+
+const char* rpcbuf::data(int n) {
+    if (n < 0 || in_avail() < n) {
+	return nil;
+    }
+    const char* p = gptr();
+    gbump(n);
+    return p;
+}
+
 // Finish the current RPC request if there's nothing to append to it,
-// thus allowing flush to send the current RPC request.  Send any
-// outgoing data using a loop to safeguard against partial writes.
-// Shift any still incomplete RPC request to the beginning of the put
-// area to make room for more data.  Append the overflow char if any.
+// thus allowing flush to send the current RPC request.  If the put
+// area filled up with complete requests, chain it to be sent later
+// and carry on in a new put area, unless that would leave more than
+// maxchainbytes waiting in the chain.
+// Otherwise send the chain and the put area's complete requests
+// together.  Shift any still incomplete RPC request to the beginning
+// of the put area to make room for more data.  Append the overflow
+// char if any.
 
 int rpcbuf::overflow(int c) {
     if (!_opened || allocate() == EOF) {
@@ -449,6 +489,12 @@ int rpcbuf::overflow(int c) {
 
     if (c == EOF) {
 	finish_request();
+    } else if (
+	rptr() > pbase() && _nchain < maxchain &&
+	_chainbytes + (rptr() - pbase()) <= maxchainbytes && chain_p()
+    ) {
+	sputc(c);
+	return zapeof(c);
     }
 
     if (rptr() == pbase() && pptr() >= epptr() && !expand_p()) {
@@ -457,14 +503,8 @@ int rpcbuf::overflow(int c) {
     }
 
     int nwrite = (rptr() >= pbase()) ? rptr() - pbase() : out_waiting();
-    int count = 0;
-    while (count < nwrite) {
-	int nsent = write(_fd, pbase() + count, nwrite - count);
-	if (nsent < 0) {
-	    sys_error("rpcbuf::overflow: write");
-	    return EOF;
-	}
-	count += nsent;
+    if (write_chain(nwrite) == EOF) {
+	return EOF;
     }
     if (rptr() > pbase()) {
 	Memory::copy(rptr(), pbase(), pptr() - rptr());
@@ -515,20 +555,22 @@ int rpcbuf::underflow() {
     return zapeof(*gptr());
 }
 
-// Probably called from ios's destructor.  Can't do anything with
-// still unread data except discard it, but can flush any outgoing RPC
-// requests from the put area.
+// Flush any outgoing RPC requests from the put area and the chain.
+// Leave still unread data alone, since a connection that sends
+// replies to pipelined requests flushes them while later requests
+// may already be buffered; close() discards unread data instead.
 
 int rpcbuf::sync() {
-    gbump(in_avail());
-    return out_waiting() ? overflow() : 0;
+    return (out_waiting() || _nchain) ? overflow() : 0;
 }
 
 // Can't seek on a socket, but can return the get pointer's current
 // position so that the caller can find out how many bytes he read
 // since the get pointer's last position (within the same request).
 
-#ifdef cplusplus_2_1
+#if __GNUC__>=3
+streampos rpcbuf::seekoff(streamoff offset, ios::seekdir dir, ios::openmode mode) {
+#elif defined(cplusplus_2_1)
 streampos rpcbuf::seekoff(streamoff offset, ios::seek_dir dir, int mode) {
 #else
 streampos rpcbuf::seekoff(streamoff offset, seek_dir dir, int mode) {
@@ -541,14 +583,18 @@ streampos rpcbuf::seekoff(streamoff offset, seek_dir dir, int mode) {
 	return EOF;
     }
 
-    return (streampos)gptr();
+    return (streampos)(streamoff)gptr();
 }
 
 // Refuse any attempt to set the buffers for storing incoming and
 // outgoing RPC requests because we need the ability to dynamically
 // expand the buffers' sizes.
 
+#if __GNUC__>=3
+streambuf* rpcbuf::setbuf(char*, std::streamsize) {
+#else
 streambuf* rpcbuf::setbuf(char*, int) {
+#endif
     return nil;
 }
 
@@ -588,7 +634,7 @@ boolean rpcbuf::expand_g(int newsize) {
 
     int navail = in_avail();
     Memory::copy(gptr(), get, navail);
-    delete eback();
+    delete [] eback();
     setb(get, get + newsize, true);
     setg(get, get, get + navail);
 
@@ -607,7 +653,7 @@ boolean rpcbuf::expand_p() {
 
     int nwaiting = out_waiting();
     Memory::copy(pbase(), put, nwaiting);
-    delete pbase();
+    delete [] pbase();
     setp(put, put + newsize);
     pbump(nwaiting);
     setr(put);
@@ -615,6 +661,89 @@ boolean rpcbuf::expand_p() {
     return true;
 }
 
+// Chain the put area's complete requests to be sent later and move
+// the incomplete request at its end to a new put area of the same
+// size.
+
+boolean rpcbuf::chain_p() {
+    int size = epptr() - pbase();
+    char* put = new char[size];
+    if (!put) {
+	return false;
+    }
+
+    int nchain = rptr() - pbase();
+    int nrest = pptr() - rptr();
+    Memory::copy(rptr(), put, nrest);
+    _chain[_nchain] = pbase();
+    _chainlen[_nchain] = nchain;
+    ++_nchain;
+    _chainbytes += nchain;
+    setp(put, put + size);
+    pbump(nrest);
+    setr(put);
+
+    return true;
+}
+
+// Send the chained put areas and then the first nwrite bytes of the
+// put area with writev, looping to safeguard against partial writes.
+// Free the chained put areas afterwards.
+
+int rpcbuf::write_chain(int nwrite) {
+    struct iovec iov[maxchain + 1];
+    int niov = 0;
+    for (int i = 0; i < _nchain; i++) {
+	iov[niov].iov_base = _chain[i];
+	iov[niov].iov_len = _chainlen[i];
+	++niov;
+    }
+    if (nwrite > 0) {
+	iov[niov].iov_base = pbase();
+	iov[niov].iov_len = nwrite;
+	++niov;
+    }
+
+    struct iovec* next = iov;
+    while (niov > 0) {
+	int nsent = writev(_fd, next, niov);
+	if (nsent < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+	    // A reply reader may have made the socket nonblocking; wait
+	    // for room rather than drop the rest of the batch.
+	    fd_set wmask;
+	    FD_ZERO(&wmask);
+	    FD_SET(_fd, &wmask);
+	    select(_fd+1, nil, &wmask, nil, nil);
+	    continue;
+	}
+	if (nsent < 0) {
+	    sys_error("rpcbuf::overflow: writev");
+	    free_chain();
+	    return EOF;
+	}
+	while (niov > 0 && nsent >= (int)next->iov_len) {
+	    nsent -= next->iov_len;
+	    ++next;
+	    --niov;
+	}
+	if (niov > 0) {
+	    next->iov_base = (char*)next->iov_base + nsent;
+	    next->iov_len -= nsent;
+	}
+    }
+
+    free_chain();
+    return 0;
+}
+
+void rpcbuf::free_chain() {
+    for (int i = 0; i < _nchain; i++) {
+	delete [] _chain[i];
+    }
+    _nchain = 0;
+    _chainbytes = 0;
+}
+
 // Print a user error message.
 
 void rpcbuf::error(const char* msg) {
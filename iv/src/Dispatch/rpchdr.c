@@ -27,17 +27,21 @@
 
 // Initialize the header for an outgoing RPC request.
 
-RpcHdr::RpcHdr(void* writer, int request) :
+RpcHdr::RpcHdr(void* writer, int request, unsigned long id) :
     _writer(writer),
     _request(request),
-    _ndata(0) {}
+    _ndata(0),
+    _id(id),
+    _data(nil) {}
 
 // Initialize the header for an incoming RPC request.
 
 RpcHdr::RpcHdr() :
     _reader(0),
     _request(0),
-    _ndata(0) {}
+    _ndata(0),
+    _id(0),
+    _data(nil) {}
 
 // If incomplete_request was set, explicitly call underflow in an
 // attempt to complete an incoming RPC request by reading additional
@@ -47,7 +51,8 @@ RpcHdr::RpcHdr() :
 // if the incoming RPC request is complete yet.  If it is, extract its
 // header, else set incomplete_request to note so.  Decrement the
 // length (which counted the entire request) by the space that the
-// header occupied to count only the data following the header.
+// header occupied to count only the data following the header, and
+// point to that data where it lies in the buffer.
 
 rpcstream& operator>>(rpcstream& client, RpcHdr& hdr) {
     if (client.good() && client.incomplete_request()) {
@@ -63,8 +68,9 @@ rpcstream& operator>>(rpcstream& client, RpcHdr& hdr) {
     if (client.good()) {
 	if (client.rdbuf()->read_request() != EOF) {
 	    streampos beginning = client.tellg();
-	    client >> hdr._ndata >> hdr._reader >> hdr._request;
+	    client >> hdr._ndata >> hdr._reader >> hdr._request >> hdr._id;
 	    hdr._ndata -= (int)(client.tellg() - beginning);
+	    hdr._data = client.rdbuf()->data(0);
 	} else {
 	    client.incomplete_request(true);
 	}
@@ -79,7 +85,7 @@ rpcstream& operator>>(rpcstream& client, RpcHdr& hdr) {
 
 rpcstream& operator<<(rpcstream& server, const RpcHdr& hdr) {
     if (server && server.rdbuf()->start_request() != EOF) {
-	server << hdr._reader << hdr._request;
+	server << hdr._reader << hdr._request << hdr._id;
     } else {
 	server.clear(server.rdstate() | ios::failbit);
     }
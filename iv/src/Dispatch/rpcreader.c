@@ -25,6 +25,7 @@
 #include <Dispatch/dispatcher.h>
 #include <Dispatch/rpchdr.h>
 #include <Dispatch/rpcreader.h>
+#include <Dispatch/rpcreply.h>
 #include <Dispatch/rpcstream.h>
 
 // Prepare to read RPC requests from somebody else's connection or
@@ -102,11 +103,17 @@ RpcReader::~RpcReader() {
 }
 
 // Read only one RPC request per call to allow the program to
-// interleave RPC requests from multiple clients.  Look up the proper
-// reader to execute the request or skip over the request's data if it
-// could not be executed.  Ask a derived class to take the appropriate
-// action (perhaps closing the file number or deleting ``this'') if no
-// more data is available or the data wasn't what we expected.
+// interleave RPC requests from multiple clients.  Pass a reply to the
+// handler waiting for it, or else look up the proper reader to
+// execute the request.  The request's data is completely buffered,
+// so a handler may extract it or use hdr.data() in place; skip over
+// whatever data the handler left, or all of it if the request could
+// not be executed.  Ask a derived class to take the appropriate action
+// (perhaps closing the file number or deleting ``this'') if no more
+// data is available or the data wasn't what we expected.  Send the
+// replies written by the requests executed so far only when no
+// complete request remains buffered, so that the replies to pipelined
+// requests go out together.
 
 int RpcReader::inputReady(int fd) {
     RpcHdr hdr;
@@ -114,10 +121,19 @@ int RpcReader::inputReady(int fd) {
     client() >> hdr;
 
     if (client().good() && !client().incomplete_request()) {
-	RpcReader* reader = map(hdr.reader());
+	int navail = client().rdbuf()->in_avail();
+	if (hdr.request() == RpcHdr::reply) {
+	    RpcReply* reply = client().answered(hdr.id());
+	    if (reply) {
+		reply->reply(hdr, client());
+	    }
+	} else {
+	    execute(map(hdr.reader()), hdr);
+	}
 
-	if (!execute(reader, hdr)) {
-	    client().ignore(hdr.ndata());
+	int nunread = hdr.ndata() - (navail - client().rdbuf()->in_avail());
+	if (nunread > 0) {
+	    client().rdbuf()->data(nunread);
 	}
     }
 
@@ -125,6 +141,7 @@ int RpcReader::inputReady(int fd) {
 	connectionClosed(fd);
 	return -1;		// don't ever call me again (i.e., detach me)
     } else if (client().incomplete_request()) {
+	client().flush();
 	return 0;		// call me only when more input arrives
     } else {
 	return 1;		// call me again as soon as possible
@@ -26,6 +26,7 @@
 #include <OS/host.h>
 #include <OS/types.h>
 #include <fstream.h>
+#include <iostream.h>
 #include <errno.h>
 #ifndef __DECCXX
 #include <osfcn.h>
@@ -40,11 +41,18 @@
 #if defined(__linux__) || defined(__FreeBSD__)
 #include <stdio.h>
 #endif
+#if __GNUC__>=3
+using std::cerr;
+using std::ends;
+using std::ifstream;
+using std::ofstream;
+#endif
+
 // Print a short error message describing the last error encountered
 // during a call to a system function.
 
 static ostream& perror(ostream& s) {
-#if defined(sun)
+#if defined(sun) || __GNUC__>=3
     s << ": " << strerror(errno);
 #else
     if (errno > 0 && errno < sys_nerr) {
@@ -22,7 +22,12 @@
  * OF THIS SOFTWARE.
  */
 
+#include <Dispatch/rpcreply.h>
 #include <Dispatch/rpcstream.h>
+#include <OS/table.h>
+
+declareTable(RpcReplyTable,long,RpcReply*)
+implementTable(RpcReplyTable,long,RpcReply*)
 
 // Specialize this class to RPC requests by initializing an rpcbuf.
 // Set incomplete_request to ensure the first attempt to extract an RPC
@@ -30,13 +35,22 @@
 
 rpcstream::rpcstream() :
     _buf(this),
-    _incomplete_request(true)
+    _incomplete_request(true),
+    _replies(nil),
+    _lastid(0),
+    _outstanding(0)
 {
+#if __GNUC__>=3
+    init(&_buf);
+#else
 //    init(&_buf);
+#endif
 }
 
 #if !defined(_IO_NEW_STREAMS)
-rpcstream::~rpcstream() {}
+rpcstream::~rpcstream() {
+    delete _replies;
+}
 #endif
 
 // Provide operations on the rpcbuf.  Most change the stream's state
@@ -76,6 +90,53 @@ void rpcstream::verbose(boolean verbose) { // no effect on stream's state
     rdbuf()->verbose(verbose);
 }
 
+// Negotiate the I/O format like any iostreamb, offering the version
+// of the protocol whose request headers carry ids.  A peer that
+// answers with the older version has already rejected ours, so give
+// up on the connection.
+
+void rpcstream::negotiate(boolean binary) {
+    int version = 1;
+    iostreamb::negotiate(binary, version);
+    if (good() && version != 1) {
+	setstate(ios::badbit);
+    }
+}
+
+// Give a new request an id under which its reply will be passed to
+// the reply handler, so that any number of requests may be sent
+// before their replies arrive.  Ids are never zero, which marks a
+// request that expects no reply.
+
+unsigned long rpcstream::expect(RpcReply* reply) {
+    if (!_replies) {
+	_replies = new RpcReplyTable(64);
+    }
+    if (++_lastid == 0) {
+	++_lastid;
+    }
+    _replies->insert((long)_lastid, reply);
+    ++_outstanding;
+    return _lastid;
+}
+
+// Return and forget the reply handler for a request now answered, or
+// nil if no request with that id is outstanding.
+
+RpcReply* rpcstream::answered(unsigned long id) {
+    RpcReply* reply = nil;
+    if (_replies && _replies->find_and_remove(reply, (long)id)) {
+	--_outstanding;
+	return reply;
+    }
+    return nil;
+}
+
+boolean rpcstream::waiting(unsigned long id) {
+    RpcReply* reply;
+    return _replies != nil && _replies->find(reply, (long)id);
+}
+
 // For some of the functions above, success means starting over with a
 // clean slate while failure means setting failbit as usual.
 
@@ -22,11 +22,16 @@
  * OF THIS SOFTWARE.
  */
 
+#include <Dispatch/dispatcher.h>
 #include <Dispatch/rpcregistry.h>
 #include <Dispatch/rpcstream.h>
 #include <Dispatch/rpcwriter.h>
 #include <stdlib.h>		/* for abort() */
 
+#if __GNUC__>=3
+using std::cerr;
+#endif
+
 // Open a connection to an RPC service at its registered host name and
 // port number, or give the host name and port number needed to open a
 // connection to the RPC service, or give the number of an already
@@ -90,6 +95,17 @@ RpcWriter::~RpcWriter() {
     delete _host;
 }
 
+// Send any buffered requests, then dispatch events until the reply to
+// the request with the given id has been handed to its RpcReply.  An
+// RpcReader must be attached to the connection to read the reply.
+
+void RpcWriter::wait(unsigned long id) {
+    server().flush();
+    while (server().good() && server().waiting(id)) {
+	Dispatcher::instance().dispatch();
+    }
+}
+
 // Use a member function to open a connection to an RPC service at its
 // registered host name and port number so that a derived class's
 // constructor can retry the attempt if necessary.
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2000 Vectaport Inc, IET Inc.
+ * Copyright (c) 1994-1999 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ * 
+ */
+
+/*
+ * FrameCache implementation.
+ */
+
+#include <FrameUnidraw/framecache.h>
+#include <FrameUnidraw/frameviews.h>
+
+#include <InterViews/canvas.h>
+#include <InterViews/transformer.h>
+#include <InterViews/window.h>
+
+#include <IV-X11/Xlib.h>
+#include <IV-X11/xcanvas.h>
+#include <IV-X11/xwindow.h>
+
+#include <OS/table.h>
+
+/*****************************************************************************/
+
+class FrameCacheEntry {
+public:
+    FrameView* _frame;
+    XDisplay* _dpy;
+    Pixmap _pixmap;
+    PixelCoord _pwidth;
+    PixelCoord _pheight;
+    float _matrix[6];
+    unsigned long _bytes;
+
+    FrameCacheEntry* _prev;
+    FrameCacheEntry* _next;
+
+    boolean Matches(Canvas*, Transformer*);
+    void Viewport(Canvas*, Transformer*);
+};
+
+static void get_matrix(Transformer* t, float m[6]) {
+    if (t) 
+        t->matrix(m[0], m[1], m[2], m[3], m[4], m[5]);
+    else {
+        m[0] = m[3] = 1.0;
+        m[1] = m[2] = m[4] = m[5] = 0.0;
+    }
+}
+
+boolean FrameCacheEntry::Matches(Canvas* c, Transformer* t) {
+    if (c->pwidth() != _pwidth || c->pheight() != _pheight) return false;
+    float m[6];
+    get_matrix(t, m);
+    for (int i = 0; i < 6; i++) 
+        if (m[i] != _matrix[i]) return false;
+    return true;
+}
+
+void FrameCacheEntry::Viewport(Canvas* c, Transformer* t) {
+    _pwidth = c->pwidth();
+    _pheight = c->pheight();
+    get_matrix(t, _matrix);
+}
+
+declareTable(FrameCacheTable,const void*,FrameCacheEntry*)
+implementTable(FrameCacheTable,const void*,FrameCacheEntry*)
+
+/*****************************************************************************/
+
+FrameCache::FrameCache(unsigned long maxbytes) {
+    _table = new FrameCacheTable(256);
+    _head = _tail = nil;
+    _maxbytes = maxbytes;
+    _bytes = 0;
+    _count = 0;
+    _hits = _misses = 0;
+}
+
+FrameCache::~FrameCache() {
+    Clear();
+    delete _table;
+}
+
+FrameCacheEntry* FrameCache::Lookup(FrameView* frame, Canvas* c, Transformer* t) {
+    FrameCacheEntry* e;
+    if (c != nil && _table->find(e, frame) && e->Matches(c, t)) 
+        return e;
+    return nil;
+}
+
+boolean FrameCache::Contains(FrameView* frame, Canvas* c, Transformer* t) {
+    return Lookup(frame, c, t) != nil;
+}
+
+boolean FrameCache::Blit(FrameView* frame, Canvas* c, Transformer* t) {
+    FrameCacheEntry* e = Lookup(frame, c, t);
+    if (e == nil) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+    Touch(e);
+
+    CanvasRep* cr = c->rep();
+    XDisplay* dpy = cr->dpy();
+    XDrawable front = cr->copybuffer_ != CanvasRep::unbound 
+        ? cr->copybuffer_ : cr->drawbuffer_;
+    GC gc = cr->copybuffer_ != CanvasRep::unbound ? cr->copygc_ : cr->drawgc_;
+    if (cr->copybuffer_ != CanvasRep::unbound) {
+	/* keep the back buffer coherent for the next real repair */
+	XCopyArea(dpy, e->_pixmap, cr->drawbuffer_, cr->drawgc_,
+		  0, 0, e->_pwidth, e->_pheight, 0, 0);
+    }
+    XCopyArea(dpy, e->_pixmap, front, gc, 0, 0, e->_pwidth, e->_pheight, 0, 0);
+    XFlush(dpy);
+    return true;
+}
+
+boolean FrameCache::Store(FrameView* frame, Canvas* c, Transformer* t) {
+    if (c == nil || c->rep()->drawbuffer_ == CanvasRep::unbound) return false;
+    CanvasRep* cr = c->rep();
+    XDisplay* dpy = cr->dpy();
+    int depth = cr->window_->rep()->visual_->depth();
+    PixelCoord pw = c->pwidth();
+    PixelCoord ph = c->pheight();
+    unsigned long bytes = (unsigned long)pw * ph * ((depth + 7) / 8);
+    if (bytes == 0 || bytes > _maxbytes) return false;
+
+    Invalidate(frame);
+    Trim(bytes);
+
+    FrameCacheEntry* e = new FrameCacheEntry;
+    e->_frame = frame;
+    e->_dpy = dpy;
+    e->_pixmap = XCreatePixmap(dpy, cr->drawbuffer_, pw, ph, depth);
+    e->_bytes = bytes;
+    e->Viewport(c, t);
+    XCopyArea(dpy, cr->drawbuffer_, e->_pixmap, cr->drawgc_, 0, 0, pw, ph, 0, 0);
+
+    e->_prev = nil;
+    e->_next = _head;
+    if (_head) _head->_prev = e;
+    _head = e;
+    if (!_tail) _tail = e;
+    _table->insert(frame, e);
+    _bytes += bytes;
+    _count++;
+    return true;
+}
+
+void FrameCache::Invalidate(FrameView* frame) {
+    FrameCacheEntry* e;
+    if (_table->find(e, frame)) Discard(e);
+}
+
+void FrameCache::Clear() {
+    while (_tail) Discard(_tail);
+}
+
+void FrameCache::MaxBytes(unsigned long maxbytes) {
+    _maxbytes = maxbytes;
+    Trim(0);
+}
+
+void FrameCache::Touch(FrameCacheEntry* e) {
+    if (e == _head) return;
+    Unlink(e);
+    e->_prev = nil;
+    e->_next = _head;
+    if (_head) _head->_prev = e;
+    _head = e;
+    if (!_tail) _tail = e;
+}
+
+void FrameCache::Unlink(FrameCacheEntry* e) {
+    if (e->_prev) e->_prev->_next = e->_next; else _head = e->_next;
+    if (e->_next) e->_next->_prev = e->_prev; else _tail = e->_prev;
+    e->_prev = e->_next = nil;
+}
+
+void FrameCache::Discard(FrameCacheEntry* e) {
+    Unlink(e);
+    _table->remove(e->_frame);
+    XFreePixmap(e->_dpy, e->_pixmap);
+    _bytes -= e->_bytes;
+    _count--;
+    delete e;
+}
+
+void FrameCache::Trim(unsigned long needed) {
+    while (_tail && _bytes + needed > _maxbytes) Discard(_tail);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ * 
+ */
+
+
+#ifndef framecache_h
+#define framecache_h
+
+#include <InterViews/enter-scope.h>
+
+class Canvas;
+class FrameView;
+class Transformer;
+class FrameCacheEntry;
+class FrameCacheTable;
+
+//: least-recently-used cache of pre-rendered frames.
+// each entry holds a server-side pixmap of a frame as it was last drawn
+// into a canvas, together with the canvas size and viewer transformation
+// (the viewport) it was drawn under.  The total size of the cached pixmaps
+// is bounded by a byte budget, least recently used frames being discarded
+// first.
+class FrameCache {
+public:
+    FrameCache(unsigned long maxbytes = FrameCache::default_budget);
+    virtual ~FrameCache();
+
+    boolean Store(FrameView*, Canvas*, Transformer*);
+    // copy current contents of the canvas into the cache as the rendering 
+    // of the frame under the given viewer transformation.
+    boolean Blit(FrameView*, Canvas*, Transformer*);
+    // copy a cached rendering of a frame onto the canvas window, if one
+    // exists for this viewport.  Returns false on a cache miss.
+    boolean Contains(FrameView*, Canvas*, Transformer*);
+    // true if a rendering exists for this frame and viewport.
+
+    void Invalidate(FrameView*);
+    // discard rendering of one frame.
+    void Clear();
+    // discard every rendering.
+
+    void MaxBytes(unsigned long);
+    // set byte budget, discarding entries as needed.
+    unsigned long MaxBytes() { return _maxbytes; }
+    // return byte budget.
+    unsigned long Bytes() { return _bytes; }
+    // return bytes currently in use.
+    int Count() { return _count; }
+    // return number of cached frames.
+
+    unsigned long hits() { return _hits; }
+    // number of successful lookups.
+    unsigned long misses() { return _misses; }
+    // number of failed lookups.
+
+    enum { default_budget = 64*1024*1024 };
+protected:
+    FrameCacheEntry* Lookup(FrameView*, Canvas*, Transformer*);
+    void Touch(FrameCacheEntry*);
+    void Unlink(FrameCacheEntry*);
+    void Discard(FrameCacheEntry*);
+    void Trim(unsigned long needed);
+
+    FrameCacheTable* _table;
+    FrameCacheEntry* _head;
+    FrameCacheEntry* _tail;
+    unsigned long _maxbytes;
+    unsigned long _bytes;
+    int _count;
+    unsigned long _hits;
+    unsigned long _misses;
+};
+
+#include <InterViews/leave-scope.h>
+
+#endif
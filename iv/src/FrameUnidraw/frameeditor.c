@@ -22,6 +22,7 @@
  * 
  */
 
+#include <FrameUnidraw/framecache.h>
 #include <FrameUnidraw/frameclasses.h>
 #include <FrameUnidraw/framecomps.h>
 #include <FrameUnidraw/framecmds.h>
@@ -47,9 +48,13 @@
 #include <Unidraw/catalog.h>
 #include <Unidraw/ctrlinfo.h>
 #include <Unidraw/keymap.h>
+#include <Unidraw/Graphic/damage.h>
+
+#include <Dispatch/dispatcher.h>
 
 #include <InterViews/box.h>
 #include <InterViews/border.h>
+#include <InterViews/canvas.h>
 #include <InterViews/glue.h>
 #include <InterViews/telltale.h>
 
@@ -59,9 +64,20 @@
 
 #include <ComTerp/comterpserv.h>
 
+#include <OS/math.h>
+
 #include <stdio.h>
+#include <sys/time.h>
 
 implementActionCallback(FrameEditor)
+declareIOCallback(FrameEditor)
+implementIOCallback(FrameEditor)
+
+static double frame_clock() {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
 
 /*****************************************************************************/
 
@@ -101,9 +117,20 @@ FrameEditor::FrameEditor(boolean initflag, OverlayKit* ok)
   _texteditor = nil;
   _autonewframe = false;
   _autonewframe_tts = nil;
+  _framecache = new FrameCache;
+  _playtimer = new IOCallback(FrameEditor)(this, &FrameEditor::PlayTick);
+  _playing = _playloop = false;
+  _playdelay = 0;
+  _playindex = 0;
+  _playgen = 0;
+  _playcount = 0;
+  _playstart = _playstop = 0.0;
 }
 
 FrameEditor::~FrameEditor() {
+  Dispatcher::instance().stopTimer(_playtimer);
+  delete _playtimer;
+  delete _framecache;
   delete _curr_others;
   delete _prev_others;
 }
@@ -114,6 +141,14 @@ void FrameEditor::Init (OverlayComp* comp, const char* name) {
   _texteditor = nil;
   _autonewframe = false;
   _autonewframe_tts = nil;
+  _framecache = new FrameCache;
+  _playtimer = new IOCallback(FrameEditor)(this, &FrameEditor::PlayTick);
+  _playing = _playloop = false;
+  _playdelay = 0;
+  _playindex = 0;
+  _playgen = 0;
+  _playcount = 0;
+  _playstart = _playstop = 0.0;
   if (!comp) comp = new FrameIdrawComp;
   _terp = new ComTerpServ();
   ((OverlayUnidraw*)unidraw)->comterp(_terp);
@@ -141,6 +176,9 @@ void FrameEditor::InitCommands() {
     sprintf(buffer, "timeexpr(\"moveframe(1)\" :sec %d)", secs);
     _terp->run(buffer);
   }
+  const char* framecache_str = catalog->GetAttribute("framecache");
+  if (framecache_str && _framecache) 
+    _framecache->MaxBytes((unsigned long)atoi(framecache_str)*1024*1024);
 }
 
 void FrameEditor::InitFrame() {
@@ -172,6 +210,16 @@ void FrameEditor::InitFrame() {
 }
 
 void FrameEditor::Update() {
+  if (_framecache && !_playing) {
+    /* whatever changed, it changed in the current frame, or in every */
+    /* frame if the current one is the background */
+    FrameIdrawView* views = (FrameIdrawView*)GetViewer()->GetGraphicView();
+    if (views->FrameGeneration() != _playgen || _currframe == views->GetFrame(0)) {
+      _framecache->Clear();
+      _playgen = views->FrameGeneration();
+    } else if (_currframe)
+      _framecache->Invalidate(_currframe);
+  }
   ComEditor::Update();
 }
 
@@ -196,11 +244,7 @@ OverlaysView* FrameEditor::GetFrame(int index) {
     return _currframe;
   else if (_frameliststate && index<_frameliststate->framenumber()) {
     FrameIdrawView* views = (FrameIdrawView*)GetViewer()->GetGraphicView();
-    Iterator i;
-    int count = 0;
-    views->First(i);
-    while (count++<index && !views->Done(i)) views->Next(i);
-    return (OverlaysView*)views->GetView(i);
+    return views->GetFrame(index);
   } else
     return nil;
 }
@@ -208,6 +252,7 @@ OverlaysView* FrameEditor::GetFrame(int index) {
 void FrameEditor::AddCommands(ComTerp* comterp) { 
   ComEditor::AddCommands(comterp);
   comterp->add_command("moveframe", new MoveFrameFunc(comterp, this));
+  comterp->add_command("playframes", new PlayFramesFunc(comterp, this));
   comterp->add_command("createframe", new CreateFrameFunc(comterp, this));
   comterp->add_command("autoframe", new AutoNewFrameFunc(comterp, this));
   comterp->add_command("numframes", new NumFramesFunc(comterp, this));
@@ -262,3 +307,105 @@ void FrameEditor::OtherFrames(int* other_frames, int num_other_frames) {
 
   
   
+
+boolean FrameEditor::ShowFrame(int index) {
+  Viewer* viewer = GetViewer();
+  FrameIdrawView* views = (FrameIdrawView*)viewer->GetGraphicView();
+  if (views->FrameGeneration() != _playgen) {
+    _framecache->Clear();
+    _playgen = views->FrameGeneration();
+  }
+  FrameView* frame = views->GetFrame(index);
+  if (!frame) return false;
+
+  Canvas* canvas = viewer->GetCanvas();
+  Transformer* t = viewer->GetGraphic()->GetTransformer();
+  if (!_framecache->Blit(frame, canvas, t)) {
+    /* the window may hold a blitted frame the views know nothing about, */
+    /* so redraw all of it before caching the result */
+    Damage* damage = viewer->GetDamage();
+    damage->Incur(0, 0, canvas->Width()-1, canvas->Height()-1);
+    if (frame != _currframe) {
+      SetFrame(frame);
+      UpdateFrame(false);
+    }
+    viewer->Update();
+    _framecache->Store(frame, canvas, t);
+  }
+  _playindex = index;
+  _playcount++;
+  if (framenumstate()) framenumstate()->framenumber(index);
+  return true;
+}
+
+void FrameEditor::Play(float fps, boolean loop) {
+  FrameIdrawView* views = (FrameIdrawView*)GetViewer()->GetGraphicView();
+  if (fps <= 0.0 || views->NumSubViews() < 2) return;
+  if (_playing) Dispatcher::instance().stopTimer(_playtimer);
+  _playdelay = long(1000000 / fps);
+  _playloop = loop;
+  _playindex = Math::max(views->FrameIndex(_currframe), 0);
+  _playcount = 0;
+  _playstart = _playstop = frame_clock();
+  _playing = true;
+  Dispatcher::instance().startTimer(0, _playdelay, _playtimer);
+}
+
+void FrameEditor::Stop() {
+  if (!_playing) return;
+  Dispatcher::instance().stopTimer(_playtimer);
+  _playing = false;
+  SyncFrame();
+}
+
+void FrameEditor::SyncFrame() {
+  FrameIdrawView* views = (FrameIdrawView*)GetViewer()->GetGraphicView();
+  FrameView* frame = views->GetFrame(_playindex);
+  if (frame && frame != _currframe) {
+    Damage* damage = GetViewer()->GetDamage();
+    if (_currframe) damage->Incur(_currframe->GetGraphic());
+    SetFrame(frame);
+    damage->Incur(frame->GetGraphic());
+    UpdateFrame(true);
+    GetViewer()->Update();
+  }
+}
+
+void FrameEditor::PlayTick(long, long) {
+  FrameIdrawView* views = (FrameIdrawView*)GetViewer()->GetGraphicView();
+  int index = _playindex + 1;
+  if (index >= views->NumSubViews()) {
+    if (!_playloop) {
+      Stop();
+      return;
+    }
+    index = 1;
+  }
+  if (!ShowFrame(index)) {
+    Stop();
+    return;
+  }
+  _playstop = frame_clock();
+  Dispatcher::instance().startTimer(0, _playdelay, _playtimer);
+}
+
+float FrameEditor::PlayRate() {
+  double secs = (_playing ? frame_clock() : _playstop) - _playstart;
+  return secs > 0.0 ? float(_playcount / secs) : 0.0;
+}
+
+float FrameEditor::PlayThrough() {
+  FrameIdrawView* views = (FrameIdrawView*)GetViewer()->GetGraphicView();
+  int nsubviews = views->NumSubViews();
+  if (_playing || nsubviews < 2) return 0.0;
+  _playindex = Math::max(views->FrameIndex(_currframe), 0);
+  _playcount = 0;
+  _playstart = frame_clock();
+  _playing = true;
+  for (int i = 1; i < nsubviews; i++) 
+    ShowFrame(i);
+  _playing = false;
+  _playstop = frame_clock();
+  SyncFrame();
+  return PlayRate();
+}
@@ -29,6 +29,9 @@
 
 #include <Unidraw/iterator.h>
 
+#include <Dispatch/iocallback.h>
+
+class FrameCache;
 class FrameNumberState;
 class FrameListState;
 class FrameView;
@@ -90,6 +93,31 @@ public:
     int NumFrames();
     // number of frames not counting background frame
 
+    FrameCache* framecache() { return _framecache; }
+    // return cache of pre-rendered frames used for flipbook playback.
+
+    void Play(float fps, boolean loop = true);
+    // start timer-driven playback from the current frame, streaming 
+    // pre-rendered frames from the frame cache where possible.
+    void Stop();
+    // stop playback, making the last frame shown the current frame.
+    boolean Playing() { return _playing; }
+    // true while playback is running.
+    float PlayRate();
+    // frames per second achieved by the current or last playback.
+    float PlayThrough();
+    // show every frame in turn as fast as possible and return the 
+    // frames per second achieved.
+
+protected:
+    boolean ShowFrame(int index);
+    // display frame by index during playback, from the frame cache if
+    // possible, otherwise by redrawing it and caching the result.
+    void PlayTick(long, long);
+    // timer callback for playback.
+    void SyncFrame();
+    // make the last frame shown during playback the current frame.
+
 protected:
     FrameView* _currframe;
     FrameView* _prevframe;
@@ -100,6 +128,16 @@ protected:
     int _num_curr_others;
     int _num_prev_others;
     boolean _autonewframe;
+    FrameCache* _framecache;
+    IOHandler* _playtimer;
+    boolean _playing;
+    boolean _playloop;
+    long _playdelay;
+    int _playindex;
+    unsigned int _playgen;
+    int _playcount;
+    double _playstart;
+    double _playstop;
 public:
     TelltaleState* _autonewframe_tts;
 
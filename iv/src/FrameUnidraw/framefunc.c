@@ -55,9 +55,7 @@ void MoveFrameFunc::execute() {
     int deltaframes = 0;
     if (absflag.is_true()) {
       FramesView* fv = (FramesView*)GetEditor()->GetViewer()->GetGraphicView();
-      Iterator it;
-      fv->SetView(((FrameEditor*)GetEditor())->GetFrame(), it);
-      int currframe = fv->Index(it);
+      int currframe = fv->FrameIndex((FrameView*)((FrameEditor*)GetEditor())->GetFrame());
       deltaframes = deltav.int_val() - currframe;
     }
     else
@@ -72,6 +70,40 @@ void MoveFrameFunc::execute() {
 
 /*****************************************************************************/
 
+PlayFramesFunc::PlayFramesFunc(ComTerp* comterp, Editor* ed) : UnidrawFunc(comterp, ed) {
+}
+
+void PlayFramesFunc::execute() {
+  ComValue fpsv(stack_arg(0));
+  static int once_symid = symbol_add("once");
+  ComValue oncev(stack_key(once_symid));
+  static int stop_symid = symbol_add("stop");
+  ComValue stopv(stack_key(stop_symid));
+  static int bench_symid = symbol_add("bench");
+  ComValue benchv(stack_key(bench_symid));
+  reset_stack();
+
+  FrameEditor* ed = (FrameEditor*)GetEditor();
+  if (!ed) return;
+
+  if (stopv.is_true()) {
+    ed->Stop();
+    ComValue retval(ed->PlayRate());
+    push_stack(retval);
+  } else if (benchv.is_true()) {
+    AttributeValueList* avl = new AttributeValueList();
+    avl->Append(new AttributeValue(ed->PlayThrough()));
+    avl->Append(new AttributeValue(ed->PlayThrough()));
+    ComValue retval(avl);
+    push_stack(retval);
+  } else {
+    ed->Play(fpsv.is_num() ? fpsv.float_val() : 10.0, oncev.is_false());
+    push_stack(ed->Playing() ? ComValue::trueval() : ComValue::falseval());
+  }
+}
+
+/*****************************************************************************/
+
 CreateFrameFunc::CreateFrameFunc(ComTerp* comterp, Editor* ed) : UnidrawFunc(comterp, ed) {
 }
 
@@ -36,6 +36,18 @@ public:
 	return "%s([num] :abs) -- move frame by num or to num if :abs"; }
 };
 
+//: interpreter command for flipbook playback.
+// playframes([fps] :once :stop :bench) -- play frames on a timer from the 
+// frame cache, or stop and return frames/sec, or time two passes through 
+// every frame and return frames/sec for each
+class PlayFramesFunc : public UnidrawFunc {
+public:
+    PlayFramesFunc(ComTerp*,Editor*);
+    virtual void execute();
+    virtual const char* docstring() { 
+	return "%s([fps] :once :stop :bench) -- play frames at fps (default 10), stop and return frames/sec, or time two passes through every frame"; }
+};
+
 //: interpreter command to create new frame.
 // createframe(:before) -- create and move to new frame
 class CreateFrameFunc : public UnidrawFunc {
@@ -41,7 +41,10 @@ boolean FrameOverlaysView::IsA(ClassId id) {
 
 /*****************************************************************************/
 
-FrameView::FrameView(FrameComp* comp) : OverlaysView(comp) {}
+FrameView::FrameView(FrameComp* comp) : OverlaysView(comp) {
+    _frameindex = -1;
+    _frameowner = nil;
+}
 
 ClassId FrameView::GetClassId() { return FRAME_VIEW; }
 
@@ -52,7 +55,16 @@ boolean FrameView::IsA(ClassId id) {
 /*****************************************************************************/
 
 
-FramesView::FramesView(FramesComp* comp) : FrameView(comp) {}
+FramesView::FramesView(FramesComp* comp) : FrameView(comp) {
+    _frames = nil;
+    _nframes = 0;
+    _frames_valid = false;
+    _framegen = 0;
+}
+
+FramesView::~FramesView() {
+    delete [] _frames;
+}
 
 ClassId FramesView::GetClassId() { return FRAMES_VIEW; }
 
@@ -63,27 +75,19 @@ boolean FramesView::IsA(ClassId id) {
 void FramesView::UpdateFrame(FrameView* curr, FrameView* prev,
 			     int* curr_others, int num_curr_others,
 			     int* prev_others, int num_prev_others) {
-  Iterator i;
-  First(i);
-  FrameView* background = (FrameView*)GetView(i);
+  FrameView* background = GetFrame(0);
   
   if (curr != prev) {
     if (prev) {		
       if (prev != background) prev->Hide();
       prev->Desensitize();
       if (prev_others) {
+	int previndex = FrameIndex(prev);
 	for (int np=0; np<num_prev_others; np++) {
-	  SetView(prev, i);
-	  if (prev_others[np]>0) 
-	    for (int ii=0; ii<prev_others[np]; ii++) Next(i);
-	  else 
-	    for (int ii=0; ii>prev_others[np]; ii--) Prev(i);
-	  if (!Done(i)) {
-	    FrameView* frame = (FrameView*)GetView(i);
-	    if (frame != background) {
-	      frame->Hide();
-	      frame->Sensitize();
-	    }
+	  FrameView* frame = GetFrame(previndex+prev_others[np]);
+	  if (frame && frame != background) {
+	    frame->Hide();
+	    frame->Sensitize();
 	  }
 	}
       }
@@ -92,18 +96,12 @@ void FramesView::UpdateFrame(FrameView* curr, FrameView* prev,
       if (curr != background) curr->Show();
       curr->Sensitize();
       if (curr_others) {
+	int currindex = FrameIndex(curr);
 	for (int np=0; np<num_curr_others; np++) {
-	  SetView(curr, i);
-	  if (curr_others[np]>0) 
-	    for (int ii=0; ii<curr_others[np]; ii++) Next(i);
-	  else 
-	    for (int ii=0; ii>curr_others[np]; ii--) Prev(i);
-	  if (!Done(i)) {
-	    FrameView* frame = (FrameView*)GetView(i);
-	    if (frame != background) {
-	      frame->Show();
-	      frame->Desensitize();
-	    }
+	  FrameView* frame = GetFrame(currindex+curr_others[np]);
+	  if (frame && frame != background) {
+	    frame->Show();
+	    frame->Desensitize();
 	  }
 	}
       }
@@ -111,6 +109,71 @@ void FramesView::UpdateFrame(FrameView* curr, FrameView* prev,
   }
 }
 
+FrameView* FramesView::GetFrame(int index) {
+    if (!_frames_valid) BuildFrames();
+    return index >= 0 && index < _nframes ? _frames[index] : nil;
+}
+
+int FramesView::FrameIndex(FrameView* frame) {
+    if (!_frames_valid) BuildFrames();
+    if (frame == nil || frame->_frameowner != this) return -1;
+    int i = frame->_frameindex;
+    return i >= 0 && i < _nframes && _frames[i] == frame ? i : -1;
+}
+
+int FramesView::NumSubViews() {
+    if (!_frames_valid) BuildFrames();
+    return _nframes;
+}
+
+void FramesView::BuildFrames() {
+    Iterator i;
+    int count = 0;
+    for (First(i); !Done(i); Next(i)) count++;
+    delete [] _frames;
+    _frames = new FrameView*[count > 0 ? count : 1];
+    _nframes = 0;
+    for (First(i); !Done(i); Next(i)) {
+        FrameView* frame = (FrameView*)GetView(i);
+        if (frame->IsA(FRAME_VIEW)) {
+            frame->_frameindex = _nframes;
+            frame->_frameowner = this;
+        }
+        _frames[_nframes++] = frame;
+    }
+    _frames_valid = true;
+}
+
+void FramesView::InvalidateFrames() {
+    _frames_valid = false;
+    _framegen++;
+}
+
+void FramesView::Add (GraphicView* view) {
+    FrameView::Add(view);
+    InvalidateFrames();
+}
+
+void FramesView::Append (GraphicView* view) {
+    FrameView::Append(view);
+    InvalidateFrames();
+}
+
+void FramesView::InsertBefore (Iterator i, GraphicView* view) {
+    FrameView::InsertBefore(i, view);
+    InvalidateFrames();
+}
+
+void FramesView::Remove (Iterator& i) {
+    FrameView::Remove(i);
+    InvalidateFrames();
+}
+
+void FramesView::DeleteView (Iterator& i) {
+    FrameView::DeleteView(i);
+    InvalidateFrames();
+}
+
 /*****************************************************************************/
 
 FrameIdrawView::FrameIdrawView(FrameIdrawComp* comp) : FramesView(comp) {}
@@ -29,6 +29,7 @@
 class FrameComp;
 class FramesComp;
 class FrameIdrawComp;
+class FramesView;
 
 //: graphical view of FrameOverlaysComp.
 class FrameOverlaysView : public OverlaysView {
@@ -48,13 +49,18 @@ public:
     virtual boolean IsA(ClassId);
 
 protected:
+    int _frameindex;
+    FramesView* _frameowner;
+    // position in the frame table of the FramesView that last indexed it.
 
+    friend class FramesView;
 };
 
 //: graphical view of FramesComp.
 class FramesView : public FrameView {
 public:
     FramesView(FramesComp* = nil);
+    virtual ~FramesView();
 
     virtual ClassId GetClassId();
     virtual boolean IsA(ClassId);
@@ -62,6 +68,32 @@ public:
     void UpdateFrame(FrameView* curr, FrameView* prev,
 		     int* curr_others, int num_curr_others,
 		     int* prev_others, int num_prev_others);
+
+    FrameView* GetFrame(int index);
+    // return frame by index (0 is the background frame) in constant time.
+    int FrameIndex(FrameView*);
+    // return index of frame in constant time, or -1 if not a sub-view.
+    int NumSubViews();
+    // number of sub-views, including the background frame.
+    unsigned int FrameGeneration() { return _framegen; }
+    // counter incremented whenever frames are added, removed, or reordered.
+
+protected:
+    virtual void Add(GraphicView*);
+    virtual void Append(GraphicView*);
+    virtual void InsertBefore(Iterator, GraphicView*);
+    virtual void Remove(Iterator&);
+    virtual void DeleteView(Iterator&);
+
+    void InvalidateFrames();
+    // discard frame index table after a change to the list of sub-views.
+    void BuildFrames();
+    // rebuild frame index table from the list of sub-views.
+
+    FrameView** _frames;
+    int _nframes;
+    boolean _frames_valid;
+    unsigned int _framegen;
 };
 
 //: graphical view of FrameIdrawComp.
@@ -39,34 +39,300 @@
 
 static const char NEWLINE = '\012';
 
+/*
+ * LineNode - one line of the text in a treap ordered by position, each
+ * node holding the length of its line (with its newline) and the totals
+ * of its subtree, so that both the line number and the index of any
+ * position are found by walking down from the root.
+ */
+
+struct TextBuffer::LineNode {
+    LineNode* left;
+    LineNode* right;
+    int len;
+    int sum;
+    int count;
+    unsigned int priority;
+
+    static LineNode* New(int len);
+    static void Free(LineNode*);
+    static int Sum(LineNode* n) { return n == nil ? 0 : n->sum; }
+    static int Count(LineNode* n) { return n == nil ? 0 : n->count; }
+    void Update() {
+        sum = Sum(left) + len + Sum(right);
+        count = Count(left) + 1 + Count(right);
+    }
+
+    static void UpdateAll(LineNode*);
+    static LineNode* Build(const int* lens, int n);
+    static LineNode* Merge(LineNode*, LineNode*);
+    static void Split(LineNode*, int k, LineNode*& first, LineNode*& rest);
+
+    static int Offset(LineNode*, int k);
+    static int Length(LineNode*, int k);
+    static void Add(LineNode*, int k, int delta);
+    static int Find(LineNode*, int index, int& start);
+};
+
+TextBuffer::LineNode* TextBuffer::LineNode::New (int len) {
+    static unsigned int seed = 0x2545f491;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    LineNode* n = new LineNode;
+    n->left = n->right = nil;
+    n->len = n->sum = len;
+    n->count = 1;
+    n->priority = seed;
+    return n;
+}
+
+void TextBuffer::LineNode::Free (LineNode* n) {
+    if (n != nil) {
+        Free(n->left);
+        Free(n->right);
+        delete n;
+    }
+}
+
+void TextBuffer::LineNode::UpdateAll (LineNode* n) {
+    if (n != nil) {
+        UpdateAll(n->left);
+        UpdateAll(n->right);
+        n->Update();
+    }
+}
+
+/* build a treap of n lines in linear time, along its right spine */
+
+TextBuffer::LineNode* TextBuffer::LineNode::Build (const int* lens, int n) {
+    LineNode** spine = new LineNode*[n];
+    int top = 0;
+    for (int i = 0; i < n; ++i) {
+        LineNode* node = New(lens[i]);
+        LineNode* last = nil;
+        while (top > 0 && spine[top-1]->priority < node->priority) {
+            last = spine[--top];
+        }
+        node->left = last;
+        if (top > 0) {
+            spine[top-1]->right = node;
+        }
+        spine[top++] = node;
+    }
+    LineNode* root = (top > 0) ? spine[0] : nil;
+    delete [] spine;
+    UpdateAll(root);
+    return root;
+}
+
+TextBuffer::LineNode* TextBuffer::LineNode::Merge (LineNode* a, LineNode* b) {
+    if (a == nil) {
+        return b;
+    } else if (b == nil) {
+        return a;
+    } else if (a->priority > b->priority) {
+        a->right = Merge(a->right, b);
+        a->Update();
+        return a;
+    } else {
+        b->left = Merge(a, b->left);
+        b->Update();
+        return b;
+    }
+}
+
+/* split off the first k lines */
+
+void TextBuffer::LineNode::Split (
+    LineNode* n, int k, LineNode*& first, LineNode*& rest
+) {
+    if (n == nil) {
+        first = rest = nil;
+    } else if (k <= Count(n->left)) {
+        Split(n->left, k, first, n->left);
+        n->Update();
+        rest = n;
+    } else {
+        Split(n->right, k - Count(n->left) - 1, n->right, rest);
+        n->Update();
+        first = n;
+    }
+}
+
+/* index of the beginning of line k */
+
+int TextBuffer::LineNode::Offset (LineNode* n, int k) {
+    int offset = 0;
+    while (n != nil) {
+        if (k <= Count(n->left)) {
+            n = n->left;
+        } else {
+            offset += Sum(n->left) + n->len;
+            k -= Count(n->left) + 1;
+            n = n->right;
+        }
+    }
+    return offset;
+}
+
+int TextBuffer::LineNode::Length (LineNode* n, int k) {
+    while (n != nil) {
+        int l = Count(n->left);
+        if (k < l) {
+            n = n->left;
+        } else if (k == l) {
+            return n->len;
+        } else {
+            k -= l + 1;
+            n = n->right;
+        }
+    }
+    return 0;
+}
+
+/* lengthen line k by delta */
+
+void TextBuffer::LineNode::Add (LineNode* n, int k, int delta) {
+    while (n != nil) {
+        int l = Count(n->left);
+        n->sum += delta;
+        if (k < l) {
+            n = n->left;
+        } else if (k == l) {
+            n->len += delta;
+            return;
+        } else {
+            k -= l + 1;
+            n = n->right;
+        }
+    }
+}
+
+/* number and starting index of the line containing index */
+
+int TextBuffer::LineNode::Find (LineNode* n, int index, int& start) {
+    int k = 0;
+    start = 0;
+    int laststart = 0;
+    int lastk = 0;
+    while (n != nil) {
+        int before = start + Sum(n->left);
+        if (index < before) {
+            n = n->left;
+        } else if (index < before + n->len) {
+            start = before;
+            return k + Count(n->left);
+        } else {
+            laststart = before;
+            lastk = k + Count(n->left);
+            start = before + n->len;
+            k += Count(n->left) + 1;
+            n = n->right;
+        }
+    }
+    /* the end of the text is on the last line */
+    start = laststart;
+    return lastk;
+}
+
+/*
+ * line_lengths returns the lengths of the lines of s[0..count), with
+ * 'first' added to the first and 'last' to the last, as a new array.
+ */
+
+static int* line_lengths (
+    const char* s, int count, int first, int last, int& nlines
+) {
+    int n = 1;
+    const char* end = s + count;
+    const char* t;
+    for (t = s; t < end && (t = (char*)memchr(t, NEWLINE, end - t)) != nil; ++t) {
+        ++n;
+    }
+    int* lens = new int[n];
+    int i = 0;
+    const char* bol = s;
+    for (t = s; t < end && (t = (char*)memchr(t, NEWLINE, end - t)) != nil; ++t) {
+        lens[i++] = t + 1 - bol;
+        bol = t + 1;
+    }
+    lens[i] = end - bol;
+    lens[0] += first;
+    lens[n-1] += last;
+    nlines = n;
+    return lens;
+}
+
 TextBuffer::TextBuffer (char* t, int l, int s) {
     text = t;
     length = l;
     size = s;
+    gap = length;
     Memory::zero(text + length, size - length);
-    linecount = 1 + LinesBetween(0, length);
-    lastline = 0;
-    lastindex = 0;
+    int* lens = line_lengths(text, length, 0, 0, linecount);
+    lines = LineNode::Build(lens, linecount);
+    delete [] lens;
 }
 
 TextBuffer::~TextBuffer() {
     /* side effect restores buffer to normal form */
     Text();
+    LineNode::Free(lines);
 }
 
 inline int limit (int l, int x, int h) {
     return (x<l) ? l : (x>h) ? h : x;
 }
 
+/*
+ * MoveGap moves the free space of the buffer to just before 'index',
+ * copying only the text in between.
+ */
+
+void TextBuffer::MoveGap (int index) {
+    int gapsize = size - length;
+    if (index < gap) {
+        Memory::copy(text + index, text + index + gapsize, gap - index);
+    } else if (index > gap) {
+        Memory::copy(text + gap + gapsize, text + gap, index - gap);
+    }
+    gap = index;
+}
+
+const char* TextBuffer::Text () {
+    if (gap != length) {
+        MoveGap(length);
+    }
+    if (length < size) {
+        text[length] = '\0';
+    }
+    return text;
+}
+
+const char* TextBuffer::Text (int i) {
+    i = limit(0, i, length);
+    return Text(i, limit(0, EndOfLine(i) + 1, length));
+}
+
+const char* TextBuffer::Text (int i1, int i2) {
+    i1 = limit(0, i1, length);
+    i2 = limit(i1, i2, length);
+    if (gap > i1 && gap < i2) {
+        MoveGap((gap - i1 < i2 - gap) ? i1 : i2);
+    }
+    return text + ((gap <= i1) ? i1 + size - length : i1);
+}
+
 int TextBuffer::Search (Regexp* regexp, int index, int range, int stop) {
     int s = limit(0, stop, length);
     int i = limit(0, index, s);
-    return regexp->Search(text, s, i, range);
+    return regexp->Search(Text(), s, i, range);
 }
 
 int TextBuffer::BackwardSearch (Regexp* regexp, int index) {
     int i = limit(0, index, length);
-    int r = regexp->Search(text, length, i, -i);
+    int r = regexp->Search(Text(), length, i, -i);
     if (r >= 0) {
         return regexp->BeginningOfMatch();
     } else {
@@ -76,7 +342,7 @@ int TextBuffer::BackwardSearch (Regexp* regexp, int index) {
 
 int TextBuffer::ForwardSearch (Regexp* regexp, int index) {
     int i = limit(0, index, length);
-    int r = regexp->Search(text, length, i, length - i);
+    int r = regexp->Search(Text(), length, i, length - i);
     if (r >= 0) {
         return regexp->EndOfMatch();
     } else {
@@ -87,13 +353,14 @@ int TextBuffer::ForwardSearch (Regexp* regexp, int index) {
 int TextBuffer::Match (Regexp* regexp, int index, int stop) {
     int s = limit(0, stop, length);
     int i = limit(0, index, s);
-    return regexp->Match(text, length, i);
+    return regexp->Match(Text(), length, i);
 }
 
 boolean TextBuffer::BackwardMatch (Regexp* regexp, int index) {
     int i = limit(0, index, length);
+    const char* t = Text();
     for (int j = i; j >= 0; --j) {
-        if (regexp->Match(text, length, j) == i - j) {
+        if (regexp->Match(t, length, j) == i - j) {
             return true;
         }
     }
@@ -102,7 +369,7 @@ boolean TextBuffer::BackwardMatch (Regexp* regexp, int index) {
 
 boolean TextBuffer::ForwardMatch (Regexp* regexp, int index) {
     int i = limit(0, index, length);
-    return regexp->Match(text, length, i) >= 0;
+    return regexp->Match(Text(), length, i) >= 0;
 }
 
 int TextBuffer::Insert (int index, const char* string, int count) {
@@ -112,16 +379,38 @@ int TextBuffer::Insert (int index, const char* string, int count) {
         return Insert(index + count, string, -count);
     } else {
         count = Math::min(count, size - length);
-        Memory::copy(text + index, text + index + count, length - index);
-        Memory::copy(string, text + index, count);
+        if (count == 0) {
+            return 0;
+        }
+        int start;
+        int line = LineNode::Find(lines, index, start);
+        int oldlen = LineNode::Length(lines, line);
+
+        MoveGap(index);
+        Memory::copy(string, text + gap, count);
+        gap += count;
         length += count;
-        int newlines = (count == 1)
-            ? (*string == NEWLINE)
-            : LinesBetween(index, index + count);
-        linecount += newlines;
-        if (lastindex > index) {
-            lastindex += count;
-            lastline += newlines;
+
+        if (count == 1 && *string != NEWLINE) {
+            LineNode::Add(lines, line, 1);
+        } else {
+            /* line splits around the new text's newlines */
+            int nlines;
+            int* lens = line_lengths(
+                string, count, index - start, start + oldlen - index, nlines
+            );
+            LineNode::Add(lines, line, lens[0] - oldlen);
+            if (nlines > 1) {
+                LineNode* first;
+                LineNode* rest;
+                LineNode::Split(lines, line + 1, first, rest);
+                lines = LineNode::Merge(
+                    LineNode::Merge(first, LineNode::Build(lens+1, nlines-1)),
+                    rest
+                );
+                linecount += nlines - 1;
+            }
+            delete [] lens;
         }
         return count;
     }
@@ -134,21 +423,34 @@ int TextBuffer::Delete (int index, int count) {
         return -Delete(index + count, -count);
     } else {
         count = Math::min(count, length - index);
-        int oldlines = (count == 1)
-            ? (text[index] == NEWLINE)
-            : LinesBetween(index, index + count);
-        if (lastindex > index + count) {
-            lastindex -= count;
-            lastline -= oldlines;
-        } else if (lastindex >= index) {
-            (void)LineNumber(index);
+        if (count == 0) {
+            return 0;
+        }
+        int start1, start2;
+        int line1 = LineNode::Find(lines, index, start1);
+        int line2 = LineNode::Find(lines, index + count, start2);
+        int end2 = start2 + LineNode::Length(lines, line2);
+
+        if (line1 == line2) {
+            LineNode::Add(lines, line1, -count);
+        } else {
+            /* lines line1 through line2 join into one */
+            LineNode* first;
+            LineNode* middle;
+            LineNode* rest;
+            LineNode::Split(lines, line1 + 1, first, rest);
+            LineNode::Split(rest, line2 - line1, middle, rest);
+            LineNode::Free(middle);
+            lines = LineNode::Merge(first, rest);
+            LineNode::Add(
+                lines, line1,
+                (end2 - count - start1) - LineNode::Length(lines, line1)
+            );
+            linecount -= line2 - line1;
         }
-        Memory::copy(
-	    text + index + count, text + index, length - (index+count)
-	);
+
+        MoveGap(index);
         length -= count;
-        Memory::zero(text + length, count);
-        linecount -= oldlines;
         return count;
     }
 }
@@ -160,7 +462,7 @@ int TextBuffer::Copy (int index, char* buffer, int count) {
         return Copy(index + count, buffer, -count);
     } else {
         count = Math::min(count, length - index);
-        Memory::copy(text + index, buffer, count);
+        Memory::copy(Text(index, index + count), buffer, count);
         return count;
     }
 }
@@ -176,49 +478,24 @@ int TextBuffer::Width () {
 }
 
 int TextBuffer::LineIndex(int line) {
-    int l = (line<0) ? 0 : (line>=linecount) ? linecount-1 : line;
-    while (lastline > l) {
-        --lastline;
-        lastindex = BeginningOfLine(EndOfPreviousLine(lastindex));
-    }
-    while (lastline < l) {
-        ++lastline;
-        lastindex = BeginningOfNextLine(lastindex);
-    }
     if (line >= linecount) {
         return EndOfText();
     } else {
-        return lastindex;
+        return LineNode::Offset(lines, (line<0) ? 0 : line);
     }
 }
 
 int TextBuffer::LinesBetween (int index1, int index2) {
     if (index1 == index2) {
         return 0;
-    } else if (index1 > index2) {
-        return -LinesBetween(index2, index1);
     } else {
-        const char* start = Text(index1);
-        const char* finish = Text(index2);
-        const char* tt;
-        int l = 0;
-	while (start < finish) {
-	    tt = (char*)memchr(start, NEWLINE, finish - start);
-	    if (tt == nil) {
-		break;
-	    }
-            start = tt + 1;
-            ++l;
-        }
-        return l;
+        return LineNumber(index2) - LineNumber(index1);
     }
 }
 
 int TextBuffer::LineNumber (int index) {
-    int l = LinesBetween(lastindex, index);
-    lastline += l;
-    lastindex = BeginningOfLine(index);
-    return lastline;
+    int start;
+    return LineNode::Find(lines, limit(0, index, length), start);
 }
 
 int TextBuffer::LineOffset (int index) {
@@ -226,94 +503,84 @@ int TextBuffer::LineOffset (int index) {
 }
 
 boolean TextBuffer::IsBeginningOfLine (int index) {
-    const char* t = Text(index);
-    return t <= text || *(t-1) == NEWLINE;
+    int i = limit(0, index, length);
+    return i == 0 || Char(i-1) == NEWLINE;
 }
 
 int TextBuffer::BeginningOfLine (int index) {
-    const char* t = Text(index);
-    while (t > text && *(t-1) != NEWLINE) {
-        --t;
-    }
-    return t - text;
+    int start;
+    (void)LineNode::Find(lines, limit(0, index, length), start);
+    return start;
 }
 
 int TextBuffer::BeginningOfNextLine (int index) {
-    const char* t = Text(index);
-    const char* e = text + length;
-    t = (char*)memchr(t, NEWLINE, e - t);
-    if (t == nil) {
+    int start;
+    int line = LineNode::Find(lines, limit(0, index, length), start);
+    if (line == linecount - 1) {
         return length;
     } else {
-        return t - text + 1;
+        return start + LineNode::Length(lines, line);
     }
 }
 
 boolean TextBuffer::IsEndOfLine (int index) {
-    const char* t = Text(index);
-    return t >= text + length || *t == NEWLINE;
+    int i = limit(0, index, length);
+    return i >= length || Char(i) == NEWLINE;
 }
 
 int TextBuffer::EndOfLine (int index) {
-    const char* t = Text(index);
-    const char* e = text + length;
-    if (t == e) {
-	return length;
-    }
-    t = (char*)memchr(t, NEWLINE, e - t);
-    if (t == nil) {
+    int start;
+    int line = LineNode::Find(lines, limit(0, index, length), start);
+    if (line == linecount - 1) {
         return length;
     } else {
-        return t - text;
+        return start + LineNode::Length(lines, line) - 1;
     }
 }
 
 int TextBuffer::EndOfPreviousLine (int index) {
-    const char* t = Text(index-1);
-    while (t > text && *t != NEWLINE) {
-        --t;
-    }
-    return t - text;
+    int i = limit(0, index-1, length);
+    return Math::max(BeginningOfLine(i+1) - 1, 0);
 }
 
 boolean TextBuffer::IsBeginningOfWord (int index) {
-    const char* t = Text(index);
-    return t <= text || !isalnum(*(t-1)) && isalnum(*t);
+    int i = limit(0, index, length);
+    return i == 0 || !isalnum(Char(i-1)) && isalnum(Char(i));
 }
 
 int TextBuffer::BeginningOfWord (int index) {
-    const char* t = Text(index);
-    while (t > text && !(!isalnum(*(t-1)) && isalnum(*t))) {
-        --t;
+    int i = limit(0, index, length);
+    while (i > 0 && !(!isalnum(Char(i-1)) && isalnum(Char(i)))) {
+        --i;
     }
-    return t - text;
+    return i;
 }
 
 int TextBuffer::BeginningOfNextWord (int index) {
-    const char* t = Text(index+1);
-    while (t < text+length && !(!isalnum(*(t-1)) && isalnum(*t))) {
-        ++t;
+    int i = limit(0, index+1, length);
+    while (i < length && !(!(i > 0 && isalnum(Char(i-1))) && isalnum(Char(i)))) {
+        ++i;
     }
-    return t - text;
+    return i;
 }
 
 boolean TextBuffer::IsEndOfWord (int index) {
-    const char* t = Text(index);
-    return t >= text+length || isalnum(*(t-1)) && !isalnum(*t);
+    int i = limit(0, index, length);
+    return i >= length || i > 0 && isalnum(Char(i-1)) && !isalnum(Char(i));
 }
 
 int TextBuffer::EndOfWord (int index) {
-    const char* t = Text(index);
-    while (t < text+length && !(isalnum(*(t-1)) && !isalnum(*t))) {
-        ++t;
+    int i = limit(0, index, length);
+    while (i < length && !(i > 0 && isalnum(Char(i-1)) && !isalnum(Char(i)))) {
+        ++i;
     }
-    return t - text;
+    return i;
 }
 
 int TextBuffer::EndOfPreviousWord (int index) {
-    const char* t = Text(index-1);
-    while (t > text && !(isalnum(*(t-1)) && !isalnum(*t))) {
-        --t;
+    int i = limit(0, index-1, length);
+    while (i > 0 && !(isalnum(Char(i-1)) && !isalnum(Char(i)))) {
+        --i;
     }
-    return t - text;
+    return i;
 }
@@ -70,7 +70,7 @@ int World::argc() const { return session_->argc(); }
 char** World::argv() const { return session_->argv(); }
 
 Style* World::style() const {
-    return display_->style();
+    return display_ != nil ? display_->style() : session_->style();
 }
 
 const char* World::property_value(const char* s) const {
@@ -175,7 +175,8 @@ World* World::current() {
 
 void World::make_current() {
     current_ = this;
-    ivpoint = double(display_->pwidth()) / display_->a_width();
+    ivpoint = display_ == nil
+	? 1.0 : double(display_->pwidth()) / display_->a_width();
     ivpoints = ivpoint;
     ivinch = 72.27 * ivpoint;
     ivinches = ivinch;
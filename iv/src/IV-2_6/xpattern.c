@@ -83,7 +83,10 @@ void Pattern::init(
 ) {
     rep_ = new PatternRep;
     rep_->display_ = Session::instance()->default_display();
-    if (pattern != nil && !is_solid((unsigned char*)pattern, width, height)) {
+    if (
+	pattern != nil && rep_->display_ != nil &&
+	!is_solid((unsigned char*)pattern, width, height)
+    ) {
 	DisplayRep* r = rep_->display_->rep();
         rep_->pixmap_ = XCreateBitmapFromData(
             r->display_, r->root_, pattern, width, height
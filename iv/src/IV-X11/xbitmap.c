@@ -31,6 +31,7 @@
 #include <InterViews/font.h>
 #include <InterViews/session.h>
 #include <IV-X11/xbitmap.h>
+#include <IV-X11/xcanvas.h>
 #include <IV-X11/xfont.h>
 #include <IV-X11/xdisplay.h>
 #include <IV-X11/Xlib.h>
@@ -192,6 +193,7 @@ Bitmap::Bitmap(const Bitmap& bm) {
 }
 
 Bitmap::~Bitmap() {
+    CanvasRep::forget_transformed(this);
     delete rep_;
 }
 
@@ -220,7 +222,13 @@ boolean Bitmap::peek(int x, int y) const {
     return pixel != 0;
 }
 
-void Bitmap::flush() const { rep()->flush(); }
+void Bitmap::flush() const {
+    BitmapRep* b = rep();
+    if (b->modified_) {
+        CanvasRep::forget_transformed(this);
+    }
+    b->flush();
+}
 
 /* class BitmapRep */
 
@@ -149,7 +149,9 @@ BrushRep* Brush::rep(Display* d) const {
     r->display_ = d;
     r->dash_list_ = impl_->dash_list;
     r->dash_count_ = impl_->dash_count;
-    r->width_ = d->to_pixels(impl_->width);
+    /* one pixel per point when there is no display (-nodisplay) */
+    r->width_ = (d == nil)
+	? PixelCoord(impl_->width + 0.5) : d->to_pixels(impl_->width);
     list.append(r);
     return r;
 }
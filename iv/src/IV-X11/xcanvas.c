@@ -43,6 +43,7 @@
 #include <IV-X11/xraster.h>
 #include <OS/math.h>
 #include <OS/list.h>
+#include <OS/table.h>
 #include <OS/table2.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -92,6 +93,7 @@ Canvas::Canvas() {
     c->text_reencode_ = false;
     c->clipping_ = XCreateRegion();
     c->empty_ = XCreateRegion();
+    c->repaired_ = XCreateRegion();
     c->transformers_ = new TransformerStack;
     c->clippers_ = new ClippingStack;
 
@@ -111,6 +113,8 @@ Canvas::Canvas() {
     c->damaged_ = false;
     c->on_damage_list_ = false;
     c->repairing_ = false;
+    c->damage_count_ = 0;
+    c->repaired_pixels_ = 0;
 
     c->status_ = unmapped;
 }
@@ -125,6 +129,7 @@ Canvas::~Canvas() {
     delete c->transformers_;
     XDestroyRegion(c->clipping_);
     XDestroyRegion(c->empty_);
+    XDestroyRegion(c->repaired_);
     delete c->clippers_;
     delete c;
     rep_ = nil;
@@ -676,23 +681,251 @@ void Canvas::character(
     }
 }
 
-declareTable2(TxBitmapTable,const Bitmap*,int,BitmapRep*)
-implementTable2(TxBitmapTable,const Bitmap*,int,BitmapRep*)
+/*
+ * Bitmaps and rasters drawn under a rotation or scale are resampled
+ * once and cached by source and transformation key.  The cache is
+ * bounded by the size of the resampled pixmaps, the least recently
+ * used being freed first, and copies of a source are discarded when
+ * it is modified or destroyed.  The copies of each source are also
+ * chained together, so discarding them does not walk the whole cache.
+ * A copy larger than the whole cache is never cached; it is freed by
+ * the caller once drawn.
+ */
+
+static const unsigned long tx_cache_limit = 8 * 1024 * 1024;
+
+class TxCacheEntry {
+public:
+    const void* source_;
+    int key_;
+    BitmapRep* bitmap_;
+    RasterRep* raster_;
+    unsigned long bytes_;
+    TxCacheEntry* prev_;
+    TxCacheEntry* next_;
+    TxCacheEntry* src_prev_;
+    TxCacheEntry* src_next_;
+};
+
+declareTable2(TxCacheTable,const void*,int,TxCacheEntry*)
+implementTable2(TxCacheTable,const void*,int,TxCacheEntry*)
+
+declareTable(TxSourceTable,const void*,TxCacheEntry*)
+implementTable(TxSourceTable,const void*,TxCacheEntry*)
+
+static TxCacheTable* _tx_cache;
+static TxSourceTable* _tx_sources;
+static TxCacheEntry* _tx_head;
+static TxCacheEntry* _tx_tail;
+static unsigned long _tx_bytes;
+
+static void tx_unlink(TxCacheEntry* e) {
+    if (e->prev_ != nil) {
+        e->prev_->next_ = e->next_;
+    } else {
+        _tx_head = e->next_;
+    }
+    if (e->next_ != nil) {
+        e->next_->prev_ = e->prev_;
+    } else {
+        _tx_tail = e->prev_;
+    }
+    e->prev_ = nil;
+    e->next_ = nil;
+}
+
+static void tx_push(TxCacheEntry* e) {
+    e->prev_ = nil;
+    e->next_ = _tx_head;
+    if (_tx_head != nil) {
+        _tx_head->prev_ = e;
+    }
+    _tx_head = e;
+    if (_tx_tail == nil) {
+        _tx_tail = e;
+    }
+}
+
+static void tx_release(BitmapRep* b, RasterRep* r) {
+    if (b != nil) {
+        delete b;
+    }
+    if (r != nil) {
+        XFreePixmap(r->display_->rep()->display_, r->pixmap_);
+        delete r;
+    }
+}
+
+static void tx_free(TxCacheEntry* e) {
+    tx_unlink(e);
+    _tx_cache->remove(e->source_, e->key_);
+    if (e->src_prev_ != nil) {
+        e->src_prev_->src_next_ = e->src_next_;
+    } else {
+        _tx_sources->remove(e->source_);
+        if (e->src_next_ != nil) {
+            _tx_sources->insert(e->source_, e->src_next_);
+        }
+    }
+    if (e->src_next_ != nil) {
+        e->src_next_->src_prev_ = e->src_prev_;
+    }
+    _tx_bytes -= e->bytes_;
+    tx_release(e->bitmap_, e->raster_);
+    delete e;
+}
+
+static TxCacheEntry* tx_find(const void* source, int key) {
+    TxCacheEntry* e;
+    if (_tx_cache == nil || !_tx_cache->find(e, source, key)) {
+        return nil;
+    }
+    if (e != _tx_head) {
+        tx_unlink(e);
+        tx_push(e);
+    }
+    return e;
+}
+
+/*
+ * Cache a transformed copy, returning false if it is too large to keep.
+ */
+
+static boolean tx_insert(
+    const void* source, int key, BitmapRep* b, RasterRep* r,
+    unsigned long bytes
+) {
+    if (bytes > tx_cache_limit) {
+        return false;
+    }
+    if (_tx_cache == nil) {
+        _tx_cache = new TxCacheTable(1024);
+        _tx_sources = new TxSourceTable(1024);
+    }
+    while (_tx_tail != nil && _tx_bytes + bytes > tx_cache_limit) {
+        tx_free(_tx_tail);
+    }
+    TxCacheEntry* e = new TxCacheEntry;
+    e->source_ = source;
+    e->key_ = key;
+    e->bitmap_ = b;
+    e->raster_ = r;
+    e->bytes_ = bytes;
+    e->src_prev_ = nil;
+    if (_tx_sources->find_and_remove(e->src_next_, source)) {
+        e->src_next_->src_prev_ = e;
+    } else {
+        e->src_next_ = nil;
+    }
+    _tx_sources->insert(source, e);
+    tx_push(e);
+    _tx_cache->insert(source, key, e);
+    _tx_bytes += bytes;
+    return true;
+}
+
+void CanvasRep::forget_transformed(const void* source) {
+    TxCacheEntry* e;
+    if (_tx_sources != nil && _tx_sources->find(e, source)) {
+        while (e != nil) {
+            TxCacheEntry* next = e->src_next_;
+            tx_free(e);
+            e = next;
+        }
+    }
+}
+
+static XImage* tx_image(
+    XDisplay* dpy, Visual* visual, int depth, int width, int height
+) {
+    XImage* image = XCreateImage(
+        dpy, visual, depth, ZPixmap, 0, nil, width, height, BitmapPad(dpy), 0
+    );
+    image->data = (char*)calloc(image->bytes_per_line * height, 1);
+    return image;
+}
+
+/*
+ * Resample the source into the (zeroed) destination image by walking the
+ * inverse transformation along each destination row.  Images whose pixels
+ * are whole bytes, and one-bit images whose bit and byte order agree, are
+ * read and written directly in their buffers; anything else goes through
+ * XGetPixel/XPutPixel.
+ */
+
+static void tx_resample(
+    XImage* source, int spwidth, int spheight,
+    XImage* dest, int width, int height,
+    const Transformer& v, int dx0, int dy0, int sx0, int sy0
+) {
+    int bpp = source->bits_per_pixel;
+    int nbytes = bpp >> 3;
+    boolean bytewise = (
+        bpp == dest->bits_per_pixel && (bpp & 7) == 0 &&
+        source->byte_order == dest->byte_order
+    );
+    boolean bitwise = (
+        bpp == 1 && dest->bits_per_pixel == 1 &&
+        source->byte_order == source->bitmap_bit_order &&
+        dest->byte_order == dest->bitmap_bit_order &&
+        source->bitmap_bit_order == dest->bitmap_bit_order
+    );
+    boolean msb = source->bitmap_bit_order == MSBFirst;
+    for (int dy = 0; dy < height; ++dy) {
+        Coord tx1, ty1, tx2, ty2;
+        v.inverse_transform(- dx0, dy - dy0, tx1, ty1);
+        v.inverse_transform(width - dx0, dy - dy0, tx2, ty2);
+        float delta_x = (tx2 - tx1) / width;
+        float delta_y = (ty2 - ty1) / width;
+        int drow = height - 1 - dy;
+        char* dline = dest->data + drow * dest->bytes_per_line;
+        int sx, sy;
+        for (int dx = 0; dx < width; ++dx) {
+            sx = int(tx1) + sx0;
+            sy = int(ty1) + sy0;
+            if (sx >= 0 && sx < spwidth && sy >= 0 && sy < spheight) {
+                int srow = spheight - 1 - sy;
+                char* sline = source->data + srow * source->bytes_per_line;
+                if (bytewise) {
+                    const char* sp = sline + sx * nbytes;
+                    char* dp = dline + dx * nbytes;
+                    for (int k = 0; k < nbytes; ++k) {
+                        dp[k] = sp[k];
+                    }
+                } else if (bitwise) {
+                    int sxo = sx + source->xoffset;
+                    int dxo = dx + dest->xoffset;
+                    int sbit = msb ? 0x80 >> (sxo & 7) : 1 << (sxo & 7);
+                    if (sline[sxo >> 3] & sbit) {
+                        dline[dxo >> 3] |= msb ? 0x80 >> (dxo & 7) : 1 << (dxo & 7);
+                    }
+                } else {
+                    XPutPixel(dest, dx, drow, XGetPixel(source, sx, srow));
+                }
+            }
+            tx1 = tx1 + delta_x;
+            ty1 = ty1 + delta_y;
+        }
+    }
+}
 
-static TxBitmapTable* _tx_bitmaps;
+/*
+ * Return the bitmap as drawn under tx, setting owned if the copy was
+ * not cached and must be released by the caller.
+ */
 
-static BitmapRep* tx_bitmap(const Bitmap* b, const Transformer& tx) {
+static BitmapRep* tx_bitmap(
+    const Bitmap* b, const Transformer& tx, boolean& owned
+) {
+    owned = false;
     int key = tx_key(tx, b->width(), b->height());
     if (key == 0) {
         return b->rep();
     } else {
-	if (_tx_bitmaps == nil) {
-	    _tx_bitmaps = new TxBitmapTable(1024);
-	}
-        BitmapRep* rep;
-        if (!_tx_bitmaps->find(rep, b, key)) {
+        TxCacheEntry* e = tx_find(b, key);
+        if (e == nil) {
 	    Display* d = b->rep()->display_;
-            rep = new BitmapRep;
+            BitmapRep* rep = new BitmapRep;
 
             Transformer v(tx);
 
@@ -722,53 +955,25 @@ static BitmapRep* tx_bitmap(const Bitmap* b, const Transformer& tx) {
                 height = 1;
             }
 
-	    XDisplay* dpy = d->rep()->display_;
+	    DisplayRep& dr = *d->rep();
+	    XDisplay* dpy = dr.display_;
             BitmapRep* srep = b->rep();
+            srep->fill();
 
-            XImage* source = XGetImage(
-                dpy, srep->pixmap_,
-                0, 0, srep->pwidth_, srep->pheight_, 0x01, ZPixmap
+            XImage* dest = tx_image(
+                dpy, dr.default_visual_->visual(), 1, width, height
             );
-
-            Pixmap map = XCreatePixmap(dpy, d->rep()->root_, width, height, 1);
-            GC xgc = XCreateGC(dpy, map, 0, nil);
-            XSetForeground(dpy, xgc, 0);
-            XFillRectangle(dpy, map, xgc, 0, 0, width, height);
-            XImage* dest = XGetImage(
-                dpy, map, 0, 0, width, height, 0x01, ZPixmap
+            tx_resample(
+                srep->image_, srep->pwidth_, srep->pheight_,
+                dest, width, height, v,
+                d->to_pixels(-xmin), d->to_pixels(-ymin),
+                d->to_pixels(b->left_bearing()), d->to_pixels(b->descent())
             );
 
-            int dx0 = d->to_pixels(-xmin);
-            int dy0 = d->to_pixels(-ymin);
-            int sx0 = d->to_pixels(b->left_bearing());
-            int sy0 = d->to_pixels(b->descent());
-            for (int dy = 0; dy < height; ++dy) {
-                Coord tx1, ty1, tx2, ty2;
-                v.inverse_transform(- dx0, dy - dy0, tx1, ty1);
-                v.inverse_transform(width - dx0, dy - dy0, tx2, ty2);
-                float delta_x = (tx2 - tx1) / width;
-                float delta_y = (ty2 - ty1) / width;
-                int sx, sy;
-                for (int dx = 0; dx < width; ++dx) {
-                    sx = int(tx1) + sx0;
-                    sy = int(ty1) + sy0;
-                    if (
-                        sx >= 0 && sx < srep->pwidth_
-                        && sy >= 0 && sy < srep->pheight_
-                    ) {
-                        XPutPixel(
-                            dest, dx, height - 1 - dy,
-                            XGetPixel(source, sx, srep->pheight_ - 1 - sy)
-                        );
-                    }
-                    tx1 = tx1 + delta_x;
-                    ty1 = ty1 + delta_y;
-                }
-            }
-
+            Pixmap map = XCreatePixmap(dpy, dr.root_, width, height, 1);
+            GC xgc = XCreateGC(dpy, map, 0, nil);
             XPutImage(dpy, map, xgc, dest, 0, 0, 0, 0, width, height);
             XFreeGC(dpy, xgc);
-            XDestroyImage(source);
             XDestroyImage(dest);
 
 	    rep->display_ = d;
@@ -781,9 +986,12 @@ static BitmapRep* tx_bitmap(const Bitmap* b, const Transformer& tx) {
             rep->right_ = xmax;
             rep->bottom_ = ymin;
             rep->top_ = ymax;
-            _tx_bitmaps->insert(b, key, rep);
+            owned = !tx_insert(
+                b, key, rep, nil, (unsigned long)((width + 7) >> 3) * height
+            );
+            return rep;
         }
-        return rep;
+        return e->bitmap_;
     }
 }
 
@@ -797,7 +1005,8 @@ void Canvas::stencil(
     XDrawable d = c.drawbuffer_;
     Transformer& m = c.matrix();
     mask->flush();
-    BitmapRep* info = tx_bitmap(mask, m);
+    boolean owned;
+    BitmapRep* info = tx_bitmap(mask, m, owned);
     Coord tx, ty;
     if (c.transformed_) {
 	m.transform(x, y, tx, ty);
@@ -839,26 +1048,29 @@ void Canvas::stencil(
 	0, 0, info->pwidth_, info->pheight_, pleft, ptop, 1
     );
     XFreeGC(dpy, xgc);
+    if (owned) {
+        tx_release(info, nil);
+    }
 }
 
-declareTable2(TxRasterTable,const Raster*,int,RasterRep*)
-implementTable2(TxRasterTable,const Raster*,int,RasterRep*)
-
-static TxRasterTable* _tx_rasters;
+/*
+ * Return the raster as drawn under tx, setting owned if the copy was
+ * not cached and must be released by the caller.
+ */
 
-static RasterRep* tx_raster(const Raster* r, const Transformer& tx) {
+static RasterRep* tx_raster(
+    const Raster* r, const Transformer& tx, boolean& owned
+) {
+    owned = false;
     int key = tx_key(tx, r->width(), r->height());
     if (key == 0) {
         return r->rep();
     } else {
-	if (_tx_rasters == nil) {
-	    _tx_rasters = new TxRasterTable(1024);
-	}
-        RasterRep* rep;
-        if (!_tx_rasters->find(rep, r, key)) {
+        TxCacheEntry* e = tx_find(r, key);
+        if (e == nil) {
 	    Display* d = r->rep()->display_;
 	    DisplayRep& dr = *d->rep();
-            rep = new RasterRep;
+            RasterRep* rep = new RasterRep;
 
             Transformer v(tx);
 
@@ -890,56 +1102,40 @@ static RasterRep* tx_raster(const Raster* r, const Transformer& tx) {
 
             XDisplay* dpy = dr.display_;
             RasterRep* srep = r->rep();
-
-            XImage* source = XGetImage(
-                dpy, srep->pixmap_,
-                0, 0, srep->pwidth_, srep->pheight_, AllPlanes, ZPixmap
-            );
-
-            Pixmap map = XCreatePixmap(
-                dpy, dr.root_, width, height, dr.default_visual_->depth()
+            int depth = dr.default_visual_->depth();
+
+            /* the client-side image is current once the raster is flushed */
+            XImage* source = srep->image_;
+            if (source == nil) {
+                source = XGetImage(
+                    dpy, srep->pixmap_,
+                    0, 0, srep->pwidth_, srep->pheight_, AllPlanes, ZPixmap
+                );
+            }
+            XImage* dest = tx_image(
+                dpy, dr.default_visual_->visual(), depth, width, height
             );
-            GC xgc = XCreateGC(dpy, map, 0, nil);
-            XSetForeground(dpy, xgc, 0);
-            XFillRectangle(dpy, map, xgc, 0, 0, width, height);
-            XImage* dest = XGetImage(
-                dpy, map, 0, 0, width, height, AllPlanes, ZPixmap
+            tx_resample(
+                source, srep->pwidth_, srep->pheight_,
+                dest, width, height, v,
+                d->to_pixels(-xmin), d->to_pixels(-ymin),
+                d->to_pixels(r->left_bearing()), d->to_pixels(r->descent())
             );
 
-            int dx0 = d->to_pixels(-xmin);
-            int dy0 = d->to_pixels(-ymin);
-            int sx0 = d->to_pixels(r->left_bearing());
-            int sy0 = d->to_pixels(r->descent());
-            for (int dy = 0; dy < height; ++dy) {
-                Coord tx1, ty1, tx2, ty2;
-                v.inverse_transform(- dx0, dy - dy0, tx1, ty1);
-                v.inverse_transform(width - dx0, dy - dy0, tx2, ty2);
-                float delta_x = (tx2 - tx1) / width;
-                float delta_y = (ty2 - ty1) / width;
-                int sx, sy;
-                for (int dx = 0; dx < width; ++dx) {
-                    sx = int(tx1) + sx0;
-                    sy = int(ty1) + sy0;
-                    if (
-                        sx >= 0 && sx < srep->pwidth_ &&
-                        sy >= 0 && sy < srep->pheight_
-                    ) {
-                        XPutPixel(
-                            dest, dx, height - 1 - dy,
-                            XGetPixel(source, sx, srep->pheight_ - 1 - sy)
-                        );
-                    }
-                    tx1 = tx1 + delta_x;
-                    ty1 = ty1 + delta_y;
-                }
-            }
-
+            Pixmap map = XCreatePixmap(dpy, dr.root_, width, height, depth);
+            GC xgc = XCreateGC(dpy, map, 0, nil);
             XPutImage(dpy, map, xgc, dest, 0, 0, 0, 0, width, height);
             XFreeGC(dpy, xgc);
-            XDestroyImage(source);
+            if (source != srep->image_) {
+                XDestroyImage(source);
+            }
             XDestroyImage(dest);
 
 	    rep->display_ = d;
+            rep->modified_ = false;
+            rep->image_ = nil;
+            rep->gc_ = nil;
+            rep->shared_memory_ = false;
             rep->pixmap_ = map;
             rep->pwidth_ = width;
             rep->pheight_ = height;
@@ -949,9 +1145,13 @@ static RasterRep* tx_raster(const Raster* r, const Transformer& tx) {
             rep->right_ = xmax;
             rep->bottom_ = ymin;
             rep->top_ = ymax;
-            _tx_rasters->insert(r, key, rep);
+            owned = !tx_insert(
+                r, key, nil, rep,
+                (unsigned long)width * height * ((depth + 7) >> 3)
+            );
+            return rep;
         }
-        return rep;
+        return e->raster_;
     }
 }
 
@@ -964,7 +1164,8 @@ void Canvas::image(const Raster* image, Coord x, Coord y) {
     Transformer& m = c->matrix();
 
     image->flush();
-    RasterRep* info = tx_raster(image, m);
+    boolean owned;
+    RasterRep* info = tx_raster(image, m, owned);
 
     Coord tx, ty;
     if (c->transformed_) {
@@ -985,6 +1186,9 @@ void Canvas::image(const Raster* image, Coord x, Coord y) {
 	dpy, info->pixmap_, c->drawbuffer_, gc,
 	0, 0, info->pwidth_, info->pheight_, pleft, ptop
     );
+    if (owned) {
+        tx_release(nil, info);
+    }
 }
 
 Window* Canvas::window() const { return rep()->window_; }
@@ -1000,18 +1204,12 @@ void Canvas::damage(const Extension& ext) {
 
 void Canvas::damage(Coord left, Coord bottom, Coord right, Coord top) {
     CanvasRep& c = *rep();
-    CanvasDamage& damage = c.damage_;
-    if (c.damaged_) {
-	damage.left = Math::min(damage.left, left);
-	damage.bottom = Math::min(damage.bottom, bottom);
-	damage.right = Math::max(damage.right, right);
-	damage.top = Math::max(damage.top, top);
-    } else {
-	damage.left = left;
-	damage.bottom = bottom;
-	damage.right = right;
-	damage.top = top;
-    }
+    CanvasDamage damage;
+    damage.left = left;
+    damage.bottom = bottom;
+    damage.right = right;
+    damage.top = top;
+    c.add_damage(damage);
     c.new_damage();
 }
 
@@ -1019,16 +1217,35 @@ boolean Canvas::damaged(const Extension& ext) const {
     return damaged(ext.left(), ext.bottom(), ext.right(), ext.top());
 }
 
+static inline boolean overlaps(
+    const CanvasDamage& d, Coord left, Coord bottom, Coord right, Coord top
+) {
+    return (
+	left < d.right && right > d.left && bottom < d.top && top > d.bottom
+    );
+}
+
+/*
+ * While repairing, damage_ is the rectangle being drawn; otherwise
+ * an extent is damaged if it overlaps any of the damaged rectangles.
+ */
+
 boolean Canvas::damaged(
     Coord left, Coord bottom, Coord right, Coord top
 ) const {
     CanvasRep& c = *rep();
-    CanvasDamage& damage = c.damage_;
-    return (
-	c.damaged_ &&
-	left < damage.right && right > damage.left &&
-	bottom < damage.top && top > damage.bottom
-    );
+    if (!c.damaged_) {
+	return false;
+    }
+    if (c.repairing_ || c.damage_count_ == 1) {
+	return overlaps(c.damage_, left, bottom, right, top);
+    }
+    for (int i = 0; i < c.damage_count_; i++) {
+	if (overlaps(c.damage_list_[i], left, bottom, right, top)) {
+	    return true;
+	}
+    }
+    return false;
 }
 
 void Canvas::damage_area(Extension& ext) {
@@ -1044,6 +1261,8 @@ void Canvas::damage_all() {
     damage.bottom = 0;
     damage.right = c.width_;
     damage.top = c.height_;
+    c.damage_list_[0] = damage;
+    c.damage_count_ = 1;
     c.new_damage();
 }
 
@@ -1094,6 +1313,15 @@ void Canvas::repair() {
     c.clear_damage();
 }
 
+long Canvas::damage_count() const {
+    CanvasRep& c = *rep();
+    return c.damaged_ ? c.damage_count_ : 0;
+}
+
+unsigned long Canvas::repaired_pixels() const {
+    return rep()->repaired_pixels_;
+}
+
 /* class CanvasRep */
 
 /*
@@ -1163,15 +1391,8 @@ static inline void restrict(int& c, int a, int b) {
     }
 }
 
-boolean CanvasRep::start_repair() {
-    CanvasRep& c = *this;
-    if (!c.damaged_) {
-	return false;
-    }
-
-    XRectangle& clip = c.clip_;
-    CanvasDamage& damage = c.damage_;
-    Display& d = *c.display_;
+void CanvasRep::clip_damage(const CanvasDamage& damage, XRectangle& clip) const {
+    Display& d = *display_;
     int d_left = d.to_pixels(damage.left);
     int d_bottom = d.to_pixels(damage.bottom);
     int d_right = d.to_pixels(damage.right);
@@ -1181,15 +1402,62 @@ boolean CanvasRep::start_repair() {
     restrict(d_right, 0, pwidth_);
     restrict(d_top, 0, pheight_);
     clip.x = d_left;
-    clip.y = c.pheight_ - d_top;
+    clip.y = pheight_ - d_top;
     clip.width = d_right - d_left;
     clip.height = d_top - d_bottom;
-    XUnionRectWithRegion(&clip, c.empty_, c.clipping_);
-    XSetClipRectangles(dpy(), c.drawgc_, 0, 0, &clip, 1, YXBanded);
+}
+
+/*
+ * Clip to all the damaged rectangles, with damage_ their bounds, so
+ * that drawing once repairs everything.  Window::repair goes on to
+ * draw each rectangle in turn with repair_damage.
+ */
+
+boolean CanvasRep::start_repair() {
+    CanvasRep& c = *this;
+    if (!c.damaged_) {
+	return false;
+    }
+
+    if (!c.repairing_) {
+	c.repaired_pixels_ = 0;
+	XUnionRegion(c.empty_, c.empty_, c.repaired_);
+    }
+    XUnionRegion(c.empty_, c.empty_, c.clipping_);
+    for (int i = 0; i < c.damage_count_; i++) {
+	XRectangle r;
+	c.clip_damage(c.damage_list_[i], r);
+	XUnionRectWithRegion(&r, c.clipping_, c.clipping_);
+	c.repaired_pixels_ += (unsigned long)r.width * r.height;
+    }
+    XUnionRegion(c.clipping_, c.repaired_, c.repaired_);
+    c.clip_damage(c.damage_, c.clip_);
+    XSetRegion(dpy(), c.drawgc_, c.clipping_);
     c.repairing_ = true;
     return true;
 }
 
+/*
+ * Clip to damaged rectangle i, making it damage_, so that drawing
+ * skips everything outside it.  False once i is past the last one.
+ */
+
+boolean CanvasRep::repair_damage(int i) {
+    CanvasRep& c = *this;
+    if (!c.repairing_ || i >= c.damage_count_) {
+	return false;
+    }
+    if (c.damage_count_ > 1) {
+	c.flush();
+	c.damage_ = c.damage_list_[i];
+	XRectangle& clip = c.clip_;
+	c.clip_damage(c.damage_, clip);
+	XUnionRectWithRegion(&clip, c.empty_, c.clipping_);
+	XSetClipRectangles(dpy(), c.drawgc_, 0, 0, &clip, 1, YXBanded);
+    }
+    return true;
+}
+
 void CanvasRep::finish_repair() {
     CanvasRep& c = *this;
     c.flush();
@@ -1197,6 +1465,7 @@ void CanvasRep::finish_repair() {
     c.damaged_ = false;
     c.on_damage_list_ = false;
     c.repairing_ = false;
+    c.damage_count_ = 0;
 }
 
 void CanvasRep::flush() {
@@ -1256,11 +1525,14 @@ void CanvasRep::swapbuffers() {
 	/* not double-buffering */
 	return;
     }
-    XRectangle& clip = c.clip_;
+    XRectangle clip;
+    XClipBox(c.repaired_, &clip);
+    XSetRegion(c.dpy(), c.copygc_, c.repaired_);
     XCopyArea(
 	c.dpy(), c.drawbuffer_, c.copybuffer_, c.copygc_,
 	clip.x, clip.y, clip.width, clip.height, clip.x, clip.y
     );
+    XSetClipMask(c.dpy(), c.copygc_, None);
 }
 
 XDisplay* CanvasRep::dpy() const { return display_->rep()->display_; }
@@ -1369,6 +1641,85 @@ void CanvasRep::new_damage() {
 void CanvasRep::clear_damage() {
     damaged_ = false;
     on_damage_list_ = false;
+    damage_count_ = 0;
+}
+
+static inline Coord area(const CanvasDamage& d) {
+    return (d.right - d.left) * (d.top - d.bottom);
+}
+
+static inline void merge(CanvasDamage& d, const CanvasDamage& e) {
+    d.left = Math::min(d.left, e.left);
+    d.bottom = Math::min(d.bottom, e.bottom);
+    d.right = Math::max(d.right, e.right);
+    d.top = Math::max(d.top, e.top);
+}
+
+/*
+ * Add a rectangle to the damage, keeping the rectangles disjoint.  It
+ * is merged with any rectangle it overlaps, and with the nearest one
+ * when their bounds would not be more than twice the area they cover
+ * or when the list is full.  Merged rectangles are added over again,
+ * since they may now overlap others.
+ */
+
+void CanvasRep::add_damage(const CanvasDamage& damage) {
+    if (damage.right <= damage.left || damage.top <= damage.bottom) {
+	if (!damaged_) {
+	    damage_ = damage;
+	    damage_count_ = 0;
+	}
+	return;
+    }
+    if (!damaged_ || damage_count_ == 0) {
+	damage_ = damage;
+	damage_list_[0] = damage;
+	damage_count_ = 1;
+	return;
+    }
+    if (!repairing_) {
+	merge(damage_, damage);
+    }
+    CanvasDamage d = damage;
+    for (;;) {
+	int i = 0;
+	while (i < damage_count_) {
+	    CanvasDamage& e = damage_list_[i];
+	    if (e.left <= d.left && e.right >= d.right &&
+		e.bottom <= d.bottom && e.top >= d.top
+	    ) {
+		return;
+	    }
+	    if (overlaps(e, d.left, d.bottom, d.right, d.top)) {
+		merge(d, e);
+		damage_list_[i] = damage_list_[--damage_count_];
+		i = 0;
+	    } else {
+		++i;
+	    }
+	}
+	int nearest = -1;
+	Coord waste = 0;
+	for (i = 0; i < damage_count_; i++) {
+	    CanvasDamage u = damage_list_[i];
+	    merge(u, d);
+	    Coord w = area(u) - area(damage_list_[i]) - area(d);
+	    if (nearest == -1 || w < waste) {
+		nearest = i;
+		waste = w;
+	    }
+	}
+	if (nearest == -1 || (
+		damage_count_ < max_damage &&
+		waste > area(damage_list_[nearest]) + area(d)
+	    )
+	) {
+	    break;
+	}
+	merge(d, damage_list_[nearest]);
+	damage_list_[nearest] = damage_list_[--damage_count_];
+    }
+    damage_list_[damage_count_++] = d;
 }
 
 /*
@@ -34,13 +34,28 @@
 #include <IV-X11/xfont.h>
 #include <OS/list.h>
 #include <OS/math.h>
+#include <OS/memory.h>
 #include <OS/string.h>
 #include <OS/ustring.h>
 #include <OS/table.h>
 #include <X11/Xatom.h>
 #include <cstdio>
+#include <stdlib.h>
 #include <string.h>
 
+/*
+ * Conversions between pixels and coordinates for a font's display.
+ * A font rep made without a display (-nodisplay) has one pixel per point.
+ */
+
+static inline Coord to_coord(Display* d, int p) {
+    return d == nil ? Coord(p) : d->to_coord(p);
+}
+
+static inline int to_pixels(Display* d, Coord c) {
+    return d == nil ? int(c + ((c > 0) ? 0.5 : -0.5)) : d->to_pixels(c);
+}
+
 /** class FontImpl **/
 
 declarePtrList(FontList,Font)
@@ -87,6 +102,7 @@ private:
     static const Font* lookup(Display*, const String&, float);
     static FontRep* find_rep(FontRepList&, Display*, float);
     static FontRep* create(Display*, const String&, float);
+    static FontRep* synthesize(const String&, float);
     static const Font* new_font(const String&, float, KnownFonts*, FontRep*);
     static KnownFonts* known(KnownFonts*, const UniqueString&);
 
@@ -232,6 +248,9 @@ FontRep* FontImpl::find_rep(FontRepList& list, Display* d, float s) {
 FontRep* FontImpl::create(Display* d, const String& name, float scale) {
     static Atom XA_CHARSET_REGISTRY = 0;
 
+    if (d == nil) {
+	return synthesize(name, scale);
+    }
     XDisplay* dpy = d->rep()->display_;
     NullTerminatedString s(name);
     XFontStruct* xf = XLoadQueryFont(dpy, s.string());
@@ -271,6 +290,56 @@ FontRep* FontImpl::create(Display* d, const String& name, float scale) {
     return f;
 }
 
+/*
+ * Without a display there are no X fonts to load, so a font gets
+ * fixed-width metrics made up from the pixel size in its XLFD name
+ * (13, as for "fixed", when the name has none): each character is 3/5
+ * of the size wide and 4/5 of it is above the baseline.  Text still
+ * lays out and has extents for picking, bounding boxes and renderers
+ * that draw their own glyphs.
+ */
+
+FontRep* FontImpl::synthesize(const String& name, float scale) {
+    NullTerminatedString s(name);
+    int size = 0;
+    const char* field = s.string();
+    for (int i = 0; i < 7 && field != nil; ++i) {
+	field = strchr(field, '-');
+	field = (field == nil) ? nil : field + 1;
+    }
+    if (field != nil) {
+	size = atoi(field);
+	if (size <= 0 && (field = strchr(field, '-')) != nil) {
+	    size = atoi(field + 1) / 10;        /* point size in decipoints */
+	}
+    }
+    if (size <= 0) {
+	size = 13;
+    }
+
+    XFontStruct* xf = new XFontStruct;
+    Memory::zero(xf, sizeof(XFontStruct));
+    xf->min_char_or_byte2 = 0;
+    xf->max_char_or_byte2 = 255;
+    xf->min_byte1 = 0;
+    xf->max_byte1 = 255;
+    xf->all_chars_exist = True;
+    xf->default_char = ' ';
+    xf->ascent = (size * 4 + 2) / 5;
+    xf->descent = size - xf->ascent;
+    xf->max_bounds.lbearing = 0;
+    xf->max_bounds.rbearing = xf->max_bounds.width = (size * 3 + 2) / 5;
+    xf->max_bounds.ascent = xf->ascent;
+    xf->max_bounds.descent = xf->descent;
+    xf->min_bounds = xf->max_bounds;
+
+    FontRep* f = new FontRep(nil, xf, scale);
+    f->name_ = new CopyString(s.string());
+    f->encoding_ = nil;
+    f->size_ = size * f->scale_;
+    return f;
+}
+
 const Font* FontImpl::new_font(
     const String& name, float scale, KnownFonts* k, FontRep* r
 ) {
@@ -297,10 +366,22 @@ FontRep::FontRep(Display* d, XFontStruct* xf, float scale) {
     scale_ = scale;
     unscaled_ = (scale_ > 0.9999 && scale_ < 1.0001);
     entry_ = nil;
+    chars_ = nil;
+    for (int i = 0; i < 256; i++) {
+	rows_[i] = nil;
+    }
 }
 
 FontRep::~FontRep() {
-    XFreeFont(display_->rep()->display_, font_);
+    delete [] chars_;
+    for (int i = 0; i < 256; i++) {
+	delete [] rows_[i];
+    }
+    if (display_ != nil) {
+	XFreeFont(display_->rep()->display_, font_);
+    } else {
+	delete font_;
+    }
     for (ListUpdater(FontRepList) i(entry_->fontreps); i.more(); i.next()) {
 	if (i.cur() == this) {
 	    i.remove_cur();
@@ -311,6 +392,50 @@ FontRep::~FontRep() {
     delete encoding_;
 }
 
+/*
+ * Metrics of each character, as Xlib finds them for a one-character
+ * string, so that measuring text only sums table entries.  A character
+ * that Xlib skips (nonexistent, with no default) has all zero metrics,
+ * as Xlib itself takes all zero metrics to mean nonexistent.  The
+ * table for single-byte text is filled on first use, and that for
+ * two-byte text a row of 256 at a time.
+ */
+
+const XCharStruct* FontRep::chars() {
+    if (chars_ == nil) {
+	chars_ = new XCharStruct[256];
+	int dir, asc, des;
+	for (int i = 0; i < 256; i++) {
+	    char c = char(i);
+	    XTextExtents(font_, &c, 1, &dir, &asc, &des, &chars_[i]);
+	}
+    }
+    return chars_;
+}
+
+const XCharStruct& FontRep::char2b(long c) {
+    int r = int((c & 0xff00) >> 8);
+    XCharStruct*& row = rows_[r];
+    if (row == nil) {
+	row = new XCharStruct[256];
+	int dir, asc, des;
+	XChar2b xc2b;
+	xc2b.byte1 = (unsigned char)r;
+	for (int i = 0; i < 256; i++) {
+	    xc2b.byte2 = (unsigned char)i;
+	    XTextExtents16(font_, &xc2b, 1, &dir, &asc, &des, &row[i]);
+	}
+    }
+    return row[c & 0xff];
+}
+
+static inline boolean char_exists(const XCharStruct& c) {
+    return (
+	c.width != 0 ||
+	(c.lbearing | c.rbearing | c.ascent | c.descent) != 0
+    );
+}
+
 /** class Font **/
 
 Font::Font(const String& name, float scale) {
@@ -376,11 +501,11 @@ void Font::font_bbox(FontBoundingBox& b) const {
     float scale = f->scale_;
     XFontStruct* xf = f->font_;
     Display* d = f->display_;
-    b.left_bearing_ = scale * d->to_coord(xf->max_bounds.lbearing);
-    b.right_bearing_ = scale * d->to_coord(xf->max_bounds.rbearing);
-    b.width_ = scale * d->to_coord(xf->max_bounds.width);
-    b.ascent_ = scale * d->to_coord(xf->ascent);
-    b.descent_ = scale * d->to_coord(xf->descent);
+    b.left_bearing_ = scale * to_coord(d, xf->max_bounds.lbearing);
+    b.right_bearing_ = scale * to_coord(d, xf->max_bounds.rbearing);
+    b.width_ = scale * to_coord(d, xf->max_bounds.width);
+    b.ascent_ = scale * to_coord(d, xf->ascent);
+    b.descent_ = scale * to_coord(d, xf->descent);
     b.font_ascent_ = b.ascent_;
     b.font_descent_ = b.descent_;
 }
@@ -400,19 +525,14 @@ void Font::char_bbox(long c, FontBoundingBox& b) const {
     float scale = f->scale_;
     XFontStruct* xf = f->font_;
     Display* d = f->display_;
-    XCharStruct xc;
-    XChar2b xc2b;
-    xc2b.byte1 = (unsigned char)((c & 0xff00) >> 8);
-    xc2b.byte2 = (unsigned char)(c & 0xff);
-    int dir, asc, des;
-    XTextExtents16(xf, &xc2b, 1, &dir, &asc, &des, &xc);
-    b.left_bearing_ = scale * d->to_coord(-xc.lbearing);
-    b.right_bearing_ = scale * d->to_coord(xc.rbearing);
+    const XCharStruct& xc = f->char2b(c);
+    b.left_bearing_ = scale * to_coord(d, -xc.lbearing);
+    b.right_bearing_ = scale * to_coord(d, xc.rbearing);
     b.width_ = width(c);
-    b.ascent_ = scale * d->to_coord(xc.ascent);
-    b.descent_ = scale * d->to_coord(xc.descent);
-    b.font_ascent_ = scale * d->to_coord(xf->ascent);
-    b.font_descent_ = scale * d->to_coord(xf->descent);
+    b.ascent_ = scale * to_coord(d, xc.ascent);
+    b.descent_ = scale * to_coord(d, xc.descent);
+    b.font_ascent_ = scale * to_coord(d, xf->ascent);
+    b.font_descent_ = scale * to_coord(d, xf->descent);
 }
 
 void Font::string_bbox(const char* s, int len, FontBoundingBox& b) const {
@@ -420,16 +540,33 @@ void Font::string_bbox(const char* s, int len, FontBoundingBox& b) const {
     float scale = f->scale_;
     XFontStruct* xf = f->font_;
     Display* d = f->display_;
+    const XCharStruct* m = f->chars();
     XCharStruct c;
-    int dir, asc, des;
-    XTextExtents(xf, s, len, &dir, &asc, &des, &c);
-    b.left_bearing_ = scale * d->to_coord(-c.lbearing);
-    b.right_bearing_ = scale * d->to_coord(c.rbearing);
+    c.lbearing = c.rbearing = c.width = c.ascent = c.descent = 0;
+    boolean found = false;
+    for (int i = 0; i < len; i++) {
+	const XCharStruct& ch = m[(unsigned char)s[i]];
+	if (!char_exists(ch)) {
+	    continue;
+	}
+	if (!found) {
+	    c = ch;
+	    found = true;
+	} else {
+	    c.ascent = Math::max(c.ascent, ch.ascent);
+	    c.descent = Math::max(c.descent, ch.descent);
+	    c.lbearing = Math::min(c.lbearing, c.width + ch.lbearing);
+	    c.rbearing = Math::max(c.rbearing, c.width + ch.rbearing);
+	    c.width += ch.width;
+	}
+    }
+    b.left_bearing_ = scale * to_coord(d, -c.lbearing);
+    b.right_bearing_ = scale * to_coord(d, c.rbearing);
     b.width_ = width(s, len);
-    b.ascent_ = scale * d->to_coord(c.ascent);
-    b.descent_ = scale * d->to_coord(c.descent);
-    b.font_ascent_ = scale * d->to_coord(xf->ascent);
-    b.font_descent_ = scale * d->to_coord(xf->descent);
+    b.ascent_ = scale * to_coord(d, c.ascent);
+    b.descent_ = scale * to_coord(d, c.descent);
+    b.font_ascent_ = scale * to_coord(d, xf->ascent);
+    b.font_descent_ = scale * to_coord(d, xf->descent);
 }
 
 Coord Font::width(long c) const {
@@ -437,15 +574,17 @@ Coord Font::width(long c) const {
 	return 0;
     }
     FontRep* f = impl_->default_rep();
-    XChar2b xc2b;
-    xc2b.byte1 = (unsigned char)((c & 0xff00) >> 8);
-    xc2b.byte2 = (unsigned char)(c & 0xff);
-    return f->scale_ * f->display_->to_coord(XTextWidth16(f->font_, &xc2b, 1));
+    return f->scale_ * to_coord(f->display_, f->char2b(c).width);
 }
 
 Coord Font::width(const char* s, int len) const {
     FontRep* f = impl_->default_rep();
-    return f->scale_ * f->display_->to_coord(XTextWidth(f->font_, s, len));
+    const XCharStruct* m = f->chars();
+    int w = 0;
+    for (int i = 0; i < len; i++) {
+	w += m[(unsigned char)s[i]].width;
+    }
+    return f->scale_ * to_coord(f->display_, w);
 }
 
 int Font::index(const char* s, int len, float offset, boolean between) const {
@@ -458,16 +597,17 @@ int Font::index(const char* s, int len, float offset, boolean between) const {
     }
     FontRep* f = impl_->default_rep();
     XFontStruct* xf = f->font_;
-    int xoffset = f->display_->to_pixels(Coord(offset * f->scale_));
+    int xoffset = to_pixels(f->display_, Coord(offset * f->scale_));
     if (xf->min_bounds.width == xf->max_bounds.width) {
         cw = xf->min_bounds.width;
         n = xoffset / cw;
         coff = xoffset % cw;
     } else {
+        const XCharStruct* m = f->chars();
         w = 0;
         cw = 0;
         for (p = s, n = 0; *p != '\0' && n < len; ++p, ++n) {
-            cw = XTextWidth(xf, p, 1);
+            cw = m[(unsigned char)*p].width;
             w += cw;
             if (w > xoffset) {
                 break;
@@ -486,33 +626,35 @@ int Font::index(const char* s, int len, float offset, boolean between) const {
 int Font::Baseline() const {
     FontBoundingBox b;
     font_bbox(b);
-    return impl_->default_rep()->display_->to_pixels(b.descent()) - 1;
+    Display* d = impl_->default_rep()->display_;
+    return to_pixels(d, b.descent()) - 1;
 }
 
 int Font::Height() const {
     FontBoundingBox b;
     font_bbox(b);
-    return impl_->default_rep()->display_->to_pixels(b.ascent() + b.descent());
+    Display* d = impl_->default_rep()->display_;
+    return to_pixels(d, b.ascent() + b.descent());
 }
 
 int Font::Width(const char* s) const {
-    return impl_->default_rep()->display_->to_pixels(width(s, strlen(s)));
+    Display* d = impl_->default_rep()->display_;
+    return to_pixels(d, width(s, strlen(s)));
 }
 
 int Font::Width(const char* s, int len) const {
-    return impl_->default_rep()->display_->to_pixels(width(s, len));
+    Display* d = impl_->default_rep()->display_;
+    return to_pixels(d, width(s, len));
 }
 
 int Font::Index(const char* s, int offset, boolean between) const {
-    return impl_->default_rep()->display_->to_pixels(
-	index(s, strlen(s), float(offset), between)
-    );
+    Display* d = impl_->default_rep()->display_;
+    return to_pixels(d, index(s, strlen(s), float(offset), between));
 }
 
 int Font::Index(const char* s, int len, int offset, boolean between) const {
-    return impl_->default_rep()->display_->to_pixels(
-	index(s, len, float(offset), between)
-    );
+    Display* d = impl_->default_rep()->display_;
+    return to_pixels(d, index(s, len, float(offset), between));
 }
 
 boolean Font::FixedWidth() const {
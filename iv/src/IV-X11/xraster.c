@@ -33,8 +33,10 @@
 #include <InterViews/session.h>
 #include <IV-X11/Xlib.h>
 #include <IV-X11/Xutil.h>
+#include <IV-X11/xcanvas.h>
 #include <IV-X11/xdisplay.h>
 #include <IV-X11/xraster.h>
+#include <OS/math.h>
 
 #include <stream.h>
 
@@ -140,6 +142,7 @@ Raster::Raster(RasterRep* r) { rep_ = r; }
 
 Raster::~Raster() {
     RasterRep* r = rep();
+    CanvasRep::forget_transformed(this);
     if (r->image_) {
         XDisplay* dpy = r->display_->rep()->display_;
         XFreePixmap(dpy, r->pixmap_);
@@ -309,6 +312,219 @@ void Raster::poke(
     r->modified_ = true;
 }
 
+/*
+ * Bulk pixel transfer.  Rows of samples are converted to pixels a chunk
+ * at a time by the visual and stored straight into the image data
+ * for the common ZPixmap layouts, falling back to XPutPixel/XGetPixel
+ * for anything else.
+ */
+
+static const unsigned long row_chunk = 256;
+
+static void store_pixels(
+    XImage* image, unsigned int x, unsigned int y, unsigned long n,
+    const unsigned long* pixels
+) {
+    unsigned char* d = (unsigned char*)image->data + y * image->bytes_per_line;
+    boolean lsb = image->byte_order == LSBFirst;
+    unsigned long i;
+    switch (image->bits_per_pixel) {
+    case 8:
+	d += x;
+	for (i = 0; i < n; i++) {
+	    *d++ = (unsigned char)pixels[i];
+	}
+	break;
+    case 16:
+	d += x * 2;
+	for (i = 0; i < n; i++, d += 2) {
+	    unsigned long p = pixels[i];
+	    if (lsb) {
+		d[0] = (unsigned char)p; d[1] = (unsigned char)(p >> 8);
+	    } else {
+		d[0] = (unsigned char)(p >> 8); d[1] = (unsigned char)p;
+	    }
+	}
+	break;
+    case 24:
+	d += x * 3;
+	for (i = 0; i < n; i++, d += 3) {
+	    unsigned long p = pixels[i];
+	    if (lsb) {
+		d[0] = (unsigned char)p; d[1] = (unsigned char)(p >> 8);
+		d[2] = (unsigned char)(p >> 16);
+	    } else {
+		d[0] = (unsigned char)(p >> 16); d[1] = (unsigned char)(p >> 8);
+		d[2] = (unsigned char)p;
+	    }
+	}
+	break;
+    case 32:
+	d += x * 4;
+	for (i = 0; i < n; i++, d += 4) {
+	    unsigned long p = pixels[i];
+	    if (lsb) {
+		d[0] = (unsigned char)p; d[1] = (unsigned char)(p >> 8);
+		d[2] = (unsigned char)(p >> 16); d[3] = (unsigned char)(p >> 24);
+	    } else {
+		d[0] = (unsigned char)(p >> 24); d[1] = (unsigned char)(p >> 16);
+		d[2] = (unsigned char)(p >> 8); d[3] = (unsigned char)p;
+	    }
+	}
+	break;
+    default:
+	for (i = 0; i < n; i++) {
+	    XPutPixel(image, x + (unsigned int)i, y, pixels[i]);
+	}
+	break;
+    }
+}
+
+static void fetch_pixels(
+    XImage* image, unsigned int x, unsigned int y, unsigned long n,
+    unsigned long* pixels
+) {
+    const unsigned char* d =
+	(const unsigned char*)image->data + y * image->bytes_per_line;
+    boolean lsb = image->byte_order == LSBFirst;
+    unsigned long i;
+    switch (image->bits_per_pixel) {
+    case 8:
+	d += x;
+	for (i = 0; i < n; i++) {
+	    pixels[i] = *d++;
+	}
+	break;
+    case 16:
+	d += x * 2;
+	for (i = 0; i < n; i++, d += 2) {
+	    pixels[i] = lsb ? (d[1] << 8) | d[0] : (d[0] << 8) | d[1];
+	}
+	break;
+    case 24:
+	d += x * 3;
+	for (i = 0; i < n; i++, d += 3) {
+	    pixels[i] = lsb
+		? (d[2] << 16) | (d[1] << 8) | d[0]
+		: (d[0] << 16) | (d[1] << 8) | d[2];
+	}
+	break;
+    case 32:
+	d += x * 4;
+	for (i = 0; i < n; i++, d += 4) {
+	    pixels[i] = lsb
+		? ((unsigned long)d[3] << 24) | (d[2] << 16) | (d[1] << 8) | d[0]
+		: ((unsigned long)d[0] << 24) | (d[1] << 16) | (d[2] << 8) | d[3];
+	}
+	break;
+    default:
+	for (i = 0; i < n; i++) {
+	    pixels[i] = XGetPixel(image, x + (unsigned int)i, y);
+	}
+	break;
+    }
+}
+
+void Raster::peekrow(
+    unsigned long x, unsigned long y, unsigned long n,
+    unsigned char* rgb, unsigned int samples
+) const {
+    RasterRep* r = rep();
+    if (x >= r->pwidth_ || y >= r->pheight_) {
+	return;
+    }
+    n = Math::min(n, r->pwidth_ - x);
+    WindowVisual* wv = r->display_->rep()->default_visual_;
+    unsigned int row = r->pheight_ - (unsigned int)y - 1;
+    unsigned long pixels[row_chunk];
+    while (n > 0) {
+	unsigned long count = Math::min(n, row_chunk);
+	fetch_pixels(r->image_, (unsigned int)x, row, count, pixels);
+	for (unsigned long i = 0; i < count; i++, rgb += samples) {
+	    XColor xc;
+	    wv->find_color(pixels[i], xc);
+	    rgb[0] = xc.red >> 8;
+	    rgb[1] = xc.green >> 8;
+	    rgb[2] = xc.blue >> 8;
+	    if (samples > 3) {
+		rgb[3] = 0xff;
+	    }
+	}
+	x += count;
+	n -= count;
+    }
+}
+
+void Raster::pokerow(
+    unsigned long x, unsigned long y, unsigned long n,
+    const unsigned char* rgb, unsigned int samples
+) {
+    RasterRep* r = rep();
+    if (x >= r->pwidth_ || y >= r->pheight_) {
+	return;
+    }
+    n = Math::min(n, r->pwidth_ - x);
+    WindowVisual* wv = r->display_->rep()->default_visual_;
+    unsigned int row = r->pheight_ - (unsigned int)y - 1;
+    unsigned long pixels[row_chunk];
+    while (n > 0) {
+	unsigned long count = Math::min(n, row_chunk);
+	wv->find_pixels(rgb, samples, count, pixels);
+	store_pixels(r->image_, (unsigned int)x, row, count, pixels);
+	rgb += count * samples;
+	x += count;
+	n -= count;
+    }
+    r->modified_ = true;
+}
+
+void Raster::pokerow(
+    unsigned long x, unsigned long y, unsigned long n,
+    const unsigned short* rgb, unsigned int samples
+) {
+    RasterRep* r = rep();
+    if (x >= r->pwidth_ || y >= r->pheight_) {
+	return;
+    }
+    n = Math::min(n, r->pwidth_ - x);
+    WindowVisual* wv = r->display_->rep()->default_visual_;
+    unsigned int row = r->pheight_ - (unsigned int)y - 1;
+    unsigned long pixels[row_chunk];
+    while (n > 0) {
+	unsigned long count = Math::min(n, row_chunk);
+	wv->find_pixels(rgb, samples, count, pixels);
+	store_pixels(r->image_, (unsigned int)x, row, count, pixels);
+	rgb += count * samples;
+	x += count;
+	n -= count;
+    }
+    r->modified_ = true;
+}
+
+void Raster::pokerect(
+    unsigned long x, unsigned long y, unsigned long w, unsigned long h,
+    const unsigned char* rgb, unsigned int samples, unsigned long stride
+) {
+    if (stride == 0) {
+	stride = w * samples;
+    }
+    for (unsigned long i = h; i > 0; i--, rgb += stride) {
+	pokerow(x, y + i - 1, w, rgb, samples);
+    }
+}
+
+void Raster::pokerect(
+    unsigned long x, unsigned long y, unsigned long w, unsigned long h,
+    const unsigned short* rgb, unsigned int samples, unsigned long stride
+) {
+    if (stride == 0) {
+	stride = w * samples;
+    }
+    for (unsigned long i = h; i > 0; i--, rgb += stride) {
+	pokerow(x, y + i - 1, w, rgb, samples);
+    }
+}
+
 #ifdef XSHM 
 static Bool completion(XDisplay* d, XEvent* eventp, char* arg) {
     return eventp->xany.type == (XShmGetEventBase(d) + ShmCompletion);
@@ -318,6 +534,7 @@ static Bool completion(XDisplay* d, XEvent* eventp, char* arg) {
 void Raster::flush() const {
     RasterRep* r = rep();
     if (r->modified_) {
+        CanvasRep::forget_transformed(this);
 
 #ifdef XSHM
         if (r->shared_memory_) {
@@ -350,6 +567,7 @@ void Raster::flushrect(IntCoord left, IntCoord bottom,
   if (r->pixmap_)
     {
       if (r->modified_) {
+	CanvasRep::forget_transformed(this);
 	
 #ifdef XSHM
 	if (r->shared_memory_) {
@@ -582,7 +582,9 @@ void Window::repair() {
     WindowRep& w = *rep();
     CanvasRep& c = *w.canvas_->rep();
     if (c.start_repair()) {
-	w.glyph_->draw(w.canvas_, w.allocation_);
+	for (int i = 0; c.repair_damage(i); i++) {
+	    w.glyph_->draw(w.canvas_, w.allocation_);
+	}
 	c.finish_repair();
     }
 }
@@ -1418,6 +1420,8 @@ WindowVisual::~WindowVisual() {
     delete ctable_;
     delete rgbtable_;
     delete [] localmap_;
+    delete [] pixeltable_;
+    delete [] pixelcache_;
 }
 
 WindowVisual* WindowVisual::find_visual(Display* d, Style* s) {
@@ -1589,6 +1593,9 @@ void WindowVisual::init_color_tables() {
     ctable_ = new ColorTable(512);
     localmap_ = nil;
     localmapsize_ = 0;
+    bytesize_ = false;
+    pixeltable_ = nil;
+    pixelcache_ = nil;
     Visual& v = *info_.visual_;
     switch (v.c_class) {
     case TrueColor:
@@ -1597,6 +1604,7 @@ void WindowVisual::init_color_tables() {
 	set_shift(v.green_mask, green_, green_shift_);
 	set_shift(v.blue_mask, blue_, blue_shift_);
 	bytesize_ = red_ == 0xff && green_ == 0xff && blue_ == 0xff;
+	init_pixel_tables();
 	break;
     default:
 	rgbtable_ = new RGBTable(512);
@@ -1764,6 +1772,99 @@ void WindowVisual::find_color(
     }
 }
 
+/*
+ * Tables for converting whole rows of 8-bit samples to pixels.
+ * For TrueColor the pixel is the or of a per-channel table entry,
+ * built once here with the same rounding find_color uses.  Other
+ * visual classes go through a direct-mapped cache of rgb to pixel
+ * in front of find_color, allocated the first time it is needed.
+ * Entries never go stale because allocated colors are never freed.
+ */
+
+static const unsigned int pixelcache_size = 4096;
+
+void WindowVisual::init_pixel_tables() {
+    pixeltable_ = new unsigned long[3 * 256];
+    for (unsigned long v = 0; v < 256; v++) {
+	unsigned long s = v * 0x101;
+	pixeltable_[v] = rescale(s, 0xffff, red_) << red_shift_;
+	pixeltable_[256 + v] = rescale(s, 0xffff, green_) << green_shift_;
+	pixeltable_[512 + v] = rescale(s, 0xffff, blue_) << blue_shift_;
+    }
+}
+
+unsigned long WindowVisual::cached_pixel(
+    unsigned char r, unsigned char g, unsigned char b
+) {
+    if (pixelcache_ == nil) {
+	pixelcache_ = new unsigned long[2 * pixelcache_size];
+	for (unsigned int i = 0; i < pixelcache_size; i++) {
+	    pixelcache_[2*i] = 0;
+	}
+    }
+    unsigned long key = (r << 16) | (g << 8) | b;
+    unsigned long* entry = pixelcache_ + 2 * (
+	((key * 2654435761UL) >> 12) & (pixelcache_size - 1)
+    );
+    if (entry[0] != (key | 0x1000000)) {
+	XColor xc;
+	find_color(
+	    (unsigned short)(r * 0x101), (unsigned short)(g * 0x101),
+	    (unsigned short)(b * 0x101), xc
+	);
+	entry[0] = key | 0x1000000;
+	entry[1] = xc.pixel;
+    }
+    return entry[1];
+}
+
+/*
+ * Convert 'n' pixels of packed rgb samples to pixel values.
+ * 'samples' is the number of samples per pixel (3, or 4 with
+ * a trailing alpha sample that is ignored).
+ */
+
+void WindowVisual::find_pixels(
+    const unsigned char* rgb, unsigned int samples, unsigned long n,
+    unsigned long* pixels
+) {
+    const unsigned char* end = rgb + n * samples;
+    if (pixeltable_ != nil) {
+	const unsigned long* rt = pixeltable_;
+	const unsigned long* gt = pixeltable_ + 256;
+	const unsigned long* bt = pixeltable_ + 512;
+	for (; rgb < end; rgb += samples) {
+	    *pixels++ = rt[rgb[0]] | gt[rgb[1]] | bt[rgb[2]];
+	}
+    } else {
+	for (; rgb < end; rgb += samples) {
+	    *pixels++ = cached_pixel(rgb[0], rgb[1], rgb[2]);
+	}
+    }
+}
+
+void WindowVisual::find_pixels(
+    const unsigned short* rgb, unsigned int samples, unsigned long n,
+    unsigned long* pixels
+) {
+    const unsigned short* end = rgb + n * samples;
+    if (pixeltable_ != nil) {
+	for (; rgb < end; rgb += samples) {
+	    *pixels++ = (
+		(rescale(rgb[0], 0xffff, red_) << red_shift_) |
+		(rescale(rgb[1], 0xffff, green_) << green_shift_) |
+		(rescale(rgb[2], 0xffff, blue_) << blue_shift_)
+	    );
+	}
+    } else {
+	XColor xc;
+	for (; rgb < end; rgb += samples) {
+	    find_color(rgb[0], rgb[1], rgb[2], xc);
+	    *pixels++ = xc.pixel;
+	}
+    }
+}
+
 /* class Display */
 
 declarePtrList(DamageList,Window)
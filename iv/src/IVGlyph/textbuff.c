@@ -89,8 +89,9 @@ int EivTextBuffer::load(const char* path)
    }
    int len = (int) info.st_size;
 
-   // allocate buffer
+   // allocate buffer (in normal form, with its gap at the end)
    int add_size = int(len * allocate_extra);
+   Text();
    char* buffer = (char *)realloc(text, len + add_size);
    if (buffer == nil) {
       close(fd);
@@ -123,6 +124,7 @@ void EivTextBuffer ::expand_buffer(int count)
    // re-allocate
    // printf("EivTextBuffer::allocating more memory\n");
    // printf("\t add:%d bytes\n", add_size);
+   Text();			// close the gap so it grows with the buffer
    char* buffer = (char *)realloc(text, size + add_size);
    if (buffer == nil)
       return;			// quitely ???
@@ -139,7 +141,7 @@ int EivTextBuffer::save()
    if (fd < 0)
       return OpenError;		// can't open file
 
-   int len = write(fd, text, length);
+   int len = write(fd, Text(), length);
    if (len != length) {
       perror("EivTextBuffer:save");
       return WriteError;			// can't write to file
@@ -34,6 +34,7 @@
 #include <InterViews/printer.h>
 #include <InterViews/superpose.h>
 #include <InterViews/tile.h>
+#include <InterViews/transformer.h>
 #include <OS/list.h>
 #include <OS/math.h>
 
@@ -47,13 +48,76 @@ private:
     Requisition requisition_;
     AllocationTable* allocations_;
 
+    /*
+     * When the layout tiles, the component allocations run in order
+     * along dimension_, and draw and pick search them for the span that
+     * matters.  ordered_ is cleared if an allocation turns out not to
+     * be in order after all; overhang_ is how far any component has
+     * drawn beyond its allocation along dimension_.
+     */
+    boolean tiled_;
+    DimensionName dimension_;
+    boolean reversed_;
+    boolean ordered_;
+    Coord overhang_;
+
+    /*
+     * Component requisitions are kept from one request to the next, and
+     * so are the component allocations and extensions of the most recent
+     * allocation (on last_canvas_ with last_transformer_).  A
+     * modification marks only the components it touches: those from
+     * changed_ up to changed_end_ are requested again, and those from
+     * reallocate_ up to reallocate_end_ allocated again.  The rest are
+     * allocated again only if their allocation actually moved.  Only the
+     * first layout after a modification (incremental_) is done this way;
+     * any other, as for a new size, requests and allocates every
+     * component, so one whose requisition changed without the box being
+     * told is still picked up.
+     */
+    Requisition* requests_;
+    GlyphIndex requests_count_;
+    GlyphIndex requests_size_;
+    GlyphIndex changed_;
+    GlyphIndex changed_end_;
+    GlyphIndex reallocate_;
+    GlyphIndex reallocate_end_;
+    boolean incremental_;
+    boolean last_valid_;
+    Canvas* last_canvas_;
+    Transformer last_transformer_;
+    Allocation* last_allocations_;
+    Extension* last_extensions_;
+    GlyphIndex last_count_;
+    GlyphIndex last_size_;
+
     static Extension* empty_ext_;
 
+    void init(Layout*);
     void request();
     AllocationInfo& info(Canvas*, const Allocation&, Extension&);
     void offset_allocate(AllocationInfo&, Coord dx, Coord dy);
     void full_allocate(AllocationInfo&);
     void invalidate();
+    void modified(GlyphIndex);
+    void mark(GlyphIndex begin, GlyphIndex end);
+    void reserve(GlyphIndex n);
+    void reserve_last(GlyphIndex n);
+    void remember(AllocationInfo&, Extension*, GlyphIndex n);
+
+    const Allotment& allotment(Allocation*, GlyphIndex n, GlyphIndex i) const;
+    void check_order(Allocation*, GlyphIndex n);
+    void note_extension(Canvas*, const Allocation&, const Extension&);
+    boolean span(Canvas*, const Extension&, Coord& lo, Coord& hi) const;
+    void range(
+	Allocation*, GlyphIndex n, Coord lo, Coord hi, boolean closed,
+	GlyphIndex& first, GlyphIndex& end
+    ) const;
+    boolean damaged_range(
+	Canvas*, AllocationInfo&, GlyphIndex& first, GlyphIndex& end
+    );
+    boolean hit_range(
+	const Hit&, AllocationInfo&, GlyphIndex& first, GlyphIndex& end
+    );
 };
 
 Extension* BoxImpl::empty_ext_;
@@ -62,9 +126,7 @@ Box::Box(Layout* layout, GlyphIndex size) : PolyGlyph(size) {
     BoxImpl* b = new BoxImpl;
     impl_ = b;
     b->box_ = this;
-    b->layout_ = layout;
-    b->requested_ = false;
-    b->allocations_ = nil;
+    b->init(layout);
 }
 
 Box::Box(
@@ -75,9 +137,7 @@ Box::Box(
     BoxImpl* b = new BoxImpl;
     impl_ = b;
     b->box_ = this;
-    b->layout_ = layout;
-    b->requested_ = false;
-    b->allocations_ = nil;
+    b->init(layout);
     if (g1 != nil) {
         append(g1);
     }
@@ -114,6 +174,9 @@ Box::~Box() {
     BoxImpl* b = impl_;
     delete b->layout_;
     delete b->allocations_;
+    delete [] b->requests_;
+    delete [] b->last_allocations_;
+    delete [] b->last_extensions_;
     delete b;
 }
 
@@ -136,8 +199,9 @@ void Box::draw(Canvas* c, const Allocation& allocation) const {
     AllocationInfo& info = b->info(c, allocation, ext);
     if (c->damaged(ext)) {
 	Allocation* a = info.component_allocations();
-        GlyphIndex n = count();
-        for (GlyphIndex i = 0; i < n; i++) {
+        GlyphIndex first = 0, end = count();
+	b->damaged_range(c, info, first, end);
+        for (GlyphIndex i = first; i < end; i++) {
             Glyph* g = component(i);
 	    if (g != nil) {
 		g->draw(c, a[i]);
@@ -172,8 +236,9 @@ void Box::pick(Canvas* c, const Allocation& a, int depth, Hit& h) {
 	ext.clear();
 	AllocationInfo& info = b->info(c, a, ext);
 	Allocation* aa = info.component_allocations();
-	GlyphIndex n = count();
-	for (GlyphIndex i = 0; i < n; i++) {
+	GlyphIndex first = 0, end = count();
+	b->hit_range(h, info, first, end);
+	for (GlyphIndex i = first; i < end; i++) {
 	    Glyph* g = component(i);
 	    if (g != nil) {
 		h.begin(depth, this, i);
@@ -189,11 +254,12 @@ void Box::undraw() {
     if (table != nil) {
 	table->flush();
     }
+    impl_->last_valid_ = false;
     PolyGlyph::undraw();
 }
 
-void Box::modified(GlyphIndex) {
-    impl_->invalidate();
+void Box::modified(GlyphIndex i) {
+    impl_->modified(i);
 }
 
 void Box::allotment(GlyphIndex index, DimensionName d, Allotment& a) const {
@@ -209,18 +275,81 @@ void Box::allotment(GlyphIndex index, DimensionName d, Allotment& a) const {
 
 /* class BoxImpl */
 
+void BoxImpl::init(Layout* layout) {
+    layout_ = layout;
+    requested_ = false;
+    allocations_ = nil;
+    tiled_ = layout_->tiled(dimension_, reversed_);
+    ordered_ = tiled_;
+    overhang_ = 0;
+    requests_ = nil;
+    requests_count_ = 0;
+    requests_size_ = 0;
+    changed_ = 0;
+    changed_end_ = 0;
+    reallocate_ = 0;
+    reallocate_end_ = 0;
+    incremental_ = false;
+    last_valid_ = false;
+    last_canvas_ = nil;
+    last_allocations_ = nil;
+    last_extensions_ = nil;
+    last_count_ = 0;
+    last_size_ = 0;
+}
+
+/*
+ * Request only the components marked as changed since the last time,
+ * then let the layout combine the lot.
+ */
+
 void BoxImpl::request() {
     GlyphIndex count = box_->count();
-    Requisition* r = new Requisition[count];
-    for (GlyphIndex i = 0; i < count; i++) {
+    if (requests_count_ != count) {
+	reserve(count);
+	requests_count_ = count;
+	mark(0, count);
+    }
+    for (GlyphIndex i = changed_; i < changed_end_; i++) {
 	Glyph* g = box_->component(i);
+	requests_[i] = Requisition();
 	if (g != nil) {
-	    g->request(r[i]);
+	    g->request(requests_[i]);
 	}
     }
-    layout_->request(count, r, requisition_);
+    changed_ = changed_end_ = 0;
+    layout_->request(count, requests_, requisition_);
     requested_ = true;
-    delete [] r;
+}
+
+void BoxImpl::reserve(GlyphIndex n) {
+    if (n > requests_size_) {
+	GlyphIndex size = Math::max(n, requests_size_ * 2);
+	Requisition* r = new Requisition[size];
+	for (GlyphIndex i = 0; i < requests_count_; i++) {
+	    r[i] = requests_[i];
+	}
+	delete [] requests_;
+	requests_ = r;
+	requests_size_ = size;
+    }
+}
+
+static void merge_range(
+    GlyphIndex& begin, GlyphIndex& end, GlyphIndex b, GlyphIndex e
+) {
+    if (begin == end) {
+	begin = b;
+	end = e;
+    } else {
+	begin = Math::min(begin, b);
+	end = Math::max(end, e);
+    }
+}
+
+void BoxImpl::mark(GlyphIndex begin, GlyphIndex end) {
+    merge_range(changed_, changed_end_, begin, end);
+    merge_range(reallocate_, reallocate_end_, begin, end);
 }
 
 AllocationInfo& BoxImpl::info(Canvas* c, const Allocation& a, Extension& ext) {
@@ -248,52 +377,324 @@ void BoxImpl::offset_allocate(AllocationInfo& info, Coord dx, Coord dy) {
     Canvas* c = info.canvas();
     Allocation* a = info.component_allocations();
     Extension& box = info.extension();
-    Extension child;
     GlyphIndex n = box_->count();
+    Extension* ext = new Extension[n];
     for (GlyphIndex i = 0; i < n; i++) {
         Glyph* g = box_->component(i);
+	ext[i].clear();
         if (g != nil) {
 	    Allocation& a_i = a[i];
 	    Allotment& ax = a_i.x_allotment();
 	    Allotment& ay = a_i.y_allotment();
 	    ax.offset(dx);
 	    ay.offset(dy);
-	    child.clear();
-            g->allocate(c, a_i, child);
-	    box.merge(child);
+            g->allocate(c, a_i, ext[i]);
+	    box.merge(ext[i]);
+	    note_extension(c, a_i, ext[i]);
         }
     }
+    remember(info, ext, n);
+    delete [] ext;
 }
 
+/*
+ * Lay out the components from their cached requisitions.  After a
+ * modification, components whose allocation is the same as in the most
+ * recent allocation on this canvas, and that have not been changed since,
+ * keep their extension from then instead of being allocated again.
+ */
+
 void BoxImpl::full_allocate(AllocationInfo& info) {
     Canvas* c = info.canvas();
     GlyphIndex n = box_->count();
     Allocation* a = info.component_allocations();
-    Requisition* r = new Requisition[n];
-    GlyphIndex i;
-    for (i = 0; i < n; i++) {
-        Glyph* g = box_->component(i);
-        if (g != nil) {
-            g->request(r[i]);
-        }
+    if (!incremental_) {
+	mark(0, n);
+	request();
+    } else if (!requested_ || requests_count_ != n) {
+	request();
     }
-    layout_->allocate(info.allocation(), n, r, a);
-    delete [] r;
+    incremental_ = false;
+    layout_->allocate(info.allocation(), n, requests_, a);
+    check_order(a, n);
 
+    boolean reuse = (
+	last_valid_ && last_canvas_ == c && last_count_ == n &&
+	(c == nil || last_transformer_ == c->transformer())
+    );
+    Extension* ext = new Extension[n];
     Extension& box = info.extension();
-    Extension child;
-    for (i = 0; i < n; i++) {
+    for (GlyphIndex i = 0; i < n; i++) {
         Glyph* g = box_->component(i);
+	ext[i].clear();
         if (g != nil) {
-	    child.clear();
-            g->allocate(c, a[i], child);
-	    box.merge(child);
+	    if (reuse && (i < reallocate_ || i >= reallocate_end_) &&
+		last_allocations_[i].equals(a[i], 1e-4)
+	    ) {
+		ext[i] = last_extensions_[i];
+	    } else {
+		g->allocate(c, a[i], ext[i]);
+		note_extension(c, a[i], ext[i]);
+	    }
+	    box.merge(ext[i]);
         }
     }
+    reallocate_ = reallocate_end_ = 0;
+    remember(info, ext, n);
+    delete [] ext;
+}
+
+void BoxImpl::reserve_last(GlyphIndex n) {
+    if (n > last_size_) {
+	GlyphIndex size = Math::max(n, last_size_ * 2);
+	Allocation* a = new Allocation[size];
+	Extension* e = new Extension[size];
+	for (GlyphIndex i = 0; i < last_count_; i++) {
+	    a[i] = last_allocations_[i];
+	    e[i] = last_extensions_[i];
+	}
+	delete [] last_allocations_;
+	delete [] last_extensions_;
+	last_allocations_ = a;
+	last_extensions_ = e;
+	last_size_ = size;
+    }
+}
+
+void BoxImpl::remember(AllocationInfo& info, Extension* ext, GlyphIndex n) {
+    last_count_ = 0;
+    reserve_last(n);
+    Allocation* a = info.component_allocations();
+    for (GlyphIndex i = 0; i < n; i++) {
+	last_allocations_[i] = a[i];
+	last_extensions_[i] = ext[i];
+    }
+    last_count_ = n;
+    last_canvas_ = info.canvas();
+    last_transformer_ = info.transformer();
+    last_valid_ = true;
 }
 
 void BoxImpl::invalidate() {
     requested_ = false;
     delete allocations_;
     allocations_ = nil;
+    ordered_ = tiled_;
+}
+
+/*
+ * PolyGlyph calls modified for an append, insert, remove, replace or
+ * change at index i; comparing the count with the cached one tells
+ * which.  The cached requisitions and the most recent allocation are
+ * shifted to match, with i marked as changed.  Anything else throws
+ * the caches away.
+ */
+
+static void shift_range(
+    GlyphIndex& begin, GlyphIndex& end, GlyphIndex i, GlyphIndex shift
+) {
+    if (begin != end) {
+	if (begin > i || (shift > 0 && begin == i)) {
+	    begin += shift;
+	}
+	if (end > i) {
+	    end += shift;
+	}
+    }
+}
+
+void BoxImpl::modified(GlyphIndex i) {
+    GlyphIndex n = box_->count();
+    GlyphIndex shift = n - requests_count_;
+    if (requests_count_ == 0 || shift < -1 || shift > 1 || i < 0 ||
+	i >= (shift > 0 ? n : requests_count_)
+    ) {
+	requests_count_ = 0;
+	incremental_ = false;
+	last_valid_ = false;
+	changed_ = changed_end_ = 0;
+	reallocate_ = reallocate_end_ = 0;
+	invalidate();
+	return;
+    }
+    if (last_valid_ && last_count_ != requests_count_) {
+	last_valid_ = false;
+    }
+    if (shift != 0) {
+	GlyphIndex j;
+	reserve(n);
+	if (shift > 0) {
+	    for (j = requests_count_; j > i; j--) {
+		requests_[j] = requests_[j - 1];
+	    }
+	} else {
+	    for (j = i; j < n; j++) {
+		requests_[j] = requests_[j + 1];
+	    }
+	}
+	requests_count_ = n;
+	if (last_valid_) {
+	    reserve_last(n);
+	    if (shift > 0) {
+		for (j = last_count_; j > i; j--) {
+		    last_allocations_[j] = last_allocations_[j - 1];
+		    last_extensions_[j] = last_extensions_[j - 1];
+		}
+	    } else {
+		for (j = i; j < n; j++) {
+		    last_allocations_[j] = last_allocations_[j + 1];
+		    last_extensions_[j] = last_extensions_[j + 1];
+		}
+	    }
+	    last_count_ = n;
+	}
+	shift_range(changed_, changed_end_, i, shift);
+	shift_range(reallocate_, reallocate_end_, i, shift);
+    }
+    if (shift >= 0) {
+	mark(i, i + 1);
+    }
+    incremental_ = true;
+    invalidate();
+}
+
+/*
+ * The allotment of component i along the tiled dimension, counting
+ * from the end for a reversed layout so that allotments always
+ * increase with i.
+ */
+
+const Allotment& BoxImpl::allotment(
+    Allocation* a, GlyphIndex n, GlyphIndex i
+) const {
+    return a[reversed_ ? n - 1 - i : i].allotment(dimension_);
+}
+
+void BoxImpl::check_order(Allocation* a, GlyphIndex n) {
+    for (GlyphIndex i = 1; i < n && ordered_; i++) {
+	const Allotment& prev = allotment(a, n, i - 1);
+	const Allotment& next = allotment(a, n, i);
+	ordered_ = prev.begin() <= next.begin() && prev.end() <= next.end();
+    }
+}
+
+void BoxImpl::note_extension(
+    Canvas* c, const Allocation& a, const Extension& child
+) {
+    if (ordered_ && child.left() <= child.right()) {
+	Coord lo, hi;
+	if (span(c, child, lo, hi)) {
+	    const Allotment& aa = a.allotment(dimension_);
+	    overhang_ = Math::max(
+		overhang_, Math::max(aa.begin() - lo, hi - aa.end())
+	    );
+	} else {
+	    ordered_ = false;
+	}
+    }
+}
+
+/*
+ * Convert an extension on the canvas back into the box's coordinates
+ * and return its span along the tiled dimension.  False if the canvas
+ * is rotated, since the span then depends on the other dimension too.
+ */
+
+boolean BoxImpl::span(
+    Canvas* c, const Extension& e, Coord& lo, Coord& hi
+) const {
+    Coord x1 = e.left(), y1 = e.bottom();
+    Coord x2 = e.right(), y2 = e.top();
+    if (c != nil && !c->transformer().identity()) {
+	const Transformer& t = c->transformer();
+	float a00, a01, a10, a11, a20, a21;
+	t.matrix(a00, a01, a10, a11, a20, a21);
+	if (a01 != 0 || a10 != 0) {
+	    return false;
+	}
+	t.inverse_transform(x1, y1);
+	t.inverse_transform(x2, y2);
+    }
+    if (dimension_ == Dimension_X) {
+	lo = Math::min(x1, x2);
+	hi = Math::max(x1, x2);
+    } else {
+	lo = Math::min(y1, y2);
+	hi = Math::max(y1, y2);
+    }
+    return true;
+}
+
+/*
+ * Binary search for the components whose allotments overlap lo to hi,
+ * returned as the index range first up to end.  If closed, a component
+ * beginning at hi counts as overlapping.
+ */
+
+void BoxImpl::range(
+    Allocation* a, GlyphIndex n, Coord lo, Coord hi, boolean closed,
+    GlyphIndex& first, GlyphIndex& end
+) const {
+    lo -= overhang_;
+    hi += overhang_;
+    GlyphIndex low = 0, high = n;
+    while (low < high) {
+	GlyphIndex mid = (low + high) / 2;
+	if (allotment(a, n, mid).end() > lo) {
+	    high = mid;
+	} else {
+	    low = mid + 1;
+	}
+    }
+    GlyphIndex f = low;
+    high = n;
+    while (low < high) {
+	GlyphIndex mid = (low + high) / 2;
+	Coord begin = allotment(a, n, mid).begin();
+	if (closed ? begin > hi : begin >= hi) {
+	    high = mid;
+	} else {
+	    low = mid + 1;
+	}
+    }
+    if (reversed_) {
+	first = n - low;
+	end = n - f;
+    } else {
+	first = f;
+	end = low;
+    }
+}
+
+boolean BoxImpl::damaged_range(
+    Canvas* c, AllocationInfo& info, GlyphIndex& first, GlyphIndex& end
+) {
+    if (!ordered_) {
+	return false;
+    }
+    Extension damage;
+    c->damage_area(damage);
+    Coord lo, hi;
+    if (!span(c, damage, lo, hi)) {
+	return false;
+    }
+    GlyphIndex n = end;
+    range(info.component_allocations(), n, lo, hi, false, first, end);
+    return true;
+}
+
+boolean BoxImpl::hit_range(
+    const Hit& h, AllocationInfo& info, GlyphIndex& first, GlyphIndex& end
+) {
+    if (!ordered_) {
+	return false;
+    }
+    GlyphIndex n = end;
+    Allocation* a = info.component_allocations();
+    if (dimension_ == Dimension_X) {
+	range(a, n, h.left(), h.right(), true, first, end);
+    } else {
+	range(a, n, h.bottom(), h.top(), true, first, end);
+    }
+    return true;
 }
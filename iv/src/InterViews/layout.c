@@ -48,6 +48,14 @@ void Layout::allocate(
     const Allocation&, GlyphIndex, const Requisition*, Allocation*
 ) { }
 
+/*
+ * A layout that places its components one after another along a
+ * dimension, in index order or in reverse, says so here so that a box
+ * can search the component allocations rather than visit them all.
+ */
+
+boolean Layout::tiled(DimensionName&, boolean&) const { return false; }
+
 /*
  * LayoutKit -- create glyphs for layout
  */
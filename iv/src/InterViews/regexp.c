@@ -55,7 +55,9 @@ static void regerror(char* s);
 static int regexec(register regexp* prog, register char* string);
 static int regtry(regexp* prog, char* string);
 static int regmatch(char* prog);
+static int regmemo(char* prog);
 static int regrepeat(char* p);
+static void regfirstset(regexp* r, char* scan);
 
 
 inline char *
@@ -115,10 +117,7 @@ int Regexp::Search (const char* text, int length, int index, int range) {
 	    return -1;
     }
 
-    if (c_pattern)
-	delete c_pattern;
-
-    if ((c_pattern = regcomp(pattern_)) == nil)
+    if (c_pattern == nil && (c_pattern = regcomp(pattern_)) == nil)
 	return -1;
 
     c_pattern->startp[0] = nil;
@@ -188,15 +187,14 @@ int Regexp::Search (const char* text, int length, int index, int range) {
     *searchLimit = save;
     c_pattern->textStart = (char *) text;
 
+    if (c_pattern->startp[0] == nil)
+	return -1;
     return c_pattern->startp[0] - c_pattern->textStart;
 }
 
 int Regexp::Match (const char* text, int length, int index) {
 
-    if (c_pattern)
-	delete c_pattern;
-
-    if ((c_pattern = regcomp(pattern_)) == nil)
+    if (c_pattern == nil && (c_pattern = regcomp(pattern_)) == nil)
 	return -1;
 
     c_pattern->startp[0] = nil;
@@ -263,6 +261,10 @@ int Regexp::EndOfMatch (int subexp) {
  * reganch	is the match anchored (at beginning-of-line only)?
  * regmust	string (pointer into program) that match must include, or nil
  * regmlen	length of regmust string
+ * regprefix	string (pointer into program) that must begin a match, or nil
+ * regplen	length of regprefix string
+ * regfset	is regfirst valid?
+ * regfirst	table of the chars that can begin a match, indexed by char
  *
  * Regstart and reganch permit very fast decisions on suitable starting points
  * for a match, cutting down the work a lot.  Regmust permits fast rejection
@@ -271,7 +273,11 @@ int Regexp::EndOfMatch (int subexp) {
  * potentially expensive (at present, the only such thing detected is * or +
  * at the start of the r.e., which can involve a lot of backup).  Regmlen is
  * supplied because the test in regexec() needs it and regcomp() is computing
- * it anyway.
+ * it anyway.  Regprefix extends regstart to the whole leading literal, so
+ * that candidate starting points are found with strstr() rather than by
+ * trying every occurrence of the first character.  Regfirst does the same
+ * for a leading [] class, possibly repeated with +, so that the general
+ * case only tries positions that could start a match.
  */
 
 /*
@@ -430,15 +436,26 @@ regcomp(char* exp) {
 	r->reganch = 0;
 	r->regmust = nil;
 	r->regmlen = 0;
+	r->regprefix = nil;
+	r->regplen = 0;
+	r->regfset = 0;
 	scan = r->program+1;			/* First BRANCH. */
 	if (OP(regnext(scan)) == END) {		/* Only one top-level choice. */
 		scan = OPERAND(scan);
 
-		/* Starting-point info. */
-		if (OP(scan) == EXACTLY)
+		/*
+		 * Starting-point info.  regatom() never lets a literal
+		 * swallow the character a following *, + or ? applies
+		 * to, so all of a leading EXACTLY must begin a match.
+		 */
+		if (OP(scan) == EXACTLY) {
 			r->regstart = *OPERAND(scan);
-		else if (OP(scan) == BOL)
+			r->regprefix = OPERAND(scan);
+			r->regplen = strlen(OPERAND(scan));
+		} else if (OP(scan) == BOL)
 			r->reganch++;
+		else
+			regfirstset(r, scan);
 
 		/*
 		 * If there's something expensive in the r.e., find the
@@ -464,6 +481,38 @@ regcomp(char* exp) {
 	return(r);
 }
 
+/*
+ - regfirstset - fill in regfirst for a program that starts with scan
+ */
+static void
+regfirstset(regexp* r, char* scan) {
+	register char *opnd;
+
+	if (OP(scan) == PLUS)
+		scan = OPERAND(scan);
+	opnd = OPERAND(scan);
+	switch (OP(scan)) {
+	case ANYOF:
+		memset(r->regfirst, 0, sizeof(r->regfirst));
+		for (; *opnd != '\0'; opnd++)
+			r->regfirst[UCHARAT(opnd)] = 1;
+		break;
+	case ANYBUT:
+		memset(r->regfirst, 1, sizeof(r->regfirst));
+		for (; *opnd != '\0'; opnd++)
+			r->regfirst[UCHARAT(opnd)] = 0;
+		break;
+	case EXACTLY:
+		memset(r->regfirst, 0, sizeof(r->regfirst));
+		r->regfirst[UCHARAT(opnd)] = 1;
+		break;
+	default:
+		return;
+	}
+	r->regfirst[0] = 0;
+	r->regfset = 1;
+}
+
 /*
  - reg - regular expression, i.e. main body or parenthesized thing
  *
@@ -863,6 +912,94 @@ static char *reginput;		/* String-input pointer. */
 static char *regbol;		/* Beginning of input, for ^ check. */
 static char **regstartp;	/* Pointer to startp array. */
 static char **regendp;		/* Ditto for endp. */
+static char *regprogram;	/* Program, for regmemo() node numbers. */
+
+/*
+ * Failure memo for regmatch().  Without backreferences, whether the rest
+ * of the program matches from a given node depends only on that node and
+ * the input position, so a (node, position) pair that failed once fails
+ * every time.  Ordinary searches never look at the memo; once a single
+ * try has taken REGMEMO_STEPS recursive steps, failures are recorded for
+ * the rest of the regexec() call and never re-explored.  That turns the
+ * exponential backtracking of patterns like \(a+\)+b into work bounded
+ * by the program size times the input length.
+ */
+#define	REGMEMO_STEPS	1024
+
+struct regmemo_entry {
+	long pos;
+	int node;		/* -1 if empty */
+};
+
+static regmemo_entry *regmemo_table;
+static unsigned long regmemo_size;	/* Power of two, or 0. */
+static unsigned long regmemo_count;
+static int regmemo_on;
+static long regsteps;		/* regmatch() calls in this try. */
+
+static unsigned long
+regmemo_hash(int node, long pos) {
+	return ((unsigned long)pos * 31 + node) * 2654435761UL;
+}
+
+static void
+regmemo_reset() {
+	if (regmemo_count > 0) {
+		memset(regmemo_table, 0xff, regmemo_size*sizeof(regmemo_entry));
+		regmemo_count = 0;
+	}
+	regmemo_on = 0;
+}
+
+/*
+ - regmemo_find - look up (node, pos), adding it if asked to
+ */
+static int			/* 1 if it was already there */
+regmemo_find(int node, long pos, int add) {
+	register unsigned long i;
+	register regmemo_entry *e;
+
+	if (regmemo_size == 0) {
+		if (!add)
+			return(0);
+		regmemo_size = 1024;
+		regmemo_table = new regmemo_entry[regmemo_size];
+		memset(regmemo_table, 0xff, regmemo_size*sizeof(regmemo_entry));
+	}
+	for (i = regmemo_hash(node, pos);; i++) {
+		e = &regmemo_table[i & (regmemo_size-1)];
+		if (e->node == -1)
+			break;
+		if (e->node == node && e->pos == pos)
+			return(1);
+	}
+	if (!add)
+		return(0);
+	e->node = node;
+	e->pos = pos;
+
+	/* Keep the table at most half full. */
+	if (++regmemo_count*2 > regmemo_size) {
+		regmemo_entry *old = regmemo_table;
+		unsigned long oldsize = regmemo_size;
+
+		regmemo_size *= 2;
+		regmemo_table = new regmemo_entry[regmemo_size];
+		memset(regmemo_table, 0xff, regmemo_size*sizeof(regmemo_entry));
+		for (unsigned long j = 0; j < oldsize; j++) {
+			if (old[j].node == -1)
+				continue;
+			for (i = regmemo_hash(old[j].node, old[j].pos);; i++) {
+				e = &regmemo_table[i & (regmemo_size-1)];
+				if (e->node == -1)
+					break;
+			}
+			*e = old[j];
+		}
+		delete [] old;
+	}
+	return(0);
+}
 
 /*
  - regexec - match a regexp against a string
@@ -884,19 +1021,13 @@ regexec(register regexp* prog, register char* string) {
 	}
 
 	/* If there is a "must appear" string, look for it. */
-	if (prog->regmust != nil) {
-		s = string;
-		while ((s = strchr(s, prog->regmust[0])) != nil) {
-			if (strncmp(s, prog->regmust, prog->regmlen) == 0)
-				break;	/* Found it. */
-			s++;
-		}
-		if (s == nil)	/* Not present. */
-			return(0);
-	}
+	if (prog->regmust != nil && strstr(string, prog->regmust) == nil)
+		return(0);	/* Not present. */
 
 	/* Mark beginning of line for ^ . */
 	regbol = string;
+	regprogram = prog->program;
+	regmemo_reset();
 
 	/* Simplest case:  anchored match need be tried only once. */
 	if (prog->reganch)
@@ -904,13 +1035,31 @@ regexec(register regexp* prog, register char* string) {
 
 	/* Messy cases:  unanchored match. */
 	s = string;
-	if (prog->regstart != '\0')
+	if (prog->regplen > 1)
+		/* We know the literal it must start with. */
+		while ((s = strstr(s, prog->regprefix)) != nil) {
+			if (regtry(prog, s))
+				return(1);
+			s++;
+		}
+	else if (prog->regstart != '\0')
 		/* We know what char it must start with. */
 		while ((s = strchr(s, prog->regstart)) != nil) {
 			if (regtry(prog, s))
 				return(1);
 			s++;
 		}
+	else if (prog->regfset)
+		/* We know which chars it can start with. */
+		for (;;) {
+			while (*s != '\0' && !prog->regfirst[UCHARAT(s)])
+				s++;
+			if (*s == '\0')
+				break;
+			if (regtry(prog, s))
+				return(1);
+			s++;
+		}
 	else
 		/* We don't -- general case. */
 		do {
@@ -934,6 +1083,7 @@ regtry(regexp* prog, char* string) {
 	reginput = string;
 	regstartp = prog->startp;
 	regendp = prog->endp;
+	regsteps = 0;
 
 	sp = prog->startp;
 	ep = prog->endp;
@@ -1029,7 +1179,7 @@ regmatch(char* prog) {
 				no = OP(scan) - OPEN;
 				save = reginput;
 
-				if (regmatch(next)) {
+				if (regmemo(next)) {
 					/*
 					 * Don't set startp if some later
 					 * invocation of the same parentheses
@@ -1057,7 +1207,7 @@ regmatch(char* prog) {
 				no = OP(scan) - CLOSE;
 				save = reginput;
 
-				if (regmatch(next)) {
+				if (regmemo(next)) {
 					/*
 					 * Don't set endp if some later
 					 * invocation of the same parentheses
@@ -1078,7 +1228,7 @@ regmatch(char* prog) {
 				else {
 					do {
 						save = reginput;
-						if (regmatch(OPERAND(scan)))
+						if (regmemo(OPERAND(scan)))
 							return(1);
 						reginput = save;
 						scan = regnext(scan);
@@ -1108,7 +1258,7 @@ regmatch(char* prog) {
 				while (no >= min) {
 					/* If it could work, try it. */
 					if (nextch == '\0' || *reginput == nextch)
-						if (regmatch(next))
+						if (regmemo(next))
 							return(1);
 					/* Couldn't or didn't -- back up. */
 					no--;
@@ -1135,6 +1285,29 @@ regmatch(char* prog) {
 	return(0);
 }
 
+/*
+ - regmemo - regmatch() through the failure memo
+ */
+static int			/* 0 failure, 1 success */
+regmemo(char* prog) {
+	register int node;
+	register long pos;
+
+	if (!regmemo_on) {
+		if (++regsteps <= REGMEMO_STEPS)
+			return(regmatch(prog));
+		regmemo_on = 1;
+	}
+	node = prog - regprogram;
+	pos = reginput - regbol;
+	if (regmemo_find(node, pos, 0))
+		return(0);
+	if (regmatch(prog))
+		return(1);
+	(void) regmemo_find(node, pos, 1);
+	return(0);
+}
+
 /*
  - regrepeat - repeatedly match something simple, report how many
  */
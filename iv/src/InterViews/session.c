@@ -78,6 +78,7 @@ static OptionDesc defoptions[] = {
     { "-motif", "*gui", OptionValueImplicit, "Motif" },
     { "-name", "*name", OptionValueNext },
     { "-nodbuf", "*double_buffered", OptionValueImplicit, "off" },
+    { "-nodisplay", "*nodisplay", OptionValueImplicit, "on" },
     { "-noshape", "*shaped_windows", OptionValueImplicit, "off" },
     { "-openlook", "*gui", OptionValueImplicit, "OpenLook" },
     { "-reverse", "*reverseVideo", OptionValueImplicit, "on" },
@@ -613,13 +614,19 @@ void SessionRep::set_style(Display* d) {
     load_props(s, props_, -5);
     load_app_defaults(s, -5);
     String str;
-    if (d->defaults(str)) {
+    if (d != nil && d->defaults(str)) {
 	s->load_list(str, -5);
     } else {
 	load_path(s, home(), "/.Xdefaults", -5);
     }
     load_environment(s, -5);
-    d->style(s);
+    if (d != nil) {
+	d->style(s);
+    } else {
+	Resource::ref(s);
+	Resource::unref(style_);
+	style_ = s;
+    }
 }
 
 void SessionRep::load_props(
@@ -715,11 +722,20 @@ String* SessionRep::find_name() {
 
 /*
  * Open the default display and initialize its style information.
+ * With -nodisplay (or the nodisplay property) no display is opened,
+ * the session keeps the complete style itself, and default_display()
+ * is nil; this is for batch programs that load, convert or render
+ * documents without a window system.
  */
 
 void SessionRep::init_display(Display* display) {
     String name;
 
+    if (display == nil && style_->value_is_on("nodisplay")) {
+	default_ = nil;
+	set_style(nil);
+	return;
+    }
     if (display != nil) {
         default_ = display;
     } else if (style_->find_attribute(String("display"), name)) {
@@ -65,3 +65,12 @@ void Superpose::allocate(
 	layout_[i]->allocate(given, count, requisition, result);
     }
 }
+
+boolean Superpose::tiled(DimensionName& d, boolean& reversed) const {
+    for (long i = 0; i < count_; ++i) {
+	if (layout_[i]->tiled(d, reversed)) {
+	    return true;
+	}
+    }
+    return false;
+}
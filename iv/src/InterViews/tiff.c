@@ -201,20 +201,19 @@ Raster* TIFFRasterImpl::load(const char* filename) {
     if (raster_ != nil && gt(width, height)) {
 	/* create raster_ from packed image data */
 	r = new Raster(width, height);
+	u_char* row = new u_char[width * 3];
 	for (long i = height - 1; i >= 0; i--) {
-	    u_char* c = (u_char*) (raster_ + i*width);
-	    /* should use a lookup table here */
+	    const u_long* p = raster_ + i*width;
+	    u_char* c = row;
 	    for (long j = 0; j < width; j++) {
-		r->poke(
-		    j, i,
-		    ColorIntensity(float(c[3]) / float(0xff)),
-		    ColorIntensity(float(c[2]) / float(0xff)),
-		    ColorIntensity(float(c[1]) / float(0xff)),
-		    1.0
-		);
-		c += sizeof (u_long);
+		u_long v = *p++;
+		*c++ = (u_char)(v & 0xff);
+		*c++ = (u_char)((v >> 8) & 0xff);
+		*c++ = (u_char)((v >> 16) & 0xff);
 	    }
+	    r->pokerow(0, i, width, row);
 	}
+	delete [] row;
     }
     TIFFClose(tif_);
     delete raster_;
@@ -109,6 +109,12 @@ void Tile::allocate(
     }
 }
 
+boolean Tile::tiled(DimensionName& d, boolean& reversed) const {
+    d = dimension_;
+    reversed = false;
+    return true;
+}
+
 TileReversed::TileReversed(DimensionName d) : Layout() { dimension_ = d; }
 TileReversed::~TileReversed() { }
 
@@ -173,6 +179,12 @@ void TileReversed::allocate(
     }
 }
 
+boolean TileReversed::tiled(DimensionName& d, boolean& reversed) const {
+    d = dimension_;
+    reversed = true;
+    return true;
+}
+
 TileFirstAligned::TileFirstAligned(DimensionName dimension) : Layout() {
     dimension_ = dimension;
 }
@@ -274,6 +286,12 @@ void TileFirstAligned::allocate(
     }
 }
 
+boolean TileFirstAligned::tiled(DimensionName& d, boolean& reversed) const {
+    d = dimension_;
+    reversed = false;
+    return true;
+}
+
 TileReversedFirstAligned::TileReversedFirstAligned(
     DimensionName d
 ) : Layout() {
@@ -376,3 +394,11 @@ void TileReversedFirstAligned::allocate(
         result[index].allot(dimension_, a);
     }
 }
+
+boolean TileReversedFirstAligned::tiled(
+    DimensionName& d, boolean& reversed
+) const {
+    d = dimension_;
+    reversed = true;
+    return true;
+}
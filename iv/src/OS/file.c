@@ -30,7 +30,7 @@
 #include <cstdio>
 #include <sys/stat.h>
 
-#ifdef sgi
+#if defined(sgi) || defined(__linux__)
 #include <sys/mman.h>
 #endif
 
@@ -117,7 +117,7 @@ void File::close() {
     FileInfo* i = rep_;
     if (i->fd_ >= 0) {
 	if (i->map_ != nil) {
-#if defined(sgi) || defined(__alpha)
+#if defined(sgi) || defined(__alpha) || defined(__linux__)
 	    munmap(i->map_, int(i->info_.st_size));
 #endif
 	}
@@ -166,7 +166,7 @@ int InputFile::read(const char*& start) {
     if (i->limit_ != 0 && len > i->limit_) {
 	len = (int)(i->limit_);
     }
-#if defined(sgi) || defined(__alpha)
+#if defined(sgi) || defined(__alpha) || defined(__linux__)
     i->map_ = (char*)mmap(0, len, PROT_READ, MAP_PRIVATE, i->fd_, i->pos_);
     if ((unsigned long)(i->map_) == (unsigned long)-1) {
 	return -1;
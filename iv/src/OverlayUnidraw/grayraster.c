@@ -132,6 +132,39 @@ void GrayRaster::poke(
   rep()->modified_ = true;
 }
 
+void GrayRaster::pokerow(
+    unsigned long x, unsigned long y, unsigned long n,
+    const unsigned char* rgb, unsigned int samples
+) {
+  if (x >= pwidth() || y >= pheight()) return;
+  if (n > pwidth() - x) n = pwidth() - x;
+
+  if (AttributeValue::is_char(value_type())) {
+    unsigned long yloc = 
+      top2bottom() ? y : (unsigned long)rep()->pheight_ - y - 1;
+    unsigned char* dst = _data + rep()->pwidth_ * yloc + x;
+    for (unsigned long i = 0; i < n; i++, rgb += samples)
+      *dst++ = (unsigned char)((299 * rgb[0] + 587 * rgb[1] + 114 * rgb[2]) / 1000);
+    rep()->modified_ = true;
+  }
+  else {
+    for (unsigned long i = 0; i < n; i++, rgb += samples)
+      poke(x + i, y, float(rgb[0])/0xff, float(rgb[1])/0xff, 
+	   float(rgb[2])/0xff, 1.0);
+  }
+}
+
+void GrayRaster::pokerow(
+    unsigned long x, unsigned long y, unsigned long n,
+    const unsigned short* rgb, unsigned int samples
+) {
+  if (x >= pwidth() || y >= pheight()) return;
+  if (n > pwidth() - x) n = pwidth() - x;
+  for (unsigned long i = 0; i < n; i++, rgb += samples)
+    poke(x + i, y, float(rgb[0])/0xffff, float(rgb[1])/0xffff, 
+	 float(rgb[2])/0xffff, 1.0);
+}
+
 
 void GrayRaster::graypeek(unsigned long x, unsigned long y, unsigned int& val)
 {
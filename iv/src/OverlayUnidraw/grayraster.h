@@ -59,6 +59,18 @@ public:
     );
     // Convert 'red','green','blue' to graylevel value using 
     // this equation: 0.299 r + 0.587 g + 0.114 b, then poke at 'x','y'.
+    virtual void pokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned char* rgb, unsigned int samples = 3
+    );
+    // convert 'n' pixels of packed 8-bit samples to graylevel values and
+    // poke them starting at 'x','y'.
+    virtual void pokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned short* rgb, unsigned int samples = 3
+    );
+    // convert 'n' pixels of packed 16-bit samples to graylevel values and
+    // poke them starting at 'x','y'.
 
     virtual void graypeek(unsigned long x, unsigned long y, unsigned int& v);
     // convert value of value_type() at 'x','y' to an unsigned int.
@@ -140,6 +152,10 @@ public:
     void set_minmax(double minval, double maxval, boolean fixminmax = false); 
     // set 'minval' and 'maxval' used for flush().
 
+    unsigned char* data() const { return _data; }
+    // raw pixel data of value_type(), pwidth() values to a row, rows in
+    // storage order (see top2bottom()).
+
 protected:
     void init(AttributeValue::ValueType type =AttributeValue::UCharType,
 	      void* data=nil);
@@ -78,7 +78,8 @@ ParamList* ArrowMultiLineOvComp::_ovarrow_multiline_params = nil;
 ParamList* ArrowSplineOvComp::_ovarrow_spline_params = nil;
 int ArrowLineOvComp::_symid = -1;
 
-ArrowLineOvComp::ArrowLineOvComp (ArrowLine* graphic) : LineOvComp(graphic) { }
+ArrowLineOvComp::ArrowLineOvComp (ArrowLine* graphic, OverlayComp* parent)
+: LineOvComp(graphic, parent) { }
 
 ArrowLineOvComp::ArrowLineOvComp(istream& in, OverlayComp* parent) 
 : LineOvComp(nil, parent) {
@@ -436,7 +437,8 @@ int ArrowLineScript::ReadTail (istream& in, void* addr1, void* addr2, void* addr
 
 int ArrowMultiLineOvComp::_symid = -1;
 
-ArrowMultiLineOvComp::ArrowMultiLineOvComp (ArrowMultiLine* g) : MultiLineOvComp(g){}
+ArrowMultiLineOvComp::ArrowMultiLineOvComp (ArrowMultiLine* g, OverlayComp* parent)
+: MultiLineOvComp(g, parent) {}
 
 ArrowMultiLineOvComp::ArrowMultiLineOvComp(istream& in, OverlayComp* parent) 
 : MultiLineOvComp(nil, parent) {
@@ -873,7 +875,8 @@ int ArrowMultiLineScript::ReadTail (istream& in, void* addr1, void* addr2,
 
 int ArrowSplineOvComp::_symid = -1;
 
-ArrowSplineOvComp::ArrowSplineOvComp (ArrowOpenBSpline* g) : SplineOvComp(g) {}
+ArrowSplineOvComp::ArrowSplineOvComp (ArrowOpenBSpline* g, OverlayComp* parent)
+: SplineOvComp(g, parent) {}
 
 
 ArrowSplineOvComp::ArrowSplineOvComp(istream& in, OverlayComp* parent) 
@@ -41,7 +41,7 @@ class ParamList;
 //: clone of ArrowLineComp derived from OverlayComp.
 class ArrowLineOvComp : public LineOvComp {
 public:
-    ArrowLineOvComp(ArrowLine* = nil);
+    ArrowLineOvComp(ArrowLine* = nil, OverlayComp* parent = nil);
     ArrowLineOvComp(istream&, OverlayComp* parent = nil);
 
     ArrowLine* GetArrowLine();
@@ -120,7 +120,7 @@ public:
 //: clone of ArrowMultiLineComp derived from OverlayComp.
 class ArrowMultiLineOvComp : public MultiLineOvComp {
 public:
-    ArrowMultiLineOvComp(ArrowMultiLine* = nil);
+    ArrowMultiLineOvComp(ArrowMultiLine* = nil, OverlayComp* parent = nil);
     ArrowMultiLineOvComp(istream&, OverlayComp* parent = nil);
 
     ArrowMultiLine* GetArrowMultiLine();
@@ -203,7 +203,7 @@ protected:
 //: clone of ArrowSplineComp derived from OverlayComp.
 class ArrowSplineOvComp : public SplineOvComp {
 public:
-    ArrowSplineOvComp(ArrowOpenBSpline* = nil);
+    ArrowSplineOvComp(ArrowOpenBSpline* = nil, OverlayComp* parent = nil);
     ArrowSplineOvComp(istream&, OverlayComp* parent = nil);
 
     ArrowOpenBSpline* GetArrowOpenBSpline();
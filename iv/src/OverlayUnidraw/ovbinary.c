@@ -0,0 +1,1091 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayBinary implementation.
+ */
+
+#include <OverlayUnidraw/ovarrow.h>
+#include <OverlayUnidraw/ovbinary.h>
+#include <OverlayUnidraw/ovcatalog.h>
+#include <OverlayUnidraw/ovclasses.h>
+#include <OverlayUnidraw/ovcomps.h>
+#include <OverlayUnidraw/ovellipse.h>
+#include <OverlayUnidraw/ovline.h>
+#include <OverlayUnidraw/ovpolygon.h>
+#include <OverlayUnidraw/ovraster.h>
+#include <OverlayUnidraw/ovrect.h>
+#include <OverlayUnidraw/ovspline.h>
+#include <OverlayUnidraw/ovtext.h>
+#include <OverlayUnidraw/ovunidraw.h>
+#include <OverlayUnidraw/paramlist.h>
+#include <OverlayUnidraw/scriptview.h>
+
+#include <UniIdraw/idarrows.h>
+
+#include <Unidraw/iterator.h>
+#include <Unidraw/unidraw.h>
+#include <Unidraw/Components/text.h>
+#include <Unidraw/Graphic/ellipses.h>
+#include <Unidraw/Graphic/lines.h>
+#include <Unidraw/Graphic/picture.h>
+#include <Unidraw/Graphic/polygons.h>
+#include <Unidraw/Graphic/pspaint.h>
+#include <Unidraw/Graphic/splines.h>
+#include <Unidraw/Graphic/verts.h>
+
+#include <Attribute/attrlist.h>
+
+#include <InterViews/transformer.h>
+
+#include <OS/file.h>
+#include <OS/math.h>
+#include <OS/string.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <strstream>
+
+/*****************************************************************************/
+
+/*
+ * File layout.  Everything is written in the byte order of the machine
+ * that wrote it; a reader on a machine of the other order refuses the
+ * file rather than swapping.  Sections start on 8-byte boundaries and
+ * hold only ints, floats and bytes, so records can be used in place.
+ */
+
+static const char ovbin_magic[8] = { 'I', 'V', 'D', 'R', 'A', 'W', 'B', '\n' };
+static const int ovbin_version = 1;
+static const int ovbin_byteorder = 0x01020304;
+static const size_t ovbin_maxsize = 0x7fffffff;    /* InputFile::read's limit */
+static const char* ovbin_suffix = ".dtb";
+
+enum {
+    OVB_STRINGS, OVB_GSTATES, OVB_POINTS, OVB_RASTERS, OVB_COMPS, OVB_TOPS,
+    OVB_NSECTIONS
+};
+
+struct OvBinSection {
+    unsigned int offset;        /* a multiple of 8 */
+    unsigned int size;          /* not counting the padding to the next */
+};
+
+struct OvBinHeader {
+    char magic[8];
+    int version;
+    int byteorder;
+    OvBinSection sections[OVB_NSECTIONS];
+};
+
+/* states of the brush, color and pattern fields of a graphic state */
+enum { OVB_UNDEF, OVB_NONE, OVB_SET, OVB_GRAY };
+
+struct OvBinColor {
+    int state;
+    int name;                   /* string offset */
+    float r, g, b;
+};
+
+struct OvBinGS {
+    int fillbg;
+    int brush;
+    int linepat;
+    float width;
+    OvBinColor fg, bg;
+    int font;                   /* string offsets, -1 if no font */
+    int printfont;
+    int printsize;
+    int pattern;
+    float graylevel;
+    int patsize;
+    int patdata[patternHeight];
+};
+
+enum {
+    OVB_DRAWING, OVB_GROUP, OVB_LINE, OVB_ARROWLINE, OVB_MULTILINE,
+    OVB_ARROWMULTILINE, OVB_SPLINE, OVB_ARROWSPLINE, OVB_CLOSEDSPLINE,
+    OVB_POLYGON, OVB_RECT, OVB_ELLIPSE, OVB_TEXT, OVB_RASTER, OVB_SCRIPT
+};
+
+static const int OVB_XFORM = 0x1;
+static const int OVB_HEAD = 0x2;
+static const int OVB_TAIL = 0x4;
+static const int OVB_GRAYRASTER = 0x8;
+
+/*
+ * One record per component in preorder.  The meaning of a[] depends
+ * on type:
+ *   line, rect:      x0, y0, x1, y1
+ *   ellipse:         x, y, r1, r2
+ *   vertex types:    first Coord in the points section, count
+ *                    (count x's followed by count y's)
+ *   text:            string offset, line height
+ *   raster:          byte offset in the rasters section, width, height
+ *   script:          string offset of the component's script text
+ */
+
+struct OvBinComp {
+    int type;
+    int subtree;                /* records in this subtree, itself included */
+    int gs;                     /* graphic state index, -1 for none */
+    int flags;
+    float xform[6];
+    float scale;                /* arrowhead scale */
+    int extras;                 /* string offset of annotation and attributes */
+    int a[4];
+};
+
+/*****************************************************************************/
+
+class OvBinBuffer {
+public:
+    OvBinBuffer();
+    ~OvBinBuffer();
+
+    size_t Append(const void*, size_t);
+    // append bytes, returning the offset they were stored at.  Bytes that
+    // would take the buffer past ovbin_maxsize are dropped and mark it full.
+    void Pad(int);
+    // zero-fill up to a multiple of the given alignment.
+
+    char* Data() { return _data; }
+    size_t Size() { return _size; }
+    boolean Full() { return _full; }
+private:
+    char* _data;
+    size_t _size;
+    size_t _cap;
+    boolean _full;
+};
+
+OvBinBuffer::OvBinBuffer () {
+    _data = nil;
+    _size = _cap = 0;
+    _full = false;
+}
+
+OvBinBuffer::~OvBinBuffer () { delete [] _data; }
+
+size_t OvBinBuffer::Append (const void* p, size_t n) {
+    if (n > ovbin_maxsize - _size) {
+        _full = true;
+        return 0;
+    }
+    if (_size + n > _cap) {
+        size_t cap = _cap ? _cap : 1024;
+        while (cap < _size + n) {
+            cap *= 2;
+        }
+        char* data = new char[cap];
+        if (_size) {
+            memcpy(data, _data, _size);
+        }
+        delete [] _data;
+        _data = data;
+        _cap = cap;
+    }
+    size_t offset = _size;
+    memcpy(_data + _size, p, n);
+    _size += n;
+    return offset;
+}
+
+void OvBinBuffer::Pad (int align) {
+    static const char zeros[8] = { 0 };
+    int n = (align - _size % align) % align;
+    if (n) {
+        Append(zeros, n);
+    }
+}
+
+/*
+ * OvBinHash maps a key to every value added under it, so callers can
+ * compare candidates themselves.
+ */
+
+struct OvBinEntry {
+    unsigned long key;
+    int value;
+    int next;
+};
+
+static const int ovbin_buckets = 4096;
+
+class OvBinHash {
+public:
+    OvBinHash();
+
+    int Find(unsigned long key);
+    int Next(int entry);
+    int Value(int entry) { return Entry(entry).value; }
+    void Add(unsigned long key, int value);
+private:
+    OvBinEntry& Entry(int e) { return ((OvBinEntry*)_entries.Data())[e]; }
+
+    int _buckets[ovbin_buckets];
+    OvBinBuffer _entries;
+};
+
+OvBinHash::OvBinHash () {
+    for (int i = 0; i < ovbin_buckets; ++i) {
+        _buckets[i] = -1;
+    }
+}
+
+int OvBinHash::Find (unsigned long key) {
+    int e = _buckets[key % ovbin_buckets];
+    while (e >= 0 && Entry(e).key != key) {
+        e = Entry(e).next;
+    }
+    return e;
+}
+
+int OvBinHash::Next (int e) {
+    unsigned long key = Entry(e).key;
+    e = Entry(e).next;
+    while (e >= 0 && Entry(e).key != key) {
+        e = Entry(e).next;
+    }
+    return e;
+}
+
+void OvBinHash::Add (unsigned long key, int value) {
+    OvBinEntry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.next = _buckets[key % ovbin_buckets];
+    int e = _entries.Size() / sizeof(OvBinEntry);
+    _entries.Append(&entry, sizeof(entry));
+    if (!_entries.Full()) {
+        _buckets[key % ovbin_buckets] = e;
+    }
+}
+
+static unsigned long ovbin_hash (const char* p, int n) {
+    unsigned long h = 5381;
+    for (int i = 0; i < n; ++i) {
+        h = h * 33 + (unsigned char)p[i];
+    }
+    return h;
+}
+
+/*****************************************************************************/
+
+class OvBinWriter {
+public:
+    boolean Write(OverlayComp*, const char* path);
+protected:
+    void Comp(OverlayComp*, boolean top);
+    int Type(OverlayComp*);
+    int String(const char*);
+    int Text(const char*);
+    int GS(Graphic*);
+    void Color(PSColor*, OvBinColor&);
+    int Points(Graphic*, int& count);
+    int Raster(OverlayRaster*, boolean gray);
+    int Extras(OverlayComp*);
+    int Script(OverlayComp*);
+
+    OvBinBuffer _strings;
+    OvBinBuffer _gstates;
+    OvBinBuffer _points;
+    OvBinBuffer _rasters;
+    OvBinBuffer _comps;
+    OvBinBuffer _tops;
+
+    OvBinHash _strhash;
+    OvBinHash _gshash;
+    OvBinHash _ptshash;
+};
+
+int OvBinWriter::Type (OverlayComp* comp) {
+    switch (comp->GetClassId()) {
+    case OVERLAY_IDRAW_COMP:    return OVB_DRAWING;
+    case OVERLAYS_COMP:         return OVB_GROUP;
+    case OVLINE_COMP:           return OVB_LINE;
+    case OVARROWLINE_COMP:      return OVB_ARROWLINE;
+    case OVMULTILINE_COMP:      return OVB_MULTILINE;
+    case OVARROWMULTILINE_COMP: return OVB_ARROWMULTILINE;
+    case OVSPLINE_COMP:         return OVB_SPLINE;
+    case OVARROWSPLINE_COMP:    return OVB_ARROWSPLINE;
+    case OVCLOSEDSPLINE_COMP:   return OVB_CLOSEDSPLINE;
+    case OVPOLYGON_COMP:        return OVB_POLYGON;
+    case OVRECT_COMP:           return OVB_RECT;
+    case OVELLIPSE_COMP:        return OVB_ELLIPSE;
+    case OVTEXT_COMP:           return OVB_TEXT;
+    case OVRASTER_COMP: {
+        /*
+         * only rasters whose pixels are the whole story; anything read by
+         * pathname, typed gray data, alpha, subimages or image commands
+         * keeps its script form.
+         */
+        RasterOvComp* rcomp = (RasterOvComp*) comp;
+        OverlayRasterRect* rr = rcomp->GetOverlayRasterRect();
+        OverlayRaster* raster = rr ? rr->GetOverlayRaster() : nil;
+        if (
+            raster != nil && raster->initialized() && !raster->grayraster() &&
+            !(rcomp->GetByPathnameFlag() && rcomp->GetPathName()) &&
+            rr->alphaval() == 1.0 && rr->xbeg() < 0 && rr->xend() < 0 &&
+            rr->ybeg() < 0 && rr->yend() < 0 && rcomp->_commands.count() == 0
+        ) {
+            return OVB_RASTER;
+        }
+        return OVB_SCRIPT;
+    }
+    default:                    return OVB_SCRIPT;
+    }
+}
+
+int OvBinWriter::String (const char* s) {
+    if (s == nil) {
+        return -1;
+    }
+    int n = strlen(s) + 1;
+    unsigned long key = ovbin_hash(s, n);
+    for (int e = _strhash.Find(key); e >= 0; e = _strhash.Next(e)) {
+        int offset = _strhash.Value(e);
+        if (strcmp(_strings.Data() + offset, s) == 0) {
+            return offset;
+        }
+    }
+    int offset = _strings.Append(s, n);
+    _strhash.Add(key, offset);
+    return offset;
+}
+
+int OvBinWriter::Text (const char* s) {
+    return s == nil ? -1 : _strings.Append(s, strlen(s) + 1);
+}
+
+void OvBinWriter::Color (PSColor* color, OvBinColor& rec) {
+    if (color == nil) {
+        rec.state = OVB_UNDEF;
+        rec.name = -1;
+    } else {
+        ColorIntensity r, g, b;
+        color->GetIntensities(r, g, b);
+        rec.state = OVB_SET;
+        rec.name = String(color->GetName());
+        rec.r = r;
+        rec.g = g;
+        rec.b = b;
+    }
+}
+
+int OvBinWriter::GS (Graphic* g) {
+    OvBinGS rec;
+    memset(&rec, 0, sizeof(rec));
+
+    rec.fillbg = g->BgFilled();
+
+    PSBrush* brush = g->GetBrush();
+    if (brush == nil) {
+        rec.brush = OVB_UNDEF;
+    } else if (brush->None()) {
+        rec.brush = OVB_NONE;
+    } else {
+        rec.brush = OVB_SET;
+        rec.linepat = brush->GetLinePattern();
+        rec.width = brush->width();
+    }
+
+    Color(g->GetFgColor(), rec.fg);
+    Color(g->GetBgColor(), rec.bg);
+
+    PSFont* font = g->GetFont();
+    if (font == nil) {
+        rec.font = rec.printfont = rec.printsize = -1;
+    } else {
+        rec.font = String(font->GetName());
+        rec.printfont = String(font->GetPrintFont());
+        rec.printsize = String(font->GetPrintSize());
+    }
+
+    PSPattern* pat = g->GetPattern();
+    if (pat == nil) {
+        rec.pattern = OVB_UNDEF;
+    } else if (pat->None()) {
+        rec.pattern = OVB_NONE;
+    } else if (pat->GetSize() > 0) {
+        /* 8x8 patterns are kept as 8 bytes, as the script writes them */
+        const int* data = pat->GetData();
+        rec.pattern = OVB_SET;
+        rec.patsize = pat->GetSize() <= 8 ? 8 : patternHeight;
+        for (int i = 0; i < rec.patsize; ++i) {
+            rec.patdata[i] = rec.patsize == 8 ? data[i] & 0xff : data[i];
+        }
+    } else {
+        rec.pattern = OVB_GRAY;
+        rec.graylevel = pat->GetGrayLevel();
+    }
+
+    unsigned long key = ovbin_hash((const char*)&rec, sizeof(rec));
+    for (int e = _gshash.Find(key); e >= 0; e = _gshash.Next(e)) {
+        int index = _gshash.Value(e);
+        OvBinGS* other = (OvBinGS*)_gstates.Data() + index;
+        if (memcmp(other, &rec, sizeof(rec)) == 0) {
+            return index;
+        }
+    }
+    int index = _gstates.Size() / sizeof(OvBinGS);
+    _gstates.Append(&rec, sizeof(rec));
+    _gshash.Add(key, index);
+    return index;
+}
+
+/*
+ * Points are shared by MultiLineObj, so drawings written with compacted
+ * point lists keep a single copy of each list.  They are the original
+ * points, which for open splines leave out the copies of the end points
+ * kept in the MultiLineObj, and 'count' is set to their number.
+ */
+
+int OvBinWriter::Points (Graphic* g, int& count) {
+    const Coord* x;
+    const Coord* y;
+    count = ((Vertices*) g)->GetOriginal(x, y);
+    unsigned long key = (unsigned long) x;
+
+    int e = _ptshash.Find(key);
+    if (e >= 0) {
+        return _ptshash.Value(e);
+    }
+    int index = _points.Size() / sizeof(int);
+    for (int i = 0; i < count; ++i) {
+        int c = int(x[i]);
+        _points.Append(&c, sizeof(c));
+    }
+    for (int i = 0; i < count; ++i) {
+        int c = int(y[i]);
+        _points.Append(&c, sizeof(c));
+    }
+    _ptshash.Add(key, index);
+    return index;
+}
+
+int OvBinWriter::Raster (OverlayRaster* raster, boolean gray) {
+    unsigned int w = raster->Width();
+    unsigned int h = raster->Height();
+    unsigned char* row = new unsigned char[w * 3];
+    int offset = _rasters.Size();
+
+    /* gray rasters keep the green sample, as graypeek does */
+    for (unsigned int y = 0; y < h; ++y) {
+        raster->peekrow(0, y, w, row, 3);
+        if (gray) {
+            for (unsigned int x = 0; x < w; ++x) {
+                row[x] = row[x*3+1];
+            }
+        }
+        _rasters.Append(row, gray ? w : w * 3);
+    }
+    _rasters.Pad(8);
+    delete [] row;
+    return offset;
+}
+
+/*
+ * Annotation and attributes are stored as the keyword text the script
+ * writes for them, in parentheses so the OverlayComp istream
+ * constructor can read them back.
+ */
+
+int OvBinWriter::Extras (OverlayComp* comp) {
+    const char* anno = comp->GetAnnotation();
+    AttributeList* al = comp->attrlist();
+
+    if (anno == nil && (al == nil || al->Number() == 0)) {
+        return -1;
+    }
+    std::ostrstream out;
+    out << "(";
+    if (anno != nil) {
+        out << " :annotation ";
+        ParamList::output_text(out, anno);
+    }
+    if (al != nil && !((OverlayUnidraw*)unidraw)->PrintAttributeList(out, al)) {
+        out << *al;
+    }
+    out << ")" << std::ends;
+    int offset = Text(out.str());
+    out.freeze(0);
+    return offset;
+}
+
+int OvBinWriter::Script (OverlayComp* comp) {
+    OverlayScript* sv = (OverlayScript*) comp->Create(SCRIPT_VIEW);
+    if (sv == nil) {
+        return -1;
+    }
+    comp->Attach(sv);
+    sv->Update();
+
+    std::ostrstream out;
+    boolean ok = sv->Definition(out);
+    out << std::ends;
+    int offset = ok ? Text(out.str()) : -1;
+    out.freeze(0);
+    delete sv;
+    return offset;
+}
+
+void OvBinWriter::Comp (OverlayComp* comp, boolean top) {
+    OvBinComp rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = Type(comp);
+    rec.gs = rec.extras = -1;
+
+    if (rec.type == OVB_SCRIPT) {
+        rec.a[0] = Script(comp);
+        if (rec.a[0] < 0) {
+            fprintf(stderr, "OvBinWriter: no script for component, skipped\n");
+            return;
+        }
+    } else {
+        Graphic* g = comp->GetGraphic();
+        rec.gs = GS(g);
+        rec.extras = Extras(comp);
+
+        Transformer* t = g->GetTransformer();
+        Transformer identity;
+        if (t != nil && *t != identity) {
+            rec.flags |= OVB_XFORM;
+            t->GetEntries(
+                rec.xform[0], rec.xform[1], rec.xform[2],
+                rec.xform[3], rec.xform[4], rec.xform[5]
+            );
+        }
+
+        switch (rec.type) {
+        case OVB_LINE:
+        case OVB_ARROWLINE: {
+            Coord x0, y0, x1, y1;
+            ((Line*) g)->GetOriginal(x0, y0, x1, y1);
+            rec.a[0] = x0; rec.a[1] = y0; rec.a[2] = x1; rec.a[3] = y1;
+            if (rec.type == OVB_ARROWLINE) {
+                ArrowLine* arrow = (ArrowLine*) g;
+                rec.flags |= arrow->Head() ? OVB_HEAD : 0;
+                rec.flags |= arrow->Tail() ? OVB_TAIL : 0;
+                rec.scale = arrow->ArrowScale();
+            }
+            break;
+        }
+        case OVB_ARROWMULTILINE: {
+            ArrowMultiLine* arrow = (ArrowMultiLine*) g;
+            rec.flags |= arrow->Head() ? OVB_HEAD : 0;
+            rec.flags |= arrow->Tail() ? OVB_TAIL : 0;
+            rec.scale = arrow->ArrowScale();
+            rec.a[0] = Points(g, rec.a[1]);
+            break;
+        }
+        case OVB_ARROWSPLINE: {
+            ArrowOpenBSpline* arrow = (ArrowOpenBSpline*) g;
+            rec.flags |= arrow->Head() ? OVB_HEAD : 0;
+            rec.flags |= arrow->Tail() ? OVB_TAIL : 0;
+            rec.scale = arrow->ArrowScale();
+            rec.a[0] = Points(g, rec.a[1]);
+            break;
+        }
+        case OVB_MULTILINE:
+        case OVB_SPLINE:
+        case OVB_CLOSEDSPLINE:
+        case OVB_POLYGON:
+            rec.a[0] = Points(g, rec.a[1]);
+            break;
+        case OVB_RECT: {
+            Coord l, b, r, t;
+            ((SF_Rect*) g)->GetOriginal(l, b, r, t);
+            rec.a[0] = l; rec.a[1] = b; rec.a[2] = r; rec.a[3] = t;
+            break;
+        }
+        case OVB_ELLIPSE: {
+            Coord x, y;
+            int r1, r2;
+            ((SF_Ellipse*) g)->GetOriginal(x, y, r1, r2);
+            rec.a[0] = x; rec.a[1] = y; rec.a[2] = r1; rec.a[3] = r2;
+            break;
+        }
+        case OVB_TEXT: {
+            TextGraphic* text = (TextGraphic*) g;
+            rec.a[0] = Text(text->GetOriginal());
+            rec.a[1] = text->GetLineHeight();
+            break;
+        }
+        case OVB_RASTER: {
+            OverlayRaster* raster =
+                ((RasterOvComp*) comp)->GetOverlayRasterRect()->GetOverlayRaster();
+            boolean gray = raster->gray_flag();
+            rec.flags |= gray ? OVB_GRAYRASTER : 0;
+            rec.a[0] = Raster(raster, gray);
+            rec.a[1] = raster->Width();
+            rec.a[2] = raster->Height();
+            break;
+        }
+        }
+    }
+
+    int index = _comps.Size() / sizeof(OvBinComp);
+    if (top) {
+        _tops.Append(&index, sizeof(index));
+    }
+    _comps.Append(&rec, sizeof(rec));
+
+    if (rec.type == OVB_DRAWING || rec.type == OVB_GROUP) {
+        static int readonly_symval = symbol_add("readonly");
+        Iterator i;
+        for (comp->First(i); !comp->Done(i); comp->Next(i)) {
+            OverlayComp* child = (OverlayComp*) comp->GetComp(i);
+            AttributeList* al = child->attrlist();
+            AttributeValue* av = al ? al->find(readonly_symval) : nil;
+            if (av == nil || !av->is_true()) {
+                Comp(child, rec.type == OVB_DRAWING);
+            }
+        }
+    }
+    OvBinComp* recs = (OvBinComp*) _comps.Data();
+    recs[index].subtree = _comps.Size() / sizeof(OvBinComp) - index;
+}
+
+boolean OvBinWriter::Write (OverlayComp* comp, const char* path) {
+    if (Type(comp) != OVB_DRAWING) {
+        return false;
+    }
+    Comp(comp, false);
+
+    OvBinBuffer* sections[OVB_NSECTIONS];
+    sections[OVB_STRINGS] = &_strings;
+    sections[OVB_GSTATES] = &_gstates;
+    sections[OVB_POINTS] = &_points;
+    sections[OVB_RASTERS] = &_rasters;
+    sections[OVB_COMPS] = &_comps;
+    sections[OVB_TOPS] = &_tops;
+
+    OvBinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ovbin_magic, sizeof(header.magic));
+    header.version = ovbin_version;
+    header.byteorder = ovbin_byteorder;
+
+    /* sizes leave out the padding, which would read as extra records */
+    size_t offset = sizeof(header);    /* a multiple of 8 */
+    boolean fits = true;
+    for (int s = 0; s < OVB_NSECTIONS; ++s) {
+        header.sections[s].offset = offset;
+        header.sections[s].size = sections[s]->Size();
+        sections[s]->Pad(8);
+        fits = fits && !sections[s]->Full() &&
+            sections[s]->Size() <= ovbin_maxsize - offset;
+        offset += fits ? sections[s]->Size() : 0;
+    }
+    if (!fits) {
+        fprintf(stderr, "%s: drawing too large for a binary drawing\n", path);
+        return false;
+    }
+
+    FILE* f = fopen(path, "w");
+    if (f == nil) {
+        return false;
+    }
+    boolean ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (int s = 0; ok && s < OVB_NSECTIONS; ++s) {
+        size_t size = sections[s]->Size();
+        ok = size == 0 || fwrite(sections[s]->Data(), size, 1, f) == 1;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+/*****************************************************************************/
+
+OverlayBinary::OverlayBinary () {
+    _file = nil;
+    _gs = nil;
+    Close();
+}
+
+OverlayBinary::~OverlayBinary () { Close(); }
+
+void OverlayBinary::Close () {
+    if (_gs != nil) {
+        for (int i = 0; i < _ngs; ++i) {
+            delete _gs[i];
+        }
+        delete [] _gs;
+    }
+    delete _file;
+    _file = nil;
+    _gs = nil;
+    _strings = nil;
+    _gsrecs = nil;
+    _points = nil;
+    _rasters = nil;
+    _comps = nil;
+    _tops = nil;
+    _nstrings = _ngs = _npoints = _nrasters = _ncomps = _ntops = 0;
+}
+
+boolean OverlayBinary::Open (const char* path) {
+    Close();
+    _file = InputFile::open(String(path));
+    const char* start = nil;
+    int len = (_file == nil) ? -1 : _file->read(start);
+
+    const OvBinHeader* header = (const OvBinHeader*) start;
+    boolean ok = len >= int(sizeof(OvBinHeader)) &&
+        memcmp(header->magic, ovbin_magic, sizeof(ovbin_magic)) == 0;
+    if (ok && header->byteorder != ovbin_byteorder) {
+        fprintf(stderr, "%s: binary drawing written with other byte order\n", path);
+        ok = false;
+    }
+    if (ok && header->version > ovbin_version) {
+        fprintf(stderr, "%s: binary drawing version %d ", path, header->version);
+        fprintf(stderr, "newer than version %d\n", ovbin_version);
+        ok = false;
+    }
+    for (int s = 0; ok && s < OVB_NSECTIONS; ++s) {
+        const OvBinSection& sect = header->sections[s];
+        ok = sect.offset % 8 == 0 && sect.offset <= (unsigned int)len &&
+            sect.size <= (unsigned int)len - sect.offset;
+    }
+    if (ok) {
+        const OvBinSection* sect = header->sections;
+        _strings = start + sect[OVB_STRINGS].offset;
+        _nstrings = sect[OVB_STRINGS].size;
+        _gsrecs = (const OvBinGS*)(start + sect[OVB_GSTATES].offset);
+        _ngs = sect[OVB_GSTATES].size / sizeof(OvBinGS);
+        _points = (const int*)(start + sect[OVB_POINTS].offset);
+        _npoints = sect[OVB_POINTS].size / sizeof(int);
+        _rasters = (const unsigned char*)(start + sect[OVB_RASTERS].offset);
+        _nrasters = sect[OVB_RASTERS].size;
+        _comps = (const OvBinComp*)(start + sect[OVB_COMPS].offset);
+        _ncomps = sect[OVB_COMPS].size / sizeof(OvBinComp);
+        _tops = (const int*)(start + sect[OVB_TOPS].offset);
+        _ntops = sect[OVB_TOPS].size / sizeof(int);
+
+        /* the string section is padded with NULs, so all strings end */
+        ok = _ncomps > 0 && (_nstrings == 0 || _strings[_nstrings-1] == '\0');
+        for (int i = 0; ok && i < _ntops; ++i) {
+            ok = _tops[i] > 0 && _tops[i] < _ncomps;
+        }
+    }
+    if (ok) {
+        _gs = new Graphic*[_ngs];
+        for (int i = 0; i < _ngs; ++i) {
+            _gs[i] = nil;
+        }
+    } else {
+        Close();
+    }
+    return ok;
+}
+
+int OverlayBinary::NumTopComps () { return _ntops; }
+
+const char* OverlayBinary::StringAt (int offset) {
+    return offset >= 0 && offset < _nstrings ? _strings + offset : nil;
+}
+
+Graphic* OverlayBinary::GS (int index) {
+    if (index < 0 || index >= _ngs) {
+        return nil;
+    }
+    if (_gs[index] != nil) {
+        return _gs[index];
+    }
+    const OvBinGS& rec = _gsrecs[index];
+    OverlayCatalog* catalog = OverlayCatalog::Instance();
+    FullGraphic* gs = new FullGraphic;
+
+    gs->FillBg(rec.fillbg);
+
+    if (rec.brush == OVB_NONE) {
+        gs->SetBrush(catalog->FindNoneBrush());
+    } else if (rec.brush == OVB_SET) {
+        gs->SetBrush(catalog->FindBrush(rec.linepat, rec.width));
+    }
+
+    PSColor* colors[2];
+    const OvBinColor* recs[2] = { &rec.fg, &rec.bg };
+    for (int i = 0; i < 2; ++i) {
+        const OvBinColor& c = *recs[i];
+        const char* name = StringAt(c.name);
+        colors[i] = c.state != OVB_SET ? nil : catalog->FindColor(
+            name ? name : "no_name",
+            Math::round(c.r * float(0xffff)),
+            Math::round(c.g * float(0xffff)),
+            Math::round(c.b * float(0xffff))
+        );
+    }
+    gs->SetColors(colors[0], colors[1]);
+
+    const char* font = StringAt(rec.font);
+    if (font != nil) {
+        const char* pf = StringAt(rec.printfont);
+        const char* ps = StringAt(rec.printsize);
+        gs->SetFont(catalog->FindFont(font, pf ? pf : "", ps ? ps : ""));
+    }
+
+    if (rec.pattern == OVB_NONE) {
+        gs->SetPattern(catalog->FindNonePattern());
+    } else if (rec.pattern == OVB_GRAY) {
+        gs->SetPattern(catalog->FindGrayLevel(rec.graylevel));
+    } else if (rec.pattern == OVB_SET) {
+        int data[patternHeight];
+        int size = Math::min(rec.patsize, patternHeight);
+        memcpy(data, rec.patdata, size * sizeof(int));
+        gs->SetPattern(catalog->FindPattern(data, size));
+    }
+    _gs[index] = gs;
+    return gs;
+}
+
+void OverlayBinary::Transform (Graphic* g, const OvBinComp* rec) {
+    if (rec->flags & OVB_XFORM) {
+        const float* a = rec->xform;
+        Transformer* t = new Transformer(a[0], a[1], a[2], a[3], a[4], a[5]);
+        g->SetTransformer(t);
+        Unref(t);
+    }
+}
+
+void OverlayBinary::Extras (OverlayComp* comp, const OvBinComp* rec) {
+    const char* text = StringAt(rec->extras);
+    if (text == nil) {
+        return;
+    }
+    std::istrstream in(text);
+    OverlayComp tmp(in);
+    if (tmp.GetAnnotation() != nil) {
+        comp->SetAnnotation(tmp.GetAnnotation());
+    }
+    if (tmp.attrlist() != nil) {
+        comp->SetAttributeList(tmp.attrlist());
+    }
+}
+
+/*
+ * ReadComp builds the component whose record is at 'index' and leaves
+ * 'index' on the record after its subtree.  Points are handed to the
+ * graphics straight from the mapping; the Unidraw graphics copy them.
+ */
+
+OverlayComp* OverlayBinary::ReadComp (int& index, OverlayComp* parent) {
+    if (index < 0 || index >= _ncomps) {
+        return nil;
+    }
+    const OvBinComp* rec = &_comps[index];
+    int next = index + rec->subtree;
+    if (rec->subtree < 1 || next > _ncomps) {
+        index = _ncomps;
+        return nil;
+    }
+    ++index;
+
+    OverlayComp* comp = nil;
+    Graphic* gs = GS(rec->gs);
+    const int* a = rec->a;
+    Coord* x = nil;
+    Coord* y = nil;
+
+    switch (rec->type) {
+    case OVB_MULTILINE:
+    case OVB_ARROWMULTILINE:
+    case OVB_SPLINE:
+    case OVB_ARROWSPLINE:
+    case OVB_CLOSEDSPLINE:
+    case OVB_POLYGON:
+        if (a[0] < 0 || a[1] < 1 || a[1] > (_npoints - a[0]) / 2) {
+            index = next;
+            return nil;
+        }
+        x = (Coord*) (_points + a[0]);
+        y = x + a[1];
+        break;
+    }
+    boolean head = (rec->flags & OVB_HEAD) != 0;
+    boolean tail = (rec->flags & OVB_TAIL) != 0;
+
+    switch (rec->type) {
+    case OVB_DRAWING:
+    case OVB_GROUP: {
+        OverlaysComp* comps;
+        if (rec->type == OVB_DRAWING) {
+            comps = new OverlayIdrawComp(nil, parent);
+            if (gs != nil) {
+                *comps->GetGraphic() = *gs;
+            }
+        } else {
+            comps = new OverlaysComp(new Picture(gs), parent);
+        }
+        while (index < next) {
+            OverlayComp* child = ReadComp(index, comps);
+            if (child != nil) {
+                comps->Append(child);
+            }
+        }
+        comp = comps;
+        break;
+    }
+    case OVB_LINE:
+        comp = new LineOvComp(new Line(a[0], a[1], a[2], a[3], gs), parent);
+        break;
+    case OVB_ARROWLINE:
+        comp = new ArrowLineOvComp(
+            new ArrowLine(a[0], a[1], a[2], a[3], head, tail, rec->scale, gs),
+            parent
+        );
+        break;
+    case OVB_MULTILINE:
+        comp = new MultiLineOvComp(new SF_MultiLine(x, y, a[1], gs), parent);
+        break;
+    case OVB_ARROWMULTILINE:
+        comp = new ArrowMultiLineOvComp(
+            new ArrowMultiLine(x, y, a[1], head, tail, rec->scale, gs), parent
+        );
+        break;
+    case OVB_SPLINE:
+        comp = new SplineOvComp(new SFH_OpenBSpline(x, y, a[1], gs), parent);
+        break;
+    case OVB_ARROWSPLINE:
+        comp = new ArrowSplineOvComp(
+            new ArrowOpenBSpline(x, y, a[1], head, tail, rec->scale, gs),
+            parent
+        );
+        break;
+    case OVB_CLOSEDSPLINE:
+        comp = new ClosedSplineOvComp(
+            new SFH_ClosedBSpline(x, y, a[1], gs), parent
+        );
+        break;
+    case OVB_POLYGON:
+        comp = new PolygonOvComp(new SF_Polygon(x, y, a[1], gs), parent);
+        break;
+    case OVB_RECT:
+        comp = new RectOvComp(new SF_Rect(a[0], a[1], a[2], a[3], gs), parent);
+        break;
+    case OVB_ELLIPSE:
+        comp = new EllipseOvComp(
+            new SF_Ellipse(a[0], a[1], a[2], a[3], gs), parent
+        );
+        break;
+    case OVB_TEXT: {
+        const char* text = StringAt(a[0]);
+        if (text != nil) {
+            comp = new TextOvComp(new TextGraphic(text, a[1], gs), parent);
+        }
+        break;
+    }
+    case OVB_RASTER: {
+        boolean gray = (rec->flags & OVB_GRAYRASTER) != 0;
+        int w = a[1];
+        int h = a[2];
+        int depth = gray ? 1 : 3;
+        if (
+            w < 1 || h < 1 || a[0] < 0 || a[0] > _nrasters ||
+            h > (_nrasters - a[0]) / depth / w
+        ) {
+            break;
+        }
+        const unsigned char* p = _rasters + a[0];
+        OverlayRaster* raster = new OverlayRaster(w, h);
+        raster->gray_flag(gray);
+        for (int y = 0; y < h; ++y, p += w * depth) {
+            if (gray) {
+                raster->graypokerow(0, y, w, p);
+            } else {
+                raster->pokerow(0, y, w, p, 3);
+            }
+        }
+        comp = new RasterOvComp(new OverlayRasterRect(raster, gs), nil, parent);
+        break;
+    }
+    case OVB_SCRIPT: {
+        const char* text = StringAt(a[0]);
+        if (text != nil) {
+            std::istrstream in(text);
+            char name[BUFSIZ];
+            ParamList::skip_space(in);
+            ParamList::parse_token(in, name, BUFSIZ);
+            comp = OverlayCatalog::Instance()->ReadComp(name, in, parent);
+            if (comp != nil && !comp->valid()) {
+                delete comp;
+                comp = nil;
+            }
+        }
+        break;
+    }
+    }
+
+    if (comp != nil && rec->type != OVB_SCRIPT) {
+        Transform(comp->GetGraphic(), rec);
+        Extras(comp, rec);
+    }
+    if (comp == nil) {
+        fprintf(stderr, "OverlayBinary: unreadable component record %d\n", next - rec->subtree);
+    }
+    index = next;
+    return comp;
+}
+
+OverlayComp* OverlayBinary::ReadTopComp (int n, OverlayComp* parent) {
+    if (n < 0 || n >= _ntops) {
+        return nil;
+    }
+    int index = _tops[n];
+    return ReadComp(index, parent);
+}
+
+OverlayIdrawComp* OverlayBinary::ReadDrawing (const char* pathname) {
+    int index = 0;
+    if (_ncomps == 0 || _comps[0].type != OVB_DRAWING) {
+        return nil;
+    }
+    OverlayIdrawComp* comp = (OverlayIdrawComp*) ReadComp(index, nil);
+    if (comp != nil) {
+        comp->SetPathName(pathname);
+    }
+    return comp;
+}
+
+boolean OverlayBinary::Write (OverlayComp* comp, const char* path) {
+    OvBinWriter writer;
+    return writer.Write(comp, path);
+}
+
+boolean OverlayBinary::IsBinary (const char* path) {
+    char magic[sizeof(ovbin_magic)];
+    FILE* f = fopen(path, "r");
+    if (f == nil) {
+        return false;
+    }
+    boolean binary = fread(magic, sizeof(magic), 1, f) == 1 &&
+        memcmp(magic, ovbin_magic, sizeof(magic)) == 0;
+    fclose(f);
+    return binary;
+}
+
+boolean OverlayBinary::BinarySuffix (const char* path) {
+    int len = strlen(path);
+    int slen = strlen(ovbin_suffix);
+    return len > slen && strcmp(path + len - slen, ovbin_suffix) == 0;
+}
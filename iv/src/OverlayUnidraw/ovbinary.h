@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayBinary - memory-mappable binary drawing format
+ */
+
+#ifndef ovbinary_h
+#define ovbinary_h
+
+#include <Unidraw/globals.h>
+
+class InputFile;
+class OverlayComp;
+class OverlayIdrawComp;
+struct OvBinComp;
+struct OvBinGS;
+
+//: reader/writer for the binary drawing format.
+// a binary drawing is a versioned header followed by sections of fixed
+// records:  strings, graphic states, point arrays, raster pixels, and
+// the component tree in preorder.  Each component record carries the
+// size of its subtree, so any top-level component can be located and
+// built without touching the rest of the file.  The file is read through
+// a read-only mapping and graphics are built straight from the mapped
+// records.  Components without a native record are stored as their
+// ASCII script text and read back with OverlayCatalog::ReadComp.
+class OverlayBinary {
+public:
+    OverlayBinary();
+    virtual ~OverlayBinary();
+
+    boolean Open(const char* path);
+    // map 'path' and validate its header and sections.
+    void Close();
+    // release the mapping.
+
+    int NumTopComps();
+    // number of top-level components in the open drawing.
+    OverlayComp* ReadTopComp(int n, OverlayComp* parent = nil);
+    // build the n-th top-level component.
+    OverlayIdrawComp* ReadDrawing(const char* pathname = nil);
+    // build the whole drawing.
+
+    static boolean Write(OverlayComp*, const char* path);
+    // write the drawing rooted at 'comp' to 'path'.
+    static boolean IsBinary(const char* path);
+    // true if 'path' starts with the binary drawing magic.
+    static boolean BinarySuffix(const char* path);
+    // true if 'path' ends in the binary drawing suffix (".dtb").
+protected:
+    OverlayComp* ReadComp(int& index, OverlayComp* parent);
+    Graphic* GS(int);
+    const char* StringAt(int);
+    void Transform(Graphic*, const OvBinComp*);
+    void Extras(OverlayComp*, const OvBinComp*);
+
+    InputFile* _file;
+    const char* _strings;
+    int _nstrings;
+    const OvBinGS* _gsrecs;
+    int _ngs;
+    const int* _points;
+    int _npoints;
+    const unsigned char* _rasters;
+    int _nrasters;
+    const OvBinComp* _comps;
+    int _ncomps;
+    const int* _tops;
+    int _ntops;
+    Graphic** _gs;
+};
+
+#endif
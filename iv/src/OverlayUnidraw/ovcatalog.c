@@ -26,6 +26,7 @@
  */
 
 #include <OverlayUnidraw/ovarrow.h>
+#include <OverlayUnidraw/ovbinary.h>
 #include <OverlayUnidraw/ovcatalog.h>
 #include <OverlayUnidraw/ovcreator.h>
 #include <OverlayUnidraw/ovclasses.h>
@@ -33,6 +34,7 @@
 #include <OverlayUnidraw/ovellipse.h>
 #include <OverlayUnidraw/ovfile.h>
 #include <OverlayUnidraw/ovimport.h>
+#include <OverlayUnidraw/ovloader.h>
 #include <OverlayUnidraw/ovpolygon.h>
 #include <OverlayUnidraw/ovraster.h>
 #include <OverlayUnidraw/ovrect.h>
@@ -46,6 +48,7 @@
 
 #include <Unidraw/Components/component.h>
 #include <Unidraw/Components/externview.h>
+#include <Unidraw/Components/grview.h>
 #include <Unidraw/Components/psformat.h>
 #include <Unidraw/Components/text.h>
 
@@ -54,7 +57,9 @@
 #include <Unidraw/Graphic/rasterrect.h>
 #include <Unidraw/Graphic/ustencil.h>
 
+#include <Unidraw/editor.h>
 #include <Unidraw/unidraw.h>
+#include <Unidraw/viewer.h>
 
 #include <InterViews/bitmap.h>
 #include <InterViews/raster.h>
@@ -131,6 +136,15 @@ static void HexDecode (
     ib = float(b) / float(color_base);
 }
 
+/* the parent OvImportCmd gives a drawing it reads */
+
+static OverlayComp* ViewerComp (Editor* ed) {
+    Viewer* viewer = ed ? ed->GetViewer() : nil;
+    return viewer 
+        ? (OverlayComp*)viewer->GetGraphicView()->GetGraphicComp() 
+        : nil;
+}
+
 /*****************************************************************************/
 
 OverlayCatalog::OverlayCatalog (
@@ -147,6 +161,15 @@ boolean OverlayCatalog::Save (Component* comp, const char* name) {
     if (UnidrawFormat(name)) {
         ok = Catalog::Save(comp, name);
 
+    } else if (
+        OverlayBinary::BinarySuffix(name) && comp->IsA(OVERLAY_IDRAW_COMP) &&
+        OverlayBinary::Write((OverlayComp*)comp, name)
+    ) {
+        ((OverlayComp*)comp)->SetPathName(name);
+        Forget(comp, name);
+        Register(comp, name);
+        ok = true;
+
     } else {
         ExternView* ev = (ExternView*) comp->Create(SCRIPT_VIEW);
 
@@ -183,6 +206,23 @@ boolean OverlayCatalog::Retrieve (const char* filename, Component*& comp) {
     if (Valid(name, comp)) {
         _valid = true;
 
+    } else if (strcmp(name, "-") != 0 && OverlayBinary::IsBinary(name)) {
+        OverlayBinary binary;
+        comp = binary.Open(name) ? binary.ReadDrawing(name) : nil;
+        _valid = comp != nil;
+        if (_valid) {
+            Forget(comp, name);
+            Register(comp, name);
+        }
+
+    } else if (
+        strcmp(name, "-") != 0 &&
+        (comp = OverlayLoader::Load(name, ViewerComp(GetEditor()))) != nil
+    ) {
+        _valid = true;
+        Forget(comp, name);
+        Register(comp, name);
+
     } else {
 #if __GNUC__<3	  
         filebuf fbuf;
@@ -1411,6 +1411,7 @@ const char* OverlayIdrawComp::GetBaseDir() { return _basedir; }
 /* for sliding in a new static default Painter */
 
 void OverlayGraphic::new_painter() {
+  if (!use_iv()) return;
   Unref(_p);
   _p = new OverlayPainter();
   Resource::ref(_p);
@@ -417,6 +417,7 @@ protected:
     char* _basedir;
 
 friend class OverlayCatalog;
+friend class OverlayLoader;
 
     CLASS_SYMID("OverlayIdrawComp"); 
 };
@@ -78,7 +78,8 @@ Component* EllipseOvComp::Copy () {
     return comp;
 }
 
-EllipseOvComp::EllipseOvComp (SF_Ellipse* graphic) : OverlayComp(graphic) { }
+EllipseOvComp::EllipseOvComp (SF_Ellipse* graphic, OverlayComp* parent)
+: OverlayComp(graphic, parent) { }
 
 EllipseOvComp::EllipseOvComp(istream& in, OverlayComp* parent) 
 : OverlayComp(nil, parent) {
@@ -42,7 +42,7 @@ class SF_Ellipse;
 //: clone of EllipseComp derived from OverlayComp.
 class EllipseOvComp : public OverlayComp {
 public:
-    EllipseOvComp(SF_Ellipse* = nil);
+    EllipseOvComp(SF_Ellipse* = nil, OverlayComp* parent = nil);
     // construct with stroke-filled ellipse graphic.
     EllipseOvComp(istream&, OverlayComp* parent = nil);
     // construct from istream.
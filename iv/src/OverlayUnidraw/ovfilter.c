@@ -0,0 +1,736 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayFilter implementation.
+ */
+
+#include <OverlayUnidraw/grayraster.h>
+#include <OverlayUnidraw/ovfilter.h>
+#include <OverlayUnidraw/ovraster.h>
+
+#include <IV-X11/xraster.h>
+
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*****************************************************************************/
+
+int OverlayFilter::_jobs = 0;
+int OverlayFilter::_minsize = 1 << 16;
+
+int OverlayFilter::Jobs () {
+    if (_jobs > 0) {
+        return _jobs;
+    }
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 1 ? (int)n : 1;
+}
+
+/* planes are allocated with malloc so a failure can be reported as nil */
+
+static void* plane_alloc (unsigned long bytes) {
+    return malloc(bytes ? bytes : 1);
+}
+
+/*****************************************************************************/
+
+struct FilterJob {
+    int w, h;
+    const float* src;
+    float* tmp;
+    float* dst;
+    const float* kern;
+    int radius;
+    const float* tvals;
+    int ntvals;
+    int* labels;
+    int* parent;
+};
+
+typedef void (*FilterBand)(FilterJob&, int y0, int y1);
+
+static int num_bands (int w, int h) {
+    if ((long)w * h < OverlayFilter::MinSize()) {
+        return 1;
+    }
+    int njobs = OverlayFilter::Jobs();
+    return njobs < h ? njobs : (h > 1 ? h : 1);
+}
+
+static int band_start (int j, int nbands, int h) {
+    return (int)((long)h * j / nbands);
+}
+
+struct FilterBandThread {
+    FilterBand f;
+    FilterJob* job;
+    int y0, y1;
+    pthread_t thread;
+    boolean started;
+};
+
+static void* band_thread (void* arg) {
+    FilterBandThread* band = (FilterBandThread*)arg;
+    (*band->f)(*band->job, band->y0, band->y1);
+    return nil;
+}
+
+/*
+ * run_bands applies 'f' to 'nbands' bands of rows, the first in this
+ * thread and each of the others in a thread of its own.  A band whose
+ * thread could not be started is done here after the first, so the
+ * result is the same however many threads ran.
+ */
+
+static void run_bands (FilterBand f, FilterJob& job, int nbands) {
+    if (nbands < 2) {
+        (*f)(job, 0, job.h);
+        return;
+    }
+    FilterBandThread* bands = new FilterBandThread[nbands];
+    for (int j = 0; j < nbands; ++j) {
+        bands[j].f = f;
+        bands[j].job = &job;
+        bands[j].y0 = band_start(j, nbands, job.h);
+        bands[j].y1 = band_start(j + 1, nbands, job.h);
+        bands[j].started = j > 0 && pthread_create(
+            &bands[j].thread, nil, &band_thread, &bands[j]
+        ) == 0;
+    }
+    (*f)(job, bands[0].y0, bands[0].y1);
+    for (int j = 1; j < nbands; ++j) {
+        if (bands[j].started) {
+            pthread_join(bands[j].thread, nil);
+        } else {
+            (*f)(job, bands[j].y0, bands[j].y1);
+        }
+    }
+    delete [] bands;
+}
+
+/*****************************************************************************/
+
+#define READ_PLANE(T) { \
+    const T* d = (const T*)data; \
+    for (unsigned long i = 0; i < n; ++i) plane[i] = (float)d[i]; \
+}
+
+/*
+ * read_plane copies the raw values of a GrayRaster, or the gray level
+ * of any other raster, into a new float plane.
+ */
+
+static float* read_plane (
+    OverlayRaster* raster, AttributeValue::ValueType& type, boolean& t2b
+) {
+    int w = raster->pwidth();
+    int h = raster->pheight();
+    unsigned long n = (unsigned long)w * h;
+    float* plane = (float*)plane_alloc(n * sizeof(float));
+    if (plane == nil) {
+        return nil;
+    }
+    if (!raster->grayraster()) {
+        type = AttributeValue::UCharType;
+        t2b = false;
+        for (int y = 0; y < h; ++y) {
+            float* row = plane + (unsigned long)y * w;
+            for (int x = 0; x < w; ++x) {
+                ColorIntensity r, g, b;
+                float alpha;
+                raster->peek(x, y, r, g, b, alpha);
+                row[x] = (float)(int)(0xff * (0.299 * r + 0.587 * g + 0.114 * b));
+            }
+        }
+        return plane;
+    }
+    GrayRaster* gray = (GrayRaster*)raster;
+    type = gray->value_type();
+    t2b = gray->top2bottom();
+    const unsigned char* data = gray->data();
+
+    switch (type) {
+    case AttributeValue::CharType:   READ_PLANE(char); break;
+    case AttributeValue::UCharType:  READ_PLANE(unsigned char); break;
+    case AttributeValue::ShortType:  READ_PLANE(short); break;
+    case AttributeValue::UShortType: READ_PLANE(unsigned short); break;
+    case AttributeValue::IntType:    READ_PLANE(int); break;
+    case AttributeValue::UIntType:   READ_PLANE(unsigned int); break;
+    case AttributeValue::LongType:   READ_PLANE(long); break;
+    case AttributeValue::ULongType:  READ_PLANE(unsigned long); break;
+    case AttributeValue::FloatType:  READ_PLANE(float); break;
+    case AttributeValue::DoubleType: READ_PLANE(double); break;
+    default:
+        free(plane);
+        return nil;
+    }
+    return plane;
+}
+
+#define WRITE_PLANE(T, lo, hi) { \
+    T* d = (T*)gray->data(); \
+    for (unsigned long i = 0; i < n; ++i) { \
+        float v = plane[i]; \
+        v = v < (lo) ? (lo) : (v > (hi) ? (hi) : v); \
+        d[i] = (T)(v < 0 ? v - 0.5f : v + 0.5f); \
+    } \
+}
+
+/*
+ * write_plane converts a float plane into a new GrayRaster of 'type',
+ * rounding and clamping to the range of integer types.
+ */
+
+static GrayRaster* write_plane (
+    const float* plane, int w, int h, AttributeValue::ValueType type,
+    boolean t2b
+) {
+    unsigned long n = (unsigned long)w * h;
+    GrayRaster* gray = new GrayRaster(w, h, type);
+    gray->top2bottom(t2b);
+
+    switch (type) {
+    case AttributeValue::CharType:   WRITE_PLANE(char, CHAR_MIN, CHAR_MAX); break;
+    case AttributeValue::UCharType:  WRITE_PLANE(unsigned char, 0, UCHAR_MAX); break;
+    case AttributeValue::ShortType:  WRITE_PLANE(short, SHRT_MIN, SHRT_MAX); break;
+    case AttributeValue::UShortType: WRITE_PLANE(unsigned short, 0, USHRT_MAX); break;
+    case AttributeValue::IntType:    WRITE_PLANE(int, -2147483520.f, 2147483520.f); break;
+    case AttributeValue::UIntType:   WRITE_PLANE(unsigned int, 0, 4294967040.f); break;
+    case AttributeValue::LongType:   WRITE_PLANE(long, -2147483520.f, 2147483520.f); break;
+    case AttributeValue::ULongType:  WRITE_PLANE(unsigned long, 0, 4294967040.f); break;
+    case AttributeValue::FloatType:
+        memcpy(gray->data(), plane, n * sizeof(float));
+        break;
+    default: {
+            double* d = (double*)gray->data();
+            for (unsigned long i = 0; i < n; ++i) d[i] = plane[i];
+        }
+        break;
+    }
+    gray->rep()->modified_ = true;
+    return gray;
+}
+
+/*****************************************************************************/
+
+/* copy a row into 'pad' with 'r' copies of its end values on either side */
+
+static void pad_row (const float* row, int w, int r, float* pad) {
+    for (int i = 0; i < r; ++i) {
+        pad[i] = row[0];
+        pad[r + w + i] = row[w - 1];
+    }
+    memcpy(pad + r, row, w * sizeof(float));
+}
+
+static inline int clamp_row (int y, int h) {
+    return y < 0 ? 0 : (y >= h ? h - 1 : y);
+}
+
+/* horizontal pass of a separable kernel, src to tmp */
+
+static void convolve_rows (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    int r = job.radius;
+    float* pad = new float[w + 2 * r];
+    for (int y = y0; y < y1; ++y) {
+        float* out = job.tmp + (unsigned long)y * w;
+        pad_row(job.src + (unsigned long)y * w, w, r, pad);
+        for (int x = 0; x < w; ++x) {
+            out[x] = 0;
+        }
+        for (int k = 0; k <= 2 * r; ++k) {
+            float c = job.kern[k];
+            const float* s = pad + k;
+            for (int x = 0; x < w; ++x) {
+                out[x] += c * s[x];
+            }
+        }
+    }
+    delete [] pad;
+}
+
+/* vertical pass of a separable kernel, tmp to dst */
+
+static void convolve_cols (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    int r = job.radius;
+    for (int y = y0; y < y1; ++y) {
+        float* out = job.dst + (unsigned long)y * w;
+        for (int x = 0; x < w; ++x) {
+            out[x] = 0;
+        }
+        for (int k = 0; k <= 2 * r; ++k) {
+            float c = job.kern[k];
+            const float* s = job.tmp + (unsigned long)clamp_row(y + k - r, job.h) * w;
+            for (int x = 0; x < w; ++x) {
+                out[x] += c * s[x];
+            }
+        }
+    }
+}
+
+/* horizontal running mean by prefix sums, src to tmp */
+
+static void box_rows (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    int r = job.radius;
+    int n = 2 * r + 1;
+    float* pad = new float[w + 2 * r];
+    double* sum = new double[w + 2 * r + 1];
+    double scale = 1.0 / n;
+    for (int y = y0; y < y1; ++y) {
+        float* out = job.tmp + (unsigned long)y * w;
+        pad_row(job.src + (unsigned long)y * w, w, r, pad);
+        sum[0] = 0;
+        for (int i = 0; i < w + 2 * r; ++i) {
+            sum[i + 1] = sum[i] + pad[i];
+        }
+        for (int x = 0; x < w; ++x) {
+            out[x] = (float)((sum[x + n] - sum[x]) * scale);
+        }
+    }
+    delete [] sum;
+    delete [] pad;
+}
+
+/*
+ * vertical running mean, a row of column sums slid down the band.  The
+ * sums are started afresh every BOX_RESTART rows counted from the top of
+ * the image, not of the band, so rounding is the same however the rows
+ * are divided.
+ */
+
+static const int BOX_RESTART = 64;
+
+static void box_sums (FilterJob& job, int y, double* acc) {
+    int w = job.w;
+    int r = job.radius;
+    for (int x = 0; x < w; ++x) {
+        acc[x] = 0;
+    }
+    for (int k = -r; k <= r; ++k) {
+        const float* s = job.tmp + (unsigned long)clamp_row(y + k, job.h) * w;
+        for (int x = 0; x < w; ++x) {
+            acc[x] += s[x];
+        }
+    }
+}
+
+static void box_cols (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    int r = job.radius;
+    double* acc = new double[w];
+    double scale = 1.0 / (2 * r + 1);
+    for (int y = y0 - y0 % BOX_RESTART; y < y1; ++y) {
+        if (y % BOX_RESTART == 0) {
+            box_sums(job, y, acc);
+        }
+        const float* add = job.tmp + (unsigned long)clamp_row(y + r + 1, job.h) * w;
+        const float* sub = job.tmp + (unsigned long)clamp_row(y - r, job.h) * w;
+        if (y >= y0) {
+            float* out = job.dst + (unsigned long)y * w;
+            for (int x = 0; x < w; ++x) {
+                out[x] = (float)(acc[x] * scale);
+            }
+        }
+        for (int x = 0; x < w; ++x) {
+            acc[x] += add[x] - sub[x];
+        }
+    }
+    delete [] acc;
+}
+
+/*
+ * median of 8-bit values by a histogram slid along each row, keeping
+ * the median and the count of values below it up to date as columns
+ * enter and leave the window.
+ */
+
+static void median_hist (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    int r = job.radius;
+    int half = (2 * r + 1) * (2 * r + 1) / 2;
+    int hist[256];
+    for (int y = y0; y < y1; ++y) {
+        memset(hist, 0, sizeof(hist));
+        for (int dy = -r; dy <= r; ++dy) {
+            const float* s = job.src + (unsigned long)clamp_row(y + dy, job.h) * w;
+            for (int dx = -r; dx <= r; ++dx) {
+                ++hist[(int)s[clamp_row(dx, w)]];
+            }
+        }
+        int med = 0;
+        int below = 0;
+        float* out = job.dst + (unsigned long)y * w;
+        for (int x = 0; x < w; ++x) {
+            while (below > half) {
+                below -= hist[--med];
+            }
+            while (below + hist[med] <= half) {
+                below += hist[med++];
+            }
+            out[x] = med;
+
+            int xsub = clamp_row(x - r, w);
+            int xadd = clamp_row(x + r + 1, w);
+            for (int dy = -r; dy <= r; ++dy) {
+                const float* s = job.src + (unsigned long)clamp_row(y + dy, job.h) * w;
+                int vsub = (int)s[xsub];
+                int vadd = (int)s[xadd];
+                --hist[vsub];
+                ++hist[vadd];
+                below += (vadd < med) - (vsub < med);
+            }
+        }
+    }
+}
+
+/* k-th smallest of n values, partially reordering them */
+
+static float select_kth (float* v, int n, int k) {
+    int lo = 0;
+    int hi = n - 1;
+    while (lo < hi) {
+        float pivot = v[(lo + hi) / 2];
+        int i = lo;
+        int j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) ++i;
+            while (v[j] > pivot) --j;
+            if (i <= j) {
+                float t = v[i]; v[i] = v[j]; v[j] = t;
+                ++i;
+                --j;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+    return v[k];
+}
+
+/* median of any values by selection over each window */
+
+static void median_select (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    int r = job.radius;
+    int n = (2 * r + 1) * (2 * r + 1);
+    float* win = new float[n];
+    for (int y = y0; y < y1; ++y) {
+        float* out = job.dst + (unsigned long)y * w;
+        for (int x = 0; x < w; ++x) {
+            int k = 0;
+            for (int dy = -r; dy <= r; ++dy) {
+                const float* s = job.src + (unsigned long)clamp_row(y + dy, job.h) * w;
+                for (int dx = -r; dx <= r; ++dx) {
+                    win[k++] = s[clamp_row(x + dx, w)];
+                }
+            }
+            out[x] = select_kth(win, n, n / 2);
+        }
+    }
+    delete [] win;
+}
+
+/* largest threshold each value reaches, by binary search */
+
+static void threshold_band (FilterJob& job, int y0, int y1) {
+    unsigned long end = (unsigned long)y1 * job.w;
+    for (unsigned long i = (unsigned long)y0 * job.w; i < end; ++i) {
+        float v = job.src[i];
+        int lo = 0;
+        int hi = job.ntvals;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (job.tvals[mid] <= v) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        job.dst[i] = lo ? job.tvals[lo - 1] : 0;
+    }
+}
+
+/*
+ * connected components use union-find over provisional labels, the
+ * provisional label of a region being one more than the index of a pixel
+ * in it.  Roots are always the smallest label of their set, so a band
+ * only ever writes the parent entries of its own pixels.
+ */
+
+static int find_root (int* parent, int l) {
+    while (parent[l] != l) {
+        parent[l] = parent[parent[l]];
+        l = parent[l];
+    }
+    return l;
+}
+
+static void unite (int* parent, int a, int b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+static void label_band (FilterJob& job, int y0, int y1) {
+    int w = job.w;
+    const float* src = job.src;
+    int* labels = job.labels;
+    int* parent = job.parent;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = 0; x < w; ++x) {
+            int i = y * w + x;
+            float v = src[i];
+            int l = 0;
+            if (v != 0) {
+                if (x > 0 && src[i - 1] == v) {
+                    l = labels[i - 1];
+                }
+                if (y > y0 && src[i - w] == v) {
+                    if (l) {
+                        unite(parent, l, labels[i - w]);
+                    } else {
+                        l = labels[i - w];
+                    }
+                }
+                if (!l) {
+                    l = i + 1;
+                    parent[l] = l;
+                }
+            }
+            labels[i] = l;
+        }
+    }
+}
+
+/*****************************************************************************/
+
+GrayRaster* OverlayFilter::Gaussian (OverlayRaster* raster, float sigma) {
+    AttributeValue::ValueType type;
+    boolean t2b;
+    float* src = read_plane(raster, type, t2b);
+    if (src == nil) {
+        return nil;
+    }
+    FilterJob job;
+    job.w = raster->pwidth();
+    job.h = raster->pheight();
+    unsigned long bytes = (unsigned long)job.w * job.h * sizeof(float);
+    job.src = src;
+    job.tmp = (float*)plane_alloc(bytes);
+    job.dst = (float*)plane_alloc(bytes);
+    job.radius = sigma > 0 ? (int)ceil(3 * sigma) : 0;
+
+    GrayRaster* result = nil;
+    if (job.tmp != nil && job.dst != nil) {
+        int n = 2 * job.radius + 1;
+        float* kern = new float[n];
+        double total = 0;
+        for (int k = 0; k < n; ++k) {
+            double d = k - job.radius;
+            kern[k] = sigma > 0 ? (float)exp(-d * d / (2.0 * sigma * sigma)) : 1;
+            total += kern[k];
+        }
+        for (int k = 0; k < n; ++k) {
+            kern[k] /= total;
+        }
+        job.kern = kern;
+        int nbands = num_bands(job.w, job.h);
+        run_bands(&convolve_rows, job, nbands);
+        run_bands(&convolve_cols, job, nbands);
+        result = write_plane(job.dst, job.w, job.h, type, t2b);
+        delete [] kern;
+    }
+    free(job.dst);
+    free(job.tmp);
+    free(src);
+    return result;
+}
+
+GrayRaster* OverlayFilter::Box (OverlayRaster* raster, int radius) {
+    AttributeValue::ValueType type;
+    boolean t2b;
+    float* src = read_plane(raster, type, t2b);
+    if (src == nil) {
+        return nil;
+    }
+    FilterJob job;
+    job.w = raster->pwidth();
+    job.h = raster->pheight();
+    unsigned long bytes = (unsigned long)job.w * job.h * sizeof(float);
+    job.src = src;
+    job.tmp = (float*)plane_alloc(bytes);
+    job.dst = (float*)plane_alloc(bytes);
+    job.radius = radius > 0 ? radius : 0;
+
+    GrayRaster* result = nil;
+    if (job.tmp != nil && job.dst != nil) {
+        int nbands = num_bands(job.w, job.h);
+        run_bands(&box_rows, job, nbands);
+        run_bands(&box_cols, job, nbands);
+        result = write_plane(job.dst, job.w, job.h, type, t2b);
+    }
+    free(job.dst);
+    free(job.tmp);
+    free(src);
+    return result;
+}
+
+GrayRaster* OverlayFilter::Median (OverlayRaster* raster, int radius) {
+    AttributeValue::ValueType type;
+    boolean t2b;
+    float* src = read_plane(raster, type, t2b);
+    if (src == nil) {
+        return nil;
+    }
+    FilterJob job;
+    job.w = raster->pwidth();
+    job.h = raster->pheight();
+    unsigned long bytes = (unsigned long)job.w * job.h * sizeof(float);
+    job.src = src;
+    job.dst = (float*)plane_alloc(bytes);
+    job.radius = radius > 0 ? radius : 0;
+
+    GrayRaster* result = nil;
+    if (job.dst != nil) {
+        run_bands(
+            type == AttributeValue::UCharType ? &median_hist : &median_select,
+            job, num_bands(job.w, job.h)
+        );
+        result = write_plane(job.dst, job.w, job.h, type, t2b);
+    }
+    free(job.dst);
+    free(src);
+    return result;
+}
+
+GrayRaster* OverlayFilter::Threshold (
+    OverlayRaster* raster, const float* tvals, int n
+) {
+    AttributeValue::ValueType type;
+    boolean t2b;
+    float* src = read_plane(raster, type, t2b);
+    if (src == nil) {
+        return nil;
+    }
+    FilterJob job;
+    job.w = raster->pwidth();
+    job.h = raster->pheight();
+    unsigned long bytes = (unsigned long)job.w * job.h * sizeof(float);
+    job.src = src;
+    job.dst = (float*)plane_alloc(bytes);
+
+    GrayRaster* result = nil;
+    if (job.dst != nil) {
+        float* sorted = new float[n > 0 ? n : 1];
+        for (int i = 0; i < n; ++i) {
+            int j = i;
+            for (; j > 0 && sorted[j - 1] > tvals[i]; --j) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = tvals[i];
+        }
+        job.tvals = sorted;
+        job.ntvals = n > 0 ? n : 0;
+        run_bands(&threshold_band, job, num_bands(job.w, job.h));
+        result = write_plane(job.dst, job.w, job.h, type, t2b);
+        delete [] sorted;
+    }
+    free(job.dst);
+    free(src);
+    return result;
+}
+
+GrayRaster* OverlayFilter::Label (OverlayRaster* raster, int& ncomps) {
+    AttributeValue::ValueType type;
+    boolean t2b;
+    ncomps = 0;
+    float* src = read_plane(raster, type, t2b);
+    if (src == nil) {
+        return nil;
+    }
+    FilterJob job;
+    job.w = raster->pwidth();
+    job.h = raster->pheight();
+    unsigned long n = (unsigned long)job.w * job.h;
+    job.src = src;
+    job.labels = (int*)plane_alloc(n * sizeof(int));
+    job.parent = (int*)plane_alloc((n + 1) * sizeof(int));
+
+    GrayRaster* result = nil;
+    if (job.labels != nil && job.parent != nil) {
+        int nbands = num_bands(job.w, job.h);
+        run_bands(&label_band, job, nbands);
+
+        /* join regions that cross from one band into the next */
+        for (int j = 1; j < nbands; ++j) {
+            int y = band_start(j, nbands, job.h);
+            for (int x = 0; x < job.w; ++x) {
+                int i = y * job.w + x;
+                if (job.labels[i] && src[i] == src[i - job.w]) {
+                    unite(job.parent, job.labels[i], job.labels[i - job.w]);
+                }
+            }
+        }
+
+        /* point every pixel at its root, then number the roots in raster order */
+        for (unsigned long i = 0; i < n; ++i) {
+            int l = job.labels[i];
+            job.labels[i] = l ? find_root(job.parent, l) : 0;
+        }
+        for (unsigned long i = 0; i < n; ++i) {
+            int root = job.labels[i];
+            if (root) {
+                if (job.parent[root] > 0) {
+                    job.parent[root] = -(++ncomps);
+                }
+                job.labels[i] = -job.parent[root];
+            }
+        }
+
+        result = new GrayRaster(job.w, job.h, AttributeValue::IntType);
+        result->top2bottom(t2b);
+        memcpy(result->data(), job.labels, n * sizeof(int));
+        result->rep()->modified_ = true;
+    }
+    free(job.parent);
+    free(job.labels);
+    free(src);
+    return result;
+}
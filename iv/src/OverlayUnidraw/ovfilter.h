@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayFilter - native image-processing operators on rasters
+ */
+
+#ifndef ovfilter_h
+#define ovfilter_h
+
+#include <Unidraw/globals.h>
+
+class GrayRaster;
+class OverlayRaster;
+
+//: image-processing operators that produce new gray-level rasters.
+// each operator reads the raw pixel values of a GrayRaster (or the gray
+// level of any other OverlayRaster) into a float plane, works on the
+// plane, and returns a new GrayRaster of the same size and orientation,
+// leaving the source untouched.  Filters and thresholds keep the value
+// type of a GrayRaster source (a UCharType raster for any other source);
+// Label returns an IntType raster.
+//
+// The rows of a large image are divided into bands that separate
+// threads work on at once; a band whose thread cannot be started is done
+// by the calling thread, so results never depend on the number of jobs.
+// The workers only compute on the planes and never touch the display or
+// the catalog.  Inner loops run along rows over contiguous floats so the
+// compiler can vectorize them.  Operators return nil if memory for the
+// planes cannot be had.
+class OverlayFilter {
+public:
+    static GrayRaster* Gaussian(OverlayRaster*, float sigma);
+    // separable Gaussian smoothing with a kernel cut off at 3 sigma.
+    static GrayRaster* Box(OverlayRaster*, int radius);
+    // mean over a (2*radius+1) square window, by running sums.
+    static GrayRaster* Median(OverlayRaster*, int radius);
+    // median over a (2*radius+1) square window; by sliding histogram for
+    // 8-bit rasters.
+    static GrayRaster* Threshold(OverlayRaster*, const float* tvals, int n);
+    // replace each value with the largest of the 'n' thresholds it reaches,
+    // or 0 if it reaches none.
+    static GrayRaster* Label(OverlayRaster*, int& ncomps);
+    // label 4-connected regions of equal non-zero value from 1 to
+    // 'ncomps', in raster order.  Zero pixels are labeled 0.
+
+    static void Jobs(int n) { _jobs = n; }
+    // number of threads to divide the rows among; 0 (the default) for
+    // one per online processor, 1 to work serially.
+    static int Jobs();
+    static void MinSize(int pixels) { _minsize = pixels; }
+    // smallest image worth dividing among threads.
+    static int MinSize() { return _minsize; }
+protected:
+    static int _jobs;
+    static int _minsize;
+};
+
+#endif
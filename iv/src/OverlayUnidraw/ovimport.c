@@ -40,6 +40,7 @@
 #include <OverlayUnidraw/ovraster.h>
 #include <OverlayUnidraw/ovselection.h>
 #include <OverlayUnidraw/ovstencil.h>
+#include <OverlayUnidraw/ovtiff.h>
 #include <OverlayUnidraw/ovpainter.h>
 #include <OverlayUnidraw/oved.h>
 #include <OverlayUnidraw/ovviewer.h>
@@ -289,13 +290,22 @@ ReadPpmIterator::ReadPpmIterator(OverlayRaster* r)
 
 void ReadPpmIterator::getPixels(std::strstream& in) {
   // cerr << "pcount: " << in.pcount() << "\ttellg: " << in.tellg() << endl;
+  u_char rowbuf[3 * 256];
   while((in.pcount() - in.tellg()) >= 3 && in.good() && !in.eof()) { 
-    u_char r, g, b;
-    in.get((char&)r);
-    in.get((char&)g);
-    in.get((char&)b);
-
-    poke(float(r)/0xff, float(g)/0xff, float(b)/0xff);
+    // poke as much of the current row as is buffered in one call
+    u_long n = (in.pcount() - in.tellg()) / 3;
+    if (n > _width - _xcur) n = _width - _xcur;
+    if (n > 256) n = 256;
+    in.read((char*)rowbuf, n * 3);
+    n = in.gcount() / 3;
+    if (n == 0) break;
+    _ras->pokerow(_xcur, _ycur, n, rowbuf);
+
+    _xcur += n;
+    if (_xcur == _width) {
+      _xcur = 0;
+      _ycur--;
+    }
   }
 }
 
@@ -1747,9 +1757,17 @@ GraphicComp* OvImportCmd::TIFF_Image (const char* pathname) {
 }
 
 OverlayRaster* OvImportCmd::TIFF_Raster (const char* pathname) {
-    Raster* raster = TIFFRaster::load(pathname);
-    OverlayRaster* ovraster = new OverlayRaster(*raster);
-    delete raster;
+    /* OverlayTIFF keeps the full sample depth; anything it does not */
+    /* handle is left to the general TIFFRaster reader */
+    OverlayRaster* ovraster = OverlayTIFF::Load(pathname);
+    if (ovraster == nil) {
+        Raster* raster = TIFFRaster::load(pathname);
+        if (raster == nil) {
+            return nil;
+        }
+        ovraster = new OverlayRaster(*raster);
+        delete raster;
+    }
     ovraster->flush();
     return ovraster;
 }
@@ -1779,6 +1797,16 @@ boolean OvImportCmd::Tiling(int& width, int& height) {
 
 // --------------------------------------------------------------------------
 
+void PortableImageHelper::read_row(
+    OverlayRaster* raster, FILE* file, u_long x, u_long y, u_long n
+) {
+    for (u_long i = 0; i < n; i++) {
+        read_poke(raster, file, x + i, y);
+    }
+}
+
+// --------------------------------------------------------------------------
+
 PPM_Helper::PPM_Helper(boolean is_ascii) : PortableImageHelper(is_ascii) {
 }
 
@@ -1826,6 +1854,19 @@ void PPM_Helper::read_poke(
     }
 }
 
+void PPM_Helper::read_row(
+    OverlayRaster* raster, FILE* file, u_long x, u_long y, u_long n
+) {
+    if (is_ascii()) {
+        PortableImageHelper::read_row(raster, file, x, y, n);
+        return;
+    }
+    u_char* row = new u_char[n * 3];
+    size_t nread = fread(row, 3, n, file);
+    raster->pokerow(x, y, nread, row);
+    delete [] row;
+}
+
 OverlayRaster* PPM_Helper::create_raster( u_long w, u_long h ) {
     return new OverlayRaster(w, h);
 }
@@ -2285,9 +2326,7 @@ void OvImportCmd::PI_Tiled_Read(
     fseek(file, fseek_amt, 1);
 
     for (int row = yend; row >= ybeg; --row) {
-	for (int column = xbeg; column <= xend; ++column) {
-            pih->read_poke(raster, file, column-xbeg, row-ybeg);
-	}
+        pih->read_row(raster, file, 0, row-ybeg, xend-xbeg+1);
     }
 }
 
@@ -2308,9 +2347,7 @@ void OvImportCmd::PI_Normal_Read(
 	if (fseek_amt>0)
 	    fseek(file, fseek_amt, 1);
 	    
-	for (int column = xbeg; column <= xend; ++column) {
-            pih->read_poke(raster, file, column-xbeg, row-ybeg);
-	}
+        pih->read_row(raster, file, 0, row-ybeg, xend-xbeg+1);
 	fseek_amt = (ncols-xend-1)*bpp;
     }
 }
@@ -2424,24 +2461,25 @@ OverlayRaster* OvImportCmd::PPM_Raster (istream& in, boolean ascii) {
 
     OverlayRaster* raster = new OverlayRaster(ncols, nrows);
   
-    for (int row = nrows - 1; row >= 0; --row) {
+    if (ascii) {
+      for (int row = nrows - 1; row >= 0; --row) {
         for (int column = 0; column < ncols; ++column) {
-          if (ascii) {
-            int red, green, blue;
-            in >> red >> green >> blue;
-            raster->poke(column, row,
-               float(red)/0xff, float(green)/0xff, float(blue)/0xff, 1.0);
-          } else {
-            unsigned char red, green, blue;
-            in.get((char&)red);
-            in.get((char&)green);
-            in.get((char&)blue);
-            raster->poke(column, row,
-               float(red)/0xff, float(green)/0xff, float(blue)/0xff, 1.0);
-          }
+          int red, green, blue;
+          in >> red >> green >> blue;
+          raster->poke(column, row,
+             float(red)/0xff, float(green)/0xff, float(blue)/0xff, 1.0);
 	  if (!in.good()) break;
         }
 	if (!in.good()) break;
+      }
+    } else {
+      unsigned char* rowbuf = new unsigned char[ncols * 3];
+      for (int row = nrows - 1; row >= 0; --row) {
+        in.read((char*)rowbuf, ncols * 3);
+        raster->pokerow(0, row, in.gcount() / 3, rowbuf);
+	if (!in.good()) break;
+      }
+      delete [] rowbuf;
     }
     
     raster->flush();
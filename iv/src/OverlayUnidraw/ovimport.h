@@ -269,6 +269,9 @@ public:
     virtual void read_write_pixel( FILE* in, FILE* out ) = 0;
     virtual const char* magic() = 0;
     virtual void read_poke( OverlayRaster*, FILE*, u_long x, u_long y ) = 0;
+    virtual void read_row( OverlayRaster*, FILE*, u_long x, u_long y, u_long n );
+    // read 'n' pixels and poke them into a row starting at 'x','y'.
+    // Defaults to 'n' calls of read_poke.
     virtual OverlayRaster* create_raster( u_long w, u_long h ) = 0;
 
     boolean is_ascii() { return _is_ascii; }
@@ -301,6 +304,9 @@ public:
     virtual void read_write_pixel( FILE* in, FILE* out );
     virtual const char* magic();
     virtual void read_poke( OverlayRaster*, FILE*, u_long x, u_long y );
+    virtual void read_row( OverlayRaster*, FILE*, u_long x, u_long y, u_long n );
+    // read a row of binary pixels at once and poke them with
+    // Raster::pokerow.
     virtual OverlayRaster* create_raster( u_long w, u_long h );
 };
 
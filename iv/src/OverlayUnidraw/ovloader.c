@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayLoader implementation.
+ */
+
+#include <OverlayUnidraw/ovcomps.h>
+#include <OverlayUnidraw/ovloader.h>
+#include <OverlayUnidraw/paramlist.h>
+#include <OverlayUnidraw/scriptview.h>
+
+#include <OS/file.h>
+#include <OS/string.h>
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <strstream>
+
+/*****************************************************************************/
+
+int OverlayLoader::_jobs = 0;
+int OverlayLoader::_minsize = 1 << 20;
+
+int OverlayLoader::Jobs () {
+    if (_jobs > 0) {
+        return _jobs;
+    }
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 1 ? (int)n : 1;
+}
+
+static const char* skip_space (const char* p, const char* end) {
+    while (p < end && isspace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/*
+ * close_paren returns the ')' that brings 'depth' open parentheses back
+ * to zero, skipping quoted strings the way ParamList::parse_string reads
+ * them, or nil if there is none.
+ */
+
+static const char* close_paren (const char* p, const char* end, int depth) {
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            char prev = '\0';
+            for (++p; p < end && (*p != '"' || prev == '\\'); ++p) {
+                prev = *p;
+            }
+            if (p == end) {
+                return nil;
+            }
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')' && --depth == 0) {
+            return p;
+        }
+        ++p;
+    }
+    return nil;
+}
+
+static boolean named (const char* p, int len, const char* name) {
+    return len == int(strlen(name)) && strncmp(p, name, len) == 0;
+}
+
+int OverlayLoader::Scan (const char* buf, int len, OverlayLoaderItem*& items) {
+    const char* end = buf + len;
+    const char* p = skip_space(buf, end);
+    const char* q = p;
+    while (q < end && *q != '(' && !isspace(*q)) {
+        ++q;
+    }
+    if (!named(p, q - p, "drawtool") && !named(p, q - p, "ov-idraw")) {
+        items = nil;
+        return -1;
+    }
+    q = skip_space(q, end);
+    if (q == end || *q != '(') {
+        items = nil;
+        return -1;
+    }
+    p = q + 1;
+
+    int count = 0;
+    int size = 64;
+    items = new OverlayLoaderItem[size];
+
+    for (;;) {
+        while (p < end && (*p == ',' || isspace(*p))) {
+            ++p;
+        }
+        if (p == end) {
+            break;
+        }
+        if (count == size) {
+            OverlayLoaderItem* bigger = new OverlayLoaderItem[size * 2];
+            memcpy(bigger, items, size * sizeof(OverlayLoaderItem));
+            delete [] items;
+            items = bigger;
+            size *= 2;
+        }
+        OverlayLoaderItem& item = items[count];
+        item.begin = p;
+        item.namelen = 0;
+
+        if (*p == ')') {
+            return count;
+
+        } else if (*p == ':') {
+            /* the drawing's own keywords run to its closing parenthesis */
+            item.end = close_paren(p, end, 1);
+            item.kind = Keywords;
+            if (item.end == nil) {
+                break;
+            }
+            return count + 1;
+        }
+
+        q = p;
+        while (q < end && *q != '(' && *q != ',' && !isspace(*q)) {
+            ++q;
+        }
+        const char* paren = skip_space(q, end);
+        if (paren == end || *paren != '(' || q - p >= BUFSIZ) {
+            break;
+        }
+        const char* close = close_paren(paren + 1, end, 1);
+        if (close == nil) {
+            break;
+        }
+        item.end = close + 1;
+        item.namelen = q - p;
+
+        if (
+            named(p, item.namelen, "gs") || named(p, item.namelen, "pts") ||
+            named(p, item.namelen, "pic")
+        ) {
+            item.kind = Table;
+        } else {
+            item.kind = Component;
+        }
+        ++count;
+        p = item.end;
+    }
+    delete [] items;
+    items = nil;
+    return -1;
+}
+
+/*****************************************************************************/
+
+/*
+ * A thread parses while it holds loader_lock, except inside ParamList's
+ * parse_*pts and parse_text* methods, where the hooks drop and retake it.
+ * The hooks only act for the threads of a load, which mark themselves
+ * with loader_key.
+ */
+
+static pthread_mutex_t loader_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t loader_key;
+static pthread_once_t loader_once = PTHREAD_ONCE_INIT;
+static boolean loading = false;
+
+static void loader_key_create () {
+    pthread_key_create(&loader_key, nil);
+}
+
+static void loader_release () {
+    if (pthread_getspecific(loader_key) != nil) {
+        pthread_mutex_unlock(&loader_lock);
+    }
+}
+
+static void loader_acquire () {
+    if (pthread_getspecific(loader_key) != nil) {
+        pthread_mutex_lock(&loader_lock);
+    }
+}
+
+struct LoaderJob {
+    const char* end;            // end of the mapped file
+    OverlayLoaderItem* items;
+    int nitems;
+    int next;                   // next item to hand out
+    OverlayIdrawComp* comp;
+    OverlayComp** kids;         // parsed components, by item
+    boolean failed;
+};
+
+static void item_name (const OverlayLoaderItem& item, char* name) {
+    strncpy(name, item.begin, item.namelen);
+    name[item.namelen] = '\0';
+}
+
+/*
+ * load_items takes components from the job until none are left, parsing
+ * each from an istream that starts after its name and runs to the end of
+ * the file, as the serial reader's would.
+ */
+
+static void load_items (LoaderJob& job) {
+    char name[BUFSIZ];
+    pthread_setspecific(loader_key, &job);
+    pthread_mutex_lock(&loader_lock);
+    while (!job.failed && job.next < job.nitems) {
+        int i = job.next++;
+        OverlayLoaderItem& item = job.items[i];
+        if (item.kind != OverlayLoader::Component) {
+            continue;
+        }
+        item_name(item, name);
+        const char* args = item.begin + item.namelen;
+        std::istrstream in(args, job.end - args);
+        OverlayComp* kid = OverlaysScript::read_obj(name, in, job.comp);
+        if (kid != nil && in.good() && kid->valid()) {
+            job.kids[i] = kid;
+        } else {
+            delete kid;
+            job.failed = true;
+        }
+    }
+    pthread_mutex_unlock(&loader_lock);
+    pthread_setspecific(loader_key, nil);
+}
+
+static void* load_thread (void* arg) {
+    load_items(*(LoaderJob*)arg);
+    return nil;
+}
+
+/*
+ * load_tables parses the gs/pts/pic tables into 'comp', which has to be
+ * done before any component that refers to them.
+ */
+
+static boolean load_tables (
+    const char* end, OverlayLoaderItem* items, int nitems, OverlayIdrawComp* comp
+) {
+    char name[BUFSIZ];
+    for (int i = 0; i < nitems; ++i) {
+        if (items[i].kind == OverlayLoader::Table) {
+            item_name(items[i], name);
+            const char* args = items[i].begin + items[i].namelen;
+            std::istrstream in(args, end - args);
+            if (OverlaysScript::read_gsptspic(name, in, comp) != 1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+OverlayIdrawComp* OverlayLoader::Load (const char* pathname, OverlayComp* parent) {
+    int njobs = Jobs();
+    if (njobs < 2 || loading) {
+        return nil;
+    }
+    InputFile* file = InputFile::open(String(pathname));
+    const char* buf = nil;
+    int len = (file == nil) ? -1 : file->read(buf);
+    OverlayLoaderItem* items = nil;
+    int nitems = len < _minsize ? -1 : Scan(buf, len, items);
+
+    /* every table has to come before the components that may use it */
+    int ncomps = 0;
+    for (int i = 0; i < nitems; ++i) {
+        if (items[i].kind == Component) {
+            ++ncomps;
+        } else if (items[i].kind == Table && ncomps > 0) {
+            nitems = -1;
+        }
+    }
+    if (nitems < 0 || ncomps < 2) {
+        delete [] items;
+        delete file;
+        return nil;
+    }
+    njobs = njobs < ncomps ? njobs : ncomps;
+
+    OverlayIdrawComp* comp = new OverlayIdrawComp(pathname, parent);
+    LoaderJob job;
+    job.end = buf + len;
+    job.items = items;
+    job.nitems = nitems;
+    job.next = 0;
+    job.comp = comp;
+    job.kids = new OverlayComp*[nitems];
+    job.failed = !load_tables(job.end, items, nitems, comp);
+    for (int i = 0; i < nitems; ++i) {
+        job.kids[i] = nil;
+    }
+
+    if (!job.failed) {
+        pthread_once(&loader_once, &loader_key_create);
+        loading = true;
+        ParamList::parse_hooks(&loader_release, &loader_acquire);
+
+        pthread_t* threads = new pthread_t[njobs];
+        int nthreads = 0;
+        while (
+            nthreads < njobs - 1 &&
+            pthread_create(&threads[nthreads], nil, &load_thread, &job) == 0
+        ) {
+            ++nthreads;
+        }
+        load_items(job);
+        for (int j = 0; j < nthreads; ++j) {
+            pthread_join(threads[j], nil);
+        }
+        delete [] threads;
+
+        ParamList::parse_hooks(nil, nil);
+        loading = false;
+    }
+
+    /* stitch the components together in file order */
+    for (int i = 0; i < nitems; ++i) {
+        if (job.kids[i] != nil) {
+            if (job.failed) {
+                delete job.kids[i];
+            } else {
+                comp->Append(job.kids[i]);
+            }
+        }
+    }
+    delete [] job.kids;
+
+    /* then the drawing's own keywords, and drop the tables */
+    if (!job.failed && items[nitems - 1].kind == Keywords) {
+        const OverlayLoaderItem& item = items[nitems - 1];
+        int n = item.end - item.begin;
+        char* keywords = new char[n + 2];
+        keywords[0] = '(';
+        memcpy(keywords + 1, item.begin, n);
+        keywords[n + 1] = ')';
+        std::istrstream in(keywords, n + 2);
+        job.failed = !comp->GetParamList()->read_args(in, comp);
+        delete [] keywords;
+    }
+    comp->ResetIndexedGS();
+    comp->ResetIndexedPts();
+    comp->ResetIndexedPic();
+
+    if (job.failed) {
+        delete comp;
+        comp = nil;
+    }
+    delete [] items;
+    delete file;
+    return comp;
+}
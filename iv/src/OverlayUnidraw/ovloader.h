@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayLoader - parallel parsing of large drawtool script files
+ */
+
+#ifndef ovloader_h
+#define ovloader_h
+
+#include <Unidraw/globals.h>
+
+class OverlayComp;
+class OverlayIdrawComp;
+
+//: one top-level item of a drawtool script file.
+struct OverlayLoaderItem {
+    const char* begin;          // first character of the item's name
+    const char* end;            // one past its closing parenthesis
+    int namelen;                // length of the name at 'begin'
+    int kind;
+};
+
+//: loader that parses the top-level components of a script on several threads.
+// the file is mapped and scanned once for the boundaries of its top-level
+// items.  The gs/pts/pic tables are parsed first, then the components are
+// handed out one at a time to a pool of threads, each parsing its own
+// istream over the mapped text into a detached component whose parent is
+// the new drawing, so table references and relative pathnames resolve as
+// they do in a serial load.  The parsed components are appended in file
+// order, the drawing's own keywords are parsed after them, and the tables
+// are dropped, as OverlayIdrawComp's istream constructor does.
+//
+// The catalog, the Resource reference counts and the display are shared,
+// so a thread holds the loader's lock while it parses, and drops it only
+// in ParamList's point list and text parsers, which touch nothing else.
+// Those make up most of the bytes of a large drawing.  Load returns nil
+// whenever this would not pay off or anything goes wrong, and the caller
+// reads the file serially.
+class OverlayLoader {
+public:
+    enum { Table, Component, Keywords };
+
+    static OverlayIdrawComp* Load(const char* pathname, OverlayComp* parent = nil);
+    // load 'pathname' in parallel, or return nil.
+
+    static int Scan(const char* buf, int len, OverlayLoaderItem*& items);
+    // split a drawtool script into its top-level items, returning the count
+    // (-1 if it is not a script that can be split).  Delete 'items' with [].
+
+    static void Jobs(int n) { _jobs = n; }
+    // number of threads to parse with; 0 (the default) for one per online
+    // processor, 1 to always read serially.
+    static int Jobs();
+    static void MinSize(int bytes) { _minsize = bytes; }
+    // smallest file worth parsing in parallel.
+    static int MinSize() { return _minsize; }
+protected:
+    static int _jobs;
+    static int _minsize;
+};
+
+#endif
@@ -1325,6 +1325,9 @@ void OverlayPainter::MapRoundUp(
 
 /* static */ void OverlayPainter::FreeCache() {
 
+    if (Session::instance()->default_display() == nil) {
+        return;     // nothing is cached without a display
+    }
     Display& d = *Session::instance()->default_display();
     XDisplay* dpy = d.rep()->display_;
 
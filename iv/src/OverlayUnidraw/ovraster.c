@@ -113,6 +113,13 @@ boolean RasterOvComp::IsA (ClassId id) {
     return OVRASTER_COMP == id || OverlayComp::IsA(id);
 }
 
+unsigned long RasterOvComp::Footprint () {
+    OverlayRasterRect* rr = GetOverlayRasterRect();
+    OverlayRaster* raster = rr == nil ? nil : rr->GetOriginal();
+    unsigned long bytes = OverlayComp::Footprint();
+    return raster == nil ? bytes : bytes + raster->pwidth() * raster->pheight() * 4;
+}
+
 
 Component* RasterOvComp::Copy () {
     RasterOvComp* nc = new RasterOvComp(
@@ -1355,6 +1362,56 @@ void OverlayRaster::poke(
     Raster::poke(x, y, red, green, blue, alpha);
 }
 
+void OverlayRaster::pokerow(
+    unsigned long x, unsigned long y, unsigned long n,
+    const unsigned char* rgb, unsigned int samples
+) {
+    RasterRep* r = rep();
+    if (!r->pixmap_) init_space();
+    Raster::pokerow(x, y, n, rgb, samples);
+}
+
+void OverlayRaster::pokerow(
+    unsigned long x, unsigned long y, unsigned long n,
+    const unsigned short* rgb, unsigned int samples
+) {
+    RasterRep* r = rep();
+    if (!r->pixmap_) init_space();
+    Raster::pokerow(x, y, n, rgb, samples);
+}
+
+void OverlayRaster::graypokerow(
+    unsigned long x, unsigned long y, unsigned long n, const unsigned char* gray
+) {
+    if (!gray_initialized())
+	gray_init();
+    RasterRep* r = rep();
+    if (!r->pixmap_) init_space();
+    if (x >= r->pwidth_ || y >= r->pheight_)
+	return;
+    n = Math::min(n, r->pwidth_ - x);
+    if (_gray_map) {
+	unsigned int row = r->pheight_ - (unsigned int)y - 1;
+	for (unsigned long i = 0; i < n; i++)
+	    XPutPixel(r->image_, (unsigned int)(x+i), row, _gray_map[gray[i]].pixel);
+	r->modified_ = true;
+	return;
+    }
+
+    /* without a gray ramp in the colormap, poke rows of equal samples */
+    const unsigned long chunk = 256;
+    unsigned char rgb[chunk*3];
+    while (n > 0) {
+	unsigned long count = Math::min(n, chunk);
+	for (unsigned long i = 0; i < count; i++)
+	    rgb[i*3] = rgb[i*3+1] = rgb[i*3+2] = gray[i];
+	Raster::pokerow(x, y, count, rgb, 3);
+	x += count;
+	gray += count;
+	n -= count;
+    }
+}
+
 void OverlayRaster::graypeek(unsigned long x, unsigned long y, unsigned int& i)
 {
   float rval, gval, bval, aval;
@@ -87,6 +87,7 @@ public:
     // set flag that indicates whether component will be serialized
     // by data or by pathname.
 
+    virtual unsigned long Footprint();
     virtual Component* Copy();
 
     virtual ClassId GetClassId();
@@ -122,6 +123,7 @@ protected:
     static boolean _warned;
 
 friend class RasterScript;
+friend class OvBinWriter;
 
     CLASS_SYMID("RasterComp");
 };
@@ -328,6 +330,16 @@ public:
     // lookup Color that best matches a given 'red', 'green', 'blue', and
     // 'alpha' value, and poke corresponding entry in the colormap into
     // the raster.
+    virtual void pokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned char* rgb, unsigned int samples = 3
+    );
+    // poke 'n' pixels of packed 8-bit samples starting at 'x','y'.
+    virtual void pokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned short* rgb, unsigned int samples = 3
+    );
+    // poke 'n' pixels of packed 16-bit samples starting at 'x','y'.
 
     virtual void graypeek(unsigned long x, unsigned long y, unsigned int&);
     // get green pixel value at 'x','y' and convert to an unsigned int.
@@ -350,6 +362,11 @@ public:
     // set rgb pixel values at 'x','y' with a double.
     virtual void graypoke(unsigned long x, unsigned long y, AttributeValue);
     // set rgb pixel values at 'x','y' with the contents of an AttributeValue.
+    virtual void graypokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned char* gray
+    );
+    // set 'n' pixels starting at 'x','y' from 8-bit gray values.
 
     virtual void highlight(unsigned long x, unsigned long y) {}
     // saturate the red value at 'x','y' to highlight a pixel.  Implemented
@@ -0,0 +1,1159 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ * 
+ */
+
+
+/*
+ * OverlayRenderer implementation.
+ */
+
+#include <OverlayUnidraw/ovrender.h>
+
+#include <UniIdraw/idarrows.h>
+#include <UniIdraw/idclasses.h>
+
+#include <Unidraw/classes.h>
+#include <Unidraw/iterator.h>
+#include <Unidraw/Components/text.h>
+#include <Unidraw/Graphic/ellipses.h>
+#include <Unidraw/Graphic/graphic.h>
+#include <Unidraw/Graphic/lines.h>
+#include <Unidraw/Graphic/polygons.h>
+#include <Unidraw/Graphic/pspaint.h>
+#include <Unidraw/Graphic/rasterrect.h>
+#include <Unidraw/Graphic/ustencil.h>
+#include <Unidraw/Graphic/verts.h>
+
+#include <InterViews/bitmap.h>
+#include <InterViews/coord.h>
+#include <InterViews/raster.h>
+#include <InterViews/transformer.h>
+
+#ifdef EXTERN_TIFF
+#include <tiffio.h>
+#else
+#include <TIFF/tiffio.h>
+#endif
+
+#include <OS/math.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************/
+
+static const int SPLINE_STEPS = 8;  // line segments per B-spline span
+static const float GREEK_WIDTH = 0.5;  // greeked character width / line height
+
+static const int GLYPH_WIDTH = 5;   // built-in font cells, 7 rows above the
+static const int GLYPH_ASCENT = 7;  // baseline and 2 below it
+static const int GLYPH_HEIGHT = 9;
+static const float GLYPH_MIN = 6;   // smallest readable text, in pixels
+
+/*
+ * glyphs for ASCII 32 through 126, one byte per row from the top, the
+ * leftmost column in bit 4.  Characters advance 3/5 of the font size,
+ * as the fixed-width metrics fonts are given without a display do.
+ */
+
+static const unsigned char glyphs[][GLYPH_HEIGHT] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00,  // '!'
+    0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '"'
+    0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a, 0x00, 0x00,  // '#'
+    0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04, 0x00, 0x00,  // '$'
+    0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00, 0x00,  // '%'
+    0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d, 0x00, 0x00,  // '&'
+    0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // "'"
+    0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00,  // '('
+    0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00,  // ')'
+    0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00, 0x00, 0x00,  // '*'
+    0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00, 0x00, 0x00,  // '+'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x04, 0x08,  // ','
+    0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00,  // '-'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00, 0x00,  // '.'
+    0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00, 0x00,  // '/'
+    0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e, 0x00, 0x00,  // '0'
+    0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00,  // '1'
+    0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00,  // '2'
+    0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e, 0x00, 0x00,  // '3'
+    0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02, 0x00, 0x00,  // '4'
+    0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e, 0x00, 0x00,  // '5'
+    0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e, 0x00, 0x00,  // '6'
+    0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00,  // '7'
+    0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e, 0x00, 0x00,  // '8'
+    0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c, 0x00, 0x00,  // '9'
+    0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x00,  // ':'
+    0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x04, 0x08, 0x00,  // ';'
+    0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00,  // '<'
+    0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00,  // '='
+    0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00, 0x00,  // '>'
+    0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00, 0x00,  // '?'
+    0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e, 0x00, 0x00,  // '@'
+    0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00, 0x00,  // 'A'
+    0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e, 0x00, 0x00,  // 'B'
+    0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00,  // 'C'
+    0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c, 0x00, 0x00,  // 'D'
+    0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f, 0x00, 0x00,  // 'E'
+    0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00,  // 'F'
+    0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f, 0x00, 0x00,  // 'G'
+    0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00, 0x00,  // 'H'
+    0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00,  // 'I'
+    0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c, 0x00, 0x00,  // 'J'
+    0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00,  // 'K'
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f, 0x00, 0x00,  // 'L'
+    0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00,  // 'M'
+    0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00,  // 'N'
+    0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00,  // 'O'
+    0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00,  // 'P'
+    0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d, 0x00, 0x00,  // 'Q'
+    0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11, 0x00, 0x00,  // 'R'
+    0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e, 0x00, 0x00,  // 'S'
+    0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00,  // 'T'
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00,  // 'U'
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00,  // 'V'
+    0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a, 0x00, 0x00,  // 'W'
+    0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11, 0x00, 0x00,  // 'X'
+    0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x00, 0x00,  // 'Y'
+    0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f, 0x00, 0x00,  // 'Z'
+    0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e, 0x00, 0x00,  // '['
+    0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00,  // '\\'
+    0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e, 0x00, 0x00,  // ']'
+    0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '^'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00,  // '_'
+    0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '`'
+    0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f, 0x00, 0x00,  // 'a'
+    0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e, 0x00, 0x00,  // 'b'
+    0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00,  // 'c'
+    0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f, 0x00, 0x00,  // 'd'
+    0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e, 0x00, 0x00,  // 'e'
+    0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08, 0x00, 0x00,  // 'f'
+    0x00, 0x00, 0x0f, 0x11, 0x11, 0x13, 0x0d, 0x01, 0x0e,  // 'g'
+    0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00,  // 'h'
+    0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00,  // 'i'
+    0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c,  // 'j'
+    0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00,  // 'k'
+    0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00,  // 'l'
+    0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11, 0x00, 0x00,  // 'm'
+    0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00,  // 'n'
+    0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00,  // 'o'
+    0x00, 0x00, 0x1e, 0x11, 0x11, 0x11, 0x1e, 0x10, 0x10,  // 'p'
+    0x00, 0x00, 0x0f, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x01,  // 'q'
+    0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00,  // 'r'
+    0x00, 0x00, 0x0e, 0x10, 0x0e, 0x01, 0x1e, 0x00, 0x00,  // 's'
+    0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00,  // 't'
+    0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x00, 0x00,  // 'u'
+    0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00,  // 'v'
+    0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a, 0x00, 0x00,  // 'w'
+    0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x00, 0x00,  // 'x'
+    0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x01, 0x0e,  // 'y'
+    0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00,  // 'z'
+    0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00, 0x00,  // '{'
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00,  // '|'
+    0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00, 0x00,  // '}'
+    0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00, 0x00,  // '~'
+};
+
+static int blend (int c0, int c1, float f) {
+    int r = int(((c0 >> 16) & 0xff)*(1 - f) + ((c1 >> 16) & 0xff)*f + 0.5);
+    int g = int(((c0 >> 8) & 0xff)*(1 - f) + ((c1 >> 8) & 0xff)*f + 0.5);
+    int b = int((c0 & 0xff)*(1 - f) + (c1 & 0xff)*f + 0.5);
+    return (r << 16) | (g << 8) | b;
+}
+
+static int compare_floats (const void* a, const void* b) {
+    float fa = *(const float*) a, fb = *(const float*) b;
+    return (fa < fb) ? -1 : (fa > fb) ? 1 : 0;
+}
+
+/*****************************************************************************/
+
+/*
+ * OverlayRenderState is the graphics state Graphic::concat would build,
+ * holding borrowed pointers instead of references so that walking a tree
+ * writes nothing shared with other renderers.
+ */
+
+class OverlayRenderState {
+public:
+    OverlayRenderState();
+    OverlayRenderState(Graphic* child, OverlayRenderState& parent);
+
+    PSColor* GetFgColor() { return _fg; }
+    PSColor* GetBgColor() { return _bg; }
+    PSBrush* GetBrush() { return _br; }
+    PSPattern* GetPattern() { return _pat; }
+    PSFont* GetFont() { return _font; }
+    int BgFilled() { return _fill; }
+    Transformer* GetTransformer() { return &_t; }
+protected:
+    PSColor* _fg, * _bg;
+    PSBrush* _br;
+    PSPattern* _pat;
+    PSFont* _font;
+    int _fill;
+    Transformer _t;
+};
+
+OverlayRenderState::OverlayRenderState () {
+    _fg = _bg = nil;
+    _br = nil;
+    _pat = nil;
+    _font = nil;
+    _fill = UNDEF;
+}
+
+OverlayRenderState::OverlayRenderState (
+    Graphic* g, OverlayRenderState& gs
+) {
+    Transformer* t = g->GetTransformer();
+
+    if (t != nil) {
+        _t = *t;
+        _t.Postmultiply(&gs._t);
+    } else {
+        _t = gs._t;
+    }
+    _fg = (gs._fg == nil) ? g->GetFgColor() : gs._fg;
+    _bg = (gs._bg == nil) ? g->GetBgColor() : gs._bg;
+    _br = (gs._br == nil) ? g->GetBrush() : gs._br;
+    _pat = (gs._pat == nil) ? g->GetPattern() : gs._pat;
+    _font = (gs._font == nil) ? g->GetFont() : gs._font;
+    _fill = (gs._fill == UNDEF) ? g->BgFilled() : gs._fill;
+}
+
+/*****************************************************************************/
+
+OverlayRenderer::OverlayRenderer (int width, int height) {
+    _width = Math::max(width, 1);
+    _height = Math::max(height, 1);
+    _data = new unsigned char[_width*_height*3];
+    _l = _b = _ox = _oy = 0;
+    _mag = 1;
+    _px = _py = nil;
+    _pcount = _psize = 0;
+    _xs = nil;
+    _xsize = 0;
+    _rasters = nil;
+    Clear();
+}
+
+OverlayRenderer::~OverlayRenderer () {
+    delete [] _data;
+    delete [] _px;
+    delete [] _py;
+    delete [] _xs;
+}
+
+void OverlayRenderer::Clear () {
+    memset(_data, 0xff, _width*_height*3);
+}
+
+void OverlayRenderer::Render (Graphic* g) {
+    float l, b, r, t;
+    g->GetBounds(l, b, r, t);
+    Render(g, l, b, r, t);
+}
+
+void OverlayRenderer::Render (
+    Graphic* g, float l, float b, float r, float t, OverlayRenderRasters* rasters
+) {
+    OverlayRenderRasters* own = (rasters == nil)
+        ? new OverlayRenderRasters(g) : nil;
+    _rasters = (rasters == nil) ? own : rasters;
+
+    float w = Math::max(r - l, float(1));
+    float h = Math::max(t - b, float(1));
+    _mag = Math::min(_width/w, _height/h);
+    _l = l;
+    _b = b;
+    _ox = (_width - w*_mag)/2;
+    _oy = (_height - h*_mag)/2;
+
+    Clear();
+    OverlayRenderState root;
+
+    if (!g->Hidden()) {
+        OverlayRenderState gs(g, root);
+        Draw(g, gs);
+    }
+    _rasters = nil;
+    delete own;
+}
+
+/*
+ * Draw walks the graphic tree the way Picture::draw does, concatenating
+ * each child's graphics state with its parent's, and dispatches leaves
+ * on the component class they belong to.
+ */
+
+void OverlayRenderer::Draw (Graphic* g, OverlayRenderState& gs) {
+    ClassId compid = g->CompId();
+
+    if (compid == GRAPHIC_COMPS) {
+        Iterator i;
+
+        for (g->First(i); !g->Done(i); g->Next(i)) {
+            Graphic* child = g->GetGraphic(i);
+
+            if (!child->Hidden()) {
+                OverlayRenderState cgs(child, gs);
+                Draw(child, cgs);
+            }
+        }
+
+    } else if (compid == LINE_COMP || compid == ARROWLINE_COMP) {
+        Coord x0, y0, x1, y1;
+        ((Line*) g)->GetOriginal(x0, y0, x1, y1);
+        float x[2], y[2];
+        Map(gs.GetTransformer(), x0, y0, x[0], y[0]);
+        Map(gs.GetTransformer(), x1, y1, x[1], y[1]);
+
+        if (compid == LINE_COMP) {
+            Stroke(x, y, 2, false, gs, true);
+
+        } else {
+            ArrowLine* line = (ArrowLine*) g;
+            float scale = line->ArrowScale();
+            float hx[3], hy[3], tx[3], ty[3];
+            float w = StrokeWidth(gs);
+
+            if (line->Head()) {
+                ArrowheadPoints(x0, y0, x1, y1, scale, gs, hx, hy);
+                Retract(x[0], y[0], hx, hy, w);
+            }
+            if (line->Tail()) {
+                ArrowheadPoints(x1, y1, x0, y0, scale, gs, tx, ty);
+                Retract(x[1], y[1], tx, ty, w);
+            }
+            Stroke(x, y, 2, false, gs, true);
+
+            if (line->Head()) DrawArrowhead(hx, hy, gs);
+            if (line->Tail()) DrawArrowhead(tx, ty, gs);
+        }
+
+    } else if (compid == MULTILINE_COMP || compid == ARROWMULTILINE_COMP) {
+        DrawVertices(g, gs, false, false);
+
+    } else if (compid == POLYGON_COMP) {
+        DrawVertices(g, gs, true, false);
+
+    } else if (compid == SPLINE_COMP || compid == ARROWSPLINE_COMP) {
+        DrawVertices(g, gs, false, true);
+
+    } else if (compid == CLOSEDSPLINE_COMP) {
+        DrawVertices(g, gs, true, true);
+
+    } else if (compid == RECT_COMP) {
+        Coord l, b, r, t;
+        ((Rect*) g)->GetOriginal(l, b, r, t);
+        float x[4], y[4];
+        Transformer* tr = gs.GetTransformer();
+        Map(tr, l, b, x[0], y[0]);
+        Map(tr, r, b, x[1], y[1]);
+        Map(tr, r, t, x[2], y[2]);
+        Map(tr, l, t, x[3], y[3]);
+        Fill(x, y, 4, gs);
+        Stroke(x, y, 4, true, gs, true);
+
+    } else if (compid == ELLIPSE_COMP) {
+        DrawEllipse(g, gs);
+
+    } else if (compid == TEXT_COMP) {
+        DrawText(g, gs);
+
+    } else if (compid == STENCIL_COMP) {
+        DrawStencil(g, gs);
+
+    } else if (compid == RASTER_COMP) {
+        DrawRaster(g, gs);
+    }
+}
+
+void OverlayRenderer::DrawVertices (
+    Graphic* g, OverlayRenderState& gs, boolean closed, boolean spline
+) {
+    const Coord* cx, * cy;
+    int n = ((Vertices*) g)->GetOriginal(cx, cy);
+
+    if (n <= 0) {
+        return;
+    }
+    ClassId compid = g->CompId();
+    boolean head = false, tail = false;
+    float scale = 1;
+
+    if (compid == ARROWMULTILINE_COMP) {
+        ArrowMultiLine* ml = (ArrowMultiLine*) g;
+        head = ml->Head();
+        tail = ml->Tail();
+        scale = ml->ArrowScale();
+
+    } else if (compid == ARROWSPLINE_COMP) {
+        ArrowOpenBSpline* sp = (ArrowOpenBSpline*) g;
+        head = sp->Head();
+        tail = sp->Tail();
+        scale = sp->ArrowScale();
+    }
+    head = head && n >= 2;
+    tail = tail && n >= 2;
+
+    Transformer* t = gs.GetTransformer();
+    float* x = new float[n];
+    float* y = new float[n];
+    float hx[3], hy[3], tx[3], ty[3];
+
+    for (int i = 0; i < n; ++i) {
+        Map(t, cx[i], cy[i], x[i], y[i]);
+    }
+    if (head) {
+        ArrowheadPoints(cx[0], cy[0], cx[1], cy[1], scale, gs, hx, hy);
+    }
+    if (tail) {
+        ArrowheadPoints(
+            cx[n-1], cy[n-1], cx[n-2], cy[n-2], scale, gs, tx, ty
+        );
+    }
+    float* px = x, * py = y;
+    int count = n;
+
+    if (spline && n >= 3) {
+        Spline(x, y, n, true);
+        Fill(_px, _py, _pcount, gs);
+        Spline(x, y, n, closed);
+        px = _px;
+        py = _py;
+        count = _pcount;
+
+    } else {
+        Fill(x, y, n, gs);
+    }
+    float w = StrokeWidth(gs);
+
+    if (head) Retract(px[0], py[0], hx, hy, w);
+    if (tail) Retract(px[count-1], py[count-1], tx, ty, w);
+    Stroke(px, py, count, closed, gs, true);
+
+    if (head) DrawArrowhead(hx, hy, gs);
+    if (tail) DrawArrowhead(tx, ty, gs);
+    delete [] x;
+    delete [] y;
+}
+
+void OverlayRenderer::DrawEllipse (Graphic* g, OverlayRenderState& gs) {
+    Coord cx, cy;
+    int r1, r2;
+    ((Ellipse*) g)->GetOriginal(cx, cy, r1, r2);
+
+    int n = int((r1 + r2)*_mag);
+    n = Math::max(16, Math::min(n, 360));
+    Transformer* t = gs.GetTransformer();
+    float* x = new float[n];
+    float* y = new float[n];
+
+    for (int i = 0; i < n; ++i) {
+        double a = 2*M_PI*i/n;
+        Map(t, cx + r1*cos(a), cy + r2*sin(a), x[i], y[i]);
+    }
+    Fill(x, y, n, gs);
+    Stroke(x, y, n, true, gs, true);
+    delete [] x;
+    delete [] y;
+}
+
+/*
+ * DrawText draws each character's glyph as runs of cells, each mapped
+ * through the text's transformer, so text scales and rotates with the
+ * drawing.  Lines stack downward from the origin like TextGraphic::draw,
+ * each with its baseline a fifth of the font size above its bottom.
+ * Text smaller than GLYPH_MIN pixels is greeked into a bar instead.
+ */
+
+void OverlayRenderer::DrawText (Graphic* g, OverlayRenderState& gs) {
+    TextGraphic* text = (TextGraphic*) g;
+    PSColor* fg = gs.GetFgColor();
+
+    if (fg == nil || fg->None()) {
+        return;
+    }
+    int rgb = Pixel(fg);
+    const char* s = text->GetOriginal();
+    int lineht = text->GetLineHeight();
+    PSFont* font = gs.GetFont();
+    float size = (font == nil || font->GetLineHt() <= 0)
+        ? lineht : font->GetLineHt();
+    float cw = size*3/5/(GLYPH_WIDTH + 1), ch = size/GLYPH_HEIGHT;
+    Transformer* t = gs.GetTransformer();
+    float x[4], y[4];
+
+    Map(t, 0, 0, x[0], y[0]);
+    Map(t, 0, size, x[1], y[1]);
+    boolean greek = hypot(x[1] - x[0], y[1] - y[0]) < GLYPH_MIN;
+    float ypos = 0;
+
+    while (*s != '\0') {
+        const char* eol = strchr(s, '\n');
+        int len = (eol == nil) ? strlen(s) : eol - s;
+
+        if (greek && len > 0) {
+            float l = 0, r = len*lineht*GREEK_WIDTH;
+            float b = ypos + lineht*0.2, tp = ypos + lineht*0.6;
+            Map(t, l, b, x[0], y[0]);
+            Map(t, r, b, x[1], y[1]);
+            Map(t, r, tp, x[2], y[2]);
+            Map(t, l, tp, x[3], y[3]);
+            FillPolygon(x, y, 4, rgb, nil, -1);
+
+        } else if (!greek) {
+            float base = ypos + size/5;
+
+            for (int i = 0; i < len; ++i) {
+                int c = (unsigned char) s[i];
+                const unsigned char* glyph = glyphs[
+                    (c > ' ' && c < 127) ? c - ' ' : 0
+                ];
+                float left = i*(GLYPH_WIDTH + 1)*cw;
+
+                for (int row = 0; row < GLYPH_HEIGHT; ++row) {
+                    float b = base + (GLYPH_ASCENT - 1 - row)*ch;
+                    int bits = glyph[row];
+                    int col = 0;
+
+                    while (col < GLYPH_WIDTH) {
+                        if (!(bits & (1 << (GLYPH_WIDTH - 1 - col)))) {
+                            ++col;
+                            continue;
+                        }
+                        int end = col;
+
+                        while (
+                            end < GLYPH_WIDTH &&
+                            (bits & (1 << (GLYPH_WIDTH - 1 - end)))
+                        ) {
+                            ++end;
+                        }
+                        float l = left + col*cw, r = left + end*cw;
+                        Map(t, l, b, x[0], y[0]);
+                        Map(t, r, b, x[1], y[1]);
+                        Map(t, r, b + ch, x[2], y[2]);
+                        Map(t, l, b + ch, x[3], y[3]);
+                        FillPolygon(x, y, 4, rgb, nil, -1);
+                        col = end;
+                    }
+                }
+            }
+        }
+        ypos -= lineht;
+        s += (eol == nil) ? len : len + 1;
+    }
+}
+
+void OverlayRenderer::DrawStencil (Graphic* g, OverlayRenderState& gs) {
+    Bitmap* image, * mask;
+    ((UStencil*) g)->GetOriginal(image, mask);
+    PSColor* fgc = gs.GetFgColor();
+    PSColor* bgc = gs.GetBgColor();
+    int fg = (fgc == nil || fgc->None()) ? -1 : Pixel(fgc);
+    int bg = (bgc == nil || bgc->None() || mask == nil) ? -1 : Pixel(bgc);
+
+    if (image == nil) {
+        return;
+    }
+    int w = image->pwidth(), h = image->pheight();
+    Transformer* t = gs.GetTransformer();
+    float x[4], y[4];
+    Map(t, 0, 0, x[0], y[0]);
+    Map(t, w, 0, x[1], y[1]);
+    Map(t, w, h, x[2], y[2]);
+    Map(t, 0, h, x[3], y[3]);
+
+    int x0 = Math::max(0, int(Math::min(x[0], x[1], x[2], x[3])));
+    int x1 = Math::min(_width - 1, int(Math::max(x[0], x[1], x[2], x[3])));
+    int y0 = Math::max(0, int(Math::min(y[0], y[1], y[2], y[3])));
+    int y1 = Math::min(_height - 1, int(Math::max(y[0], y[1], y[2], y[3])));
+
+    for (int dy = y0; dy <= y1; ++dy) {
+        for (int dx = x0; dx <= x1; ++dx) {
+            float bx, by;
+            Unmap(t, dx + 0.5, dy + 0.5, bx, by);
+            int ix = int(floor(bx)), iy = int(floor(by));
+
+            if (ix >= 0 && ix < w && iy >= 0 && iy < h) {
+                if (image->peek(ix, iy)) {
+                    Plot(dx, dy, fg);
+                } else if (mask != nil && mask->peek(ix, iy)) {
+                    Plot(dx, dy, bg);
+                }
+            }
+        }
+    }
+}
+
+void OverlayRenderer::DrawRaster (Graphic* g, OverlayRenderState& gs) {
+    Raster* raster = ((RasterRect*) g)->GetOriginal();
+    const unsigned char* pixels = (raster == nil || _rasters == nil)
+        ? nil : _rasters->Pixels(raster);
+
+    if (pixels == nil) {
+        return;
+    }
+    int w = raster->pwidth(), h = raster->pheight();
+    Transformer* t = gs.GetTransformer();
+    float x[4], y[4];
+    Map(t, 0, 0, x[0], y[0]);
+    Map(t, w, 0, x[1], y[1]);
+    Map(t, w, h, x[2], y[2]);
+    Map(t, 0, h, x[3], y[3]);
+
+    int x0 = Math::max(0, int(Math::min(x[0], x[1], x[2], x[3])));
+    int x1 = Math::min(_width - 1, int(Math::max(x[0], x[1], x[2], x[3])));
+    int y0 = Math::max(0, int(Math::min(y[0], y[1], y[2], y[3])));
+    int y1 = Math::min(_height - 1, int(Math::max(y[0], y[1], y[2], y[3])));
+
+    for (int dy = y0; dy <= y1; ++dy) {
+        unsigned char* row = _data + dy*_width*3;
+
+        for (int dx = x0; dx <= x1; ++dx) {
+            float rx, ry;
+            Unmap(t, dx + 0.5, dy + 0.5, rx, ry);
+            int ix = int(floor(rx)), iy = int(floor(ry));
+
+            if (ix >= 0 && ix < w && iy >= 0 && iy < h) {
+                memcpy(row + dx*3, pixels + (iy*w + ix)*3, 3);
+            }
+        }
+    }
+}
+
+/*
+ * ArrowheadPoints maps the corners of an arrowhead pointing from (fromx,
+ * fromy) to its tip at (tipx, tipy), sized as the idraw arrows size theirs
+ * in their own coordinates: left corner, tip, right corner.
+ */
+
+void OverlayRenderer::ArrowheadPoints (
+    float tipx, float tipy, float fromx, float fromy, float scale,
+    OverlayRenderState& gs, float* x, float* y
+) {
+    float w = Math::round(ARROWWIDTH*ivpoints)*scale/2;
+    float h = Math::round(ARROWHEIGHT*ivpoints)*scale;
+    float dx = tipx - fromx, dy = tipy - fromy;
+    float len = sqrt(dx*dx + dy*dy);
+
+    if (len > 0) {
+        dx /= len;
+        dy /= len;
+    } else {
+        dx = 0;
+        dy = 1;
+    }
+    float bx = tipx - dx*h, by = tipy - dy*h;
+    Transformer* t = gs.GetTransformer();
+    Map(t, bx + dy*w, by - dx*w, x[0], y[0]);
+    Map(t, tipx, tipy, x[1], y[1]);
+    Map(t, bx - dy*w, by + dx*w, x[2], y[2]);
+}
+
+/*
+ * Retract pulls the end of a line w pixels wide back into its arrowhead,
+ * to where the arrowhead is as wide as the line, so that the line's end
+ * doesn't stick out past the tip, as Arrowhead::CorrectedTip does.
+ */
+
+void OverlayRenderer::Retract (
+    float& x, float& y, const float* ax, const float* ay, float w
+) {
+    float bx = (ax[0] + ax[2])/2, by = (ay[0] + ay[2])/2;
+    float dx = ax[1] - bx, dy = ay[1] - by;
+    float h = sqrt(dx*dx + dy*dy);
+    float hw = sqrt(
+        (ax[2] - ax[0])*(ax[2] - ax[0]) + (ay[2] - ay[0])*(ay[2] - ay[0])
+    )/2;
+
+    if (w < 1.5 || h <= 0 || hw <= 0) {
+        return;
+    }
+    float r = Math::min(w/2*h/hw + w/2, h);
+    x = ax[1] - dx/h*r;
+    y = ay[1] - dy/h*r;
+}
+
+void OverlayRenderer::DrawArrowhead (
+    const float* x, const float* y, OverlayRenderState& gs
+) {
+    Fill(x, y, 3, gs);
+    Stroke(x, y, 3, true, gs, false);
+}
+
+/*****************************************************************************/
+
+// Map takes drawing coordinates through the graphic's total transformation
+// and then into image pixels, whose y axis runs downward.
+
+void OverlayRenderer::Map (
+    Transformer* t, float x, float y, float& dx, float& dy
+) {
+    if (t != nil) {
+        t->Transform(x, y, x, y);
+    }
+    dx = (x - _l)*_mag + _ox;
+    dy = _height - ((y - _b)*_mag + _oy);
+}
+
+void OverlayRenderer::Unmap (
+    Transformer* t, float dx, float dy, float& x, float& y
+) {
+    x = (dx - _ox)/_mag + _l;
+    y = (_height - dy - _oy)/_mag + _b;
+
+    if (t != nil) {
+        t->InvTransform(x, y, x, y);
+    }
+}
+
+void OverlayRenderer::AddPoint (float x, float y) {
+    if (_pcount == _psize) {
+        int size = Math::max(2*_psize, 64);
+        float* px = new float[size];
+        float* py = new float[size];
+        memcpy(px, _px, _pcount*sizeof(float));
+        memcpy(py, _py, _pcount*sizeof(float));
+        delete [] _px;
+        delete [] _py;
+        _px = px;
+        _py = py;
+        _psize = size;
+    }
+    _px[_pcount] = x;
+    _py[_pcount] = y;
+    ++_pcount;
+}
+
+/*
+ * Spline flattens a uniform cubic B-spline into _px/_py.  Open splines
+ * triple their end points and closed ones wrap around, as Painter's
+ * BSpline and ClosedBSpline do.
+ */
+
+void OverlayRenderer::Spline (
+    const float* x, const float* y, int n, boolean closed
+) {
+    int m = closed ? n + 3 : n + 4;
+    int* index = new int[m];
+
+    for (int i = 0; i < m; ++i) {
+        if (closed) {
+            index[i] = (i + n - 1) % n;
+        } else {
+            index[i] = Math::max(0, Math::min(i - 2, n - 1));
+        }
+    }
+    _pcount = 0;
+
+    for (int s = 0; s + 3 < m; ++s) {
+        const int* k = &index[s];
+
+        for (int j = (s == 0) ? 0 : 1; j <= SPLINE_STEPS; ++j) {
+            float u = float(j)/SPLINE_STEPS;
+            float u2 = u*u, u3 = u2*u;
+            float b0 = (1 - u)*(1 - u)*(1 - u)/6;
+            float b1 = (3*u3 - 6*u2 + 4)/6;
+            float b2 = (-3*u3 + 3*u2 + 3*u + 1)/6;
+            float b3 = u3/6;
+            AddPoint(
+                b0*x[k[0]] + b1*x[k[1]] + b2*x[k[2]] + b3*x[k[3]],
+                b0*y[k[0]] + b1*y[k[1]] + b2*y[k[2]] + b3*y[k[3]]
+            );
+        }
+    }
+    delete [] index;
+}
+
+/*****************************************************************************/
+
+int OverlayRenderer::Pixel (PSColor* c) {
+    ColorIntensity r, g, b;
+    c->GetIntensities(r, g, b);
+    return (int(r*255 + 0.5) << 16) | (int(g*255 + 0.5) << 8) | int(b*255 + 0.5);
+}
+
+/*
+ * Fill paints an interior with the graphic's pattern: bitmap patterns
+ * are tiled in image space like X stipples, gray levels are blended
+ * between foreground and background as the idraw prologue does.
+ */
+
+void OverlayRenderer::Fill (
+    const float* x, const float* y, int n, OverlayRenderState& gs
+) {
+    PSPattern* pat = gs.GetPattern();
+    PSColor* fgc = gs.GetFgColor();
+    PSColor* bgc = gs.GetBgColor();
+
+    if (n < 3 || pat == nil || pat->None() || fgc == nil) {
+        return;
+    }
+    int fg = fgc->None() ? -1 : Pixel(fgc);
+    int bg = (bgc == nil || bgc->None()) ? -1 : Pixel(bgc);
+
+    if (pat->GetSize() > 0) {
+        FillPolygon(x, y, n, fg, pat->GetData(), gs.BgFilled() ? bg : -1);
+
+    } else if (fg >= 0) {
+        float gray = pat->GetGrayLevel();
+        int rgb = (bg < 0 || gray <= 0) ? fg : blend(fg, bg, gray);
+        FillPolygon(x, y, n, rgb, nil, -1);
+    }
+}
+
+float OverlayRenderer::StrokeWidth (OverlayRenderState& gs) {
+    PSBrush* br = gs.GetBrush();
+    return (br == nil || br->None()) ? 0 : Math::max(br->width()*_mag, float(1));
+}
+
+// Stroke draws dashed brushes solid unless dashed is true, as arrowheads
+// are drawn.
+
+void OverlayRenderer::Stroke (
+    const float* x, const float* y, int n, boolean closed,
+    OverlayRenderState& gs, boolean dashed
+) {
+    PSBrush* br = gs.GetBrush();
+    PSColor* fgc = gs.GetFgColor();
+
+    if (n < 2 || br == nil || br->None() || fgc == nil || fgc->None()) {
+        return;
+    }
+    int rgb = Pixel(fgc);
+    float w = StrokeWidth(gs);
+    const int* dash = br->GetDashPattern();
+    int ndash = dashed ? br->GetDashPatternSize() : 0;
+    int d = 0;
+    boolean on = true;
+    float left = (ndash > 0) ? Math::max(dash[0]*_mag, float(1)) : 0;
+
+    if (ndash > 0) {
+        float offset = br->GetDashOffset()*_mag;
+
+        while (offset > 0) {
+            float step = Math::min(offset, left);
+            offset -= step;
+            left -= step;
+
+            if (left <= 0) {
+                d = (d + 1) % ndash;
+                on = !on;
+                left = Math::max(dash[d]*_mag, float(1));
+            }
+        }
+    }
+    int segs = closed ? n : n - 1;
+
+    for (int i = 0; i < segs; ++i) {
+        float x0 = x[i], y0 = y[i];
+        float x1 = x[(i + 1) % n], y1 = y[(i + 1) % n];
+
+        if (ndash == 0) {
+            Segment(x0, y0, x1, y1, w, rgb);
+            continue;
+        }
+        float len = sqrt((x1 - x0)*(x1 - x0) + (y1 - y0)*(y1 - y0));
+        float pos = 0;
+
+        while (pos < len) {
+            float step = Math::min(len - pos, left);
+
+            if (on) {
+                float f0 = pos/len, f1 = (pos + step)/len;
+                Segment(
+                    x0 + (x1 - x0)*f0, y0 + (y1 - y0)*f0,
+                    x0 + (x1 - x0)*f1, y0 + (y1 - y0)*f1, w, rgb
+                );
+            }
+            pos += step;
+            left -= step;
+
+            if (left <= 0) {
+                d = (d + 1) % ndash;
+                on = !on;
+                left = Math::max(dash[d]*_mag, float(1));
+            }
+        }
+    }
+}
+
+/*
+ * Segment draws hairlines with a DDA and wider lines as a quadrilateral
+ * capped by squares at both ends, which also fills in the joins.
+ */
+
+void OverlayRenderer::Segment (
+    float x0, float y0, float x1, float y1, float w, int rgb
+) {
+    float dx = x1 - x0, dy = y1 - y0;
+
+    if (w < 1.5) {
+        int steps = int(Math::max(Math::abs(dx), Math::abs(dy))) + 1;
+
+        for (int i = 0; i <= steps; ++i) {
+            Plot(int(x0 + dx*i/steps), int(y0 + dy*i/steps), rgb);
+        }
+        return;
+    }
+    float h = w/2;
+    float len = sqrt(dx*dx + dy*dy);
+    float x[4], y[4];
+
+    if (len > 0) {
+        float nx = -dy/len*h, ny = dx/len*h;
+        x[0] = x0 + nx; y[0] = y0 + ny;
+        x[1] = x1 + nx; y[1] = y1 + ny;
+        x[2] = x1 - nx; y[2] = y1 - ny;
+        x[3] = x0 - nx; y[3] = y0 - ny;
+        FillPolygon(x, y, 4, rgb, nil, -1);
+    }
+    for (int e = 0; e < 2; ++e) {
+        float cx = e ? x1 : x0, cy = e ? y1 : y0;
+        x[0] = cx - h; y[0] = cy - h;
+        x[1] = cx + h; y[1] = cy - h;
+        x[2] = cx + h; y[2] = cy + h;
+        x[3] = cx - h; y[3] = cy + h;
+        FillPolygon(x, y, 4, rgb, nil, -1);
+    }
+}
+
+/*
+ * FillPolygon scan converts with the even-odd rule, sampling at pixel
+ * centers.  pat, if given, is a 16x16 stipple selecting between rgb and
+ * bg; a negative color is left unpainted.
+ */
+
+void OverlayRenderer::FillPolygon (
+    const float* x, const float* y, int n, int rgb, const int* pat, int bg
+) {
+    float ymin = y[0], ymax = y[0];
+
+    for (int i = 1; i < n; ++i) {
+        ymin = Math::min(ymin, y[i]);
+        ymax = Math::max(ymax, y[i]);
+    }
+    int y0 = Math::max(0, int(ceil(ymin - 0.5)));
+    int y1 = Math::min(_height - 1, int(floor(ymax - 0.5)));
+
+    if (_xsize < n) {
+        delete [] _xs;
+        _xsize = Math::max(n, 2*_xsize);
+        _xs = new float[_xsize];
+    }
+
+    for (int sy = y0; sy <= y1; ++sy) {
+        float yc = sy + 0.5;
+        int count = 0;
+
+        for (int i = 0; i < n; ++i) {
+            float xa = x[i], ya = y[i];
+            float xb = x[(i + 1) % n], yb = y[(i + 1) % n];
+
+            if ((ya <= yc && yc < yb) || (yb <= yc && yc < ya)) {
+                _xs[count++] = xa + (yc - ya)*(xb - xa)/(yb - ya);
+            }
+        }
+        if (count < 8) {
+            for (int i = 1; i < count; ++i) {
+                float v = _xs[i];
+                int j = i;
+
+                for (; j > 0 && _xs[j - 1] > v; --j) {
+                    _xs[j] = _xs[j - 1];
+                }
+                _xs[j] = v;
+            }
+        } else {
+            qsort(_xs, count, sizeof(float), &compare_floats);
+        }
+        for (int i = 0; i + 1 < count; i += 2) {
+            Span(sy, int(ceil(_xs[i] - 0.5)), int(floor(_xs[i+1] - 0.5)), rgb, pat, bg);
+        }
+    }
+}
+
+void OverlayRenderer::Span (
+    int y, int x0, int x1, int rgb, const int* pat, int bg
+) {
+    x0 = Math::max(x0, 0);
+    x1 = Math::min(x1, _width - 1);
+
+    if (pat == nil) {
+        if (rgb < 0) {
+            return;
+        }
+        unsigned char* p = _data + (y*_width + x0)*3;
+        unsigned char r = rgb >> 16, g = rgb >> 8, b = rgb;
+
+        for (int x = x0; x <= x1; ++x) {
+            *p++ = r;
+            *p++ = g;
+            *p++ = b;
+        }
+        return;
+    }
+    int row = pat[y % patternHeight];
+
+    for (int x = x0; x <= x1; ++x) {
+        int bit = row & (1 << (patternWidth - 1 - x % patternWidth));
+        Plot(x, y, bit ? rgb : bg);
+    }
+}
+
+void OverlayRenderer::Plot (int x, int y, int rgb) {
+    if (rgb >= 0 && x >= 0 && x < _width && y >= 0 && y < _height) {
+        unsigned char* p = _data + (y*_width + x)*3;
+        p[0] = rgb >> 16;
+        p[1] = rgb >> 8;
+        p[2] = rgb;
+    }
+}
+
+/*****************************************************************************/
+
+boolean OverlayRenderer::WritePPM (const char* path) {
+    FILE* f = fopen(path, "w");
+
+    if (f == nil) {
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", _width, _height);
+    boolean ok = fwrite(_data, 3, _width*_height, f) == size_t(_width*_height);
+    return fclose(f) == 0 && ok;
+}
+
+boolean OverlayRenderer::WriteTIFF (const char* path) {
+    TIFF* tif = TIFFOpen(path, "w");
+
+    if (tif == nil) {
+        return false;
+    }
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, _width);
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, _height);
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 8);
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 3);
+    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, Math::max(1, 8192/(_width*3)));
+    boolean ok = true;
+
+    for (int y = 0; ok && y < _height; ++y) {
+        ok = TIFFWriteScanline(tif, _data + y*_width*3, y, 0) >= 0;
+    }
+    TIFFClose(tif);
+    return ok;
+}
+
+/*****************************************************************************/
+
+OverlayRenderRasters::OverlayRenderRasters (Graphic* g) {
+    _raster = nil;
+    _pixels = nil;
+    _count = _size = 0;
+    Add(g);
+}
+
+OverlayRenderRasters::~OverlayRenderRasters () {
+    for (int i = 0; i < _count; ++i) {
+        delete [] _pixels[i];
+    }
+    delete [] _raster;
+    delete [] _pixels;
+}
+
+/*
+ * Add walks the tree as OverlayRenderer::Draw does, reading each raster
+ * a row at a time into the slot that keeps _raster sorted.
+ */
+
+void OverlayRenderRasters::Add (Graphic* g) {
+    ClassId compid = g->CompId();
+
+    if (compid == GRAPHIC_COMPS) {
+        Iterator i;
+
+        for (g->First(i); !g->Done(i); g->Next(i)) {
+            Add(g->GetGraphic(i));
+        }
+        return;
+
+    } else if (compid != RASTER_COMP) {
+        return;
+    }
+    Raster* raster = ((RasterRect*) g)->GetOriginal();
+    int lo = Find(raster);
+
+    if (raster == nil || (lo < _count && _raster[lo] == raster)) {
+        return;
+    }
+    if (_count == _size) {
+        _size = Math::max(2*_size, 8);
+        Raster** nraster = new Raster*[_size];
+        unsigned char** npixels = new unsigned char*[_size];
+        memcpy(nraster, _raster, _count*sizeof(Raster*));
+        memcpy(npixels, _pixels, _count*sizeof(unsigned char*));
+        delete [] _raster;
+        delete [] _pixels;
+        _raster = nraster;
+        _pixels = npixels;
+    }
+    memmove(_raster + lo + 1, _raster + lo, (_count - lo)*sizeof(Raster*));
+    memmove(_pixels + lo + 1, _pixels + lo, (_count - lo)*sizeof(unsigned char*));
+    ++_count;
+
+    unsigned long w = raster->pwidth(), h = raster->pheight();
+    unsigned char* pixels = new unsigned char[w*h*3];
+
+    for (unsigned long y = 0; y < h; ++y) {
+        raster->peekrow(0, y, w, pixels + y*w*3, 3);
+    }
+    _raster[lo] = raster;
+    _pixels[lo] = pixels;
+}
+
+const unsigned char* OverlayRenderRasters::Pixels (Raster* raster) {
+    int i = Find(raster);
+    return i < _count && _raster[i] == raster ? _pixels[i] : nil;
+}
+
+int OverlayRenderRasters::Find (Raster* raster) {
+    int lo = 0, hi = _count;
+
+    while (lo < hi) {
+        int mid = (lo + hi)/2;
+
+        if (_raster[mid] < raster) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
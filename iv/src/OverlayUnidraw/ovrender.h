@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ * 
+ */
+
+
+/*
+ * OverlayRenderer - software rasterizer for Graphic trees
+ */
+
+#ifndef ovrender_h
+#define ovrender_h
+
+#include <Unidraw/globals.h>
+
+class Graphic;
+class OverlayRenderRasters;
+class OverlayRenderState;
+class PSColor;
+class Raster;
+class Transformer;
+
+//: software rasterizer for Graphic trees.
+// draws a tree of Unidraw graphics into an in-memory 24-bit RGB image
+// without a Canvas or a window system connection, so drawings can be
+// rendered to files in batch.  Lines, multilines, polygons, rectangles,
+// ellipses, open and closed B-splines, arrowheads, stencils and rasters
+// are drawn with their brush, colors and fill pattern; text is drawn
+// with a built-in bitmap font scaled to the size of its font, and greeked
+// into bars where it is too small to read.  Rendering only reads the
+// graphics, so renderers in different threads can draw the same tree,
+// given the bounds to draw and the tree's rasters already converted.
+class OverlayRenderer {
+public:
+    OverlayRenderer(int width, int height);
+    virtual ~OverlayRenderer();
+
+    void Render(Graphic*);
+    // clear the image and draw the graphic scaled to fit it.  computing
+    // the bounds caches them in the graphic, so this is not thread-safe.
+    void Render(
+        Graphic*, float l, float b, float r, float t,
+        OverlayRenderRasters* = nil
+    );
+    // clear the image and draw the given area (in drawing coordinates),
+    // with the rasters converted beforehand.  without them the rasters
+    // are converted here, which is not thread-safe either.
+
+    boolean WritePPM(const char* path);
+    // write the image as a raw (P6) PPM file.
+    boolean WriteTIFF(const char* path);
+    // write the image as an uncompressed RGB TIFF file.
+
+    int Width() { return _width; }
+    int Height() { return _height; }
+    unsigned char* Data() { return _data; }
+    // image rows, top to bottom, 3 bytes per pixel.
+protected:
+    void Clear();
+    void Draw(Graphic*, OverlayRenderState&);
+    void DrawVertices(Graphic*, OverlayRenderState&, boolean closed, boolean spline);
+    void DrawEllipse(Graphic*, OverlayRenderState&);
+    void DrawText(Graphic*, OverlayRenderState&);
+    void DrawStencil(Graphic*, OverlayRenderState&);
+    void DrawRaster(Graphic*, OverlayRenderState&);
+    void DrawArrowhead(const float* x, const float* y, OverlayRenderState&);
+
+    void ArrowheadPoints(
+        float tipx, float tipy, float fromx, float fromy, float scale,
+        OverlayRenderState&, float* x, float* y
+    );
+    void Retract(float& x, float& y, const float* ax, const float* ay, float w);
+    void Map(Transformer*, float x, float y, float& dx, float& dy);
+    void Unmap(Transformer*, float dx, float dy, float& x, float& y);
+    void Spline(const float* x, const float* y, int n, boolean closed);
+    void AddPoint(float x, float y);
+
+    void Fill(const float* x, const float* y, int n, OverlayRenderState&);
+    void Stroke(
+        const float* x, const float* y, int n, boolean closed,
+        OverlayRenderState&, boolean dashed
+    );
+    float StrokeWidth(OverlayRenderState&);
+    void Segment(float x0, float y0, float x1, float y1, float w, int rgb);
+    void FillPolygon(
+        const float* x, const float* y, int n, int rgb, const int* pat, int bg
+    );
+    void Span(int y, int x0, int x1, int rgb, const int* pat, int bg);
+    void Plot(int x, int y, int rgb);
+    int Pixel(PSColor*);
+protected:
+    int _width, _height;
+    unsigned char* _data;
+    float _l, _b, _mag;         // drawing-to-image mapping
+    float _ox, _oy;
+
+    float* _px, *_py;           // scratch point buffer for curves
+    int _pcount, _psize;
+    float* _xs;                 // scratch scanline crossings
+    int _xsize;
+    OverlayRenderRasters* _rasters;
+};
+
+//: packed RGB copies of the rasters in a graphic tree.
+// reading a raster's pixels goes through the display's color table,
+// so the copies are made once, on one thread, for renderers in other
+// threads to sample.
+class OverlayRenderRasters {
+public:
+    OverlayRenderRasters(Graphic*);
+    virtual ~OverlayRenderRasters();
+
+    const unsigned char* Pixels(Raster*);
+    // rows bottom to top, 3 bytes per pixel; nil if not in the tree.
+protected:
+    void Add(Graphic*);
+    int Find(Raster*);
+    // index of the raster, or of where it would be inserted.
+protected:
+    Raster** _raster;           // sorted, to be searched
+    unsigned char** _pixels;
+    int _count, _size;
+};
+
+#endif
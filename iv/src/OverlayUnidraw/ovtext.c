@@ -79,6 +79,12 @@ boolean TextOvComp::IsA (ClassId id) {
     return OVTEXT_COMP == id || OverlayComp::IsA(id);
 }
 
+unsigned long TextOvComp::Footprint () {
+    TextGraphic* text = GetText();
+    unsigned long bytes = OverlayComp::Footprint();
+    return text == nil ? bytes : bytes + strlen(text->GetOriginal()) + 1;
+}
+
 Component* TextOvComp::Copy () {
     TextOvComp* comp =
       new TextOvComp((TextGraphic*) GetGraphic()->Copy());
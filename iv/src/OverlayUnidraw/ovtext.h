@@ -56,6 +56,7 @@ public:
     TextGraphic* GetText();
     // return pointer to graphic.
     
+    virtual unsigned long Footprint();
     virtual Component* Copy();
     virtual ClassId GetClassId();
     virtual boolean IsA(ClassId);
@@ -0,0 +1,663 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayTIFF implementation.
+ */
+
+#include <OverlayUnidraw/grayraster.h>
+#include <OverlayUnidraw/ovraster.h>
+#include <OverlayUnidraw/ovtiff.h>
+
+#ifdef EXTERN_TIFF
+#include <tiffio.h>
+#else
+#include <TIFF/tiffio.h>
+#endif
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * the bundled libtiff 3.00 returns its long fields as unsigned long.
+ * An external libtiff returns 32-bit fields, and from 4.0 on 64-bit
+ * byte counts.
+ */
+
+#if defined(TIFFLIB_VERSION)
+typedef unsigned int tiff_long;
+#if TIFFLIB_VERSION >= 20091104
+typedef unsigned long long tiff_count;
+#else
+typedef unsigned int tiff_count;
+#endif
+#else
+typedef unsigned long tiff_long;
+typedef unsigned long tiff_count;
+#endif
+
+/*****************************************************************************/
+
+int OverlayTIFF::_jobs = 0;
+int OverlayTIFF::_minsize = 1 << 18;
+
+int OverlayTIFF::Jobs () {
+    if (_jobs > 0) {
+        return _jobs;
+    }
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 1 ? (int)n : 1;
+}
+
+/* false if a * b does not fit in an unsigned long */
+
+static boolean size_product (unsigned long a, unsigned long b, unsigned long& r) {
+    if (b != 0 && a > ULONG_MAX / b) {
+        return false;
+    }
+    r = a * b;
+    return true;
+}
+
+struct TIFFJob {
+    OverlayTIFF* tiff;
+    int first, last;
+    boolean ok;
+    pthread_t thread;
+    boolean started;
+};
+
+/*****************************************************************************/
+
+/*
+ * LZW as written by libtiff: codes of 9 to 12 bits packed most
+ * significant bit first, with the code width growing one code early.
+ * Every string in the table is some earlier string plus one byte, so it
+ * already sits in the output where it was last written: the table keeps
+ * where it starts and its length, and decoding a code is a copy from
+ * earlier in the strip rather than a walk down a chain of prefixes.  Away
+ * from the end of the strip strings are copied eight bytes at a time, the
+ * bytes copied past the end of one being overwritten by the next.
+ */
+
+static const int lzw_clear = 256;
+static const int lzw_eoi = 257;
+static const int lzw_first = 258;
+static const int lzw_tabsize = 5120;
+
+static inline void lzw_copy8 (unsigned char* op, const unsigned char* src) {
+    unsigned char t[8];
+    memcpy(t, src, 8);
+    memcpy(op, t, 8);
+}
+
+static boolean lzw_decode (
+    const unsigned char* bp, const unsigned char* end,
+    unsigned char* op, unsigned long occ
+) {
+    /* kept apart, as where the next string goes waits on the lengths */
+    const unsigned char* strings[lzw_tabsize];
+    unsigned short lengths[lzw_tabsize];
+    strings[lzw_clear] = strings[lzw_eoi] = nil;
+    lengths[lzw_clear] = lengths[lzw_eoi] = 0;
+
+    unsigned char* limit = op + occ;
+    unsigned long long nextdata = 0;
+    int nextbits = 0;
+    int nbits = 9;
+    int nbitsmask = (1 << 9) - 1;
+    int maxcode = nbitsmask - 1;
+    int free_ent = lzw_first;
+    const unsigned char* prev = nil;
+    unsigned long prevlen = 0;
+
+    while (op < limit) {
+        if (nextbits < nbits) {
+            if (end - bp >= 8) {
+                /* as many whole bytes as fit, from one 8-byte load */
+                int n = (63 - nextbits) >> 3;
+                unsigned long long w =
+                    (unsigned long long)bp[0] << 56 |
+                    (unsigned long long)bp[1] << 48 |
+                    (unsigned long long)bp[2] << 40 |
+                    (unsigned long long)bp[3] << 32 |
+                    (unsigned long long)bp[4] << 24 |
+                    (unsigned long long)bp[5] << 16 |
+                    (unsigned long long)bp[6] << 8 |
+                    (unsigned long long)bp[7];
+                nextdata = (nextdata << (n * 8)) | (w >> (64 - n * 8));
+                nextbits += n * 8;
+                bp += n;
+            } else {
+                while (nextbits <= 56 && bp < end) {
+                    nextdata = (nextdata << 8) | *bp++;
+                    nextbits += 8;
+                }
+                if (nextbits < nbits) {
+                    return false;
+                }
+            }
+        }
+        int code = (int)(nextdata >> (nextbits - nbits)) & nbitsmask;
+        nextbits -= nbits;
+
+        unsigned long len;
+        unsigned long room = limit - op;
+        if (code < 256) {
+            *op = (unsigned char)code;
+            len = 1;
+        } else if (code < free_ent) {
+            len = lengths[code];
+            const unsigned char* string = strings[code];
+            if (len + 8 <= room && len != 0) {
+                for (unsigned long i = 0; i < len; i += 8) {
+                    lzw_copy8(op + i, string + i);
+                }
+            } else if (len == 0) {
+                if (code == lzw_eoi) {
+                    break;
+                }
+                nbits = 9;
+                nbitsmask = (1 << 9) - 1;
+                maxcode = nbitsmask - 1;
+                free_ent = lzw_first;
+                prev = nil;
+                continue;
+            } else {
+                unsigned long n = len < room ? len : room;
+                for (unsigned long i = 0; i < n; ++i) {
+                    op[i] = string[i];
+                }
+            }
+        } else if (code == free_ent && prev != nil) {
+            /* the string being defined: previous string + its first byte */
+            len = prevlen + 1;
+            unsigned long n = len < room ? len : room;
+            for (unsigned long i = 0; i < n; ++i) {
+                op[i] = i < prevlen ? prev[i] : prev[0];
+            }
+        } else {
+            return false;
+        }
+        if (len >= room) {
+            return true;
+        }
+
+        if (prev != nil) {
+            if (free_ent >= lzw_tabsize) {
+                return false;
+            }
+            strings[free_ent] = prev;
+            lengths[free_ent] = (unsigned short)(prevlen + 1);
+            if (++free_ent > maxcode) {
+                if (++nbits > 12) {
+                    nbits = 12;
+                }
+                nbitsmask = (1 << nbits) - 1;
+                maxcode = nbitsmask - 1;
+            }
+        }
+        prev = op;
+        prevlen = len;
+        op += len;
+    }
+    return op == limit;
+}
+
+static boolean packbits_decode (
+    const unsigned char* bp, const unsigned char* end,
+    unsigned char* op, unsigned long occ
+) {
+    while (occ > 0 && bp < end) {
+        int n = (signed char)*bp++;
+        if (n >= 0) {
+            unsigned long count = n + 1;
+            if (count > occ || count > (unsigned long)(end - bp)) {
+                return false;
+            }
+            memcpy(op, bp, count);
+            bp += count;
+            op += count;
+            occ -= count;
+        } else if (n != -128) {
+            unsigned long count = 1 - n;
+            if (count > occ || bp >= end) {
+                return false;
+            }
+            memset(op, *bp++, count);
+            op += count;
+            occ -= count;
+        }
+    }
+    return occ == 0;
+}
+
+static void swab_samples (unsigned char* p, unsigned long n, int size) {
+    unsigned char* end = p + n * size;
+    unsigned char t;
+    switch (size) {
+    case 2:
+        for (; p < end; p += 2) {
+            t = p[0]; p[0] = p[1]; p[1] = t;
+        }
+        break;
+    case 4:
+        for (; p < end; p += 4) {
+            t = p[0]; p[0] = p[3]; p[3] = t;
+            t = p[1]; p[1] = p[2]; p[2] = t;
+        }
+        break;
+    case 8:
+        for (; p < end; p += 8) {
+            for (int i = 0; i < 4; ++i) {
+                t = p[i]; p[i] = p[7 - i]; p[7 - i] = t;
+            }
+        }
+        break;
+    }
+}
+
+#define UNDIFFERENCE(T) { \
+    for (unsigned long r = 0; r < rows; ++r) { \
+        T* s = (T*)p + r * rowsamples; \
+        for (unsigned long i = samples; i < rowsamples; ++i) { \
+            s[i] += s[i - samples]; \
+        } \
+    } \
+}
+
+/*
+ * undifference reverses horizontal differencing (predictor 2) over
+ * 'rows' rows of 'rowsamples' samples each.
+ */
+
+static void undifference (
+    unsigned char* p, unsigned long rows, unsigned long rowsamples,
+    int samples, int size
+) {
+    switch (size) {
+    case 1:
+        UNDIFFERENCE(unsigned char);
+        break;
+    case 2:
+        UNDIFFERENCE(unsigned short);
+        break;
+    case 4:
+        UNDIFFERENCE(unsigned int);
+        break;
+    }
+}
+
+/*****************************************************************************/
+
+OverlayTIFF::OverlayTIFF (const char* pathname) {
+    _pathname = strdup(pathname);
+    _width = _height = 0;
+    _samples = _bits = 0;
+    _type = AttributeValue::UnknownType;
+    _tiled = false;
+    _chunkwidth = _chunkheight = 0;
+    _nchunks = 0;
+    _compression = COMPRESSION_NONE;
+    _predictor = false;
+    _swab = false;
+    _raw = nil;
+    _rawsize = 0;
+    _rawoffset = nil;
+    _rawcount = nil;
+    _data = nil;
+    _datasize = 0;
+    _chunksize = 0;
+}
+
+OverlayTIFF::~OverlayTIFF () {
+    free(_pathname);
+    if (_raw != nil) {
+        munmap((void*)_raw, _rawsize);
+    }
+    delete [] _rawoffset;
+    delete [] _rawcount;
+    free(_data);
+}
+
+OverlayRaster* OverlayTIFF::Load (const char* pathname) {
+    OverlayTIFF tiff(pathname);
+    return tiff.Decode() ? tiff.CreateRaster() : nil;
+}
+
+static AttributeValue::ValueType sample_type (int format, int bits) {
+    switch (format) {
+    case SAMPLEFORMAT_INT:
+        switch (bits) {
+        case 8: return AttributeValue::CharType;
+        case 16: return AttributeValue::ShortType;
+        case 32: return AttributeValue::IntType;
+        }
+        break;
+    case SAMPLEFORMAT_IEEEFP:
+        switch (bits) {
+        case 32: return AttributeValue::FloatType;
+        case 64: return AttributeValue::DoubleType;
+        }
+        break;
+    default:
+        switch (bits) {
+        case 8: return AttributeValue::UCharType;
+        case 16: return AttributeValue::UShortType;
+        case 32: return AttributeValue::UIntType;
+        }
+        break;
+    }
+    return AttributeValue::UnknownType;
+}
+
+/*
+ * libtiff checks the layout and locates the strips or tiles.  The file
+ * itself is mapped, so the threads decode straight from it.
+ */
+
+boolean OverlayTIFF::Decode () {
+    int fd = open(_pathname, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nil, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            _raw = (const unsigned char*)p;
+            _rawsize = st.st_size;
+        }
+    }
+    close(fd);
+    if (_raw == nil) {
+        return false;
+    }
+    short one = 1;
+    boolean little = *(char*)&one == 1;
+    _swab = (_raw[0] == 'M') == little;
+
+    TIFF* tif = TIFFOpen(_pathname, "r");
+    if (tif == nil) {
+        return false;
+    }
+    tiff_long width = 0, height = 0;
+    unsigned short bits = 1, samples = 1, format = SAMPLEFORMAT_UINT;
+    unsigned short photometric = PHOTOMETRIC_MINISBLACK;
+    unsigned short planar = PLANARCONFIG_CONTIG;
+    unsigned short compression = COMPRESSION_NONE;
+    unsigned short predictor = 1, fillorder = FILLORDER_MSB2LSB;
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+    TIFFGetField(tif, TIFFTAG_BITSPERSAMPLE, &bits);
+    TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &samples);
+    TIFFGetField(tif, TIFFTAG_SAMPLEFORMAT, &format);
+    TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric);
+    TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &planar);
+    TIFFGetField(tif, TIFFTAG_COMPRESSION, &compression);
+    TIFFGetField(tif, TIFFTAG_PREDICTOR, &predictor);
+    TIFFGetField(tif, TIFFTAG_FILLORDER, &fillorder);
+
+    _width = width;
+    _height = height;
+    _samples = samples;
+    _bits = bits;
+    _type = sample_type(format, bits);
+    _compression = compression;
+    _predictor = predictor == 2;
+
+    boolean ok = width > 0 && height > 0 &&
+        _type != AttributeValue::UnknownType &&
+        (samples == 1 || planar == PLANARCONFIG_CONTIG) &&
+        fillorder == FILLORDER_MSB2LSB &&
+        (predictor == 1 || (predictor == 2 && format != SAMPLEFORMAT_IEEEFP)) &&
+        (compression == COMPRESSION_NONE || compression == COMPRESSION_LZW ||
+         compression == COMPRESSION_PACKBITS);
+    if (samples == 1) {
+        ok = ok && photometric == PHOTOMETRIC_MINISBLACK;
+    } else {
+        ok = ok && (samples == 3 || samples == 4) &&
+            photometric == PHOTOMETRIC_RGB &&
+            (_type == AttributeValue::UCharType ||
+             _type == AttributeValue::UShortType);
+    }
+    if (!ok) {
+        TIFFClose(tif);
+        return false;
+    }
+
+    _tiled = TIFFIsTiled(tif);
+    if (_tiled) {
+        tiff_long tw = 0, tl = 0;
+        TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tw);
+        TIFFGetField(tif, TIFFTAG_TILELENGTH, &tl);
+        _chunkwidth = tw;
+        _chunkheight = tl;
+        _nchunks = TIFFNumberOfTiles(tif);
+    } else {
+        tiff_long rps = height;
+        TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &rps);
+        _chunkwidth = width;
+        _chunkheight = rps < height ? rps : height;
+        _nchunks = TIFFNumberOfStrips(tif);
+    }
+    tiff_count* offsets = nil;
+    tiff_count* counts = nil;
+    TIFFGetField(
+        tif, _tiled ? TIFFTAG_TILEOFFSETS : TIFFTAG_STRIPOFFSETS, &offsets
+    );
+    TIFFGetField(
+        tif, _tiled ? TIFFTAG_TILEBYTECOUNTS : TIFFTAG_STRIPBYTECOUNTS, &counts
+    );
+    ok = _chunkwidth > 0 && _chunkheight > 0 && _nchunks > 0 &&
+        offsets != nil && counts != nil;
+    if (ok) {
+        _rawoffset = new unsigned long[_nchunks];
+        _rawcount = new unsigned long[_nchunks];
+        for (int i = 0; i < _nchunks && ok; ++i) {
+            _rawoffset[i] = (unsigned long)offsets[i];
+            _rawcount[i] = (unsigned long)counts[i];
+            ok = _rawoffset[i] <= _rawsize &&
+                _rawcount[i] <= _rawsize - _rawoffset[i];
+        }
+    }
+    TIFFClose(tif);
+    if (!ok) {
+        return false;
+    }
+
+    int size = _bits / 8;
+    unsigned long pixels;
+    ok = size_product(_width, _height, pixels) &&
+        size_product(pixels, _samples * size, _datasize) &&
+        size_product(_chunkwidth, _chunkheight, pixels) &&
+        size_product(pixels, _samples * size, _chunksize);
+    if (!ok) {
+        return false;
+    }
+    /* zeroed, so a strip or tile the file leaves out reads as 0 */
+    _data = (unsigned char*)calloc(_datasize ? _datasize : 1, 1);
+    if (_data == nil) {
+        return false;
+    }
+
+    int njobs = _width * _height < (unsigned long)MinSize() ? 1 : Jobs();
+    njobs = njobs < _nchunks ? njobs : _nchunks;
+    if (njobs < 2) {
+        return DecodeChunks(0, _nchunks);
+    }
+    TIFFJob* jobs = new TIFFJob[njobs];
+    int j;
+    for (j = 0; j < njobs; ++j) {
+        jobs[j].tiff = this;
+        jobs[j].first = (int)((long)_nchunks * j / njobs);
+        jobs[j].last = (int)((long)_nchunks * (j + 1) / njobs);
+        jobs[j].ok = false;
+        jobs[j].started = j > 0 && pthread_create(
+            &jobs[j].thread, nil, &OverlayTIFF::DecodeThread, &jobs[j]
+        ) == 0;
+    }
+    ok = DecodeChunks(jobs[0].first, jobs[0].last);
+    for (j = 1; j < njobs; ++j) {
+        if (jobs[j].started) {
+            pthread_join(jobs[j].thread, nil);
+            ok = ok && jobs[j].ok;
+        } else {
+            ok = ok && DecodeChunks(jobs[j].first, jobs[j].last);
+        }
+    }
+    delete [] jobs;
+    return ok;
+}
+
+/*
+ * Decode divides the strips or tiles into runs, decodes the first here
+ * and each of the others in a thread of its own.  A run whose thread
+ * could not be started is decoded here after the first.
+ */
+
+void* OverlayTIFF::DecodeThread (void* arg) {
+    TIFFJob* job = (TIFFJob*)arg;
+    job->ok = job->tiff->DecodeChunks(job->first, job->last);
+    return nil;
+}
+
+boolean OverlayTIFF::DecodeChunks (int first, int last) {
+    unsigned char* tilebuf = nil;
+    if (_tiled) {
+        tilebuf = (unsigned char*)malloc(_chunksize ? _chunksize : 1);
+        if (tilebuf == nil) {
+            return false;
+        }
+    }
+    boolean ok = true;
+    for (int i = first; i < last && ok; ++i) {
+        ok = DecodeChunk(i, tilebuf);
+    }
+    free(tilebuf);
+    return ok;
+}
+
+/*
+ * A strip decodes straight into its rows of _data.  A tile decodes
+ * into 'tilebuf', and the part of it inside the image is copied into
+ * place.
+ */
+
+boolean OverlayTIFF::DecodeChunk (int chunk, unsigned char* tilebuf) {
+    int size = _bits / 8;
+    unsigned long rowsamples = _chunkwidth * _samples;
+    unsigned long rowbytes = rowsamples * size;
+    unsigned long x0 = 0, y0, rows;
+    unsigned char* dst;
+    if (_tiled) {
+        unsigned long across = (_width + _chunkwidth - 1) / _chunkwidth;
+        x0 = (chunk % across) * _chunkwidth;
+        y0 = (chunk / across) * _chunkheight;
+        if (y0 >= _height) {
+            return true;
+        }
+        rows = _chunkheight;
+        dst = tilebuf;
+    } else {
+        y0 = chunk * _chunkheight;
+        if (y0 >= _height) {
+            return true;
+        }
+        rows = _height - y0 < _chunkheight ? _height - y0 : _chunkheight;
+        dst = _data + y0 * rowbytes;
+    }
+
+    const unsigned char* src = _raw + _rawoffset[chunk];
+    const unsigned char* end = src + _rawcount[chunk];
+    unsigned long occ = rows * rowbytes;
+    boolean ok;
+    switch (_compression) {
+    case COMPRESSION_LZW:
+        ok = lzw_decode(src, end, dst, occ);
+        break;
+    case COMPRESSION_PACKBITS:
+        ok = packbits_decode(src, end, dst, occ);
+        break;
+    default:
+        ok = (unsigned long)(end - src) >= occ;
+        if (ok) {
+            memcpy(dst, src, occ);
+        }
+        break;
+    }
+    if (!ok) {
+        return false;
+    }
+    if (_swab && size > 1) {
+        swab_samples(dst, rows * rowsamples, size);
+    }
+    if (_predictor) {
+        undifference(dst, rows, rowsamples, _samples, size);
+    }
+
+    if (_tiled) {
+        unsigned long w = _width - x0 < _chunkwidth ? _width - x0 : _chunkwidth;
+        unsigned long h = _height - y0 < rows ? _height - y0 : rows;
+        unsigned long imagerowbytes = _width * _samples * size;
+        for (unsigned long r = 0; r < h; ++r) {
+            memcpy(
+                _data + (y0 + r) * imagerowbytes + x0 * _samples * size,
+                tilebuf + r * rowbytes, w * _samples * size
+            );
+        }
+    }
+    return true;
+}
+
+/*****************************************************************************/
+
+OverlayRaster* OverlayTIFF::CreateRaster () {
+    if (_data == nil) {
+        return nil;
+    }
+    if (_samples == 1) {
+        return new GrayRaster(_width, _height, _type, _data);
+    }
+    OverlayRaster* raster = new OverlayRaster(_width, _height);
+    unsigned long rowsamples = _width * _samples;
+    for (unsigned long r = 0; r < _height; ++r) {
+        if (_type == AttributeValue::UShortType) {
+            raster->pokerow(
+                0, _height - r - 1, _width,
+                (const unsigned short*)_data + r * rowsamples, _samples
+            );
+        } else {
+            raster->pokerow(
+                0, _height - r - 1, _width, _data + r * rowsamples, _samples
+            );
+        }
+    }
+    return raster;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+ * OverlayTIFF - strip and tile TIFF decoder for rasters
+ */
+
+#ifndef ovtiff_h
+#define ovtiff_h
+
+#include <Unidraw/globals.h>
+#include <Attribute/attrvalue.h>
+
+class OverlayRaster;
+
+//: decoder that reads TIFF images into rasters at full depth.
+// Handles images of one sample per pixel (min-is-black) of 8, 16 or 32
+// bit integers or 32 or 64 bit floats, and rgb(a) images of 8 or 16 bit
+// samples, stored in strips or tiles of a single plane and compressed
+// with LZW or PackBits, or not at all, optionally with horizontal
+// differencing.  One-sample images become a GrayRaster of the matching
+// value_type(), without squashing to 8 bits.  Anything else is left to
+// TIFFRaster::load.
+//
+// The file is mapped into memory and its compressed strips or tiles
+// divided among threads that decode them at once into the image, each
+// on its own code table.
+class OverlayTIFF {
+public:
+    OverlayTIFF(const char* pathname);
+    virtual ~OverlayTIFF();
+
+    boolean Decode();
+    // read and decode the image; false if the file cannot be read or
+    // is not an image handled here.
+    OverlayRaster* CreateRaster();
+    // new GrayRaster of Type() for one sample per pixel, or a new
+    // OverlayRaster for rgb, after a successful Decode.
+
+    static OverlayRaster* Load(const char* pathname);
+    // decode 'pathname' into a new raster, nil if it is not handled here.
+
+    unsigned long Width() { return _width; }
+    // pixels per row.
+    unsigned long Height() { return _height; }
+    // number of rows.
+    int Samples() { return _samples; }
+    // samples per pixel.
+    AttributeValue::ValueType Type() { return _type; }
+    // type of a sample.
+    boolean Tiled() { return _tiled; }
+    // true if the image is stored in tiles rather than strips.
+    const void* Data() { return _data; }
+    // decoded samples, top row first, in host byte order.
+
+    static void Jobs(int n) { _jobs = n; }
+    // number of threads to divide the strips or tiles among; 0 (the
+    // default) for one per online processor, 1 to decode serially.
+    static int Jobs();
+    static void MinSize(int pixels) { _minsize = pixels; }
+    // smallest image worth dividing among threads.
+    static int MinSize() { return _minsize; }
+
+protected:
+    boolean DecodeChunk(int chunk, unsigned char* tilebuf);
+    // decode strip or tile 'chunk' into _data.
+    boolean DecodeChunks(int first, int last);
+    // decode strips or tiles 'first' up to 'last'; false at the first
+    // that fails.
+    static void* DecodeThread(void* job);
+    // DecodeChunks for one TIFFJob, in a thread of its own.
+
+protected:
+    char* _pathname;
+    unsigned long _width, _height;
+    int _samples, _bits;
+    AttributeValue::ValueType _type;
+    boolean _tiled;
+    unsigned long _chunkwidth, _chunkheight;
+    int _nchunks;
+    int _compression;
+    boolean _predictor;
+    boolean _swab;
+
+    const unsigned char* _raw;
+    unsigned long _rawsize;
+    unsigned long* _rawoffset;
+    unsigned long* _rawcount;
+    unsigned char* _data;
+    unsigned long _datasize;
+    unsigned long _chunksize;
+
+    static int _jobs;
+    static int _minsize;
+};
+
+#endif
@@ -172,10 +172,16 @@ void OverlayUnidraw::Log (Command* cmd, boolean dirty) {
 	    DirtyCmd* dc = new DirtyCmd(ed);
 	    dc->Execute();
             cmd = new MacroCmd(ed, cmd, dc);
+
+        } else if (!past->IsEmpty() && command(past->First())->Coalesce(cmd)) {
+	    Resource::unref(ed);
+            delete cmd;
+            return;
 	}
 	    
         past->Prepend(new UList(cmd));
         ClearHistory(past, _histlen+1);
+        TrimHistory(past);
     }
 }
 
@@ -53,6 +53,12 @@ boolean VerticesOvComp::IsA (ClassId id) {
     return OVVERTICES_COMP == id || OverlayComp::IsA(id);
 }
 
+unsigned long VerticesOvComp::Footprint () {
+    Vertices* verts = GetVertices();
+    unsigned long bytes = OverlayComp::Footprint();
+    return verts == nil ? bytes : bytes + verts->count() * 2 * sizeof(Coord);
+}
+
 VerticesOvComp::VerticesOvComp (Vertices* graphic, OverlayComp* parent) 
 : OverlayComp(graphic, parent) { }
 
@@ -47,6 +47,7 @@ public:
     Vertices* GetVertices();
     // return generic pointer to graphic.
 
+    virtual unsigned long Footprint();
     virtual ClassId GetClassId();
     virtual boolean IsA(ClassId);
 
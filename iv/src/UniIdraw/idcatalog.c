@@ -48,7 +48,9 @@
 #include <InterViews/textbuffer.h>
 #include <InterViews/transformer.h>
 
+#include <OS/file.h>
 #include <OS/math.h>
+#include <OS/string.h>
 
 #include <ctype.h>
 #include <stdio.h>
@@ -75,6 +77,52 @@ static char octal(const char* p) {
 
 /*****************************************************************************/
 
+/*
+ * IdrawBuf presents a drawing read in one piece by InputFile (mapped
+ * where the system allows it) as a streambuf, so the istream-based
+ * readers never go back to the file.  Skip and PSReadPoints also scan
+ * its bytes directly when the istream they are given sits on top of it.
+ */
+
+class IdrawBuf : public streambuf {
+public:
+    IdrawBuf(const char*, int);
+
+    const char* cur() { return gptr(); }
+    const char* end() { return egptr(); }
+    void seek(const char* p) { setg(eback(), (char*) p, egptr()); }
+};
+
+IdrawBuf::IdrawBuf (const char* start, int len) {
+    char* p = (char*) start;
+    setg(p, p, p + len);
+}
+
+// scan_coord reads one decimal integer, as "in >> coord" would.
+
+static boolean scan_coord (const char*& p, const char* end, Coord& c) {
+    while (p < end && isspace(*p)) {
+        ++p;
+    }
+    boolean neg = false;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p++ == '-';
+    }
+    if (p == end || !isdigit(*p)) {
+        return false;
+    }
+    long v = 0;
+
+    while (p < end && isdigit(*p)) {
+        v = v*10 + (*p++ - '0');
+    }
+    c = Coord(neg ? -v : v);
+    return true;
+}
+
+/*****************************************************************************/
+
 char IdrawCatalog::_buf[CHARBUFSIZE];
 float IdrawCatalog::_psversion;
 
@@ -82,6 +130,7 @@ IdrawCatalog::IdrawCatalog (
     const char* name, Creator* creator
 ) : Catalog(name, creator) {
     _psversion = PSV_ORIGINAL;
+    _idrawbuf = nil;
 }
 
 boolean IdrawCatalog::Save (EditorInfo* o, const char* name) {
@@ -146,22 +195,69 @@ boolean IdrawCatalog::Retrieve (const char* name, Component*& comp) {
         _valid = Catalog::Retrieve(name, comp);
 
     } else {
-        filebuf fbuf;
-        _valid = fbuf.open(name, input) != 0;
+        InputFile* file = InputFile::open(String(name));
+        const char* start;
+        int len = (file == nil) ? -1 : file->read(start);
+        _valid = len > 0;
 
         if (_valid) {
-            istream in(&fbuf);
+            IdrawBuf buf(start, len);
+            istream in(&buf);
+            IdrawBuf* prev = _idrawbuf;
+            _idrawbuf = &buf;
             comp = ReadPostScript(in);
+            _idrawbuf = prev;
 
             if (_valid) {
                 Forget(comp, name);
                 Register(comp, name);
             }
         }
+        delete file;
     }
     return _valid;
 }
 
+/*
+ * Skip finds the next MARK token the way Catalog::Skip does, leaving
+ * the stream just past the whitespace character that ends it.
+ */
+
+void IdrawCatalog::Skip (istream& in) {
+    IdrawBuf* buf = Mapped(in);
+
+    if (buf == nil) {
+        Catalog::Skip(in);
+        return;
+    }
+    int len = strlen(MARK);
+    const char* p = buf->cur();
+    const char* end = buf->end();
+
+    while (p < end) {
+        boolean found = end - p >= len && strncmp(p, MARK, len) == 0;
+
+        while (p < end && !isspace(*p)) {
+            ++p;
+        }
+        if (p < end) {
+            ++p;
+        } else {
+            break;
+        }
+        if (found) {
+            buf->seek(p);
+            return;
+        }
+    }
+    buf->seek(end);
+    in.setstate(ios::eofbit | ios::failbit);
+}
+
+IdrawBuf* IdrawCatalog::Mapped (istream& in) {
+    return (_idrawbuf != nil && in.rdbuf() == _idrawbuf) ? _idrawbuf : nil;
+}
+
 boolean IdrawCatalog::UnidrawFormat (const char* name) {
     filebuf fbuf;
     boolean unidraw_format = false;
@@ -736,6 +832,9 @@ void IdrawCatalog::PSReadTransformer (istream& in, Graphic* gs) {
 /*
  * PSReadPoints reads a set of points as efficiently as possible by
  * using dynamic static buffers instead of mallocing on every call.
+ * The buffers are sized from the point count up front and grow
+ * geometrically; the coordinates of a mapped drawing are scanned
+ * straight out of the file image into them.
  */
 
 void IdrawCatalog::PSReadPoints (istream& in, const Coord*& x, const Coord*& y,
@@ -748,19 +847,40 @@ int& n) {
     Skip(in);
     in >> n;
 
+    if (!in.good() || n < 0) {
+        n = 0;
+    }
     if (n > sizepoints) {
-        delete xcoords;
-        delete ycoords;
-        sizepoints = max(n, INITIALSIZE);
+        delete [] xcoords;
+        delete [] ycoords;
+        sizepoints = max(n, max(2*sizepoints, INITIALSIZE));
         xcoords = new Coord[sizepoints];
         ycoords = new Coord[sizepoints];
     }
+    IdrawBuf* buf = Mapped(in);
+
+    if (buf != nil && _psversion >= PSV_NONREDUNDANT) {
+        const char* p = buf->cur();
+        const char* end = buf->end();
+
+        for (int i = 0; i < n; i++) {
+            if (
+                !scan_coord(p, end, xcoords[i]) ||
+                !scan_coord(p, end, ycoords[i])
+            ) {
+                in.setstate(ios::failbit);
+                break;
+            }
+        }
+        buf->seek(p);
 
-    for (int i = 0; i < n; i++) {
-        if (_psversion < PSV_NONREDUNDANT) {
-            Skip(in);
+    } else {
+        for (int i = 0; i < n; i++) {
+            if (_psversion < PSV_NONREDUNDANT) {
+                Skip(in);
+            }
+            in >> xcoords[i] >> ycoords[i];
         }
-        in >> xcoords[i] >> ycoords[i];
     }
 
     x = xcoords;
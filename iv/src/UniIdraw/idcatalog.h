@@ -31,6 +31,7 @@
 #include <Unidraw/catalog.h>
 
 class GraphicComp;
+class IdrawBuf;
 
 class IdrawCatalog : public Catalog{
 public:
@@ -45,8 +46,11 @@ public:
     virtual boolean Retrieve(const char*, Component*&);
     virtual boolean Retrieve(const char*, Command*&);
     virtual boolean Retrieve(const char*, Tool*&);
+
+    void Skip(istream&);
 protected:
     boolean UnidrawFormat(const char*);
+    IdrawBuf* Mapped(istream&);
 
     void PSReadGridSpacing(istream&, float&, float&);
     void PSReadGS(istream&, Graphic*);
@@ -86,6 +90,7 @@ protected:
     static float _psversion;       // stores version of drawing read from file
     boolean _head, _tail;          // stores arrow state for last GS read
     boolean _valid;
+    IdrawBuf* _idrawbuf;           // drawing being read by Retrieve, if any
 };
 
 #endif
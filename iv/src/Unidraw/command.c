@@ -32,6 +32,7 @@
 #include <Unidraw/iterator.h>
 #include <Unidraw/selection.h>
 #include <Unidraw/uhash.h>
+#include <Unidraw/ulist.h>
 #include <Unidraw/unidraw.h>
 #include <Unidraw/viewer.h>
 
@@ -224,6 +225,61 @@ void Command::Store (Component* comp, Data* data) {
     }
 }
 
+unsigned long Command::Footprint () {
+    unsigned long bytes = sizeof(Command);
+    Iterator i;
+
+    if (_clipboard != nil) {
+        for (_clipboard->First(i); !_clipboard->Done(i); _clipboard->Next(i)) {
+            bytes += sizeof(UList);
+        }
+    }
+    if (_cache != nil) {
+        bytes += sizeof(DataCache) + (DATACACHE_SIZE+1) * sizeof(void*);
+
+        for (_cache->First(i); !_cache->Done(i); _cache->Next(i)) {
+            bytes += sizeof(DataElem) + _cache->GetData(i)->data()->Footprint();
+        }
+    }
+    return bytes;
+}
+
+unsigned long Command::ClipboardFootprint () {
+    unsigned long bytes = 0;
+    Iterator i;
+
+    if (_clipboard != nil) {
+        for (_clipboard->First(i); !_clipboard->Done(i); _clipboard->Next(i)) {
+            bytes += _clipboard->GetComp(i)->Footprint();
+        }
+    }
+    return bytes;
+}
+
+boolean Command::Coalesce (Command*) { return false; }
+
+boolean Command::SameTargets (Command* cmd) {
+    if (
+        cmd->GetEditor() != GetEditor() || _cache != nil || cmd->_cache != nil ||
+        _clipboard == nil || cmd->_clipboard == nil
+    ) {
+        return false;
+    }
+    Clipboard* cb = cmd->_clipboard;
+    Iterator i, j;
+
+    for (
+        _clipboard->First(i), cb->First(j); 
+        !_clipboard->Done(i) && !cb->Done(j); 
+        _clipboard->Next(i), cb->Next(j)
+    ) {
+        if (_clipboard->GetComp(i) != cb->GetComp(j)) {
+            return false;
+        }
+    }
+    return _clipboard->Done(i) && cb->Done(j);
+}
+
 Data* Command::Recall (Component* comp) {
     Data* data = nil;
 
@@ -40,6 +40,7 @@
 ClassId Component::GetClassId () { return COMPONENT; }
 ClassId Component::GetSubstId (const char*&) { return UNDEFINED_CLASS; }
 boolean Component::IsA (ClassId id) { return COMPONENT == id; }
+unsigned long Component::Footprint () { return sizeof(Component); }
 Component::Component () { _views = new UList; }
 Component* Component::Copy () { return nil; }
 void Component::Read (istream&) { }
@@ -29,3 +29,4 @@
 /*****************************************************************************/
 
 Data::Data () { }
+unsigned long Data::Footprint () { return sizeof(Data); }
@@ -35,6 +35,8 @@ VoidData::VoidData (void* v) {
     _void = v;
 }
 
+unsigned long VoidData::Footprint () { return sizeof(VoidData); }
+
 /*****************************************************************************/
 
 ColorData::ColorData (PSColor* fg, PSColor* bg) {
@@ -42,6 +44,8 @@ ColorData::ColorData (PSColor* fg, PSColor* bg) {
     _bg = bg;
 }
 
+unsigned long ColorData::Footprint () { return sizeof(ColorData); }
+
 /*****************************************************************************/
 
 MoveData::MoveData (float dx, float dy) {
@@ -49,11 +53,17 @@ MoveData::MoveData (float dx, float dy) {
     _dy = dy;
 }
 
+unsigned long MoveData::Footprint () { return sizeof(MoveData); }
+
 /*****************************************************************************/
 
 GSData::GSData (Graphic* g) { _gs = new FullGraphic(g); }
 GSData::~GSData () { delete _gs; }
 
+unsigned long GSData::Footprint () {
+    return sizeof(GSData) + sizeof(FullGraphic);
+}
+
 /*****************************************************************************/
 
 MobilityData::MobilityData (Mobility m, Graphic* g) { 
@@ -65,6 +75,10 @@ MobilityData::~MobilityData () {
     delete _gs;
 }
 
+unsigned long MobilityData::Footprint () {
+    return sizeof(MobilityData) + sizeof(FullGraphic);
+}
+
 /*****************************************************************************/
 
 UngroupData::UngroupData (GraphicComp* p, Graphic* g) { 
@@ -76,4 +90,8 @@ UngroupData::~UngroupData () {
     delete _gs;
 }
 
+unsigned long UngroupData::Footprint () {
+    return sizeof(UngroupData) + sizeof(FullGraphic);
+}
+
 
@@ -115,6 +115,11 @@ void CutCmd::Unexecute () {
     _executed = false;
 }
 
+unsigned long CutCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    return _executed ? bytes + ClipboardFootprint() : bytes;
+}
+
 /*****************************************************************************/
 
 ClassId CopyCmd::GetClassId () { return COPY_CMD; }
@@ -188,6 +193,11 @@ void PasteCmd::Unexecute () {
     _executed = false;
 }
 
+unsigned long PasteCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    return !_executed ? bytes + ClipboardFootprint() : bytes;
+}
+
 boolean PasteCmd::Reversible () {
     Clipboard* cb = GetClipboard();
     Clipboard* globalcb = unidraw->GetCatalog()->GetClipboard();
@@ -277,6 +287,11 @@ void DupCmd::Unexecute () {
     _executed = false;
 }
 
+unsigned long DupCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    return !_executed ? bytes + ClipboardFootprint() : bytes;
+}
+
 /*****************************************************************************/
 
 ClassId DeleteCmd::GetClassId () { return DELETE_CMD; }
@@ -315,6 +330,11 @@ void DeleteCmd::Unexecute () {
     _executed = false;
 }
 
+unsigned long DeleteCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    return _executed ? bytes + ClipboardFootprint() : bytes;
+}
+
 /*****************************************************************************/
 
 ClassId SlctAllCmd::GetClassId () { return SLCTALL_CMD; }
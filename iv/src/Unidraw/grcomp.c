@@ -83,6 +83,24 @@ boolean GraphicComp::IsA (ClassId id) {
     return GRAPHIC_COMP == id || Component::IsA(id);
 }
 
+unsigned long GraphicComp::Footprint () {
+    unsigned long bytes = sizeof(GraphicComp);
+    Graphic* gr = GetGraphic();
+    Iterator i;
+
+    if (gr != nil) {
+        bytes += sizeof(FullGraphic);
+
+        if (gr->GetTransformer() != nil) {
+            bytes += sizeof(Transformer);
+        }
+    }
+    for (First(i); !Done(i); Next(i)) {
+        bytes += GetComp(i)->Footprint();
+    }
+    return bytes;
+}
+
 GraphicComp::GraphicComp (Graphic* g) { GraphicComp::SetGraphic(g); }
 GraphicComp::~GraphicComp () { delete _gr; }
 Graphic* GraphicComp::GetGraphic () { return _gr; }
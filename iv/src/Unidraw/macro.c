@@ -105,6 +105,16 @@ boolean MacroCmd::Reversible () {
     return false;
 }
 
+unsigned long MacroCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    Iterator i;
+
+    for (First(i); !Done(i); Next(i)) {
+        bytes += sizeof(UList) + GetCommand(i)->Footprint();
+    }
+    return bytes;
+}
+
 UList* MacroCmd::Elem (Iterator& i) { return (UList*) i.GetValue(); }
 void MacroCmd::First (Iterator& i) { i.SetValue(_cmds->First()); }
 void MacroCmd::Last (Iterator& i) { i.SetValue(_cmds->Last()); }
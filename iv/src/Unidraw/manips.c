@@ -532,7 +532,7 @@ void TextManip::GetPosition (Coord& x, Coord& y) {
 
 const char* TextManip::GetText (int& size) { 
     size = _text->Length();
-    return _buf;
+    return _text->Text();
 }
 
 void TextManip::CheckBuf (int more) {
@@ -542,7 +542,7 @@ void TextManip::CheckBuf (int more) {
     if (_textlen + more >= _bufsize) {
         _bufsize = (_textlen + more) * 2;
         new_buf = new char[_bufsize];
-        strncpy(new_buf, _buf, _textlen);
+        strncpy(new_buf, _text->Text(), _textlen);
         delete _text;
         delete _buf;
         _buf = new_buf;
@@ -52,6 +52,13 @@ boolean RasterComp::IsA (ClassId id) {
     return RASTER_COMP == id || GraphicComp::IsA(id);
 }
 
+unsigned long RasterComp::Footprint () {
+    RasterRect* rr = GetRasterRect();
+    Raster* raster = rr == nil ? nil : rr->GetOriginal();
+    unsigned long bytes = GraphicComp::Footprint();
+    return raster == nil ? bytes : bytes + raster->pwidth() * raster->pheight() * 4;
+}
+
 Component* RasterComp::Copy () {
     return new RasterComp((RasterRect*) GetGraphic()->Copy(), _filename);
 }
@@ -123,6 +123,11 @@ void GroupCmd::Unexecute () {
     }
 }
 
+unsigned long GroupCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    return !_executed && _group != nil ? bytes + _group->Footprint() : bytes;
+}
+
 boolean GroupCmd::Reversible () {
     Clipboard* cb = GetClipboard();
     return cb == nil || !cb->IsEmpty();
@@ -216,6 +221,11 @@ void UngroupCmd::Unexecute () {
     }
 }
 
+unsigned long UngroupCmd::Footprint () {
+    unsigned long bytes = Command::Footprint();
+    return _executed ? bytes + ClipboardFootprint() : bytes;
+}
+
 /*****************************************************************************/
 
 ClassId FrontCmd::GetClassId () { return FRONT_CMD; }
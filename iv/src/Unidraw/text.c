@@ -65,6 +65,12 @@ boolean TextComp::IsA (ClassId id) {
     return TEXT_COMP == id || GraphicComp::IsA(id);
 }
 
+unsigned long TextComp::Footprint () {
+    TextGraphic* text = GetText();
+    unsigned long bytes = GraphicComp::Footprint();
+    return text == nil ? bytes : bytes + strlen(text->GetOriginal()) + 1;
+}
+
 Component* TextComp::Copy () {
     return new TextComp((TextGraphic*) GetGraphic()->Copy());
 }
@@ -56,6 +56,17 @@ void MoveCmd::GetMovement (float& x, float& y) {
     y = _dy;
 }
 
+boolean MoveCmd::Coalesce (Command* cmd) {
+    if (cmd->GetClassId() != GetClassId() || !SameTargets(cmd)) {
+        return false;
+    }
+    float dx, dy;
+    ((MoveCmd*) cmd)->GetMovement(dx, dy);
+    _dx += dx;
+    _dy += dy;
+    return true;
+}
+
 void MoveCmd::Read (istream& in) {
     Command::Read(in);
     in >> _dx >> _dy;
@@ -125,6 +136,14 @@ RotateCmd::RotateCmd (ControlInfo* c, float a) : Command(c) {
 
 RotateCmd::RotateCmd (Editor* ed, float a) : Command(ed) { _angle = a; }
 
+boolean RotateCmd::Coalesce (Command* cmd) {
+    if (cmd->GetClassId() != GetClassId() || !SameTargets(cmd)) {
+        return false;
+    }
+    _angle += ((RotateCmd*) cmd)->GetRotation();
+    return true;
+}
+
 Command* RotateCmd::Copy () {
     Command* copy = new RotateCmd(CopyControlInfo(), _angle);
     InitCopy(copy);
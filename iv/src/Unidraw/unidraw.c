@@ -40,6 +40,8 @@
 #include <Unidraw/Commands/dirty.h>
 #include <Unidraw/Commands/macro.h>
 
+#include <Unidraw/Graphic/graphic.h>
+
 #include <InterViews/event.h>
 #include <InterViews/window.h>
 #include <IV-2_6/InterViews/world.h>
@@ -51,6 +53,7 @@
 /*****************************************************************************/
 
 static const int DEFAULT_HISTLEN = 20;
+static const unsigned long DEFAULT_HISTMEM = 16*1024*1024;
 
 /*****************************************************************************/
 
@@ -193,6 +196,9 @@ void Unidraw::Init (Catalog* c, World* w) {
     csolver = new CSolver;
     unidraw = this;
 
+    if (w->display() == nil) {
+        Graphic::use_iv(false);     // -nodisplay: no painters or X lookups
+    }
     _catalog = c;
     _world = w;
     _catalog->Init(_world);
@@ -221,6 +227,8 @@ Unidraw::~Unidraw () {
 void Unidraw::InitAttributes () {
     const char* attrib = GetWorld()->GetAttribute("history");
     _histlen = (attrib == nil) ? DEFAULT_HISTLEN : atoi(attrib);
+    attrib = GetWorld()->GetAttribute("historymem");
+    _histmem = (attrib == nil) ? DEFAULT_HISTMEM : strtoul(attrib, nil, 10);
 }
 
 void Unidraw::Mark (Editor* editor) {
@@ -383,6 +391,64 @@ Editor* Unidraw::FindAny (Component* comp, UList* editors) {
 
 void Unidraw::SetHistoryLength (int hl) { _histlen = hl; }
 int Unidraw::GetHistoryLength () { return _histlen; }
+void Unidraw::SetHistoryMemory (unsigned long hm) { _histmem = hm; }
+unsigned long Unidraw::GetHistoryMemory () { return _histmem; }
+
+unsigned long Unidraw::HistoryFootprint (Component* comp) {
+    unsigned long bytes = 0;
+
+    if (comp == nil) {
+        for (int i = 0; i < _histories->Count(); ++i) {
+            History* history = _histories->GetHistory(i);
+
+            if (history != nil) {
+                bytes += HistoryFootprint(history->_past);
+                bytes += HistoryFootprint(history->_future);
+            }
+        }
+
+    } else {
+        History* history = _histories->GetHistory(comp->GetRoot());
+
+        if (history != nil) {
+            bytes += HistoryFootprint(history->_past);
+            bytes += HistoryFootprint(history->_future);
+        }
+    }
+    return bytes;
+}
+
+unsigned long Unidraw::HistoryFootprint (UList* hist) {
+    unsigned long bytes = 0;
+
+    for (UList* u = hist->First(); u != hist->End(); u = u->Next()) {
+        bytes += sizeof(UList) + command(u)->Footprint();
+    }
+    return bytes;
+}
+
+/*
+ * discard the oldest commands once the history exceeds its byte
+ * budget, always keeping the most recent one.
+ */
+
+void Unidraw::TrimHistory (UList* hist) {
+    if (_histmem == 0) {
+        return;
+    }
+    unsigned long bytes = 0;
+    int index = 0;
+
+    for (UList* u = hist->First(); u != hist->End(); u = u->Next()) {
+        bytes += sizeof(UList) + command(u)->Footprint();
+
+        if (bytes > _histmem && index > 0) {
+            ClearHistory(hist, index+1);
+            return;
+        }
+        ++index;
+    }
+}
 
 void Unidraw::ClearHistory (Editor* ed) {
     Component* comp = ed->GetComponent();
@@ -449,10 +515,16 @@ void Unidraw::Log (Command* cmd) {
 	    DirtyCmd* dc = new DirtyCmd(ed);
 	    dc->Execute();
             cmd = new MacroCmd(ed, cmd, dc);
+
+        } else if (!past->IsEmpty() && command(past->First())->Coalesce(cmd)) {
+	    Resource::unref(ed);
+            delete cmd;
+            return;
 	}
 	    
         past->Prepend(new UList(cmd));
         ClearHistory(past, _histlen+1);
+        TrimHistory(past);
     }
 }
 
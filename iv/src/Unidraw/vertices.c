@@ -49,6 +49,12 @@ boolean VerticesComp::IsA (ClassId id) {
     return VERTICES_COMP == id || GraphicComp::IsA(id);
 }
 
+unsigned long VerticesComp::Footprint () {
+    Vertices* verts = GetVertices();
+    unsigned long bytes = GraphicComp::Footprint();
+    return verts == nil ? bytes : bytes + verts->count() * 2 * sizeof(Coord);
+}
+
 VerticesComp::VerticesComp (Vertices* graphic) : GraphicComp(graphic) { }
 Vertices* VerticesComp::GetVertices () { return (Vertices*) GetGraphic(); }
 
@@ -23,6 +23,7 @@
 
 #ifdef HAVE_ACE
 #include <ComTerp/comhandler.h>
+#include <ComTerp/comshm.h>
 #include <ace/SOCK_Connector.h>
 #include <ace/Synch.h>
 
@@ -77,6 +78,7 @@ int main(int argc, char *argv[]) {
         ComterpAcceptor* peer_acceptor = 
 	    new ComterpAcceptor(ComterpHandler::reactor_singleton());
 	ComterpHandler::logger_mode(logger_flag);
+	ComterpShmAcceptor* shm_acceptor = nil;
 
         int portnum = argc > 2 ? atoi(argv[2]) : atoi(ACE_DEFAULT_SERVER_PORT_STR);
         if (peer_acceptor->open (ACE_INET_Addr (portnum),
@@ -89,8 +91,20 @@ int main(int argc, char *argv[]) {
           cerr << "comterp: error registering acceptor with ACE reactor\n";
 #endif
 
-	else if (ComterpHandler::logger_mode()==0)
-	  cerr << "accepting comterp port (" << portnum << ") connections\n";
+	else {
+	  // offer shared memory to clients on this host
+	  if (!logger_flag) {
+	    shm_acceptor = new ComterpShmAcceptor();
+	    if (shm_acceptor->open(portnum, ComterpHandler::reactor_singleton()) == -1) {
+	      cerr << "comterp: shared-memory connections not offered on port " 
+		   << portnum << "\n";
+	      delete shm_acceptor;
+	      shm_acceptor = nil;
+	    }
+	  }
+	  if (ComterpHandler::logger_mode()==0)
+	    cerr << "accepting comterp port (" << portnum << ") connections\n";
+	}
     
         // Register COMTERP_QUIT_HANDLER to receive SIGINT commands.  When received,
         // COMTERP_QUIT_HANDLER becomes "set" and thus, the event loop below will
@@ -111,6 +125,13 @@ int main(int argc, char *argv[]) {
         // Perform logging service until COMTERP_QUIT_HANDLER receives SIGINT.
         while (COMTERP_QUIT_HANDLER::instance ()->is_set () == 0)
             ComterpHandler::reactor_singleton()->handle_events ();
+
+	// take down the local socket shared-memory clients look for
+	if (shm_acceptor) {
+	  ComterpHandler::reactor_singleton()->remove_handler
+	    (shm_acceptor, ACE_Event_Handler::READ_MASK | ACE_Event_Handler::DONT_CALL);
+	  delete shm_acceptor;
+	}
     
         return 0;
     }
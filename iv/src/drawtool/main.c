@@ -36,8 +36,12 @@
 #endif
 
 #include <OverlayUnidraw/ovcatalog.h>
+#include <OverlayUnidraw/ovclasses.h>
+#include <OverlayUnidraw/ovcomps.h>
 #include <OverlayUnidraw/ovcreator.h>
+#include <OverlayUnidraw/ovloader.h>
 #include <OverlayUnidraw/oved.h>
+#include <OverlayUnidraw/ovrender.h>
 #include <OverlayUnidraw/ovunidraw.h>
 
 #include <Unidraw/Graphic/geomobjs.h>
@@ -45,9 +49,15 @@
 #include <InterViews/world.h>
 #include <InterViews/event.h>
 
+#include <dirent.h>
 #include <stream.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <version.h>
 #include <iostream>
 #include <fstream>
@@ -165,6 +175,7 @@ static PropertyData properties[] = {
     { "*ptrloc",        "false"  },
     { "*dithermap",     "false"  },
     { "*svgexport",     "false"  },
+    { "*loadjobs",      "0"  },
 #ifdef HAVE_ACE
     { "*import",        "20001" },
 #endif
@@ -201,6 +212,7 @@ static OptionDesc options[] = {
     { "-ptrloc", "*ptrloc", OptionValueImplicit, "true" },
     { "-dithermap", "*dithermap", OptionValueImplicit, "true" },
     { "-svgexport", "*svgexport", OptionValueImplicit, "true" },
+    { "-loadjobs", "*loadjobs", OptionValueNext },
 #ifdef HAVE_ACE
     { "-import", "*import", OptionValueNext },
 #endif
@@ -216,18 +228,412 @@ static char* usage =
 [-gray7] [-import port] [-nocolor6] [-opaque_off|-opoff] [-pagecols|-ncols n] \n\
 [-pagerows|-nrows n] [-panner_align|-pal tl|tc|tr|cl|c|cr|cl|bl|br|l|r|t|b|hc|vc] \n\
 [-panner_off|-poff] [-ptrloc] [-scribble_pointer|-scrpt ] [-slider_off|-soff]\n\
-[-svgexport] [-toolbarloc|-tbl r|l ] [-zoomer_off|-zoff] [file]";
+[-svgexport] [-loadjobs n] [-toolbarloc|-tbl r|l ] [-zoomer_off|-zoff] [file]\n\
+       drawtool -convert outdir [-jobs n] [-binary] file|directory ...\n\
+       drawtool -render outdir [-jobs n] [-size WxH] [-tiff] file|directory ...";
 #else
 static char* usage =
 "Usage: drawtool [any idraw parameter] [-color5] [-dithermap] [-gray5] [-gray6] \n\
 [-gray7] [-nocolor6] [-opaque_off|-opoff] [-pagecols|-ncols n] \n\
 [-pagerows|-nrows n] [-panner_align|-pal tl|tc|tr|cl|c|cr|cl|bl|br|l|r|t|b|hc|vc] \n\
 [-panner_off|-poff] [-ptrloc] [-scribble_pointer|-scrpt ] [-slider_off|-soff]\n\
-[-svgexport] [-toolbarloc|-tbl r|l ] [-zoomer_off|-zoff] [file]";
+[-svgexport] [-loadjobs n] [-toolbarloc|-tbl r|l ] [-zoomer_off|-zoff] [file]\n\
+       drawtool -convert outdir [-jobs n] [-binary] file|directory ...\n\
+       drawtool -render outdir [-jobs n] [-size WxH] [-tiff] file|directory ...";
 #endif
 /*****************************************************************************/
 
+/*
+ * Batch conversion of idraw (or any other drawing drawtool can read)
+ * into drawtool format, or rendering into PPM or TIFF images with the
+ * software OverlayRenderer.  No editor is opened and no display is
+ * needed: the documents are read with a Unidraw built with -nodisplay.
+ * Converting spreads the files over njobs worker processes, each
+ * handling every njobs'th file of the list.  Rendering reads the files
+ * in one thread, since catalogs aren't thread-safe, converts their
+ * rasters there too, since reading pixels goes through the display's
+ * color table, and hands them to a pool of njobs threads with a
+ * renderer each, which draw and write them.
+ */
+
+static boolean batch_render = false;
+static boolean batch_tiff = false;
+static boolean batch_binary = false;
+static int batch_width = 512;
+static int batch_height = 512;
+static const int batch_maxsize = 16384;
+
+static char* convert_path (const char* outdir, const char* file) {
+    const char* base = strrchr(file, '/');
+    base = (base == nil) ? file : base + 1;
+    const char* dot = strrchr(base, '.');
+    int baselen = (dot == nil || dot == base) ? strlen(base) : dot - base;
+    const char* suffix = batch_render
+        ? (batch_tiff ? ".tif" : ".ppm") : (batch_binary ? ".dtb" : ".drawtool");
+
+    char* path = new char[strlen(outdir) + baselen + strlen(suffix) + 2];
+    sprintf(path, "%s/%.*s%s", outdir, baselen, base, suffix);
+    return path;
+}
+
+static OverlayUnidraw* convert_unidraw (char* prog, OverlayCatalog*& catalog) {
+    static OverlayCreator creator;
+    int argc = 2;
+    char* argv[3];
+    argv[0] = prog;
+    argv[1] = (char*) "-nodisplay";
+    argv[2] = nil;
+
+    catalog = new OverlayCatalog("drawtool", &creator);
+    OverlayUnidraw* unidraw = new OverlayUnidraw(
+        catalog, argc, argv, options, properties
+    );
+    MultiLineObj::CompactPoints(true);
+    return unidraw;
+}
+
+static Component* convert_read (OverlayCatalog* catalog, const char* file) {
+    Component* comp = nil;
+    boolean ok = catalog->IdrawCatalog::Retrieve(file, comp);
+
+    if (!ok) {
+        delete comp;
+        comp = nil;
+        ok = catalog->Retrieve(file, comp);
+    }
+    if (!ok) {
+        delete comp;
+        return nil;
+    }
+    catalog->Forget(comp);
+    return comp;
+}
+
+static int convert_files (
+    char* prog, const char* outdir, char** files, int nfiles, int job, int njobs
+) {
+    OverlayCatalog* catalog;
+    OverlayUnidraw* unidraw = convert_unidraw(prog, catalog);
+    int failed = 0;
+
+    for (int i = job; i < nfiles; i += njobs) {
+        char* path = convert_path(outdir, files[i]);
+        Component* comp = convert_read(catalog, files[i]);
+        boolean ok = comp != nil;
+
+        if (ok) {
+            if (!comp->IsA(OVERLAY_IDRAW_COMP)) {
+                OverlayIdrawComp* icomp = new OverlayIdrawComp;
+                icomp->Append((GraphicComp*) comp);
+                comp = icomp;
+            }
+            ok = catalog->Save(comp, path);
+            catalog->Forget(comp);
+        }
+        if (!ok) {
+            cerr << "drawtool: unable to convert " << files[i] << "\n";
+            ++failed;
+        }
+        delete comp;
+        delete [] path;
+    }
+    delete unidraw;
+    return failed;
+}
+
+/*
+ * A RenderJob is a document read and measured by the main thread, queued
+ * for the render threads and passed back on the finished list once its
+ * image is written, so that the main thread can delete it.  At most
+ * render_limit jobs are outstanding at once.
+ */
+
+class RenderJob {
+public:
+    Component* comp;
+    OverlayRenderRasters* rasters;
+    const char* file;
+    char* path;
+    float l, b, r, t;
+    boolean ok;
+    RenderJob* next;
+};
+
+static pthread_mutex_t render_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t render_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t render_finished = PTHREAD_COND_INITIALIZER;
+static RenderJob* render_head = nil;    // queued, oldest first
+static RenderJob* render_tail = nil;
+static RenderJob* render_done = nil;    // written, not yet deleted
+static int render_outstanding = 0;
+static int render_limit = 1;
+static boolean render_closed = false;
+
+static void render_job (OverlayRenderer* renderer, RenderJob* job) {
+    renderer->Render(
+        ((GraphicComp*) job->comp)->GetGraphic(),
+        job->l, job->b, job->r, job->t, job->rasters
+    );
+    job->ok = batch_tiff
+        ? renderer->WriteTIFF(job->path) : renderer->WritePPM(job->path);
+}
+
+static void* render_thread (void*) {
+    OverlayRenderer renderer(batch_width, batch_height);
+    pthread_mutex_lock(&render_lock);
+
+    for (;;) {
+        while (render_head == nil && !render_closed) {
+            pthread_cond_wait(&render_queued, &render_lock);
+        }
+        RenderJob* job = render_head;
+
+        if (job == nil) {
+            break;
+        }
+        render_head = job->next;
+
+        if (render_head == nil) {
+            render_tail = nil;
+        }
+        pthread_mutex_unlock(&render_lock);
+        render_job(&renderer, job);
+        pthread_mutex_lock(&render_lock);
+
+        job->next = render_done;
+        render_done = job;
+        pthread_cond_signal(&render_finished);
+    }
+    pthread_mutex_unlock(&render_lock);
+    return nil;
+}
+
+// render_reap deletes the finished jobs, first waiting until fewer than
+// limit are outstanding, and returns how many failed.
+
+static int render_reap (int limit) {
+    pthread_mutex_lock(&render_lock);
+
+    while (render_outstanding >= limit && render_done == nil) {
+        pthread_cond_wait(&render_finished, &render_lock);
+    }
+    RenderJob* done = render_done;
+    render_done = nil;
+    pthread_mutex_unlock(&render_lock);
+    int failed = 0;
+
+    while (done != nil) {
+        RenderJob* job = done;
+        done = job->next;
+
+        if (!job->ok) {
+            cerr << "drawtool: unable to render " << job->file << "\n";
+            ++failed;
+        }
+        delete job->rasters;
+        delete job->comp;
+        delete [] job->path;
+        delete job;
+
+        pthread_mutex_lock(&render_lock);
+        --render_outstanding;
+        pthread_mutex_unlock(&render_lock);
+    }
+    return failed;
+}
+
+static int render_files (
+    char* prog, const char* outdir, char** files, int nfiles, int njobs
+) {
+    OverlayCatalog* catalog;
+    OverlayUnidraw* unidraw = convert_unidraw(prog, catalog);
+    pthread_t* threads = new pthread_t[njobs];
+    int nthreads = 0;
+
+    while (
+        nthreads < njobs &&
+        pthread_create(&threads[nthreads], nil, &render_thread, nil) == 0
+    ) {
+        ++nthreads;
+    }
+    OverlayRenderer* renderer = (nthreads == 0)
+        ? new OverlayRenderer(batch_width, batch_height) : nil;
+    render_limit = 2*njobs;
+    int failed = 0;
+
+    for (int i = 0; i < nfiles; ++i) {
+        Component* comp = convert_read(catalog, files[i]);
+
+        if (comp == nil) {
+            cerr << "drawtool: unable to render " << files[i] << "\n";
+            ++failed;
+            continue;
+        }
+        RenderJob* job = new RenderJob;
+        job->comp = comp;
+        job->file = files[i];
+        job->path = convert_path(outdir, files[i]);
+        job->ok = false;
+        job->next = nil;
+        Graphic* graphic = ((GraphicComp*) comp)->GetGraphic();
+        graphic->GetBounds(job->l, job->b, job->r, job->t);
+        job->rasters = new OverlayRenderRasters(graphic);
+
+        if (renderer != nil) {
+            render_job(renderer, job);
+            job->next = render_done;
+            render_done = job;
+            ++render_outstanding;
+            failed += render_reap(render_limit);
+            continue;
+        }
+        failed += render_reap(render_limit);
+
+        pthread_mutex_lock(&render_lock);
+        if (render_tail == nil) {
+            render_head = job;
+        } else {
+            render_tail->next = job;
+        }
+        render_tail = job;
+        ++render_outstanding;
+        pthread_cond_signal(&render_queued);
+        pthread_mutex_unlock(&render_lock);
+    }
+    pthread_mutex_lock(&render_lock);
+    render_closed = true;
+    pthread_cond_broadcast(&render_queued);
+    pthread_mutex_unlock(&render_lock);
+
+    for (int t = 0; t < nthreads; ++t) {
+        pthread_join(threads[t], nil);
+    }
+    failed += render_reap(1);
+    delete renderer;
+    delete [] threads;
+    delete unidraw;
+    return failed;
+}
+
+static int convert (int argc, char** argv) {
+    batch_render = strcmp(argv[1], "-render") == 0;
+    const char* outdir = argv[2];
+    int njobs = 1;
+    int first = 3;
+
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-jobs") == 0 && first + 1 < argc) {
+            njobs = atoi(argv[++first]);
+        } else if (strcmp(argv[first], "-size") == 0 && first + 1 < argc) {
+            char extra;
+
+            if (
+                sscanf(
+                    argv[++first], "%dx%d%c", &batch_width, &batch_height, &extra
+                ) != 2 ||
+                batch_width < 1 || batch_width > batch_maxsize ||
+                batch_height < 1 || batch_height > batch_maxsize
+            ) {
+                cerr << "drawtool: bad -size " << argv[first]
+                     << ", expected WxH of at most "
+                     << batch_maxsize << "x" << batch_maxsize << "\n";
+                return 1;
+            }
+        } else if (strcmp(argv[first], "-tiff") == 0) {
+            batch_tiff = true;
+        } else if (strcmp(argv[first], "-binary") == 0) {
+            batch_binary = true;
+        } else {
+            cerr << usage << "\n";
+            return 1;
+        }
+        ++first;
+    }
+    int size = argc;
+    int nfiles = 0;
+    char** files = (char**) malloc(size * sizeof(char*));
+
+    for (int i = first; i < argc; ++i) {
+        struct stat st;
+        DIR* dir = (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode))
+            ? opendir(argv[i]) : nil;
+        struct dirent* d = nil;
+
+        while (dir == nil || (d = readdir(dir)) != nil) {
+            char* file;
+
+            if (dir == nil) {
+                file = new char[strlen(argv[i]) + 1];
+                strcpy(file, argv[i]);
+            } else {
+                if (d->d_name[0] == '.') {
+                    continue;
+                }
+                file = new char[strlen(argv[i]) + strlen(d->d_name) + 2];
+                sprintf(file, "%s/%s", argv[i], d->d_name);
+
+                if (stat(file, &st) != 0 || !S_ISREG(st.st_mode)) {
+                    delete [] file;
+                    continue;
+                }
+            }
+            if (nfiles == size) {
+                size *= 2;
+                files = (char**) realloc(files, size * sizeof(char*));
+            }
+            files[nfiles++] = file;
+
+            if (dir == nil) {
+                break;
+            }
+        }
+        if (dir != nil) {
+            closedir(dir);
+        }
+    }
+    njobs = (njobs < 1) ? 1 : (njobs > nfiles ? nfiles : njobs);
+    int failed = 0;
+
+    if (batch_render) {
+        failed = render_files(argv[0], outdir, files, nfiles, njobs);
+
+    } else if (njobs <= 1) {
+        failed = convert_files(argv[0], outdir, files, nfiles, 0, 1);
+
+    } else {
+        for (int job = 0; job < njobs; ++job) {
+            pid_t pid = fork();
+
+            if (pid == 0) {
+                _exit(convert_files(argv[0], outdir, files, nfiles, job, njobs) ? 1 : 0);
+            } else if (pid < 0) {
+                failed += convert_files(argv[0], outdir, files, nfiles, job, njobs);
+            }
+        }
+        int status;
+
+        while (wait(&status) > 0) {
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                ++failed;
+            }
+        }
+    }
+    for (int f = 0; f < nfiles; ++f) {
+        delete [] files[f];
+    }
+    free(files);
+    return failed == 0 ? 0 : 1;
+}
+
+/*****************************************************************************/
+
 int main (int argc, char** argv) {
+    if (
+        argc > 2 &&
+        (strcmp(argv[1], "-convert") == 0 || strcmp(argv[1], "-render") == 0)
+    ) {
+        return convert(argc, argv);
+    }
 #ifdef HAVE_ACE
     Dispatcher::instance(new AceDispatcher(ComterpHandler::reactor_singleton()));
 #endif
@@ -242,6 +648,8 @@ int main (int argc, char** argv) {
       cerr << usage << "\n";
       return 0;
     }
+
+    OverlayLoader::Jobs(atoi(catalog->GetAttribute("loadjobs")));
     
 #ifdef HAVE_ACE
 
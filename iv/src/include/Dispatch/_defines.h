@@ -5,6 +5,7 @@
 #define RpcPeer _lib_dp(RpcPeer)
 #define RpcReader _lib_dp(RpcReader)
 #define RpcRegistry _lib_dp(RpcRegistry)
+#define RpcReply _lib_dp(RpcReply)
 #define RpcService _lib_dp(RpcService)
 #define RpcWriter _lib_dp(RpcWriter)
 #define TimerQueue _lib_dp(TimerQueue)
@@ -5,6 +5,7 @@
 #undef RpcPeer
 #undef RpcReader
 #undef RpcRegistry
+#undef RpcReply
 #undef RpcService
 #undef RpcWriter
 #undef TimerQueue
@@ -27,6 +27,12 @@
 
 #include <Dispatch/enter-scope.h>
 #include <iostream.h>
+#if __GNUC__>=3
+using std::ios;
+using std::streambuf;
+using std::streamoff;
+using std::streampos;
+#endif
 
 //: Modify ios to store extra state information for binary I/O.
 // <p><a href=../man3.1/iostreamb.html>man page</a>
@@ -115,6 +121,8 @@ public:
     ~iostreamb();
 
     void negotiate(boolean binary);
+protected:
+    void negotiate(boolean binary, int& version);
 };
 
 #endif
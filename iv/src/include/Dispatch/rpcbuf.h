@@ -26,10 +26,13 @@
 #define dp_rpcbuf_h
 
 #include <Dispatch/iostreamb.h>
+#include <stdio.h>
 
 //: streambuf specialized for sending and receiving RPC requests
 // Specialize streambuf to sending and receiving RPC requests to and
-// from remote machines.
+// from remote machines.  Complete requests accumulate in a chain of
+// put areas and are sent with a single writev when the stream is
+// flushed, or when the chain holds maxchainbytes.
 // <p><a href=../man3.1/rpcbuf.html>man page</a>
 class rpcbuf : public streambuf {
 public:
@@ -52,21 +55,36 @@ public:
     rpcbuf* close();
     int start_request();
     int read_request();
+    const char* data(int n);
 
     virtual int overflow(int c = EOF);
     virtual int underflow();
     virtual int sync();
+#if __GNUC__>=3
+    virtual streampos seekoff(streamoff, ios::seekdir, ios::openmode);
+    virtual streambuf* setbuf(char*, std::streamsize);
+#else
 #ifdef cplusplus_2_1
     virtual streampos seekoff(streamoff, ios::seek_dir, int);
 #else
     virtual streampos seekoff(streamoff, seek_dir, int);
 #endif
     virtual streambuf* setbuf(char*, int);
+#endif
 protected:
     virtual int doallocate();
+#if __GNUC__>=3
+    int allocate();
+    char* ebuf();
+    int out_waiting();
+    void setb(char*, char*, int);
+#endif
     void finish_request();
     boolean expand_g(int);
     boolean expand_p();
+    boolean chain_p();
+    int write_chain(int);
+    void free_chain();
     void error(const char*);
     void sys_error(const char*);
     iostreamb& mystream();
@@ -84,6 +102,16 @@ protected:
     boolean _close;		// should I close my file descriptor on exit?
     boolean _nonblocking;	// can I read or write without blocking?
     boolean _verbose;		// should I print system error messages?
+
+    enum { maxchain = 16, maxchainbytes = 32768 };
+    char* _chain[maxchain];	// filled put areas waiting to be sent
+    int _chainlen[maxchain];	// number of bytes to send from each
+    int _nchain;		// number of put areas in the chain
+    int _chainbytes;		// number of bytes to send from the chain
+#if __GNUC__>=3
+    char* _base;		// buffer holding the get area
+    char* _ebuf;		// end of that buffer
+#endif
 };
 
 // Get the stream which will format the length field of RPC requests.
@@ -106,4 +134,28 @@ inline void rpcbuf::rbump(int n) {
     _rptr += n;
 }
 
+#if __GNUC__>=3
+
+// Stand in for the buffer management of the original streambuf,
+// which std::streambuf leaves to derived classes.
+
+inline int rpcbuf::allocate() {
+    return _base ? 0 : doallocate();
+}
+
+inline char* rpcbuf::ebuf() {
+    return _ebuf;
+}
+
+inline int rpcbuf::out_waiting() {
+    return pptr() - pbase();
+}
+
+inline void rpcbuf::setb(char* b, char* eb, int) {
+    _base = b;
+    _ebuf = eb;
+}
+
+#endif
+
 #endif
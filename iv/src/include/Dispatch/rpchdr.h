@@ -31,15 +31,24 @@ class rpcstream;
 
 //: header for remote procedure calls
 // Insert or extract this header to send or receive a RPC request.
+// A request that expects a reply carries the id given it by
+// rpcstream::expect; the reply is sent with a header whose request
+// is RpcHdr::reply and whose id is the same.  Once extracted, the
+// header points at the request's data, which stays in the stream's
+// buffer while the request is handled.
 // <p><a href=../man3.1/RpcHdr.html>man page</a>
 class RpcHdr {
 public:
-    RpcHdr(void* writer, int request);
+    enum { reply = -1 };
+
+    RpcHdr(void* writer, int request, unsigned long id = 0);
     RpcHdr();
 
     unsigned long reader();
     int request();
     int ndata();
+    unsigned long id();
+    const char* data();
 protected:
     friend rpcstream& operator>>(rpcstream&, RpcHdr&);
     friend rpcstream& operator<<(rpcstream&, const RpcHdr&);
@@ -50,6 +59,8 @@ protected:
     };
     int _request;		// maps to member function to be called
     int _ndata;			// gives size (in bytes) of data to extract
+    unsigned long _id;		// matches a reply to its request, or zero
+    const char* _data;		// points to data of an extracted request
 };
 
 // Get information about the RPC request.
@@ -66,4 +77,12 @@ inline int RpcHdr::ndata() {
     return _ndata;
 }
 
+inline unsigned long RpcHdr::id() {
+    return _id;
+}
+
+inline const char* RpcHdr::data() {
+    return _data;
+}
+
 #endif
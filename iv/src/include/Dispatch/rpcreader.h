@@ -34,7 +34,9 @@ class rpcstream;
 // Read RPC requests from a client.  Derived classes initialize the
 // function array with addresses of static member functions to
 // unmarshall RPC requests and implement the virtual function called
-// when the client closes the connection.
+// when the client closes the connection.  A function may extract the
+// request's data from the stream or read it in place through
+// RpcHdr::data; any data it leaves is skipped.
 // <p><a href=../man3.1/RpcReader.html>man page</a>
 class RpcReader : public IOHandler {
 public:
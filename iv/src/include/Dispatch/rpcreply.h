@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 1994-2000 Vectaport Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the names of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any purpose.
+ * It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+ * FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION
+ * WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef dp_rpcreply_h
+#define dp_rpcreply_h
+
+#include <Dispatch/enter-scope.h>
+
+class RpcHdr;
+class rpcstream;
+
+//: handler for the reply to a pipelined RPC request
+// Register a reply handler with rpcstream::expect to get an id for an
+// outgoing request.  Any number of requests may be outstanding on a
+// connection at once; an RpcReader attached to the connection calls
+// reply() when the reply carrying the handler's id arrives.
+class RpcReply {
+public:
+    virtual ~RpcReply();
+
+    virtual void reply(RpcHdr&, rpcstream&) = 0;
+    // extract the reply's data, hdr.ndata() bytes, from the stream, or
+    // read them in place through hdr.data().
+};
+
+#endif
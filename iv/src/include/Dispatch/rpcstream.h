@@ -27,9 +27,16 @@
 
 #include <Dispatch/rpcbuf.h>
 
+class RpcReply;
+class RpcReplyTable;
+
 //: iostreamb specialized to RPC requests
 // Modify iostreamb to store a rpcbuf and provide operations on the
-// rpcbuf, therefore specializing iostreamb to RPC requests.
+// rpcbuf, therefore specializing iostreamb to RPC requests.  Also
+// keep track of the requests sent over the connection whose replies
+// are still outstanding.  Request headers carry an id, which peers
+// built before ids existed do not send; negotiate() fails against
+// such a peer instead of misreading its requests.
 // <a href=../man3.1/rpcstream.html>man page</a>
 class rpcstream : public
 #if !defined(_IO_NEW_STREAMS)
@@ -49,15 +56,24 @@ public:
     void close();
     void nonblocking(boolean);
     void verbose(boolean);
+    void negotiate(boolean binary);
 
     rpcbuf* rdbuf();
     boolean incomplete_request();
     void incomplete_request(boolean);
+
+    unsigned long expect(RpcReply*);
+    RpcReply* answered(unsigned long id);
+    boolean waiting(unsigned long id);
+    int outstanding();
 protected:
     void verify(int);
 protected:
     rpcbuf _buf;		 // streambuf specialized to RPC requests
     boolean _incomplete_request; // is the incoming request still incomplete?
+    RpcReplyTable* _replies;	 // reply handlers of outstanding requests
+    unsigned long _lastid;	 // id given to the most recent request
+    int _outstanding;		 // number of requests awaiting replies
 };
 
 // Return or set protected member variables.
@@ -74,4 +90,8 @@ inline void rpcstream::incomplete_request(boolean incomplete_request) {
     _incomplete_request = incomplete_request;
 }
 
+inline int rpcstream::outstanding() {
+    return _outstanding;
+}
+
 #endif
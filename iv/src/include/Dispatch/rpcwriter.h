@@ -31,13 +31,18 @@ class rpcstream;
 
 //: write RPC requests to a server
 // Write RPC requests to a server.  Derived classes should add member
-// functions corresponding to the RPC service's protocol.
+// functions corresponding to the RPC service's protocol.  Requests
+// are buffered and sent together when the server stream is flushed;
+// a request that expects a reply gets its id from
+// server().expect(), and wait() dispatches events until that reply
+// has been handled by an RpcReader attached to server().
 // <p><a href=../man3.1/RpcWriter.html>man page</a>
 class RpcWriter {
 public:
     ~RpcWriter();
 
     rpcstream& server();
+    void wait(unsigned long id);
 protected:
     RpcWriter(const char* path, boolean fatal, boolean binary);
     RpcWriter(const char* host, int port, boolean fatal, boolean binary);
@@ -35,6 +35,14 @@ class Regexp;
 
 //: editable text buffer (iv-2.6)
 // <a href=../man3.1/TextBuffer.html>man page</a>
+//
+// The free space of the buffer is kept as a gap at the last point of
+// editing, so an insertion or deletion only moves the text between it and
+// the previous one.  The starts of lines are kept in a balanced tree of
+// line lengths, so mapping between lines and indices and keeping the map
+// up to date take time logarithmic in the number of lines.  Text() closes
+// the gap (putting the buffer in normal form); a subclass that reallocates
+// 'text' must call it first.
 class TextBuffer {
 public:
     TextBuffer(char* buffer, int length, int size);
@@ -95,22 +103,17 @@ protected:
     int length;
     int size;
 private:
+    void MoveGap(int index);
+
+    struct LineNode;
     int linecount;
-    int lastline;
-    int lastindex;
+    int gap;
+    LineNode* lines;
 };
 
 inline char TextBuffer::Char (int i) {
-    return (i<0) ? text[0] : (i>length) ? text[length] : text[i];
-}
-inline const char* TextBuffer::Text () {
-    return text;
-}
-inline const char* TextBuffer::Text (int i) {
-    return text + ((i<0) ? 0 : (i>length) ? length : i);
-}
-inline const char* TextBuffer::Text (int i, int) {
-    return text + ((i<0) ? 0 : (i>length) ? length : i);
+    i = (i<0) ? 0 : i;
+    return (i>=length) ? '\0' : text[(i<gap) ? i : i + size - length];
 }
 inline int TextBuffer::PreviousCharacter (int i) {
     return (i<=0) ? 0 : i-1;
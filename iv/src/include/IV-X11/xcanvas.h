@@ -89,10 +89,16 @@ public:
     PixelCoord pwidth_;
     PixelCoord pheight_;
 
+    enum { max_damage = 8 };
+
     boolean damaged_ : 1;
     boolean on_damage_list_ : 1;
     boolean repairing_ : 1;
     CanvasDamage damage_;
+    CanvasDamage damage_list_[max_damage];
+    int damage_count_;
+    Region repaired_;
+    unsigned long repaired_pixels_;
 
     XDrawable drawbuffer_;
     XDrawable copybuffer_;
@@ -134,12 +140,18 @@ public:
 
     void new_damage();
     void clear_damage();
+    void add_damage(const CanvasDamage&);
     boolean start_repair();
+    boolean repair_damage(int);
     void finish_repair();
+    void clip_damage(const CanvasDamage&, XRectangle&) const;
 
     void bind(boolean double_buffered);
     void unbind();
 
+    static void forget_transformed(const void*);
+    /* discard cached transformed copies of a bitmap or raster */
+
     /* for backward compability */
 public:
     CanvasLocation status_;
@@ -44,6 +44,9 @@ public:
     FontRep(Display*, XFontStruct*, float);
     ~FontRep();
 
+    const XCharStruct* chars();
+    const XCharStruct& char2b(long);
+
     Display* display_;
     XFontStruct* font_;
     float scale_;
@@ -52,6 +55,9 @@ public:
     String* encoding_;
     float size_;
     KnownFonts* entry_;
+
+    XCharStruct* chars_;
+    XCharStruct* rows_[256];
 };
 
 class FontFamilyRep {
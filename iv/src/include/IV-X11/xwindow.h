@@ -78,6 +78,14 @@ public:
     void find_color(
 	unsigned short r, unsigned short g, unsigned short b, XColor&
     );
+    void find_pixels(
+	const unsigned char* rgb, unsigned int samples, unsigned long n,
+	unsigned long* pixels
+    );
+    void find_pixels(
+	const unsigned short* rgb, unsigned int samples, unsigned long n,
+	unsigned long* pixels
+    );
 
     unsigned long x_or(const Style&) const;
     unsigned long x_or_(const Style&) const;
@@ -102,6 +110,8 @@ private:
     unsigned long white_;
     unsigned long xor_;
     boolean bytesize_;
+    unsigned long* pixeltable_;
+    unsigned long* pixelcache_;
 
     static void find_visual_by_class_name(const String&, WindowVisualInfo&);
     static boolean find_layer(const String&, int& layer);
@@ -111,6 +121,10 @@ private:
     );
 
     void set_shift(unsigned long mask, unsigned long& v, unsigned long& shift);
+    void init_pixel_tables();
+    unsigned long cached_pixel(
+	unsigned char r, unsigned char g, unsigned char b
+    );
 
     static unsigned int MSB(unsigned long);
     static double distance(
@@ -120,6 +120,8 @@ public:
     );
     virtual void redraw(Coord left, Coord bottom, Coord right, Coord top);
     virtual void repair();
+    virtual long damage_count() const;
+    virtual unsigned long repaired_pixels() const;
 
     CanvasRep* rep() const;
 private:
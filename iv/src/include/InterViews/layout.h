@@ -47,6 +47,7 @@ public:
         const Allocation& given, GlyphIndex count, const Requisition*,
 	Allocation* result
     );
+    virtual boolean tiled(DimensionName&, boolean& reversed) const;
 };
 
 class Color;
@@ -68,6 +68,40 @@ public:
 	float alpha
     );
 
+    virtual void peekrow(
+	unsigned long x, unsigned long y, unsigned long n,
+	unsigned char* rgb, unsigned int samples = 3
+    ) const;
+    // read 'n' pixels starting at 'x','y' into packed 8-bit samples,
+    // 'samples' (3 for rgb, 4 for rgba) to a pixel.  Alpha is set to 0xff.
+    virtual void pokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned char* rgb, unsigned int samples = 3
+    );
+    // store 'n' pixels starting at 'x','y' from packed 8-bit samples,
+    // 'samples' (3 for rgb, 4 for rgba) to a pixel.  Alpha is ignored,
+    // as it is by poke.
+    virtual void pokerow(
+	unsigned long x, unsigned long y, unsigned long n,
+	const unsigned short* rgb, unsigned int samples = 3
+    );
+    // store 'n' pixels starting at 'x','y' from packed 16-bit samples.
+    void pokerect(
+	unsigned long x, unsigned long y, unsigned long w, unsigned long h,
+	const unsigned char* rgb, unsigned int samples = 3,
+	unsigned long stride = 0
+    );
+    // store a 'w' by 'h' rectangle with lower-left corner at 'x','y' from
+    // rows of packed 8-bit samples, top row first as in image files.
+    // 'stride' is the number of samples from one row to the next,
+    // 'w'*'samples' when 0.
+    void pokerect(
+	unsigned long x, unsigned long y, unsigned long w, unsigned long h,
+	const unsigned short* rgb, unsigned int samples = 3,
+	unsigned long stride = 0
+    );
+    // store a rectangle from rows of packed 16-bit samples.
+
     virtual void flush() const;
     virtual void flushrect(IntCoord l, IntCoord b, IntCoord s, IntCoord t) const;
     // flush rectangular region of internal XImage data structure 
@@ -49,6 +49,10 @@ struct regexp {
     char reganch;		/* Internal use only. */
     char *regmust;		/* Internal use only. */
     int regmlen;		/* Internal use only. */
+    char *regprefix;		/* Internal use only. */
+    int regplen;		/* Internal use only. */
+    char regfset;		/* Internal use only. */
+    char regfirst[256];		/* Internal use only. */
     char program[1];		/* Unwarranted chumminess with compiler. */
 };
 
@@ -45,6 +45,7 @@ public:
         const Allocation& given, GlyphIndex count, const Requisition*,
 	Allocation* result
     );
+    virtual boolean tiled(DimensionName&, boolean& reversed) const;
 private:
     Layout** layout_;
     int count_;
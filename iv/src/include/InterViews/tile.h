@@ -43,6 +43,7 @@ public:
         const Allocation& given, GlyphIndex count, const Requisition*,
 	Allocation* result
     );
+    virtual boolean tiled(DimensionName&, boolean& reversed) const;
 private:
     DimensionName dimension_;
     Requisition requisition_;
@@ -60,6 +61,7 @@ public:
         const Allocation& given, GlyphIndex count, const Requisition*,
 	Allocation* result
     );
+    virtual boolean tiled(DimensionName&, boolean& reversed) const;
 private:
     DimensionName dimension_;
     Requisition requisition_;
@@ -77,6 +79,7 @@ public:
         const Allocation& given, GlyphIndex count, const Requisition*,
 	Allocation* result
     );
+    virtual boolean tiled(DimensionName&, boolean& reversed) const;
 private:
     DimensionName dimension_;
     Requisition requisition_;
@@ -94,6 +97,7 @@ public:
         const Allocation& given, GlyphIndex count, const Requisition*,
 	Allocation* result
     );
+    virtual boolean tiled(DimensionName&, boolean& reversed) const;
 private:
     DimensionName dimension_;
     Requisition requisition_;
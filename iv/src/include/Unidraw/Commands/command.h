@@ -58,6 +58,12 @@ public:
     virtual void Store(Component*, Data* = nil);
     virtual Data* Recall(Component*);
     virtual void Log();
+
+    virtual unsigned long Footprint();
+    // estimate of the bytes held by this command in the undo history.
+    virtual boolean Coalesce(Command*);
+    // merge an executed command that follows this one into it, so that
+    // both are undone and redone as one.  Returns false if not possible.
     
     virtual void SetControlInfo(ControlInfo*);
     virtual void SetEditor(Editor*);
@@ -91,6 +97,9 @@ protected:
     Clipboard* DeepCopyClipboard();
 
     GraphicComp* GetGraphicComp();
+    boolean SameTargets(Command*);
+    unsigned long ClipboardFootprint();
+    // bytes held by the clipboard's components, for commands that own them.
 protected:
     ControlInfo* _ctrlInfo;
     Editor* _editor;
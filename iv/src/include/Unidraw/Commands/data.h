@@ -36,6 +36,9 @@
 // interpret. 
 // <p><a href=../man3.1/Data.html>man page</a>
 class Data : public Resource {
+public:
+    virtual unsigned long Footprint();
+    // estimate of the bytes held by this data.
 protected:
     Data();
 };
@@ -43,6 +43,8 @@ class FullGraphic;
 class VoidData : public Data {
 public:
     VoidData(void*);
+
+    virtual unsigned long Footprint();
 public:
     void* _void;
 };
@@ -52,6 +54,8 @@ public:
 class MoveData : public Data {
 public:
     MoveData(float, float);
+
+    virtual unsigned long Footprint();
 public:
     float _dx, _dy;
 };
@@ -61,6 +65,8 @@ public:
 class ColorData : public Data {
 public:
     ColorData(PSColor*, PSColor*);
+
+    virtual unsigned long Footprint();
 public:
     PSColor* _fg, *_bg;
 };
@@ -71,6 +77,8 @@ class GSData : public Data {
 public:
     GSData(Graphic*);
     virtual ~GSData();
+
+    virtual unsigned long Footprint();
 public:
     FullGraphic* _gs;
 };
@@ -81,6 +89,8 @@ class MobilityData : public Data {
 public:
     MobilityData(Mobility, Graphic*);
     virtual ~MobilityData();
+
+    virtual unsigned long Footprint();
 public:
     Mobility _mobility;
     FullGraphic* _gs;
@@ -94,6 +104,8 @@ class UngroupData : public Data {
 public:
     UngroupData(GraphicComp* parent, Graphic*);
     virtual ~UngroupData();
+
+    virtual unsigned long Footprint();
 public:
     GraphicComp* _parent;
     FullGraphic* _gs;
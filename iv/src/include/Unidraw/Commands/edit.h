@@ -72,6 +72,7 @@ public:
 
     virtual void Execute();
     virtual void Unexecute();
+    virtual unsigned long Footprint();
 
     virtual Command* Copy();
     virtual ClassId GetClassId();
@@ -106,6 +107,7 @@ public:
 
     virtual void Execute();
     virtual void Unexecute();
+    virtual unsigned long Footprint();
     virtual boolean Reversible();
 
     virtual Command* Copy();
@@ -142,6 +144,7 @@ public:
 
     virtual void Execute();
     virtual void Unexecute();
+    virtual unsigned long Footprint();
 
     virtual Command* Copy();
     virtual ClassId GetClassId();
@@ -160,6 +163,7 @@ public:
 
     virtual void Execute();
     virtual void Unexecute();
+    virtual unsigned long Footprint();
 
     virtual Command* Copy();
     virtual ClassId GetClassId();
@@ -45,6 +45,7 @@ public:
     virtual void Execute();
     virtual void Unexecute();
     virtual boolean Reversible();
+    virtual unsigned long Footprint();
     
     virtual void SetEditor(Editor*);
 
@@ -43,6 +43,7 @@ public:
 
     virtual void Execute();
     virtual void Unexecute();
+    virtual unsigned long Footprint();
     virtual boolean Reversible();
 
     GraphicComp* GetGroup();
@@ -74,6 +75,7 @@ public:
 
     virtual void Execute();
     virtual void Unexecute();
+    virtual unsigned long Footprint();
 
     Clipboard* GetKids();
     void SetKids(Clipboard*);
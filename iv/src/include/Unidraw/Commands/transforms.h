@@ -40,6 +40,7 @@ public:
 
     void GetMovement(float&, float&);
 
+    virtual boolean Coalesce(Command*);
     virtual Command* Copy();
     virtual void Read(istream&);
     virtual void Write(ostream&);
@@ -80,6 +81,7 @@ public:
 
     float GetRotation();
 
+    virtual boolean Coalesce(Command*);
     virtual Command* Copy();
     virtual void Read(istream&);
     virtual void Write(ostream&);
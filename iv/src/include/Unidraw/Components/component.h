@@ -81,6 +81,9 @@ public:
     virtual ClassId GetSubstId(const char*& delim);
     virtual boolean IsA(ClassId);
 
+    virtual unsigned long Footprint();
+    // estimate of the bytes held by this component and its children.
+
     static boolean use_unidraw() { return _use_unidraw; }
     static void use_unidraw(boolean flag) { _use_unidraw = flag; }
 
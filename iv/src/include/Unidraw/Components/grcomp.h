@@ -75,6 +75,10 @@ public:
     virtual ClassId GetClassId();
     virtual boolean IsA(ClassId);
 
+    virtual unsigned long Footprint();
+    // estimate of the bytes held by this component, its graphic and
+    // its children.
+
     virtual void SetGraphic(Graphic*);
 protected:
     GraphicComp(Graphic* = nil);
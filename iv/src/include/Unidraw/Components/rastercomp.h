@@ -43,6 +43,7 @@ public:
     RasterRect* GetRasterRect();
     const char* GetFileName();
 
+    virtual unsigned long Footprint();
     virtual Component* Copy();
     virtual void Read(istream&);
     virtual void Write(ostream&);
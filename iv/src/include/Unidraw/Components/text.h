@@ -47,6 +47,7 @@ public:
     
     TextGraphic* GetText();
     
+    virtual unsigned long Footprint();
     virtual Component* Copy();
     virtual void Read(istream&);
     virtual void Write(ostream&);
@@ -40,6 +40,7 @@ class VerticesComp : public GraphicComp {
 public:
     Vertices* GetVertices();
 
+    virtual unsigned long Footprint();
     virtual ClassId GetClassId();
     virtual boolean IsA(ClassId);
 protected:
@@ -77,6 +77,9 @@ public:
 
     void SetHistoryLength(int);
     int GetHistoryLength();
+    void SetHistoryMemory(unsigned long);
+    unsigned long GetHistoryMemory();
+    unsigned long HistoryFootprint(Component* = nil);
 
     virtual void Log(Command*);
     void Undo(Component*, int = 1);
@@ -97,6 +100,8 @@ protected:
 
     void GetHistory(Component*, UList*& past, UList*& future);
     void ClearHistory(UList*, int = 1);
+    void TrimHistory(UList*);
+    unsigned long HistoryFootprint(UList*);
 
     UList* elem(Iterator);
     Command* command(UList*);
@@ -124,6 +129,7 @@ protected:
 
     HistoryMap* _histories;
     int _histlen;
+    unsigned long _histmem;
 };
 
 inline Catalog* Unidraw::GetCatalog () { return _catalog; }
@@ -0,0 +1,204 @@
+/*
+ * ivbench cases built from InterViews 3.1 glyphs, compiled apart from
+ * ivbench.c, which uses the 2.6 names.
+ */
+
+#include "boxbench.h"
+
+#include <InterViews/canvas.h>
+#include <InterViews/display.h>
+#include <InterViews/event.h>
+#include <InterViews/font.h>
+#include <InterViews/hit.h>
+#include <InterViews/layout.h>
+#include <InterViews/monoglyph.h>
+#include <InterViews/polyglyph.h>
+#include <InterViews/session.h>
+#include <InterViews/window.h>
+#include <IV-look/kit.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/*****************************************************************************/
+
+/*
+ * Box: a vbox of labelled rows far longer than its window, scrolled a
+ * window at a time, each view repaired and then picked at its middle.
+ */
+
+static const Coord scroll_width = 300;
+static const Coord scroll_height = 600;
+
+class BenchScroller : public MonoGlyph {
+public:
+    BenchScroller(Glyph* body) : MonoGlyph(body) { offset_ = 0; }
+
+    virtual void request(Requisition& r) const {
+        Glyph* g = body();
+        g->request(natural_);
+        Requirement rx(scroll_width, 0, 0, 0);
+        Requirement ry(scroll_height, 0, 0, 0);
+        r.require(Dimension_X, rx);
+        r.require(Dimension_Y, ry);
+    }
+    virtual void allocate(Canvas* c, const Allocation& a, Extension& ext) {
+        canvas_ = c;
+        allocation_ = a;
+        ext.merge(c, a);
+    }
+    virtual void draw(Canvas* c, const Allocation& a) const {
+        Allocation s;
+        shift(a, s);
+        c->push_clipping();
+        c->clip_rect(a.left(), a.bottom(), a.right(), a.top());
+        body()->draw(c, s);
+        c->pop_clipping();
+    }
+    virtual void pick(Canvas* c, const Allocation& a, int depth, Hit& h) {
+        Allocation s;
+        shift(a, s);
+        body()->pick(c, s, depth, h);
+    }
+
+    void scroll(Coord offset) { offset_ = offset; }
+    Coord length() const { return natural_.y_requirement().natural(); }
+    Canvas* canvas() const { return canvas_; }
+    const Allocation& allocation() const { return allocation_; }
+private:
+    void shift(const Allocation& a, Allocation& s) const {
+        Allotment x(a.left(), a.right() - a.left(), 0);
+        Allotment y(a.top() + offset_, length(), 1);
+        s.allot(Dimension_X, x);
+        s.allot(Dimension_Y, y);
+    }
+
+    Coord offset_;
+    mutable Requisition natural_;
+    Canvas* canvas_;
+    Allocation allocation_;
+};
+
+static PolyGlyph* bench_rows = nil;
+static BenchScroller* bench_scroller = nil;
+static ApplicationWindow* bench_window = nil;
+
+static void box_sync () {
+    Session* session = Session::instance();
+    session->default_display()->sync();
+    Event e;
+
+    while (session->pending()) {
+        session->read(e);
+        e.handle();
+    }
+}
+
+void box_setup (int n) {
+    WidgetKit& kit = *WidgetKit::instance();
+    LayoutKit& layout = *LayoutKit::instance();
+    PolyGlyph* rows = layout.vbox(n);
+    char buf[32];
+    for (int i = 0; i < n; ++i) {
+        sprintf(buf, "row %d", i);
+        rows->append(layout.hbox(kit.label(buf), layout.hglue()));
+    }
+    bench_rows = rows;
+    bench_scroller = new BenchScroller(rows);
+    bench_window = new ApplicationWindow(bench_scroller);
+    bench_window->map();
+    box_sync();
+}
+
+void box_scroll (int) {
+    Coord length = bench_scroller->length();
+    for (Coord offset = 0; offset < length; offset += length / 50) {
+        bench_scroller->scroll(offset);
+        Canvas* c = bench_scroller->canvas();
+        c->damage_all();
+        bench_window->repair();
+        const Allocation& a = bench_scroller->allocation();
+        Hit h((a.left() + a.right()) / 2, (a.bottom() + a.top()) / 2);
+        bench_scroller->pick(c, a, 0, h);
+    }
+    Session::instance()->default_display()->sync();
+}
+
+void box_edit (int n) {
+    WidgetKit& kit = *WidgetKit::instance();
+    LayoutKit& layout = *LayoutKit::instance();
+    Canvas* c = bench_scroller->canvas();
+    char buf[32];
+    for (int i = 0; i < 100; ++i) {
+        sprintf(buf, "edit %d", i);
+        bench_rows->replace(n / 2, layout.hbox(kit.label(buf), layout.hglue()));
+        c->damage_all();
+        bench_window->repair();
+    }
+    Session::instance()->default_display()->sync();
+}
+
+void box_corners (int) {
+    Canvas* c = bench_scroller->canvas();
+    Coord w = c->width(), h = c->height();
+    unsigned long pixels = 0;
+    for (int i = 0; i < 100; ++i) {
+        c->damage(0, h - 20, 20, h);
+        c->damage(w - 20, 0, w, 20);
+        bench_window->repair();
+        pixels += c->repaired_pixels();
+    }
+    Session::instance()->default_display()->sync();
+    fprintf(stderr, "box.corners: %lu pixels redrawn per frame\n", pixels / 100);
+}
+
+void box_cleanup () {
+    bench_window->unmap();
+    delete bench_window;
+    bench_window = nil;
+    bench_scroller = nil;
+    bench_rows = nil;
+    box_sync();
+}
+
+/*****************************************************************************/
+
+/*
+ * Text: lines of labels laid out in a vbox, each line measured and then
+ * searched for the caret index at a range of offsets.
+ */
+
+static const char* text_words[] = {
+    "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog",
+    "Pack", "my", "box", "with", "five", "dozen", "liquor", "jugs"
+};
+static const int text_nwords = sizeof(text_words) / sizeof(text_words[0]);
+
+void text_layout (int n) {
+    WidgetKit& kit = *WidgetKit::instance();
+    LayoutKit& layout = *LayoutKit::instance();
+    const Font* f = kit.font();
+    PolyGlyph* lines = layout.vbox(n);
+    Resource::ref(lines);
+    char line[256];
+    long carets = 0;
+    for (int i = 0; i < n; ++i) {
+        line[0] = '\0';
+        for (int j = 0; j < 12; ++j) {
+            strcat(line, text_words[(i * 7 + j * 3) % text_nwords]);
+            strcat(line, " ");
+        }
+        int len = strlen(line);
+        lines->append(layout.hbox(kit.label(line), layout.hglue()));
+        Coord w = f->width(line, len);
+        for (Coord x = 0; x < w; x += w / 32) {
+            carets += f->index(line, len, x, true);
+        }
+    }
+    Requisition r;
+    lines->request(r);
+    Resource::unref(lines);
+    if (carets < 0) {
+        fprintf(stderr, "text.layout: bad caret\n");
+    }
+}
@@ -0,0 +1,26 @@
+/*
+ * ivbench cases built from InterViews 3.1 glyphs.
+ */
+
+#ifndef boxbench_h
+#define boxbench_h
+
+void box_setup(int rows);
+// build a window onto a vbox of 'rows' labelled rows.
+void box_scroll(int rows);
+// scroll through the rows a window at a time, repairing and picking
+// each view.
+void box_edit(int rows);
+// replace the middle row a hundred times, repairing the window after
+// each.
+void box_corners(int rows);
+// damage two small opposite corners of the window a hundred times,
+// repairing after each.
+void box_cleanup();
+// close the window.
+
+void text_layout(int lines);
+// lay out a vbox of labelled lines of text, measuring each line and
+// finding the caret at offsets along it.
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * ivbench cases for comterp transports: a child process runs a comterp
+ * server on a private port, and the same commands are sent to it over
+ * TCP loopback or through a ComterpShm.  Compiled to nothing without ACE.
+ */
+
+#include "combench.h"
+
+#if defined(HAVE_ACE)
+
+#include <ComTerp/comhandler.h>
+#include <ComTerp/comshm.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ace/SOCK_Connector.h>
+
+/*****************************************************************************/
+
+static double com_now () {
+    struct timeval tv;
+    gettimeofday(&tv, nil);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static pid_t com_server = -1;
+static int com_fd = -1;
+static ComterpShm* com_shm = nil;
+static char com_in[BUFSIZ];
+static int com_inlen = 0;
+static int com_inpos = 0;
+static double* com_sent = nil;
+static double* com_latency = nil;
+static int com_received = 0;
+static double com_elapsed = 0;
+static const char* com_transport = nil;
+static const char* com_mode = nil;
+static int com_port = 0;
+
+static void com_serve (int port, int ready) {
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, 2);   /* the server echoes every command */
+    ACE_Reactor* reactor = ComterpHandler::reactor_singleton();
+    ComterpAcceptor* tcp = new ComterpAcceptor(reactor);
+    ComterpShmAcceptor* shm = new ComterpShmAcceptor();
+    char ok = tcp->open(ACE_INET_Addr(port), reactor) != -1 &&
+        shm->open(port, reactor) != -1;
+    write(ready, &ok, 1);
+    close(ready);
+    for (;;) {
+        reactor->handle_events();
+    }
+}
+
+static void com_setup (int n, boolean shared) {
+    com_port = 20000 + getpid() % 20000;
+    int ready[2];
+    if (pipe(ready) < 0) {
+        perror("com_setup: pipe");
+        exit(1);
+    }
+    com_server = fork();
+    if (com_server == 0) {
+        close(ready[0]);
+        com_serve(com_port, ready[1]);
+        _exit(0);
+    }
+    close(ready[1]);
+    char ok = 0;
+    read(ready[0], &ok, 1);
+    close(ready[0]);
+    if (!ok) {
+        fprintf(stderr, "com_setup: server failed on port %d\n", com_port);
+        exit(1);
+    }
+
+    if (shared) {
+        com_transport = "shm";
+        com_shm = ComterpShm::connect(com_port);
+    } else {
+        com_transport = "tcp";
+        ACE_SOCK_Stream stream;
+        ACE_SOCK_Connector connector;
+        if (connector.connect(stream, ACE_INET_Addr(com_port, "localhost")) != -1) {
+            com_fd = stream.get_handle();
+        }
+    }
+    if (!com_shm && com_fd < 0) {
+        fprintf(stderr, "com_setup: cannot connect over %s\n", com_transport);
+        exit(1);
+    }
+    com_inlen = com_inpos = 0;
+    com_sent = new double[n];
+    com_latency = new double[n];
+}
+
+void com_tcp_setup (int n) {
+    com_setup(n, false);
+}
+
+void com_shm_setup (int n) {
+    com_setup(n, true);
+}
+
+static boolean com_send (const char* cmd) {
+    if (com_shm) {
+        return com_shm->puts(cmd) >= 0;
+    }
+    return write(com_fd, cmd, strlen(cmd)) > 0;
+}
+
+static boolean com_reply () {
+    if (com_shm) {
+        return com_shm->gets() != nil;
+    }
+    for (;;) {
+        char* nl = (char*) memchr(com_in + com_inpos, '\n', com_inlen - com_inpos);
+        if (nl) {
+            com_inpos = nl - com_in + 1;
+            return true;
+        }
+        memmove(com_in, com_in + com_inpos, com_inlen - com_inpos);
+        com_inlen -= com_inpos;
+        com_inpos = 0;
+        int got = read(com_fd, com_in + com_inlen, sizeof(com_in) - com_inlen);
+        if (got <= 0) {
+            return false;
+        }
+        com_inlen += got;
+    }
+}
+
+static void com_run (int n, int window) {
+    int sent = 0;
+    com_received = 0;
+    double start = com_now();
+    while (com_received < n) {
+        while (sent < n && sent - com_received < window) {
+            com_sent[sent++] = com_now();
+            if (!com_send("1+1\n")) {
+                return;
+            }
+        }
+        if (!com_reply()) {
+            return;
+        }
+        com_latency[com_received] = com_now() - com_sent[com_received];
+        ++com_received;
+    }
+    com_elapsed = com_now() - start;
+}
+
+void com_serial (int n) {
+    com_mode = "serial";
+    com_run(n, 1);
+}
+
+void com_pipeline (int n) {
+    com_mode = "pipeline";
+    com_run(n, 64);
+}
+
+static int compare_latency (const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+void com_cleanup () {
+    if (com_received > 0 && com_elapsed > 0) {
+        qsort(com_latency, com_received, sizeof(double), &compare_latency);
+        fprintf(
+            stderr, "comterp.%s.%s: %d commands, %.0f commands/s, p99 %.1f us\n",
+            com_transport, com_mode, com_received, com_received / com_elapsed,
+            com_latency[(com_received * 99) / 100] * 1e6
+        );
+    }
+    delete com_shm;
+    com_shm = nil;
+    if (com_fd >= 0) {
+        close(com_fd);
+        com_fd = -1;
+    }
+    kill(com_server, SIGTERM);
+    int status;
+    waitpid(com_server, &status, 0);
+    const char* sockpath = ComterpShm::path(com_port);
+    if (sockpath) unlink(sockpath);
+    delete [] com_sent;
+    delete [] com_latency;
+    com_sent = com_latency = nil;
+}
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * ivbench cases for comterp transports: a child process serves comterp
+ * over TCP and shared memory, and commands are sent to it one at a time
+ * or pipelined.
+ */
+
+#ifndef combench_h
+#define combench_h
+
+void com_tcp_setup(int commands);
+// fork a comterp server and connect to it over TCP loopback.
+void com_shm_setup(int commands);
+// fork a comterp server and connect to it through shared memory.
+void com_serial(int commands);
+// send commands one at a time, waiting for each result.
+void com_pipeline(int commands);
+// send commands with up to 64 outstanding.
+void com_cleanup();
+// report commands/s and p99 latency of the last run and stop the server.
+
+#endif
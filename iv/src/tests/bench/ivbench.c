@@ -0,0 +1,1439 @@
+/*
+ * ivbench - time synthetic load, save, draw, pick and script workloads
+ * and report the results as JSON.
+ */
+
+#include "boxbench.h"
+#include "combench.h"
+#include "rpcbench.h"
+
+#include <FrameUnidraw/framecomps.h>
+#include <FrameUnidraw/framecreator.h>
+#include <FrameUnidraw/frameviews.h>
+
+#include <ComTerp/comprofile.h>
+#include <ComTerp/comterpserv.h>
+#include <ComTerp/comvalue.h>
+
+#include <OverlayUnidraw/grayraster.h>
+#include <OverlayUnidraw/ovarrow.h>
+#include <OverlayUnidraw/ovbinary.h>
+#include <OverlayUnidraw/ovcatalog.h>
+#include <OverlayUnidraw/ovcomps.h>
+#include <OverlayUnidraw/ovcreator.h>
+#include <OverlayUnidraw/ovellipse.h>
+#include <OverlayUnidraw/oved.h>
+#include <OverlayUnidraw/ovfilter.h>
+#include <OverlayUnidraw/ovimport.h>
+#include <OverlayUnidraw/ovline.h>
+#include <OverlayUnidraw/ovpolygon.h>
+#include <OverlayUnidraw/ovpsview.h>
+#include <OverlayUnidraw/ovraster.h>
+#include <OverlayUnidraw/ovrect.h>
+#include <OverlayUnidraw/ovrender.h>
+#include <OverlayUnidraw/ovtext.h>
+#include <OverlayUnidraw/ovtiff.h>
+#include <OverlayUnidraw/ovunidraw.h>
+
+#include <Unidraw/Commands/transforms.h>
+#include <Unidraw/Components/gvupdater.h>
+#include <Unidraw/Components/text.h>
+#include <UniIdraw/idarrows.h>
+
+#include <Unidraw/Graphic/damage.h>
+#include <Unidraw/Graphic/ellipses.h>
+#include <Unidraw/Graphic/geomobjs.h>
+#include <Unidraw/Graphic/lines.h>
+#include <Unidraw/Graphic/picture.h>
+#include <Unidraw/Graphic/polygons.h>
+#include <Unidraw/catalog.h>
+#include <Unidraw/classes.h>
+#include <Unidraw/clipboard.h>
+#include <Unidraw/editor.h>
+#include <Unidraw/iterator.h>
+#include <Unidraw/selection.h>
+#include <Unidraw/unidraw.h>
+#include <Unidraw/viewer.h>
+
+#include <InterViews/display.h>
+#include <InterViews/event.h>
+#include <InterViews/regexp.h>
+#include <InterViews/session.h>
+#include <InterViews/textbuffer.h>
+#include <InterViews/transformer.h>
+#include <InterViews/world.h>
+
+#include <IV-X11/xdisplay.h>
+#include <IV-X11/xwindow.h>
+
+#ifdef EXTERN_TIFF
+#include <tiffio.h>
+#else
+#include <TIFF/tiffio.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <version.h>
+#include <fstream>
+#include <iostream>
+
+using std::cerr;
+
+/*****************************************************************************/
+
+static PropertyData properties[] = {
+    { "*OverlayEditor*name", "ivbench" },
+    { "*OverlayEditor*iconName", "ivbench" },
+    { "*domain",  "drawing" },
+    { "*initialbrush",  "2" },
+    { "*initialfgcolor","1" },
+    { "*initialbgcolor","10" },
+    { "*initialfont",   "4" },
+    { "*initialpattern","1" },
+    { "*initialarrow", "none" },
+    { "*pagewidth", "8.5" },
+    { "*pageheight", "11" },
+    { "*gridxincr", "8" },
+    { "*gridyincr", "8" },
+    { "*font1", "-*-courier-medium-r-normal-*-8-*-*-*-*-*-*-* Courier 8" },
+    { "*font2", "-*-courier-medium-r-normal-*-10-*-*-*-*-*-*-* Courier 10" },
+    { "*font3", "-*-courier-bold-r-normal-*-12-*-*-*-*-*-*-* Courier-Bold 12" },
+    { "*font4",
+	"-*-helvetica-medium-r-normal-*-12-*-*-*-*-*-*-* Helvetica 12"
+    },
+    { "*brush1",	"none" },
+    { "*brush2",	"ffff 0" },
+    { "*brush3",	"ffff 1" },
+    { "*brush4",	"ffff 2" },
+    { "*pattern1",	"none" },
+    { "*pattern2",	"0.0" },
+    { "*pattern3",	"1.0" },
+    { "*pattern4",	"0.5" },
+    { "*fgcolor1",	"Black" },
+    { "*fgcolor2",	"Red" },
+    { "*fgcolor3",	"Green" },
+    { "*fgcolor4",	"Blue" },
+    { "*bgcolor1",	"Black" },
+    { "*bgcolor2",	"Red" },
+    { "*bgcolor3",	"Green" },
+    { "*bgcolor4",	"Blue" },
+    { "*bgcolor10",	"White" },
+    { "*history",	"20" },
+    { "*color5",        "false" },
+    { "*color6",        "true" },
+    { "*gray5",         "false" },
+    { "*gray6",         "false" },
+    { "*gray7",         "false" },
+    { "*pagecols",      "0" },
+    { "*pagerows",      "0" },
+    { "*panner_off",    "true"  },
+    { "*panner_align",  "br"  },
+    { "*scribble_pointer", "false" },
+    { "*slider_off",    "true"  },
+    { "*theight",       "512" },
+    { "*tile",          "false" },
+    { "*toolbarloc",    "l"  },
+    { "*twidth",        "512" },
+    { "*zoomer_off",    "true"  },
+    { "*opaque_off",    "false"  },
+    { "*ptrloc",        "false"  },
+    { "*dithermap",     "false"  },
+    { "*svgexport",     "false"  },
+    { "*help",          "false"  },
+    { "*font",          "-adobe-helvetica-medium-r-normal--14-140-75-75-p-77-iso8859-1"  },
+    { nil }
+};
+
+static OptionDesc options[] = {
+    { nil }
+};
+
+static const char* usage =
+"Usage: ivbench [-n size] [-repeat n] [-only name[,name...]] [-o file]\n\
+       [-baseline file] [-dir tmpdir] [-display display] [-visual class]\n\
+       [-list]";
+
+/*****************************************************************************/
+
+/*
+ * Each benchmark case is set up once, run once untimed, then timed over
+ * a number of runs.  Its work grows linearly with -n (the number of
+ * graphics in a synthetic drawing, and a proportional number of script
+ * iterations, text bytes and pixels), so results taken at one size can
+ * be compared across builds.  Cases that work on drawings get a Unidraw,
+ * built with -nodisplay unless a selected case needs a display for
+ * windows or rasters; those cases are skipped when there is none.
+ */
+
+enum { BENCH_PLAIN, BENCH_UNIDRAW, BENCH_DISPLAY };
+
+struct BenchCase {
+    const char* name;
+    int needs;                  // BENCH_UNIDRAW or BENCH_DISPLAY, if either
+    int factor;                 // items per unit of -n
+    void (*setup)(int items);
+    void (*run)(int items);
+    void (*cleanup)();
+};
+
+static OverlayUnidraw* bench_unidraw = nil;
+static boolean bench_display = false;
+static ComTerpServ* bench_comterp = nil;
+static const char* bench_dir = "/tmp";
+static char bench_path[BUFSIZ];
+
+static unsigned long bench_seed = 1;
+
+static int bench_random (int range) {
+    bench_seed = bench_seed * 1103515245 + 12345;
+    return (int) ((bench_seed >> 8) % (unsigned long) range);
+}
+
+static const char* bench_file (const char* suffix) {
+    sprintf(bench_path, "%s/ivbench%d%s", bench_dir, (int) getpid(), suffix);
+    return bench_path;
+}
+
+static void bench_sync () {
+    Session* session = Session::instance();
+    session->default_display()->sync();
+    Event e;
+
+    while (session->pending()) {
+        session->read(e);
+        e.handle();
+    }
+    bench_unidraw->Update(true);
+    session->default_display()->sync();
+}
+
+/*****************************************************************************/
+
+/*
+ * ComTerp scripts.  Every script is one expression (sequenced with ';')
+ * run through ComTerpServ::run.
+ */
+
+static char bench_script[BUFSIZ];
+
+static void comterp_run (const char* fmt, int items) {
+    if (bench_comterp == nil) {
+        bench_comterp = new ComTerpServ(BUFSIZ);
+        bench_comterp->add_defaults();
+    }
+    sprintf(bench_script, fmt, items);
+    bench_comterp->run(bench_script);
+}
+
+static void comterp_arith (int n) {
+    comterp_run("x=0;for(i=0 i<%d i++ x=x+i*2-1);x", n);
+}
+
+static void comterp_list_setup (int n) {
+    comterp_run("l=list(1..%d)", n);
+}
+
+static void comterp_list (int n) {
+    comterp_run("s=0;for(i=0 i<%d i++ s=s+at(l i));s", n);
+}
+
+static void comterp_stream (int n) {
+    comterp_run("sum(list(1..%d))", n);
+}
+
+static void comterp_vector_setup (int n) {
+    comterp_run("v=vector(list(1..%d) :double)", n);
+}
+
+static void comterp_vector (int) {
+    comterp_run("sum(v*v+v)", 0);
+}
+
+/* pmap over one processor each, and over as many as there are online */
+
+static void comterp_pmap (int) {
+    comterp_run("sum(pmap(l x*x+1))", 0);
+}
+
+static void comterp_pmap_jobs (int jobs) {
+    comterp_run("sum(pmap(l x*x+1 :jobs %d))", jobs);
+}
+
+static void comterp_pmap1 (int) { comterp_pmap_jobs(1); }
+static void comterp_pmap2 (int) { comterp_pmap_jobs(2); }
+static void comterp_pmap4 (int) { comterp_pmap_jobs(4); }
+static void comterp_pmap8 (int) { comterp_pmap_jobs(8); }
+
+static void comterp_cleanup () {
+    comterp_run("l=nil;v=nil", 0);
+}
+
+/*
+ * Scanning a generated list of 'n' point coordinates, parsed where it
+ * lies, and running a script file of 'n' lines, mapped into memory.
+ */
+
+static char* bench_points = nil;
+
+static void comterp_scan_setup (int n) {
+    delete [] bench_points;
+    bench_points = new char[n * 6 + 64];
+    char* p = bench_points + sprintf(bench_points, "pts=list(");
+    for (int i = 0; i < n; i++) {
+        p += sprintf(p, i ? ",%d" : "%d", bench_random(10000));
+    }
+    strcpy(p, ")");
+
+    FILE* fptr = fopen(bench_file(".comterp"), "w");
+    for (int i = 0; i < n; i++) {
+        fprintf(fptr, "x=%d\n", bench_random(10000));
+    }
+    fclose(fptr);
+    if (bench_comterp == nil) {
+        bench_comterp = new ComTerpServ(BUFSIZ);
+        bench_comterp->add_defaults();
+    }
+}
+
+static void comterp_scan (int) {
+    int ntokens;
+    delete [] bench_comterp->gen_code(bench_points, ntokens);
+}
+
+static void comterp_runfile (int) {
+    bench_comterp->runfile(bench_file(".comterp"));
+    bench_comterp->pop_stack();
+}
+
+static void comterp_scan_cleanup () {
+    unlink(bench_file(".comterp"));
+    delete [] bench_points;
+    bench_points = nil;
+}
+
+/*****************************************************************************/
+
+/*
+ * Regexp searches over text that has the searched-for match only at its
+ * very end, and TextBuffer edits scattered over many lines.
+ */
+
+static char* bench_text = nil;
+static int bench_textlen = 0;
+
+static void text_setup (int n) {
+    static const char* words[] = {
+        "alpha", "beta", "gamma", "delta", "epsilon", "lambda", "omega",
+        "unidraw", "graphic", "component", "1994", "2000", "42"
+    };
+    int nwords = sizeof(words) / sizeof(words[0]);
+    int size = n + n / 4 + 64;
+    delete [] bench_text;
+    bench_text = new char[size];
+    bench_textlen = 0;
+
+    while (bench_textlen < n) {
+        const char* w = words[bench_random(nwords)];
+        int len = strlen(w);
+        memcpy(bench_text + bench_textlen, w, len);
+        bench_textlen += len;
+        bench_text[bench_textlen++] = bench_random(8) == 0 ? '\n' : ' ';
+    }
+    strcpy(bench_text + bench_textlen, "123x zyzzyva\n");
+    bench_textlen += strlen(bench_text + bench_textlen);
+}
+
+static void text_cleanup () {
+    delete [] bench_text;
+    bench_text = nil;
+    bench_textlen = 0;
+}
+
+static void regexp_search (const char* pattern) {
+    Regexp re(pattern);
+    if (re.Search(bench_text, bench_textlen, 0, bench_textlen) < 0) {
+        cerr << "ivbench: no match for " << pattern << "\n";
+    }
+}
+
+static void regexp_literal (int) {
+    regexp_search("zyzzyva");
+}
+
+static void regexp_class (int) {
+    regexp_search("[0-9][0-9]*x");
+}
+
+static void textbuffer_edit (int n) {
+    int size = bench_textlen + 64;
+    char* buf = new char[size];
+    memcpy(buf, bench_text, bench_textlen);
+    TextBuffer* tb = new TextBuffer(buf, bench_textlen, size);
+    int edits = n / 64;
+
+    for (int i = 0; i < edits; ++i) {
+        int index = bench_random(tb->Length());
+        tb->Insert(index, "inserted\n", 9);
+        tb->LineIndex(tb->LineNumber(index) + 1);
+        tb->Delete(index, 9);
+    }
+    delete tb;
+    delete [] buf;
+}
+
+/*****************************************************************************/
+
+/*
+ * Synthetic drawings: a mix of rectangles, ellipses, lines, polygons and
+ * text spread over an area that grows with the number of graphics, so the
+ * density (and the number of graphics under a point) stays about the same
+ * at any size.
+ */
+
+static OverlayIdrawComp* bench_drawing = nil;
+static OverlayEditor* bench_editor = nil;
+
+static OverlayIdrawComp* make_drawing (int n, boolean arrows = false) {
+    Catalog* catalog = bench_unidraw->GetCatalog();
+    PSBrush* brush = catalog->FindBrush(0xffff, 1);
+    PSPattern* patterns[2];
+    patterns[0] = catalog->FindNonePattern();
+    patterns[1] = catalog->FindGrayLevel(0.5);
+    PSColor* colors[4];
+    colors[0] = catalog->FindColor("Black");
+    colors[1] = catalog->FindColor("Red");
+    colors[2] = catalog->FindColor("Green");
+    colors[3] = catalog->FindColor("Blue");
+    PSFont* font = catalog->FindFont(
+        "-*-helvetica-medium-r-normal-*-12-*-*-*-*-*-*-*", "Helvetica", "12"
+    );
+    int extent = (int) sqrt((double) n) * 40 + 100;
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    FullGraphic gs;
+    bench_seed = 1;
+
+    for (int i = 0; i < n; ++i) {
+        Coord x = bench_random(extent), y = bench_random(extent);
+        Coord w = 4 + bench_random(60), h = 4 + bench_random(60);
+        gs.SetBrush(brush);
+        gs.SetColors(colors[i % 4], colors[(i + 1) % 4]);
+        gs.SetPattern(patterns[i % 2]);
+        gs.FillBg(i % 2);
+        gs.SetFont(font);
+        OverlayComp* comp;
+
+        switch (i % 5) {
+        case 0:
+            comp = new RectOvComp(new SF_Rect(x, y, x + w, y + h, &gs));
+            break;
+        case 1:
+            comp = new EllipseOvComp(new SF_Ellipse(x, y, w/2, h/2, &gs));
+            break;
+        case 2:
+            if (arrows) {
+                comp = new ArrowLineOvComp(
+                    new ArrowLine(x, y, x + w, y + h, false, false, 1., &gs)
+                );
+            } else {
+                comp = new LineOvComp(new Line(x, y, x + w, y + h, &gs));
+            }
+            break;
+        case 3: {
+            Coord px[3], py[3];
+            px[0] = x; px[1] = x + w; px[2] = x + w/2;
+            py[0] = y; py[1] = y; py[2] = y + h;
+            comp = new PolygonOvComp(new SF_Polygon(px, py, 3, &gs));
+            break;
+        }
+        default: {
+            TextGraphic* text = new TextGraphic(
+                "ivbench", font == nil ? 12 : font->GetLineHt(), &gs
+            );
+            text->SetTransformer(new Transformer);
+            text->Translate(x, y);
+            comp = new TextOvComp(text);
+            break;
+        }
+        }
+        drawing->Append(comp);
+    }
+    return drawing;
+}
+
+static void drawing_setup (int n) {
+    bench_drawing = make_drawing(n);
+}
+
+static void drawing_cleanup () {
+    delete bench_drawing;
+    bench_drawing = nil;
+}
+
+static void catalog_save (int) {
+    Catalog* catalog = bench_unidraw->GetCatalog();
+    catalog->Save(bench_drawing, bench_file(".drawtool"));
+    catalog->Forget(bench_drawing);
+}
+
+static void catalog_load_setup (int n) {
+    drawing_setup(n);
+    catalog_save(n);
+    drawing_cleanup();
+}
+
+static void catalog_load (int) {
+    Catalog* catalog = bench_unidraw->GetCatalog();
+    Component* comp = nil;
+
+    if (catalog->Retrieve(bench_file(".drawtool"), comp)) {
+        catalog->Forget(comp);
+    }
+    delete comp;
+}
+
+static void binary_save (int) {
+    OverlayBinary::Write(bench_drawing, bench_file(".dtb"));
+}
+
+static void binary_load_setup (int n) {
+    drawing_setup(n);
+    binary_save(n);
+    drawing_cleanup();
+}
+
+static void binary_load (int) {
+    OverlayBinary binary;
+
+    if (binary.Open(bench_file(".dtb"))) {
+        delete binary.ReadDrawing();
+    }
+}
+
+/*
+ * A large drawing for loading serially, made mostly of the long point
+ * lists and multi-line text bodies that make up most of the bytes of
+ * real drawings.
+ */
+
+static OverlayIdrawComp* make_large_drawing (int n) {
+    static const int npoints = 100;
+    static const char* lines =
+        "ivbench large drawing text, line one of four\n"
+        "ivbench large drawing text, line two of four\n"
+        "ivbench large drawing text, line three of four\n"
+        "ivbench large drawing text, line four of four";
+    Catalog* catalog = bench_unidraw->GetCatalog();
+    PSFont* font = catalog->FindFont(
+        "-*-helvetica-medium-r-normal-*-12-*-*-*-*-*-*-*", "Helvetica", "12"
+    );
+    int extent = (int) sqrt((double) n) * 40 + 100;
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    FullGraphic gs;
+    gs.SetBrush(catalog->FindBrush(0xffff, 1));
+    gs.SetColors(catalog->FindColor("Black"), catalog->FindColor("White"));
+    gs.SetPattern(catalog->FindNonePattern());
+    gs.SetFont(font);
+    Coord px[npoints], py[npoints];
+    bench_seed = 1;
+
+    for (int i = 0; i < n; ++i) {
+        Coord x = bench_random(extent), y = bench_random(extent);
+
+        if (i % 4 == 3) {
+            TextGraphic* text = new TextGraphic(
+                lines, font == nil ? 12 : font->GetLineHt(), &gs
+            );
+            text->SetTransformer(new Transformer);
+            text->Translate(x, y);
+            drawing->Append(new TextOvComp(text));
+
+        } else {
+            for (int j = 0; j < npoints; ++j) {
+                x += bench_random(9) - 4;
+                y += bench_random(9) - 4;
+                px[j] = x;
+                py[j] = y;
+            }
+            drawing->Append(
+                new MultiLineOvComp(new SF_MultiLine(px, py, npoints, &gs))
+            );
+        }
+    }
+    return drawing;
+}
+
+static void catalog_large_setup (int n) {
+    bench_drawing = make_large_drawing(n);
+    catalog_save(n);
+    drawing_cleanup();
+}
+
+/*
+ * idraw PostScript written from the synthetic drawing and read back the
+ * way drawtool -convert reads legacy drawings.  Its lines are arrow
+ * lines, the only kind idraw writes.
+ */
+
+static void idraw_load_setup (int n) {
+    bench_drawing = make_drawing(n, true);
+    OverlayPS* ps = (OverlayPS*) bench_drawing->Create(POSTSCRIPT_VIEW);
+    bench_drawing->Attach(ps);
+    ps->Update();
+    std::ofstream out(bench_file(".ps"));
+    ps->Emit(out);
+    out.close();
+    bench_drawing->Detach(ps);
+    delete ps;
+    drawing_cleanup();
+}
+
+static void idraw_load (int) {
+    OverlayCatalog* catalog = (OverlayCatalog*) bench_unidraw->GetCatalog();
+    Component* comp = nil;
+
+    if (catalog->IdrawCatalog::Retrieve(bench_file(".ps"), comp)) {
+        catalog->Forget(comp);
+    }
+    delete comp;
+}
+
+static void load_cleanup () {
+    unlink(bench_file(".drawtool"));
+    unlink(bench_file(".dtb"));
+    unlink(bench_file(".ps"));
+}
+
+static void picture_pick (int n) {
+    Graphic* picture = bench_drawing->GetGraphic();
+    Coord l, b, r, t;
+    picture->GetBox(l, b, r, t);
+    int side = (int) sqrt((double) n) + 1;
+
+    for (int i = 0; i < side; ++i) {
+        for (int j = 0; j < side; ++j) {
+            PointObj p(l + (r - l) * i / side, b + (t - b) * j / side);
+            picture->LastGraphicContaining(p);
+        }
+    }
+}
+
+static void render_software (int) {
+    OverlayRenderer renderer(512, 512);
+    renderer.Render(bench_drawing->GetGraphic());
+}
+
+/*
+ * Damage repair and view updates without an editor: BenchDamage repairs
+ * each damaged area by finding the graphics it touches, as
+ * Picture::drawClipped does before drawing them, and GVUpdater brings a
+ * view of the drawing with no viewer up to date.
+ */
+
+class BenchDamage : public Damage {
+public:
+    BenchDamage(Graphic* g) : Damage(nil, nil, g) { _touched = 0; }
+protected:
+    virtual void DrawAreas();
+    virtual void DrawAdditions() { }
+
+    int _touched;
+};
+
+void BenchDamage::DrawAreas () {
+    Iterator i, j;
+
+    for (FirstArea(i); !Done(i); Next(i)) {
+        BoxObj* area = GetArea(i);
+
+        for (_graphic->First(j); !_graphic->Done(j); _graphic->Next(j)) {
+            BoxObj box;
+            _graphic->GetGraphic(j)->GetBox(box);
+
+            if (area->Intersects(box)) {
+                ++_touched;
+            }
+        }
+    }
+}
+
+static BenchDamage* bench_damage = nil;
+static GraphicView* bench_view = nil;
+
+static void damage_setup (int n) {
+    drawing_setup(n);
+    bench_damage = new BenchDamage(bench_drawing->GetGraphic());
+}
+
+static void damage_cleanup () {
+    delete bench_damage;
+    bench_damage = nil;
+    drawing_cleanup();
+}
+
+static void damage_repair (int n) {
+    Coord l, b, r, t;
+    bench_drawing->GetGraphic()->GetBox(l, b, r, t);
+    int areas = n / 10 + 1;
+
+    for (int i = 0; i < areas; ++i) {
+        Coord x = l + bench_random(r - l + 1), y = b + bench_random(t - b + 1);
+        bench_damage->Incur(x, y, x + bench_random(64), y + bench_random(64));
+    }
+    bench_damage->Repair();
+}
+
+static void view_setup (int n) {
+    drawing_setup(n);
+    bench_view = (GraphicView*) bench_drawing->Create(COMPONENT_VIEW);
+    bench_drawing->Attach(bench_view);
+    bench_view->Update();
+}
+
+static void view_cleanup () {
+    bench_drawing->Detach(bench_view);
+    delete bench_view;
+    bench_view = nil;
+    drawing_cleanup();
+}
+
+static void translate_drawing (GraphicComp* drawing) {
+    Iterator i;
+
+    for (drawing->First(i); !drawing->Done(i); drawing->Next(i)) {
+        drawing->GetComp(i)->GetGraphic()->Translate(1, 0);
+    }
+}
+
+static void gvupdater_update (int) {
+    translate_drawing(bench_drawing);
+    GVUpdater updater(bench_view);
+    updater.Update();
+}
+
+/*
+ * The same in an editor on the screen, where repairs and updates draw.
+ * draw.rotated redraws a window full of labels at assorted angles, which
+ * the canvas draws from its cache of transformed glyph bitmaps.
+ */
+
+static void editor_setup (int n) {
+    bench_editor = new OverlayEditor(make_drawing(n));
+    bench_unidraw->Open(bench_editor);
+    bench_sync();
+}
+
+static void editor_cleanup () {
+    bench_unidraw->Close(bench_editor);
+    bench_editor = nil;
+    bench_sync();
+}
+
+static void damage_draw (int n) {
+    Damage* damage = bench_editor->GetViewer()->GetDamage();
+    int areas = n / 10 + 1;
+
+    for (int i = 0; i < areas; ++i) {
+        Coord x = bench_random(512), y = bench_random(512);
+        damage->Incur(x, y, x + bench_random(64), y + bench_random(64));
+    }
+    damage->Repair();
+    bench_sync();
+}
+
+static void gvupdater_draw (int) {
+    GraphicView* view = bench_editor->GetViewer()->GetGraphicView();
+    translate_drawing((GraphicComp*) view->GetGraphicComp());
+    GVUpdater updater(view);
+    updater.Update();
+    bench_sync();
+}
+
+static void rotated_setup (int n) {
+    Catalog* catalog = bench_unidraw->GetCatalog();
+    PSFont* font = catalog->FindFont(
+        "-*-helvetica-medium-r-normal-*-12-*-*-*-*-*-*-*", "Helvetica", "12"
+    );
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    FullGraphic gs;
+    gs.SetColors(catalog->FindColor("Black"), catalog->FindColor("White"));
+    gs.SetFont(font);
+
+    for (int i = 0; i < n; ++i) {
+        TextGraphic* text = new TextGraphic(
+            "label", font == nil ? 12 : font->GetLineHt(), &gs
+        );
+        text->SetTransformer(new Transformer);
+        text->Rotate(float(i % 24) * 15);
+        text->Translate(16 + bench_random(480), 16 + bench_random(480));
+        drawing->Append(new TextOvComp(text));
+    }
+    bench_editor = new OverlayEditor(drawing);
+    bench_unidraw->Open(bench_editor);
+    bench_sync();
+}
+
+static void rotated_draw (int) {
+    Damage* damage = bench_editor->GetViewer()->GetDamage();
+    damage->Incur(0, 0, 511, 511);
+    damage->Repair();
+    bench_sync();
+}
+
+/*
+ * Flipbook frames: a drawing of 'n' frames of one graphic each, whose
+ * view is asked for frames at random, as stepping through or playing a
+ * flipbook does.
+ */
+
+static FrameIdrawComp* bench_frames = nil;
+static FramesView* bench_framesview = nil;
+
+static void frames_setup (int n) {
+    Catalog* catalog = bench_unidraw->GetCatalog();
+    FullGraphic gs;
+    gs.SetBrush(catalog->FindBrush(0xffff, 1));
+    gs.SetColors(catalog->FindColor("Black"), catalog->FindColor("White"));
+    gs.SetPattern(catalog->FindNonePattern());
+    bench_frames = new FrameIdrawComp;
+
+    for (int i = 0; i < n; ++i) {
+        FrameComp* frame = new FrameComp;
+        Coord x = bench_random(512), y = bench_random(512);
+        frame->Append(new RectOvComp(new SF_Rect(x, y, x + 16, y + 16, &gs)));
+        bench_frames->Append(frame);
+    }
+    bench_framesview = (FramesView*) bench_frames->Create(COMPONENT_VIEW);
+    bench_frames->Attach(bench_framesview);
+    bench_framesview->Update();
+}
+
+static void frames_index (int n) {
+    int nframes = bench_framesview->NumSubViews();
+
+    for (int i = 0; i < n; ++i) {
+        FrameView* frame = bench_framesview->GetFrame(bench_random(nframes));
+        bench_framesview->FrameIndex(frame);
+    }
+}
+
+static void frames_cleanup () {
+    bench_frames->Detach(bench_framesview);
+    delete bench_framesview;
+    bench_framesview = nil;
+    delete bench_frames;
+    bench_frames = nil;
+}
+
+/*
+ * Undo history: 'n' moves logged by an editor with no window, sixteen in
+ * a row on each graphic, so each run coalesces into one history entry per
+ * graphic and the history stays within its length and memory limits.
+ */
+
+class BenchEditor : public Editor {
+public:
+    BenchEditor(Component* comp) { _comp = comp; }
+
+    virtual Component* GetComponent() { return _comp; }
+    virtual void SetComponent(Component* comp) { _comp = comp; }
+    virtual Selection* GetSelection() { return &_selection; }
+protected:
+    Component* _comp;
+    Selection _selection;
+};
+
+static BenchEditor* bench_history = nil;
+
+static void history_setup (int n) {
+    drawing_setup(n);
+    bench_history = new BenchEditor(bench_drawing);
+    Resource::ref(bench_history);
+}
+
+static void history_log (int n) {
+    Iterator i;
+    bench_drawing->First(i);
+
+    for (int j = 0; j < n; ++j) {
+        if (j > 0 && j % 16 == 0) {
+            bench_drawing->Next(i);
+
+            if (bench_drawing->Done(i)) {
+                bench_drawing->First(i);
+            }
+        }
+        MoveCmd* cmd = new MoveCmd(bench_history, 1, 0);
+        cmd->SetClipboard(new Clipboard(bench_drawing->GetComp(i)));
+        cmd->Execute();
+        cmd->Log();
+    }
+}
+
+static void history_cleanup () {
+    bench_unidraw->ClearHistory(bench_drawing);
+    Resource::unref(bench_history);
+    bench_history = nil;
+    drawing_cleanup();
+}
+
+/*****************************************************************************/
+
+/*
+ * Rasters: a synthetic RGB image written as a PPM file and read back,
+ * flushed to the display, and run through the image filters.
+ */
+
+static OverlayRaster* bench_raster = nil;
+
+static void raster_write (int n) {
+    int side = (int) sqrt((double) n);
+    FILE* fptr = fopen(bench_file(".ppm"), "w");
+    if (fptr == nil) return;
+    fprintf(fptr, "P6\n%d %d\n255\n", side, side);
+
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            putc(x & 0xff, fptr);
+            putc(y & 0xff, fptr);
+            putc((x ^ y) & 0xff, fptr);
+        }
+    }
+    fclose(fptr);
+}
+
+static void raster_import (int) {
+    OverlayRaster* raster = OvImportCmd::PPM_Raster(bench_file(".ppm"));
+    Resource::ref(raster);
+    Resource::unref(raster);
+}
+
+static void raster_setup (int n) {
+    raster_write(n);
+    bench_raster = OvImportCmd::PPM_Raster(bench_file(".ppm"));
+    Resource::ref(bench_raster);
+}
+
+static void raster_cleanup () {
+    Resource::unref(bench_raster);
+    bench_raster = nil;
+    unlink(bench_file(".ppm"));
+}
+
+/*
+ * raster.poke and raster.pokerow fill the raster with the same pixels one
+ * at a time and a row at a time; comparing runs made with different
+ * -visual classes shows the cost of the visual's pixel conversion.
+ */
+
+static void raster_poke (int) {
+    unsigned long w = bench_raster->pwidth(), h = bench_raster->pheight();
+    for (unsigned long y = 0; y < h; ++y) {
+        for (unsigned long x = 0; x < w; ++x) {
+            bench_raster->poke(
+                x, y, float(x & 0xff)/0xff, float(y & 0xff)/0xff,
+                float((x ^ y) & 0xff)/0xff, 1.0
+            );
+        }
+    }
+}
+
+static void raster_pokerow (int) {
+    unsigned long w = bench_raster->pwidth(), h = bench_raster->pheight();
+    unsigned char* row = new unsigned char[w * 3];
+    for (unsigned long y = 0; y < h; ++y) {
+        for (unsigned long x = 0; x < w; ++x) {
+            row[3*x] = x & 0xff;
+            row[3*x + 1] = y & 0xff;
+            row[3*x + 2] = (x ^ y) & 0xff;
+        }
+        bench_raster->pokerow(0, y, w, row);
+    }
+    delete [] row;
+}
+
+static void raster_flush (int) {
+    bench_raster->flush();
+    Session::instance()->default_display()->sync();
+}
+
+static void filter_gaussian (int) {
+    GrayRaster* raster = OverlayFilter::Gaussian(bench_raster, 2.0);
+    Resource::ref(raster);
+    Resource::unref(raster);
+}
+
+static void filter_median (int) {
+    GrayRaster* raster = OverlayFilter::Median(bench_raster, 2);
+    Resource::ref(raster);
+    Resource::unref(raster);
+}
+
+/*
+ * TIFF: a synthetic 16-bit gray image written LZW compressed, once in
+ * strips and once in tiles, decoded by OverlayTIFF with its threads or
+ * serially, and (for comparison) strip by strip by libtiff into the same
+ * size of buffer.  tiff.load goes on to make the raster.
+ */
+
+#if defined(TIFFLIB_VERSION)
+typedef unsigned int bench_tifflong;
+#else
+typedef unsigned long bench_tifflong;
+#endif
+
+static boolean tiff_tiled = false;
+
+static void tiff_write (int n) {
+    int side = ((int) sqrt((double) n) + 15) & ~15;
+    TIFF* tif = TIFFOpen((char*) bench_file(".tif"), (char*) "w");
+    if (tif == nil) return;
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, (bench_tifflong) side);
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, (bench_tifflong) side);
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 16);
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 1);
+    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+
+    int chunk = tiff_tiled ? 64 : 16;
+    int chunkwidth = tiff_tiled ? chunk : side;
+    unsigned short* buf = new unsigned short[chunkwidth * chunk];
+    unsigned int bytes = chunkwidth * chunk * sizeof(unsigned short);
+    int across = tiff_tiled ? (side + chunk - 1) / chunk : 1;
+    int down = (side + chunk - 1) / chunk;
+    if (tiff_tiled) {
+        TIFFSetField(tif, TIFFTAG_TILEWIDTH, (bench_tifflong) chunk);
+        TIFFSetField(tif, TIFFTAG_TILELENGTH, (bench_tifflong) chunk);
+    } else {
+        TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, (bench_tifflong) chunk);
+    }
+
+    for (int cy = 0; cy < down; ++cy) {
+        for (int cx = 0; cx < across; ++cx) {
+            for (int y = 0; y < chunk; ++y) {
+                for (int x = 0; x < chunkwidth; ++x) {
+                    int px = cx * chunkwidth + x, py = cy * chunk + y;
+                    buf[y * chunkwidth + x] = (unsigned short)
+                        (((px * 37 + py * 11) & 0xfff0) | bench_random(16));
+                }
+            }
+            if (tiff_tiled) {
+                TIFFWriteEncodedTile(
+                    tif, cy * across + cx, (unsigned char*) buf, bytes
+                );
+            } else {
+                TIFFWriteEncodedStrip(tif, cy, (unsigned char*) buf, bytes);
+            }
+        }
+    }
+    delete [] buf;
+    TIFFClose(tif);
+}
+
+static void tiff_strips_setup (int n) {
+    tiff_tiled = false;
+    tiff_write(n);
+}
+
+static void tiff_tiles_setup (int n) {
+    tiff_tiled = true;
+    tiff_write(n);
+}
+
+static void tiff_serial_setup (int n) {
+    OverlayTIFF::Jobs(1);
+    tiff_strips_setup(n);
+}
+
+static void tiff_decode (int) {
+    OverlayTIFF tiff(bench_file(".tif"));
+    tiff.Decode();
+}
+
+static void tiff_libtiff (int) {
+    TIFF* tif = TIFFOpen((char*) bench_file(".tif"), (char*) "r");
+    if (tif == nil) return;
+    bench_tifflong width = 0, height = 0;
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+    unsigned long stripsize = TIFFStripSize(tif);
+    unsigned char* data = new unsigned char[width * height * sizeof(unsigned short)];
+    unsigned char* op = data;
+    int nstrips = TIFFNumberOfStrips(tif);
+    for (int i = 0; i < nstrips; ++i) {
+        op += TIFFReadEncodedStrip(tif, i, op, stripsize);
+    }
+    delete [] data;
+    TIFFClose(tif);
+}
+
+static void tiff_load (int) {
+    OverlayRaster* raster = OverlayTIFF::Load(bench_file(".tif"));
+    Resource::ref(raster);
+    Resource::unref(raster);
+}
+
+static void tiff_cleanup () {
+    OverlayTIFF::Jobs(0);
+    unlink(bench_file(".tif"));
+}
+
+static void nothing (int) { }
+static void nothing () { }
+
+/*****************************************************************************/
+
+static BenchCase cases[] = {
+    { "comterp.arith", BENCH_PLAIN, 10,
+      &nothing, &comterp_arith, &nothing },
+    { "comterp.list", BENCH_PLAIN, 10,
+      &comterp_list_setup, &comterp_list, &comterp_cleanup },
+    { "comterp.stream", BENCH_PLAIN, 100,
+      &nothing, &comterp_stream, &nothing },
+    { "comterp.vector", BENCH_PLAIN, 1000,
+      &comterp_vector_setup, &comterp_vector, &comterp_cleanup },
+    { "comterp.pmap", BENCH_PLAIN, 10,
+      &comterp_list_setup, &comterp_pmap, &comterp_cleanup },
+    { "comterp.pmap.1", BENCH_PLAIN, 10,
+      &comterp_list_setup, &comterp_pmap1, &comterp_cleanup },
+    { "comterp.pmap.2", BENCH_PLAIN, 10,
+      &comterp_list_setup, &comterp_pmap2, &comterp_cleanup },
+    { "comterp.pmap.4", BENCH_PLAIN, 10,
+      &comterp_list_setup, &comterp_pmap4, &comterp_cleanup },
+    { "comterp.pmap.8", BENCH_PLAIN, 10,
+      &comterp_list_setup, &comterp_pmap8, &comterp_cleanup },
+    { "comterp.scan", BENCH_PLAIN, 1000,
+      &comterp_scan_setup, &comterp_scan, &comterp_scan_cleanup },
+    { "comterp.runfile", BENCH_PLAIN, 100,
+      &comterp_scan_setup, &comterp_runfile, &comterp_scan_cleanup },
+    { "regexp.literal", BENCH_PLAIN, 10000,
+      &text_setup, &regexp_literal, &text_cleanup },
+    { "regexp.class", BENCH_PLAIN, 1000,
+      &text_setup, &regexp_class, &text_cleanup },
+    { "textbuffer.edit", BENCH_PLAIN, 1000,
+      &text_setup, &textbuffer_edit, &text_cleanup },
+    { "catalog.save", BENCH_UNIDRAW, 1,
+      &drawing_setup, &catalog_save, &drawing_cleanup },
+    { "catalog.load", BENCH_UNIDRAW, 1,
+      &catalog_load_setup, &catalog_load, &load_cleanup },
+    { "binary.save", BENCH_UNIDRAW, 1,
+      &drawing_setup, &binary_save, &drawing_cleanup },
+    { "binary.load", BENCH_UNIDRAW, 1,
+      &binary_load_setup, &binary_load, &load_cleanup },
+    { "picture.pick", BENCH_UNIDRAW, 1,
+      &drawing_setup, &picture_pick, &drawing_cleanup },
+    { "render.software", BENCH_UNIDRAW, 1,
+      &drawing_setup, &render_software, &drawing_cleanup },
+    { "catalog.load.large", BENCH_UNIDRAW, 1,
+      &catalog_large_setup, &catalog_load, &load_cleanup },
+    { "idraw.load", BENCH_UNIDRAW, 1,
+      &idraw_load_setup, &idraw_load, &load_cleanup },
+    { "damage.repair", BENCH_UNIDRAW, 1,
+      &damage_setup, &damage_repair, &damage_cleanup },
+    { "gvupdater.update", BENCH_UNIDRAW, 1,
+      &view_setup, &gvupdater_update, &view_cleanup },
+    { "frames.index", BENCH_UNIDRAW, 1,
+      &frames_setup, &frames_index, &frames_cleanup },
+    { "history.log", BENCH_UNIDRAW, 10,
+      &history_setup, &history_log, &history_cleanup },
+    { "damage.draw", BENCH_DISPLAY, 1,
+      &editor_setup, &damage_draw, &editor_cleanup },
+    { "gvupdater.draw", BENCH_DISPLAY, 1,
+      &editor_setup, &gvupdater_draw, &editor_cleanup },
+    { "draw.rotated", BENCH_DISPLAY, 10,
+      &rotated_setup, &rotated_draw, &editor_cleanup },
+    { "raster.import", BENCH_DISPLAY, 256,
+      &raster_write, &raster_import, &raster_cleanup },
+    { "raster.poke", BENCH_DISPLAY, 256,
+      &raster_setup, &raster_poke, &raster_cleanup },
+    { "raster.pokerow", BENCH_DISPLAY, 256,
+      &raster_setup, &raster_pokerow, &raster_cleanup },
+    { "raster.flush", BENCH_DISPLAY, 256,
+      &raster_setup, &raster_flush, &raster_cleanup },
+    { "filter.gaussian", BENCH_DISPLAY, 256,
+      &raster_setup, &filter_gaussian, &raster_cleanup },
+    { "filter.median", BENCH_DISPLAY, 256,
+      &raster_setup, &filter_median, &raster_cleanup },
+    { "box.scroll", BENCH_DISPLAY, 100,
+      &box_setup, &box_scroll, &box_cleanup },
+    { "box.edit", BENCH_DISPLAY, 100,
+      &box_setup, &box_edit, &box_cleanup },
+    { "box.corners", BENCH_DISPLAY, 100,
+      &box_setup, &box_corners, &box_cleanup },
+    { "text.layout", BENCH_DISPLAY, 1000,
+      &nothing, &text_layout, &nothing },
+#if defined(HAVE_ACE)
+    { "comterp.tcp.serial", BENCH_PLAIN, 10,
+      &com_tcp_setup, &com_serial, &com_cleanup },
+    { "comterp.shm.serial", BENCH_PLAIN, 10,
+      &com_shm_setup, &com_serial, &com_cleanup },
+    { "comterp.tcp.pipeline", BENCH_PLAIN, 10,
+      &com_tcp_setup, &com_pipeline, &com_cleanup },
+    { "comterp.shm.pipeline", BENCH_PLAIN, 10,
+      &com_shm_setup, &com_pipeline, &com_cleanup },
+#endif
+#if defined(IVBENCH_RPC)
+    { "rpc.serial", BENCH_PLAIN, 100,
+      &rpc_setup, &rpc_serial, &rpc_cleanup },
+    { "rpc.pipeline", BENCH_PLAIN, 100,
+      &rpc_setup, &rpc_pipeline, &rpc_cleanup },
+    { "rpc.bulk", BENCH_PLAIN, 10,
+      &rpc_setup, &rpc_bulk_pipeline, &rpc_cleanup },
+#endif
+    { "tiff.strips", BENCH_PLAIN, 1024,
+      &tiff_strips_setup, &tiff_decode, &tiff_cleanup },
+    { "tiff.tiles", BENCH_PLAIN, 1024,
+      &tiff_tiles_setup, &tiff_decode, &tiff_cleanup },
+    { "tiff.serial", BENCH_PLAIN, 1024,
+      &tiff_serial_setup, &tiff_decode, &tiff_cleanup },
+    { "tiff.libtiff", BENCH_PLAIN, 1024,
+      &tiff_strips_setup, &tiff_libtiff, &tiff_cleanup },
+    { "tiff.load", BENCH_DISPLAY, 1024,
+      &tiff_strips_setup, &tiff_load, &tiff_cleanup },
+    { nil }
+};
+
+/*****************************************************************************/
+
+static int compare_times (const void* a, const void* b) {
+    double ta = *(const double*) a, tb = *(const double*) b;
+    return ta < tb ? -1 : ta > tb ? 1 : 0;
+}
+
+static boolean selected (const char* name, const char* only) {
+    if (only == nil) {
+        return true;
+    }
+    const char* p = only;
+
+    while (*p != '\0') {
+        const char* comma = strchr(p, ',');
+        int len = comma == nil ? strlen(p) : comma - p;
+
+        if (len > 0 && strncmp(name, p, len) == 0) {
+            return true;
+        }
+        p += comma == nil ? len : len + 1;
+    }
+    return false;
+}
+
+/*
+ * baseline_median finds the median reported for 'name' in an earlier
+ * ivbench output, which has one result object per line.
+ */
+
+static double baseline_median (const char* baseline, const char* name) {
+    if (baseline == nil) {
+        return 0.0;
+    }
+    char key[BUFSIZ];
+    sprintf(key, "\"name\": \"%s\"", name);
+    const char* line = strstr(baseline, key);
+    const char* eol = line == nil ? nil : strchr(line, '\n');
+    const char* median = line == nil ? nil : strstr(line, "\"median\": ");
+
+    if (median == nil || (eol != nil && median > eol)) {
+        return 0.0;
+    }
+    return atof(median + strlen("\"median\": "));
+}
+
+static char* read_file (const char* path) {
+    FILE* fptr = fopen(path, "r");
+    if (fptr == nil) {
+        return nil;
+    }
+    int size = BUFSIZ, len = 0, nread;
+    char* buf = (char*) malloc(size + 1);
+
+    while ((nread = fread(buf + len, 1, size - len, fptr)) > 0) {
+        len += nread;
+        if (len == size) {
+            size *= 2;
+            buf = (char*) realloc(buf, size + 1);
+        }
+    }
+    buf[len] = '\0';
+    fclose(fptr);
+    return buf;
+}
+
+int main (int argc, char** argv) {
+    int size = 1000;
+    int repeat = 5;
+    const char* only = nil;
+    const char* outpath = nil;
+    const char* basepath = nil;
+    const char* display = nil;
+    const char* visual = nil;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-only") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outpath = argv[++i];
+        } else if (strcmp(argv[i], "-baseline") == 0 && i + 1 < argc) {
+            basepath = argv[++i];
+        } else if (strcmp(argv[i], "-dir") == 0 && i + 1 < argc) {
+            bench_dir = argv[++i];
+        } else if (strcmp(argv[i], "-display") == 0 && i + 1 < argc) {
+            display = argv[++i];
+        } else if (strcmp(argv[i], "-visual") == 0 && i + 1 < argc) {
+            visual = argv[++i];
+        } else if (strcmp(argv[i], "-list") == 0) {
+            for (BenchCase* c = cases; c->name != nil; ++c) {
+                printf("%s\n", c->name);
+            }
+            return 0;
+        } else {
+            cerr << usage << "\n";
+            return 1;
+        }
+    }
+    size = size < 1 ? 1 : size;
+    repeat = repeat < 1 ? 1 : repeat;
+
+    char* baseline = nil;
+    if (basepath != nil && (baseline = read_file(basepath)) == nil) {
+        cerr << "ivbench: unable to read " << basepath << "\n";
+        return 1;
+    }
+    FILE* out = outpath == nil ? stdout : fopen(outpath, "w");
+    if (out == nil) {
+        cerr << "ivbench: unable to write " << outpath << "\n";
+        return 1;
+    }
+
+    int needs = BENCH_PLAIN;
+    for (BenchCase* c = cases; c->name != nil; ++c) {
+        if (c->needs > needs && selected(c->name, only)) {
+            needs = c->needs;
+        }
+    }
+    if (needs != BENCH_PLAIN) {
+        const char* env = getenv("DISPLAY");
+        int uargc = 1;
+        char* uargv[6];
+        uargv[0] = argv[0];
+
+        if (needs == BENCH_DISPLAY &&
+            (display != nil || (env != nil && *env != '\0'))
+        ) {
+            if (display != nil) {
+                uargv[uargc++] = (char*) "-display";
+                uargv[uargc++] = (char*) display;
+            }
+            if (visual != nil) {
+                uargv[uargc++] = (char*) "-visual";
+                uargv[uargc++] = (char*) visual;
+            }
+        } else {
+            uargv[uargc++] = (char*) "-nodisplay";
+        }
+        uargv[uargc] = nil;
+
+        FrameCreator* creator = new FrameCreator;
+        OverlayCatalog* catalog = new OverlayCatalog("ivbench", creator);
+        bench_unidraw = new OverlayUnidraw(
+            catalog, uargc, uargv, options, properties
+        );
+        bench_display = Session::instance()->default_display() != nil;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"program\": \"ivbench\",\n");
+    fprintf(out, "  \"version\": \"%s\",\n", VersionString);
+    fprintf(out, "  \"size\": %d,\n", size);
+    fprintf(out, "  \"repeat\": %d,\n", repeat);
+    fprintf(out, "  \"cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(out, "  \"display\": %s,\n", bench_display ? "true" : "false");
+    if (bench_display) {
+        static const char* classes[] = {
+            "StaticGray", "GrayScale", "StaticColor",
+            "PseudoColor", "TrueColor", "DirectColor"
+        };
+        WindowVisual* wv =
+            Session::instance()->default_display()->rep()->default_visual_;
+        int c = wv->visual()->c_class;
+        fprintf(
+            out, "  \"visual\": \"%s\",\n  \"depth\": %d,\n",
+            c >= 0 && c < 6 ? classes[c] : "unknown", wv->depth()
+        );
+    }
+    fprintf(out, "  \"results\": [");
+
+    double* times = new double[repeat];
+    boolean first = true;
+
+    for (BenchCase* c = cases; c->name != nil; ++c) {
+        if (!selected(c->name, only)) {
+            continue;
+        }
+        fprintf(out, first ? "\n" : ",\n");
+        first = false;
+
+        if (c->needs == BENCH_DISPLAY && !bench_display) {
+            fprintf(
+                out, "    {\"name\": \"%s\", \"skipped\": \"no display\"}",
+                c->name
+            );
+            continue;
+        }
+        int items = size * c->factor;
+        bench_seed = 1;
+        (*c->setup)(items);
+        (*c->run)(items);
+
+        for (int r = 0; r < repeat; ++r) {
+            double start = ComProfile::now();
+            (*c->run)(items);
+            times[r] = ComProfile::now() - start;
+        }
+        (*c->cleanup)();
+
+        double mean = 0.0;
+        for (int r = 0; r < repeat; ++r) {
+            mean += times[r];
+        }
+        mean /= repeat;
+        qsort(times, repeat, sizeof(double), &compare_times);
+        double median = (repeat % 2)
+            ? times[repeat/2] : (times[repeat/2 - 1] + times[repeat/2]) / 2;
+
+        fprintf(
+            out, "    {\"name\": \"%s\", \"items\": %d, \"min\": %.6g, "
+            "\"median\": %.6g, \"mean\": %.6g, \"max\": %.6g, "
+            "\"ns_per_item\": %.6g",
+            c->name, items, times[0], median, mean, times[repeat - 1],
+            median * 1e9 / items
+        );
+        double base = baseline_median(baseline, c->name);
+        if (base > 0.0) {
+            fprintf(
+                out, ", \"baseline\": %.6g, \"ratio\": %.4f",
+                base, median / base
+            );
+        }
+        fprintf(out, "}");
+        fflush(out);
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    delete [] times;
+    free(baseline);
+    if (out != stdout) {
+        fclose(out);
+    }
+    delete bench_comterp;
+    delete bench_unidraw;
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * ivbench cases for the Dispatch RPC classes: a child process echoes
+ * requests sent over a local socket, one at a time or pipelined, or
+ * adds up the bytes of bulk requests where they lie in its buffer.
+ * Compiled to nothing unless the RPC classes are built.
+ */
+
+#include "rpcbench.h"
+
+#if defined(IVBENCH_RPC)
+
+#include <Dispatch/dispatcher.h>
+#include <Dispatch/rpchdr.h>
+#include <Dispatch/rpcreader.h>
+#include <Dispatch/rpcreply.h>
+#include <Dispatch/rpcstream.h>
+#include <Dispatch/rpcwriter.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*****************************************************************************/
+
+static double rpc_now () {
+    struct timeval tv;
+    gettimeofday(&tv, nil);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static const int rpc_bulksize = 4096;
+
+static unsigned long rpc_sum (const char* data, int n) {
+    unsigned long sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += (unsigned char) data[i];
+    }
+    return sum;
+}
+
+class EchoReader : public RpcReader {
+public:
+    enum { ECHO, SUM, NFCNS };
+
+    EchoReader(int fd) : RpcReader(fd, NFCNS, false) {
+        _function[ECHO] = &EchoReader::echo;
+        _function[SUM] = &EchoReader::sum;
+        _done = false;
+    }
+    boolean done() { return _done; }
+protected:
+    static void echo(RpcReader*, RpcHdr& hdr, rpcstream& client) {
+        long value;
+        client >> value;
+        client << RpcHdr(nil, RpcHdr::reply, hdr.id()) << value << 0L;
+    }
+    static void sum(RpcReader*, RpcHdr& hdr, rpcstream& client) {
+        long value;
+        memcpy(&value, hdr.data(), sizeof(value));
+        unsigned long sum = rpc_sum(
+            hdr.data() + sizeof(value), hdr.ndata() - sizeof(value)
+        );
+        client << RpcHdr(nil, RpcHdr::reply, hdr.id()) << value << sum;
+    }
+    virtual void connectionClosed(int) { _done = true; }
+
+    boolean _done;
+};
+
+class EchoWriter : public RpcWriter {
+public:
+    EchoWriter(int fd) : RpcWriter(fd, false, false) {}
+
+    unsigned long echo(long value, RpcReply* reply) {
+        unsigned long id = server().expect(reply);
+        server() << RpcHdr(this, EchoReader::ECHO, id) << value;
+        return id;
+    }
+    unsigned long sum(long value, const char* data, int n, RpcReply* reply) {
+        unsigned long id = server().expect(reply);
+        server() << RpcHdr(this, EchoReader::SUM, id);
+        server().write((const char*) &value, sizeof(value));
+        server().write(data, n);
+        return id;
+    }
+};
+
+class EchoReplies : public RpcReader, public RpcReply {
+public:
+    EchoReplies(rpcstream* server) : RpcReader(server, 0) {}
+
+    virtual void reply(RpcHdr&, rpcstream&);
+protected:
+    virtual void connectionClosed(int) {}
+};
+
+static pid_t rpc_server = -1;
+static int rpc_fd = -1;
+static EchoWriter* rpc_writer = nil;
+static EchoReplies* rpc_replies = nil;
+static double* rpc_sent = nil;
+static double* rpc_latency = nil;
+static int rpc_received = 0;
+static int rpc_wrong = 0;
+static double rpc_elapsed = 0;
+static const char* rpc_name = nil;
+static char* rpc_bulk = nil;
+static unsigned long rpc_bulksum = 0;
+
+void EchoReplies::reply(RpcHdr&, rpcstream& server) {
+    long value;
+    unsigned long sum;
+    server >> value >> sum;
+    if (server.good() && value >= 0) {
+        rpc_latency[rpc_received++] = rpc_now() - rpc_sent[value];
+        if (sum != 0 && sum != rpc_bulksum) {
+            ++rpc_wrong;
+        }
+    }
+}
+
+void rpc_setup (int n) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        perror("rpc_setup: socketpair");
+        exit(1);
+    }
+    rpc_server = fork();
+    if (rpc_server == 0) {
+        close(sv[0]);
+        EchoReader* reader = new EchoReader(sv[1]);
+        while (!reader->done()) {
+            Dispatcher::instance().dispatch();
+        }
+        _exit(0);
+    }
+    close(sv[1]);
+    rpc_fd = sv[0];
+    rpc_writer = new EchoWriter(rpc_fd);
+    rpc_replies = new EchoReplies(&rpc_writer->server());
+    rpc_sent = new double[n];
+    rpc_latency = new double[n];
+    rpc_bulk = new char[rpc_bulksize];
+    for (int i = 0; i < rpc_bulksize; ++i) {
+        rpc_bulk[i] = (char) (i * 7);
+    }
+    rpc_bulksum = rpc_sum(rpc_bulk, rpc_bulksize);
+}
+
+static void rpc_run (int n, int window, boolean bulk) {
+    int sent = 0;
+    rpc_received = 0;
+    rpc_wrong = 0;
+    double start = rpc_now();
+    while (rpc_received < n && rpc_writer->server().good()) {
+        while (sent < n && sent - rpc_received < window) {
+            rpc_sent[sent] = rpc_now();
+            if (bulk) {
+                rpc_writer->sum(sent, rpc_bulk, rpc_bulksize, rpc_replies);
+            } else {
+                rpc_writer->echo(sent, rpc_replies);
+            }
+            ++sent;
+        }
+        rpc_writer->server().flush();
+        Dispatcher::instance().dispatch();
+    }
+    rpc_elapsed = rpc_now() - start;
+}
+
+void rpc_serial (int n) {
+    rpc_name = "rpc.serial";
+    rpc_run(n, 1, false);
+}
+
+void rpc_pipeline (int n) {
+    rpc_name = "rpc.pipeline";
+    rpc_run(n, 64, false);
+}
+
+void rpc_bulk_pipeline (int n) {
+    rpc_name = "rpc.bulk";
+    rpc_run(n, 64, true);
+}
+
+static int compare_latency (const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+void rpc_cleanup () {
+    if (rpc_received > 0 && rpc_elapsed > 0) {
+        qsort(rpc_latency, rpc_received, sizeof(double), &compare_latency);
+        fprintf(
+            stderr, "%s: %d requests, %.0f requests/s, p99 %.1f us\n",
+            rpc_name, rpc_received, rpc_received / rpc_elapsed,
+            rpc_latency[(rpc_received * 99) / 100] * 1e6
+        );
+    }
+    if (rpc_wrong > 0) {
+        fprintf(stderr, "%s: %d replies had the wrong sum\n", rpc_name, rpc_wrong);
+    }
+    delete rpc_replies;
+    delete rpc_writer;
+    close(rpc_fd);
+    int status;
+    waitpid(rpc_server, &status, 0);
+    delete [] rpc_sent;
+    delete [] rpc_latency;
+    delete [] rpc_bulk;
+    rpc_bulk = nil;
+    rpc_replies = nil;
+    rpc_writer = nil;
+    rpc_sent = rpc_latency = nil;
+}
+
+#endif
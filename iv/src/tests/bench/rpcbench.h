@@ -0,0 +1,22 @@
+/*
+ * ivbench cases for the Dispatch RPC classes, built only when they are.
+ */
+
+#ifndef rpcbench_h
+#define rpcbench_h
+
+void rpc_setup(int requests);
+// fork an echo server on the other end of a local socket.
+void rpc_serial(int requests);
+// send echo requests one at a time, waiting for each reply.
+void rpc_pipeline(int requests);
+// send echo requests with up to 64 outstanding, flushing them in
+// batches.
+void rpc_bulk_pipeline(int requests);
+// send 4K requests with up to 64 outstanding, which the server adds up
+// without copying them out of its buffer.
+void rpc_cleanup();
+// report requests/s and p99 latency of the last run and stop the
+// server.
+
+#endif
@@ -0,0 +1,501 @@
+/*
+ * binarytest - save drawings of every kind of component as script text
+ * and as binary (.dtb) through the catalog, read each back, and check
+ * that no trip through the binary format changes the text a drawing
+ * writes, exiting with the number of failures.  Each script is also
+ * parsed on several threads by OverlayLoader, with and without gs/pts
+ * tables, and has to come back the same as a serial read.
+ */
+
+#include <OverlayUnidraw/ovarrow.h>
+#include <OverlayUnidraw/ovbinary.h>
+#include <OverlayUnidraw/ovcatalog.h>
+#include <OverlayUnidraw/ovcomps.h>
+#include <OverlayUnidraw/ovcreator.h>
+#include <OverlayUnidraw/ovellipse.h>
+#include <OverlayUnidraw/ovline.h>
+#include <OverlayUnidraw/ovloader.h>
+#include <OverlayUnidraw/ovpolygon.h>
+#include <OverlayUnidraw/ovraster.h>
+#include <OverlayUnidraw/ovrect.h>
+#include <OverlayUnidraw/ovspline.h>
+#include <OverlayUnidraw/ovtext.h>
+#include <OverlayUnidraw/ovunidraw.h>
+#include <OverlayUnidraw/textfile.h>
+
+#include <UniIdraw/idarrows.h>
+
+#include <Unidraw/Graphic/ellipses.h>
+#include <Unidraw/Graphic/lines.h>
+#include <Unidraw/Graphic/picture.h>
+#include <Unidraw/Graphic/polygons.h>
+#include <Unidraw/Graphic/splines.h>
+#include <Unidraw/catalog.h>
+#include <Unidraw/unidraw.h>
+
+#include <Unidraw/Components/text.h>
+
+#include <InterViews/session.h>
+#include <InterViews/transformer.h>
+
+#include <Attribute/attrlist.h>
+#include <Attribute/attrvalue.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static OptionDesc options[] = {
+    { nil }
+};
+
+static PropertyData properties[] = {
+    { "*domain",  "drawing" },
+    { nil }
+};
+
+static OverlayUnidraw* unidraw_app = nil;
+static boolean has_display = false;
+
+static const char* text_file = "binarytest.drawtool";
+static const char* binary_file = "binarytest.dtb";
+static const char* text_copy = "binarytest2.drawtool";
+static const char* binary_copy = "binarytest2.dtb";
+static const char* included_file = "binarytest.txt";
+
+/*****************************************************************************/
+
+/*
+ * Graphic states: brushes, colors, patterns and fonts of every kind the
+ * script format writes, chosen by index so each drawing mixes them.
+ */
+
+static void set_state (FullGraphic& gs, int i) {
+    Catalog* catalog = unidraw_app->GetCatalog();
+    static int bitmap[] = {
+        0xaaaa, 0x5555, 0xaaaa, 0x5555, 0xaaaa, 0x5555, 0xaaaa, 0x5555,
+        0xaaaa, 0x5555, 0xaaaa, 0x5555, 0xaaaa, 0x5555, 0xaaaa, 0x5555
+    };
+
+    switch (i % 4) {
+    case 0: gs.SetBrush(catalog->FindBrush(0xffff, 1)); break;
+    case 1: gs.SetBrush(catalog->FindBrush(0xf0f0, 2)); break;
+    case 2: gs.SetBrush(catalog->FindBrush(0xffff, 0.5f)); break;
+    default: gs.SetBrush(catalog->FindNoneBrush()); break;
+    }
+    static const char* colors[] = { "Black", "Red", "Green", "Blue", "White" };
+    gs.SetColors(catalog->FindColor(colors[i % 5]), catalog->FindColor(colors[(i + 2) % 5]));
+    switch (i % 3) {
+    case 0: gs.SetPattern(catalog->FindNonePattern()); break;
+    case 1: gs.SetPattern(catalog->FindGrayLevel(0.25)); break;
+    default: gs.SetPattern(catalog->FindPattern(bitmap, 16)); break;
+    }
+    gs.FillBg(i % 2);
+    gs.SetFont(
+        i % 2 ?
+        catalog->FindFont("-*-courier-bold-r-normal-*-12-*-*-*-*-*-*-*", "Courier-Bold", "12") :
+        catalog->FindFont("-*-helvetica-medium-r-normal-*-12-*-*-*-*-*-*-*", "Helvetica", "12")
+    );
+}
+
+/*
+ * Text takes the line height of its font, as the editor gives it; the
+ * script format moves text of any other height when it is read back.
+ */
+
+static int line_height (FullGraphic& gs) {
+    PSFont* font = gs.GetFont();
+    return font == nil ? 12 : font->GetLineHt();
+}
+
+/* set_transform leaves some graphics alone and moves, scales or rotates the rest */
+
+static void set_transform (Graphic* g, int i) {
+    switch (i % 4) {
+    case 0: break;
+    case 1: g->Translate(17, -5); break;
+    case 2: g->Scale(2.5, 0.75); g->Translate(3, 4); break;
+    default: g->Rotate(30.0); g->Translate(100, 40); break;
+    }
+}
+
+/*
+ * make_comp builds the i-th kind of graphic with a native binary record
+ * at (x, y).
+ */
+
+static const int nkinds = 11;
+
+static OverlayComp* make_comp (int i, Coord x, Coord y) {
+    FullGraphic gs;
+    set_state(gs, i);
+    Coord px[5], py[5];
+    px[0] = x; px[1] = x + 20; px[2] = x + 35; px[3] = x + 10; px[4] = x - 5;
+    py[0] = y; py[1] = y + 5; py[2] = y + 30; py[3] = y + 40; py[4] = y + 12;
+    OverlayComp* comp = nil;
+
+    switch (i % nkinds) {
+    case 0:
+        comp = new LineOvComp(new Line(x, y, x + 30, y + 20, &gs));
+        break;
+    case 1:
+        comp = new ArrowLineOvComp(
+            new ArrowLine(x, y, x + 30, y + 20, true, i % 2, 1.5, &gs)
+        );
+        break;
+    case 2:
+        comp = new MultiLineOvComp(new SF_MultiLine(px, py, 5, &gs));
+        break;
+    case 3:
+        comp = new ArrowMultiLineOvComp(
+            new ArrowMultiLine(px, py, 4, i % 2, true, 2.0, &gs)
+        );
+        break;
+    case 4:
+        comp = new SplineOvComp(new SFH_OpenBSpline(px, py, 5, &gs));
+        break;
+    case 5:
+        comp = new ArrowSplineOvComp(
+            new ArrowOpenBSpline(px, py, 5, true, true, 0.5, &gs)
+        );
+        break;
+    case 6:
+        comp = new ClosedSplineOvComp(new SFH_ClosedBSpline(px, py, 5, &gs));
+        break;
+    case 7:
+        comp = new PolygonOvComp(new SF_Polygon(px, py, 3, &gs));
+        break;
+    case 8:
+        comp = new RectOvComp(new SF_Rect(x, y, x + 40, y + 25, &gs));
+        break;
+    case 9:
+        comp = new EllipseOvComp(new SF_Ellipse(x, y, 20, 9, &gs));
+        break;
+    default: {
+        TextGraphic* text = new TextGraphic("binarytest", line_height(gs), &gs);
+        text->Translate(x, y);
+        comp = new TextOvComp(text);
+        break;
+    }
+    }
+    set_transform(comp->GetGraphic(), i / nkinds);
+    return comp;
+}
+
+/*****************************************************************************/
+
+static OverlayIdrawComp* make_shapes () {
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    for (int i = 0; i < nkinds * 4; ++i) {
+        drawing->Append(make_comp(i, (i % 8) * 60, (i / 8) * 60));
+    }
+    return drawing;
+}
+
+/* make_many gives the parallel loader enough components to share out */
+
+static OverlayIdrawComp* make_many () {
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    for (int i = 0; i < nkinds * 200; ++i) {
+        drawing->Append(make_comp(i, (i % 40) * 60, (i / 40) * 60));
+    }
+    return drawing;
+}
+
+static OverlaysComp* make_group (int depth, int seed) {
+    FullGraphic gs;
+    set_state(gs, seed);
+    OverlaysComp* group = new OverlaysComp(new Picture(&gs));
+    for (int i = 0; i < 3; ++i) {
+        group->Append(make_comp(seed + i * 5, i * 50, depth * 30));
+    }
+    if (depth > 0) {
+        group->Append(make_group(depth - 1, seed + 1));
+    }
+    set_transform(group->GetGraphic(), seed + depth);
+    return group;
+}
+
+static OverlayIdrawComp* make_groups () {
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    drawing->Append(make_comp(8, 0, 0));
+    drawing->Append(make_group(3, 1));
+    drawing->Append(make_group(0, 6));
+    drawing->Append(make_comp(1, 300, 300));
+    return drawing;
+}
+
+/* text bodies end without a newline, which the script format drops */
+
+static OverlayIdrawComp* make_text () {
+    static const char* bodies[] = {
+        "one line",
+        "two\nlines",
+        "a \"quoted\" word and a back\\slash",
+        "\n\nblank lines first\n\nand between",
+        "(parentheses) :colons, commas {braces}",
+        ""
+    };
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    int n = sizeof(bodies) / sizeof(bodies[0]);
+    for (int i = 0; i < n; ++i) {
+        FullGraphic gs;
+        set_state(gs, i);
+        TextGraphic* text = new TextGraphic(bodies[i], line_height(gs), &gs);
+        set_transform(text, i);
+        text->Translate(0, i * 40);
+        drawing->Append(new TextOvComp(text));
+    }
+    return drawing;
+}
+
+/* make_extras annotates components and gives them attributes */
+
+static OverlayIdrawComp* make_extras () {
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    for (int i = 0; i < 6; ++i) {
+        OverlayComp* comp = make_comp(i * 2, i * 30, 0);
+        if (i % 2 == 0) {
+            comp->SetAnnotation(i == 0 ? "a note" : "a \"quoted\" note\nof two lines");
+        }
+        if (i > 0) {
+            AttributeList* al = new AttributeList;
+            AttributeValue ival(i * 7, AttributeValue::IntType);
+            AttributeValue fval(i * 0.5);
+            AttributeValue sval("value");
+            al->add_attr("count", ival);
+            al->add_attr("ratio", fval);
+            if (i % 3 == 0) {
+                al->add_attr("label", sval);
+            }
+            comp->SetAttributeList(al);
+        }
+        drawing->Append(comp);
+    }
+    return drawing;
+}
+
+/*
+ * make_script mixes native records with a component that has none, a
+ * text file inclusion, which the binary format keeps as script text.
+ */
+
+static OverlayIdrawComp* make_script () {
+    FILE* f = fopen(included_file, "w");
+    if (f != nil) {
+        fputs("begin\nincluded text\nsecond line\nend\n", f);
+        fclose(f);
+    }
+    FullGraphic gs;
+    set_state(gs, 1);
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    drawing->Append(make_comp(8, 0, 0));
+    TextFileComp* comp = new TextFileComp(included_file, "begin", "end", -1, &gs);
+    comp->GetGraphic()->Translate(20, 80);
+    drawing->Append(comp);
+    drawing->Append(make_comp(9, 100, 0));
+    return drawing;
+}
+
+/* make_raster draws a slope of pixels, in color or in gray */
+
+static OverlayIdrawComp* make_raster (boolean gray) {
+    static const int w = 37, h = 23;
+    OverlayRaster* raster = new OverlayRaster(w, h);
+    unsigned char row[w * 3];
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            row[x * 3] = x * 7;
+            row[x * 3 + 1] = gray ? x * 7 : y * 11;
+            row[x * 3 + 2] = gray ? x * 7 : (x + y) * 3;
+        }
+        raster->pokerow(0, y, w, row, 3);
+    }
+    raster->gray_flag(gray);
+    raster->initialize();
+    FullGraphic gs;
+    set_state(gs, 0);
+    OverlayIdrawComp* drawing = new OverlayIdrawComp;
+    RasterOvComp* comp = new RasterOvComp(new OverlayRasterRect(raster, &gs));
+    set_transform(comp->GetGraphic(), 2);
+    drawing->Append(comp);
+    drawing->Append(make_comp(8, 0, 0));
+    return drawing;
+}
+
+static OverlayIdrawComp* make_rgb_raster () { return make_raster(false); }
+static OverlayIdrawComp* make_gray_raster () { return make_raster(true); }
+
+/*****************************************************************************/
+
+static boolean save (Component* comp, const char* name) {
+    Catalog* catalog = unidraw_app->GetCatalog();
+    boolean ok = catalog->Save(comp, name);
+    catalog->Forget(comp);
+    return ok;
+}
+
+static Component* retrieve (const char* name) {
+    Catalog* catalog = unidraw_app->GetCatalog();
+    Component* comp = nil;
+    if (catalog->Retrieve(name, comp)) {
+        catalog->Forget(comp);
+    }
+    return comp;
+}
+
+/* file_text returns the contents of 'name' as a string, or nil */
+
+static char* file_text (const char* name) {
+    FILE* f = fopen(name, "r");
+    if (f == nil) {
+        return nil;
+    }
+    int size = 0, len = 0;
+    char* text = nil;
+    do {
+        size += BUFSIZ;
+        text = (char*) realloc(text, size + 1);
+        len += fread(text + len, 1, size - len, f);
+    } while (len == size);
+    text[len] = '\0';
+    fclose(f);
+    return text;
+}
+
+/* load_parallel reads the script 'name' with OverlayLoader's threads */
+
+static Component* load_parallel (const char* name) {
+    OverlayLoader::Jobs(4);
+    Component* comp = OverlayLoader::Load(name);
+    OverlayLoader::Jobs(1);
+    return comp;
+}
+
+/*
+ * same_text writes 'comp' as text to the copy and compares it with
+ * 'expected', deleting 'comp'.
+ */
+
+static boolean same_text (Component* comp, const char* expected) {
+    boolean same = false;
+    if (save(comp, text_copy)) {
+        char* text = file_text(text_copy);
+        same = text != nil && strcmp(text, expected) == 0;
+        free(text);
+    }
+    delete comp;
+    return same;
+}
+
+static const char* run_test (OverlayIdrawComp* (*make)()) {
+    OverlayIdrawComp* drawing = (*make)();
+    boolean saved = save(drawing, text_file) && save(drawing, binary_file);
+    delete drawing;
+    if (!saved) {
+        return "not saved";
+    } else if (!OverlayBinary::IsBinary(binary_file)) {
+        return "saved as text in place of binary";
+    }
+    char* text = file_text(text_file);
+    const char* result = nil;
+
+    /* drawing to binary to text, against drawing to text */
+    Component* comp = retrieve(binary_file);
+    if (comp == nil) {
+        result = "binary drawing not read";
+    } else if (!same_text(comp, text)) {
+        result = "drawing read from binary writes different text";
+    }
+
+    /* text to binary to text, against the text */
+    if (result == nil) {
+        comp = retrieve(text_file);
+        saved = comp != nil && save(comp, binary_copy);
+        delete comp;
+        comp = saved ? retrieve(binary_copy) : nil;
+        if (comp == nil) {
+            result = "text drawing not saved and read as binary";
+        } else if (!same_text(comp, text)) {
+            result = "text drawing changed by a trip through binary";
+        }
+    }
+
+    /* text, with and without tables, read in parallel, against the text */
+    OverlayCatalog* catalog = (OverlayCatalog*) unidraw_app->GetCatalog();
+    for (int tables = 0; result == nil && tables < 2; ++tables) {
+        comp = retrieve(text_file);
+        catalog->SetCompactions(tables, tables, false);
+        saved = comp != nil && save(comp, text_copy);
+        catalog->SetCompactions(false, false, false);
+        delete comp;
+        comp = saved ? load_parallel(text_copy) : nil;
+        if (comp == nil) {
+            result = "text drawing not read in parallel";
+        } else if (!same_text(comp, text)) {
+            result = tables ?
+                "drawing with tables read in parallel writes different text" :
+                "drawing read in parallel writes different text";
+        }
+    }
+    free(text);
+    unlink(text_file);
+    unlink(binary_file);
+    unlink(text_copy);
+    unlink(binary_copy);
+    return result;
+}
+
+struct BinaryTest {
+    const char* name;
+    OverlayIdrawComp* (*make)();
+    boolean display;		// rasters need one
+};
+
+static BinaryTest tests[] = {
+    { "shapes", &make_shapes },
+    { "many", &make_many },
+    { "groups", &make_groups },
+    { "text", &make_text },
+    { "extras", &make_extras },
+    { "script", &make_script },
+    { "raster.rgb", &make_rgb_raster, true },
+    { "raster.gray", &make_gray_raster, true },
+    { nil }
+};
+
+int main(int argc, char** argv) {
+    const char* display = getenv("DISPLAY");
+    has_display = display != nil && *display != '\0';
+    int uargc = 1;
+    char* uargv[3];
+    uargv[0] = argv[0];
+    if (!has_display) {
+        uargv[uargc++] = (char*) "-nodisplay";
+    }
+    uargv[uargc] = nil;
+    OverlayCatalog* catalog = new OverlayCatalog("binarytest", new OverlayCreator);
+    unidraw_app = new OverlayUnidraw(catalog, uargc, uargv, options, properties);
+    OverlayLoader::Jobs(1);
+    OverlayLoader::MinSize(0);
+
+    int failures = 0;
+    for (BinaryTest* test = tests; test->name; test++) {
+        if (argc > 1 && strcmp(argv[1], test->name) != 0)
+	    continue;
+        if (test->display && !has_display) {
+            printf("SKIP %s (rasters need a display)\n", test->name);
+            continue;
+        }
+	const char* err = run_test(test->make);
+	if (!err)
+	    printf("PASS %s\n", test->name);
+	else {
+	    printf("FAIL %s\n  %s\n", test->name, err);
+	    failures++;
+	}
+    }
+    unlink(included_file);
+    return failures;
+}
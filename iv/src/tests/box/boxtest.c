@@ -0,0 +1,491 @@
+/*
+ * boxtest - change, add and remove the components of a vbox, told and
+ * untold, and check every relayout against a box built afresh from the
+ * same components; then draw and pick parts of tiled boxes and check
+ * that every component in the damage or under the hit is reached,
+ * exiting with the number of failures.  No window is needed, so none
+ * is opened.
+ */
+
+#include <InterViews/canvas.h>
+#include <InterViews/geometry.h>
+#include <InterViews/glyph.h>
+#include <InterViews/hit.h>
+#include <InterViews/layout.h>
+#include <InterViews/polyglyph.h>
+#include <InterViews/transformer.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * A component of fixed size that counts how often it is requested,
+ * allocated, drawn and picked.  Resize changes it without telling the
+ * box.  Its extension reaches 'overhang' past its allocation all round.
+ */
+
+class TestGlyph : public Glyph {
+public:
+    TestGlyph(Coord width, Coord height, Coord overhang = 0);
+
+    void resize(Coord width, Coord height);
+    void extent(Canvas*, Extension&) const;
+    // where the glyph draws, as of its last allocation.
+
+    virtual void request(Requisition&) const;
+    virtual void allocate(Canvas*, const Allocation&, Extension&);
+    virtual void draw(Canvas*, const Allocation&) const;
+    virtual void pick(Canvas*, const Allocation&, int depth, Hit&);
+
+    int requests() const { return requests_; }
+    int allocates() const { return allocates_; }
+    int draws() const { return draws_; }
+    int picks() const { return picks_; }
+    void clear_counts() { draws_ = picks_ = 0; }
+private:
+    Coord width_, height_;
+    Coord overhang_;
+    Allocation allocation_;
+    int requests_;
+    int allocates_;
+    int draws_;
+    int picks_;
+};
+
+TestGlyph::TestGlyph(Coord width, Coord height, Coord overhang) {
+    width_ = width;
+    height_ = height;
+    overhang_ = overhang;
+    requests_ = 0;
+    allocates_ = 0;
+    draws_ = 0;
+    picks_ = 0;
+}
+
+void TestGlyph::resize(Coord width, Coord height) {
+    width_ = width;
+    height_ = height;
+}
+
+void TestGlyph::extent(Canvas* c, Extension& ext) const {
+    const Allocation& a = allocation_;
+    Coord o = overhang_;
+    ext.clear();
+    ext.merge_xy(c, a.left() - o, a.bottom() - o, a.right() + o, a.top() + o);
+}
+
+void TestGlyph::request(Requisition& r) const {
+    ((TestGlyph*) this)->requests_ += 1;
+    Requirement rx(width_, 0, 0, 0);
+    Requirement ry(height_, 0, 0, 1);
+    r.require(Dimension_X, rx);
+    r.require(Dimension_Y, ry);
+}
+
+void TestGlyph::allocate(Canvas* c, const Allocation& a, Extension& ext) {
+    allocates_ += 1;
+    allocation_ = a;
+    Extension mine;
+    extent(c, mine);
+    ext.merge(mine);
+}
+
+void TestGlyph::draw(Canvas*, const Allocation&) const {
+    ((TestGlyph*) this)->draws_ += 1;
+}
+
+void TestGlyph::pick(Canvas*, const Allocation&, int, Hit&) {
+    picks_ += 1;
+}
+
+/*
+ * A canvas that keeps only a transformer and a damaged area, both in
+ * canvas coordinates, so that draw can be checked without a window.
+ */
+
+class TestCanvas : public Canvas {
+public:
+    TestCanvas(const Transformer&);
+
+    virtual const Transformer& transformer() const;
+    virtual void damage(Coord left, Coord bottom, Coord right, Coord top);
+    virtual boolean damaged(const Extension&) const;
+    virtual boolean damaged(
+	Coord left, Coord bottom, Coord right, Coord top
+    ) const;
+    virtual void damage_area(Extension&);
+private:
+    Transformer transformer_;
+    Coord left_, bottom_, right_, top_;
+};
+
+TestCanvas::TestCanvas(const Transformer& t) : transformer_(t) {
+    left_ = bottom_ = right_ = top_ = 0;
+}
+
+const Transformer& TestCanvas::transformer() const { return transformer_; }
+
+void TestCanvas::damage(Coord left, Coord bottom, Coord right, Coord top) {
+    left_ = left;
+    bottom_ = bottom;
+    right_ = right;
+    top_ = top;
+}
+
+boolean TestCanvas::damaged(const Extension& ext) const {
+    return damaged(ext.left(), ext.bottom(), ext.right(), ext.top());
+}
+
+boolean TestCanvas::damaged(
+    Coord left, Coord bottom, Coord right, Coord top
+) const {
+    return left < right_ && right > left_ && bottom < top_ && top > bottom_;
+}
+
+void TestCanvas::damage_area(Extension& ext) {
+    ext.set_xy(nil, left_, bottom_, right_, top_);
+}
+
+/*****************************************************************************/
+
+static const int rows = 8;
+
+static TestGlyph* glyphs[rows + 2];
+
+static PolyGlyph* make_box() {
+    PolyGlyph* box = LayoutKit::instance()->vbox();
+    for (int i = 0; i < rows; ++i) {
+	glyphs[i] = new TestGlyph(50 + i, 10 + i);
+	box->append(glyphs[i]);
+    }
+    glyphs[rows] = new TestGlyph(70, 25);
+    glyphs[rows + 1] = new TestGlyph(30, 5);
+    Resource::ref(box);
+    return box;
+}
+
+static void make_allocation(Allocation& a, Coord height) {
+    a.allot(Dimension_X, Allotment(0, 200, 0));
+    a.allot(Dimension_Y, Allotment(0, height, 1));
+}
+
+static void lay_out(Glyph* box, const Allocation& a) {
+    Requisition r;
+    Extension ext;
+    ext.clear();
+    box->request(r);
+    box->allocate(nil, a, ext);
+}
+
+/*
+ * same_layout compares 'box' as allocated with 'a' to a new vbox of the
+ * same components given the same allocation.
+ */
+
+static boolean same_layout(PolyGlyph* box, const Allocation& a) {
+    lay_out(box, a);
+    PolyGlyph* fresh = LayoutKit::instance()->vbox();
+    Resource::ref(fresh);
+    GlyphIndex n = box->count();
+    for (GlyphIndex i = 0; i < n; ++i) {
+	fresh->append(box->component(i));
+    }
+    lay_out(fresh, a);
+    boolean same = fresh->count() == n;
+    for (GlyphIndex i = 0; same && i < n; ++i) {
+	for (int d = Dimension_X; same && d <= Dimension_Y; ++d) {
+	    Allotment got, expected;
+	    box->allotment(i, DimensionName(d), got);
+	    fresh->allotment(i, DimensionName(d), expected);
+	    same = got.equals(expected, 1e-4);
+	}
+    }
+    Resource::unref(fresh);
+    return same;
+}
+
+/*****************************************************************************/
+
+static const char* resize_untold() {
+    PolyGlyph* box = make_box();
+    Allocation a;
+    make_allocation(a, 300);
+    lay_out(box, a);
+    glyphs[3]->resize(80, 40);
+    int before = glyphs[3]->allocates();
+
+    Allocation b;
+    make_allocation(b, 320);
+    const char* result = nil;
+    if (!same_layout(box, b)) {
+	result = "untold change missed on a new size";
+    } else if (glyphs[3]->allocates() == before) {
+	result = "untold change not allocated on a new size";
+    }
+    Resource::unref(box);
+    return result;
+}
+
+static const char* change_one() {
+    PolyGlyph* box = make_box();
+    Allocation a;
+    make_allocation(a, 300);
+    lay_out(box, a);
+    glyphs[3]->resize(80, 40);
+    box->change(3);
+    int requests = glyphs[0]->requests();
+    int allocates = glyphs[0]->allocates();
+    int changed = glyphs[3]->allocates();
+
+    const char* result = nil;
+    lay_out(box, a);
+    if (glyphs[3]->allocates() == changed) {
+	result = "changed component not allocated";
+    } else if (
+	glyphs[0]->requests() != requests ||
+	glyphs[0]->allocates() != allocates
+    ) {
+	result = "unchanged component laid out again";
+    } else if (!same_layout(box, a)) {
+	result = "layout after a change differs";
+    }
+    Resource::unref(box);
+    return result;
+}
+
+static const char* edit_sequence() {
+    PolyGlyph* box = make_box();
+    Allocation a;
+    make_allocation(a, 300);
+    lay_out(box, a);
+
+    const char* result = nil;
+    for (int step = 0; result == nil && step < 8; ++step) {
+	switch (step) {
+	case 0: box->append(glyphs[rows]); break;
+	case 1: box->insert(2, glyphs[rows + 1]); break;
+	case 2: box->remove(5); break;
+	case 3: box->prepend(glyphs[rows + 1]); break;
+	case 4: box->replace(4, glyphs[rows]); break;
+	case 5: glyphs[1]->resize(60, 2); box->change(2); break;
+	case 6: box->remove(box->count() - 1); break;
+	case 7: box->remove(0); break;
+	}
+	if (!same_layout(box, a)) {
+	    static char err[BUFSIZ];
+	    sprintf(err, "layout differs after edit %d", step);
+	    result = err;
+	}
+    }
+    Resource::unref(box);
+    return result;
+}
+
+/*****************************************************************************/
+
+/*
+ * The culling tests tile cull_count components 20 by 10, the one at
+ * cull_overhang drawing 'overhang' past its allocation, in a box
+ * allocated on 'canvas' at its natural size.
+ */
+
+static const int cull_count = 40;
+static const int cull_overhang = 12;
+
+static TestGlyph* cull_glyphs[cull_count];
+
+static PolyGlyph* make_tiles(
+    boolean vertical, Coord overhang, Canvas* c, Allocation& a
+) {
+    LayoutKit* kit = LayoutKit::instance();
+    PolyGlyph* box = vertical ? kit->vbox() : kit->hbox();
+    for (int i = 0; i < cull_count; ++i) {
+	cull_glyphs[i] = new TestGlyph(
+	    20, 10, i == cull_overhang ? overhang : 0
+	);
+	box->append(cull_glyphs[i]);
+    }
+    Resource::ref(box);
+    Requisition r;
+    box->request(r);
+    const Requirement& rx = r.requirement(Dimension_X);
+    const Requirement& ry = r.requirement(Dimension_Y);
+    a.allot(Dimension_X, Allotment(0, rx.natural(), rx.alignment()));
+    a.allot(Dimension_Y, Allotment(0, ry.natural(), ry.alignment()));
+    Extension ext;
+    ext.clear();
+    box->allocate(c, a, ext);
+    return box;
+}
+
+/*
+ * cull_draw damages the part of the canvas from the start of component
+ * 'from' to the end of component 'to', less 'inset' at each end, and
+ * draws the box.  Every component whose extent meets the damage must be
+ * drawn, and some must not, or nothing was culled.
+ */
+
+static const char* cull_draw(
+    PolyGlyph* box, TestCanvas& c, const Allocation& a,
+    int from, int to, Coord inset
+) {
+    Extension first, last;
+    cull_glyphs[from]->extent(&c, first);
+    cull_glyphs[to]->extent(&c, last);
+    first.merge(last);
+    c.damage(
+	first.left() + inset, first.bottom() + inset,
+	first.right() - inset, first.top() - inset
+    );
+    for (int i = 0; i < cull_count; ++i) {
+	cull_glyphs[i]->clear_counts();
+    }
+    box->draw(&c, a);
+
+    int drawn = 0;
+    for (int i = 0; i < cull_count; ++i) {
+	Extension ext;
+	cull_glyphs[i]->extent(&c, ext);
+	if (c.damaged(ext) && cull_glyphs[i]->draws() == 0) {
+	    return "damaged component not drawn";
+	}
+	drawn += cull_glyphs[i]->draws();
+    }
+    return drawn < cull_count ? nil : "every component drawn";
+}
+
+static const char* cull_reversed() {
+    Transformer identity;
+    TestCanvas c(identity);
+    Allocation a;
+    PolyGlyph* box = make_tiles(true, 0, &c, a);
+    const char* result = cull_draw(box, c, a, 20, 23, 1);
+    Resource::unref(box);
+    return result;
+}
+
+static const char* cull_forward() {
+    Transformer identity;
+    TestCanvas c(identity);
+    Allocation a;
+    PolyGlyph* box = make_tiles(false, 0, &c, a);
+    const char* result = cull_draw(box, c, a, 5, 6, 1);
+    Resource::unref(box);
+    return result;
+}
+
+/* damage only the neighbours' share of what one component overdraws */
+
+static const char* cull_overhanging() {
+    Transformer identity;
+    TestCanvas c(identity);
+    Allocation a;
+    PolyGlyph* box = make_tiles(true, 15, &c, a);
+    const char* result = cull_draw(box, c, a, cull_overhang + 1, cull_overhang + 2, 4);
+    if (result == nil) {
+	result = cull_draw(box, c, a, cull_overhang - 2, cull_overhang - 1, 4);
+    }
+    Resource::unref(box);
+    return result;
+}
+
+static const char* cull_flipped() {
+    Transformer flip;
+    flip.scale(1, -1);
+    flip.translate(30, 500);
+    TestCanvas c(flip);
+    Allocation a;
+    PolyGlyph* box = make_tiles(true, 0, &c, a);
+    const char* result = cull_draw(box, c, a, 30, 31, 1);
+    if (result == nil) {
+	Resource::unref(box);
+	box = make_tiles(false, 0, &c, a);
+	result = cull_draw(box, c, a, 0, 2, 1);
+    }
+    Resource::unref(box);
+    return result;
+}
+
+/*
+ * cull_pick picks a point in the middle of component 'at'.  Every
+ * component whose extent holds it must be picked, and some must not.
+ */
+
+static const char* cull_pick(boolean vertical, Coord overhang, int at) {
+    Transformer identity;
+    TestCanvas c(identity);
+    Allocation a;
+    PolyGlyph* box = make_tiles(vertical, overhang, &c, a);
+    Extension target;
+    cull_glyphs[at]->extent(&c, target);
+    Coord x = (target.left() + target.right()) / 2;
+    Coord y = (target.bottom() + target.top()) / 2;
+    Hit h(x, y);
+    box->pick(&c, a, 0, h);
+
+    const char* result = nil;
+    int picked = 0;
+    for (int i = 0; result == nil && i < cull_count; ++i) {
+	Extension ext;
+	cull_glyphs[i]->extent(&c, ext);
+	if (
+	    x >= ext.left() && x <= ext.right() &&
+	    y >= ext.bottom() && y <= ext.top() &&
+	    cull_glyphs[i]->picks() == 0
+	) {
+	    result = "component under the hit not picked";
+	}
+	picked += cull_glyphs[i]->picks();
+    }
+    if (result == nil && picked == cull_count) {
+	result = "every component picked";
+    }
+    Resource::unref(box);
+    return result;
+}
+
+static const char* cull_pick_tiles() {
+    const char* result = cull_pick(true, 0, 25);
+    return result != nil ? result : cull_pick(false, 0, 7);
+}
+
+/* pick inside the neighbours, where only the overhang can be hit */
+
+static const char* cull_pick_overhang() {
+    const char* result = cull_pick(true, 15, cull_overhang + 1);
+    return result != nil ? result : cull_pick(true, 15, cull_overhang - 1);
+}
+
+struct BoxTest {
+    const char* name;
+    const char* (*run)();
+};
+
+static BoxTest tests[] = {
+    { "resize.untold", &resize_untold },
+    { "change.one", &change_one },
+    { "edit.sequence", &edit_sequence },
+    { "cull.reversed", &cull_reversed },
+    { "cull.forward", &cull_forward },
+    { "cull.overhang", &cull_overhanging },
+    { "cull.flipped", &cull_flipped },
+    { "cull.pick", &cull_pick_tiles },
+    { "cull.pick.overhang", &cull_pick_overhang },
+    { nil }
+};
+
+int main(int argc, char** argv) {
+    int failures = 0;
+    for (BoxTest* test = tests; test->name; test++) {
+        if (argc > 1 && strcmp(argv[1], test->name) != 0)
+	    continue;
+	const char* err = (*test->run)();
+	if (!err)
+	    printf("PASS %s\n", test->name);
+	else {
+	    printf("FAIL %s\n  %s\n", test->name, err);
+	    failures++;
+	}
+    }
+    return failures;
+}
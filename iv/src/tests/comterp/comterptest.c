@@ -0,0 +1,270 @@
+/*
+ * comterptest - run scripts through a comterp server and compare what
+ * they print with what is expected, exiting with the number of failures.
+ */
+
+#include <ComTerp/comshm.h>
+#include <ComTerp/comterpserv.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct ComTerpTest {
+    const char* name;
+    const char* script;
+    const char* expected;
+    boolean runfile;		// run the script as a file, not from stdin,
+				// expecting its errors with what it prints
+    int bufsize;
+    boolean remote;		// script takes the test server's port for %d
+};
+
+static ComTerpTest tests[] = {
+
+    /* a new-line inside an evaluated string ends its expression */
+    { "eval.newline", "eval(\"1\\n2\")\n", "1\n" },
+    { "eval.newline.tail", "eval(\"x=7\\ny=8\") y\n", "7\nnil\n" },
+    { "eval.newline.seq", "a=eval(\"1\\n2\");print(a)\n", "1\n" },
+    { "eval.paren.newline", "eval(\"(1+\\n2)\")\n", "3\n" },
+
+    /* lines too long for the buffer are cut between tokens, */
+    /* including before negative numbers */
+    { "runfile.cut.negative",
+      "v=list(1,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12,-13,-14)\n"
+      "print(v)\n",
+      "{1,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12,-13,-14}", true, 32 },
+
+    /* and errors are reported on the line of the file they are on, */
+    /* past cut lines, blank lines and expressions over two lines */
+    { "runfile.cut.linenum",
+      "a=list(1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20)\n"
+      "\n"
+      "b=(1+\n"
+      "2)\n"
+      "c=xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\n",
+      "comterp:  (5) Line greater than 30 characters long\n", true, 32 },
+
+    /* futures of remote commands, answered by a server on this host */
+    { "remote.async",
+      "f=remote(\"127.0.0.1\" %d \"1+2\" :async);wait(f)\n", "3\n",
+      false, 0, true },
+    { "remote.async.lines",
+      "f=remote(\"127.0.0.1\" %d \"list(1 2) 5\" :async);wait(f)\n", "5\n",
+      false, 0, true },
+    { "remote.async.twice",
+      "f=remote(\"127.0.0.1\" %d \"7\" :async);wait(f)+wait(f)\n", "14\n",
+      false, 0, true },
+    { "remote.async.order",
+      "a=remote(\"127.0.0.1\" %d \"10\" :async);"
+      "b=remote(\"127.0.0.1\" %d \"20\" :async);"
+      "c=remote(\"127.0.0.1\" %d \"30\" :async);"
+      "wait(c),wait(a),wait(b)\n", "{30,10,20}\n",
+      false, 0, true },
+    { "remote.waitall",
+      "waitall(remote(\"127.0.0.1\" %d \"1\" :async) "
+      "remote(\"127.0.0.1\" %d \"x=2\" :async))\n", "{1,2}\n",
+      false, 0, true },
+
+    { nil }
+};
+
+static FILE* script_file(const char* script) {
+    FILE* file = tmpfile();
+    fputs(script, file);
+    fflush(file);
+    rewind(file);
+    return file;
+}
+
+static char* contents(FILE* file) {
+    long len = ftell(file);
+    char* text = new char[len+1];
+    rewind(file);
+    len = fread(text, 1, len, file);
+    text[len] = '\0';
+    return text;
+}
+
+/* 
+ * Serve one connection on 'listenfd' from a child process, the way a
+ * comterp server would, and return the child's pid.
+ */
+
+static pid_t serve(int listenfd) {
+    pid_t pid = fork();
+    if (pid != 0)
+	return pid;
+    int fd = accept(listenfd, nil, nil);
+    if (fd < 0)
+	_exit(1);
+    dup2(fd, 0);
+    dup2(fd, 1);
+    setvbuf(stdout, nil, _IOLBF, 0);
+    ComTerpServ* terp = new ComTerpServ(BUFSIZ, 0);
+    terp->add_defaults();
+    terp->disable_prompt();
+    terp->run();
+    _exit(0);
+}
+
+static int listen_local(int& port) {
+    struct sockaddr_in name;
+    socklen_t len = sizeof(name);
+    memset(&name, 0, sizeof(name));
+    name.sin_family = AF_INET;
+    name.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr*)&name, sizeof(name)) < 0 ||
+	listen(fd, 1) < 0 || getsockname(fd, (struct sockaddr*)&name, &len) < 0)
+	return -1;
+    port = ntohs(name.sin_port);
+    return fd;
+}
+
+static int server_port = -1;
+
+/* 
+ * Echo a line many times the size of a shared-memory ring through a
+ * child process, so that each end has to wait for the other to make
+ * room; nil if it comes back whole, else what went wrong.
+ */
+
+static const char* shm_ring_full() {
+    ComterpShm::ringsize(5000);
+    if (ComterpShm::ringsize() != 8192)
+	return "ring size not rounded up to a power of 2";
+    int port = 0x10000 + getpid();
+    int listenfd = ComterpShm::listen(port);
+    if (listenfd < 0)
+	return "no local socket";
+
+    pid_t pid = fork();
+    if (pid == 0) {
+	ComterpShm* shm = ComterpShm::accept(listenfd);
+	char* line = shm ? shm->gets() : nil;
+	_exit(line && shm->puts(line) >= 0 ? 0 : 1);
+    }
+    close(listenfd);
+
+    const int len = 16 * 8192;
+    char* sent = new char[len+1];
+    for (int i = 0; i < len; i++) 
+	sent[i] = 'a' + i % 26;
+    sent[len] = '\0';
+    const char* err = nil;
+    ComterpShm* shm = ComterpShm::connect(port);
+    if (!shm)
+	err = "no connection";
+    else if (shm->puts(sent) < 0)
+	err = "write failed";
+    else {
+	char* line = shm->gets();
+	if (!line || strcmp(line, sent) != 0)
+	    err = "line came back changed";
+    }
+    delete shm;
+    delete [] sent;
+    int status;
+    waitpid(pid, &status, 0);
+    if (!err && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+	err = "echo failed";
+    unlink(ComterpShm::path(port));
+    return err;
+}
+
+static char* run_test(ComTerpTest& test) {
+    char script[BUFSIZ];
+    if (test.remote) {
+	int p = server_port;
+	snprintf(script, BUFSIZ, test.script, p, p, p, p);
+    } else
+	snprintf(script, BUFSIZ, "%s", test.script);
+    FILE* in = script_file(script);
+    FILE* out = tmpfile();
+    fflush(stdout);
+    fflush(stderr);
+    int save_stdout = dup(1);
+    int save_stderr = dup(2);
+    dup2(fileno(out), 1);
+    if (test.runfile)
+	dup2(fileno(out), 2);
+
+    int bufsize = test.bufsize ? test.bufsize : BUFSIZ;
+    if (test.runfile) {
+        char path[] = "/tmp/comterptestXXXXXX";
+	int fd = mkstemp(path);
+	write(fd, script, strlen(script));
+	close(fd);
+	ComTerpServ* terp = new ComTerpServ(bufsize);
+	terp->add_defaults();
+	terp->runfile(path);
+	delete terp;
+	unlink(path);
+    } else {
+	ComTerpServ* terp = new ComTerpServ(bufsize, dup(fileno(in)));
+	terp->add_defaults();
+	terp->disable_prompt();
+	terp->run();
+	delete terp;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    dup2(save_stdout, 1);
+    dup2(save_stderr, 2);
+    close(save_stdout);
+    close(save_stderr);
+    char* text = contents(out);
+    fclose(out);
+    fclose(in);
+    return text;
+}
+
+int main(int argc, char** argv) {
+    int listenfd = listen_local(server_port);
+    pid_t server = listenfd < 0 ? -1 : serve(listenfd);
+
+    int failures = 0;
+    for (ComTerpTest* test = tests; test->name; test++) {
+        if (argc > 1 && strcmp(argv[1], test->name) != 0)
+	    continue;
+	if (test->remote && server < 0) {
+	    printf("FAIL %s\n  no server\n", test->name);
+	    failures++;
+	    continue;
+	}
+	char* output = run_test(*test);
+	if (strcmp(output, test->expected) == 0)
+	    printf("PASS %s\n", test->name);
+	else {
+	    printf("FAIL %s\n  expected: \"%s\"\n  printed:  \"%s\"\n",
+		   test->name, test->expected, output);
+	    failures++;
+	}
+	delete [] output;
+    }
+
+    if (ComterpShm::supported() && 
+	(argc < 2 || strcmp(argv[1], "shm.ring.full") == 0)) {
+	const char* err = shm_ring_full();
+	if (!err)
+	    printf("PASS shm.ring.full\n");
+	else {
+	    printf("FAIL shm.ring.full\n  %s\n", err);
+	    failures++;
+	}
+    }
+
+    if (server > 0) {
+	kill(server, SIGTERM);
+	waitpid(server, nil, 0);
+    }
+    return failures;
+}
@@ -0,0 +1,168 @@
+/*
+ * filtertest - run the OverlayFilter operators over images of several
+ * shapes and value types, divided among different numbers of threads,
+ * and check every result against the serial one, exiting with the
+ * number of failures.
+ */
+
+#include <OverlayUnidraw/grayraster.h>
+#include <OverlayUnidraw/ovfilter.h>
+
+#include <InterViews/session.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { GAUSSIAN, BOX, MEDIAN, THRESHOLD, LABEL };
+
+struct FilterTest {
+    const char* name;
+    int op;
+    AttributeValue::ValueType type;
+    int w, h;
+    int levels;			// distinct values in the source image
+};
+
+static FilterTest tests[] = {
+    { "gaussian.uchar", GAUSSIAN, AttributeValue::UCharType, 301, 257, 256 },
+    { "gaussian.float", GAUSSIAN, AttributeValue::FloatType, 128, 300, 1000 },
+    { "box.short", BOX, AttributeValue::ShortType, 257, 301, 4000 },
+    { "median.uchar", MEDIAN, AttributeValue::UCharType, 300, 300, 256 },
+    { "median.float", MEDIAN, AttributeValue::FloatType, 97, 211, 1000 },
+    { "threshold.uchar", THRESHOLD, AttributeValue::UCharType, 300, 299, 256 },
+    { "label.uchar", LABEL, AttributeValue::UCharType, 300, 300, 3 },
+    { "label.short", LABEL, AttributeValue::ShortType, 512, 64, 2 },
+
+    /* fewer rows than threads */
+    { "gaussian.short.rows", GAUSSIAN, AttributeValue::ShortType, 400, 5, 4000 },
+    { "label.uchar.rows", LABEL, AttributeValue::UCharType, 400, 3, 2 },
+    { nil }
+};
+
+static const int jobs[] = { 2, 3, 8 };
+
+static unsigned long seed = 1;
+
+static int random_value (int range) {
+    seed = seed * 1103515245 + 12345;
+    return (int) ((seed >> 8) % (unsigned long) range);
+}
+
+static int value_size (AttributeValue::ValueType type) {
+    switch (type) {
+    case AttributeValue::UCharType: return sizeof(unsigned char);
+    case AttributeValue::ShortType: return sizeof(short);
+    case AttributeValue::IntType:   return sizeof(int);
+    case AttributeValue::FloatType: return sizeof(float);
+    default:                        return 0;
+    }
+}
+
+/*
+ * make_image fills an image with runs of random values, so that labeled
+ * regions run across the rows where the image is divided.
+ */
+
+static GrayRaster* make_image (FilterTest& test) {
+    GrayRaster* image = new GrayRaster(test.w, test.h, test.type);
+    unsigned long n = (unsigned long) test.w * test.h;
+    unsigned char* data = image->data();
+    int v = 0;
+    seed = 1;
+
+    for (unsigned long i = 0; i < n; ++i) {
+        if (random_value(4) == 0) {
+            v = random_value(test.levels);
+        }
+        switch (test.type) {
+        case AttributeValue::UCharType: ((unsigned char*) data)[i] = v; break;
+        case AttributeValue::ShortType: ((short*) data)[i] = v - 2000; break;
+        default: ((float*) data)[i] = v * 0.25f; break;
+        }
+    }
+    return image;
+}
+
+static GrayRaster* run_filter (FilterTest& test, GrayRaster* image, int& ncomps) {
+    static const float tvals[] = { 200, 10, 128, 64 };
+    ncomps = 0;
+
+    switch (test.op) {
+    case GAUSSIAN:  return OverlayFilter::Gaussian(image, 2.0);
+    case BOX:       return OverlayFilter::Box(image, 3);
+    case MEDIAN:    return OverlayFilter::Median(image, 2);
+    case THRESHOLD: return OverlayFilter::Threshold(image, tvals, 4);
+    default:        return OverlayFilter::Label(image, ncomps);
+    }
+}
+
+static const char* run_test (FilterTest& test) {
+    static char err[BUFSIZ];
+    GrayRaster* image = make_image(test);
+    Resource::ref(image);
+
+    OverlayFilter::Jobs(1);
+    int serial_ncomps;
+    GrayRaster* serial = run_filter(test, image, serial_ncomps);
+    const char* result = nil;
+
+    if (serial == nil) {
+        result = "no serial result";
+    }
+    int njobs = sizeof(jobs) / sizeof(jobs[0]);
+    for (int j = 0; result == nil && j < njobs; ++j) {
+        OverlayFilter::Jobs(jobs[j]);
+        int ncomps;
+        GrayRaster* threaded = run_filter(test, image, ncomps);
+
+        if (threaded == nil) {
+            sprintf(err, "no result with %d threads", jobs[j]);
+            result = err;
+        } else if (ncomps != serial_ncomps) {
+            sprintf(
+                err, "%d components with %d threads, %d serially",
+                ncomps, jobs[j], serial_ncomps
+            );
+            result = err;
+        } else if (
+            threaded->value_type() != serial->value_type() ||
+            memcmp(
+                threaded->data(), serial->data(),
+                (size_t) test.w * test.h * value_size(serial->value_type())
+            ) != 0
+        ) {
+            sprintf(err, "result with %d threads differs", jobs[j]);
+            result = err;
+        }
+        Resource::unref(threaded);
+    }
+    Resource::unref(serial);
+    Resource::unref(image);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* display = getenv("DISPLAY");
+    if (display == nil || *display == '\0') {
+        printf("SKIP filter (rasters need a display)\n");
+        return 0;
+    }
+    Session* session = new Session("FilterTest", argc, argv);
+    OverlayFilter::MinSize(1);
+
+    int failures = 0;
+    for (FilterTest* test = tests; test->name; test++) {
+        if (argc > 1 && strcmp(argv[1], test->name) != 0)
+	    continue;
+	const char* err = run_test(*test);
+	if (!err)
+	    printf("PASS %s\n", test->name);
+	else {
+	    printf("FAIL %s\n  %s\n", test->name, err);
+	    failures++;
+	}
+    }
+    delete session;
+    return failures;
+}
@@ -0,0 +1,231 @@
+/*
+ * tifftest - write images of several layouts with libtiff, decode them
+ * with OverlayTIFF serially and in threads, and check every result
+ * against libtiff's own reading of the file, exiting with the number of
+ * failures.
+ */
+
+#include <OverlayUnidraw/ovtiff.h>
+
+#ifdef EXTERN_TIFF
+#include <tiffio.h>
+#else
+#include <TIFF/tiffio.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(TIFFLIB_VERSION)
+typedef unsigned int test_tifflong;
+#else
+typedef unsigned long test_tifflong;
+#endif
+
+struct TIFFTest {
+    const char* name;
+    int bits, samples;
+    int compression;
+    int predictor;
+    boolean tiled;
+    unsigned int chunk;		// rows per strip, or tile width and height
+    boolean big;		// big-endian file (older libtiffs write host order)
+    unsigned int w, h;
+    int noise;			// random part of each sample
+};
+
+static TIFFTest tests[] = {
+    { "none.uchar.strips", 8, 1, COMPRESSION_NONE, 1, false, 17, false, 301, 207, 4 },
+    { "none.ushort.big", 16, 1, COMPRESSION_NONE, 1, false, 32, true, 200, 100, 256 },
+    { "lzw.uchar.strips", 8, 1, COMPRESSION_LZW, 1, false, 17, false, 301, 207, 4 },
+    { "lzw.uchar.noise", 8, 1, COMPRESSION_LZW, 1, false, 64, false, 512, 256, 256 },
+    { "lzw.uchar.onestrip", 8, 1, COMPRESSION_LZW, 1, false, 500, false, 640, 500, 16 },
+    { "lzw.ushort.big", 16, 1, COMPRESSION_LZW, 1, false, 16, true, 257, 130, 16 },
+    { "lzw.ushort.predictor", 16, 1, COMPRESSION_LZW, 2, false, 16, false, 257, 130, 16 },
+    { "lzw.uint.tiles", 32, 1, COMPRESSION_LZW, 1, true, 32, false, 100, 70, 16 },
+    { "lzw.rgb.predictor.tiles", 8, 3, COMPRESSION_LZW, 2, true, 64, false, 301, 207, 8 },
+    { "lzw.rgb16.tiles.big", 16, 3, COMPRESSION_LZW, 1, true, 48, true, 150, 97, 64 },
+    { "packbits.uchar.tiles", 8, 1, COMPRESSION_PACKBITS, 1, true, 32, false, 301, 207, 2 },
+    { "packbits.rgb.strips", 8, 3, COMPRESSION_PACKBITS, 1, false, 9, true, 130, 61, 2 },
+    { nil }
+};
+
+static const int jobs[] = { 1, 3 };
+
+static const char* test_file = "tifftest.tif";
+
+static unsigned long seed = 1;
+
+static int random_value (int range) {
+    seed = seed * 1103515245 + 12345;
+    return (int) ((seed >> 8) % (unsigned long) range);
+}
+
+/*
+ * write_image fills one strip or tile at a time with a slope plus some
+ * noise, so that runs of codes and literals both show up.
+ */
+
+static boolean write_image (TIFFTest& test) {
+    TIFF* tif = TIFFOpen((char*) test_file, (char*) (test.big ? "wb" : "wl"));
+    if (tif == nil) {
+        return false;
+    }
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, (test_tifflong) test.w);
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, (test_tifflong) test.h);
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, test.bits);
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, test.samples);
+    TIFFSetField(
+        tif, TIFFTAG_PHOTOMETRIC,
+        test.samples == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB
+    );
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_COMPRESSION, test.compression);
+    if (test.predictor == 2) {
+        TIFFSetField(tif, TIFFTAG_PREDICTOR, test.predictor);
+    }
+
+    int chunkwidth = test.tiled ? test.chunk : test.w;
+    int across = test.tiled ? (test.w + test.chunk - 1) / test.chunk : 1;
+    int down = (test.h + test.chunk - 1) / test.chunk;
+    if (test.tiled) {
+        TIFFSetField(tif, TIFFTAG_TILEWIDTH, (test_tifflong) test.chunk);
+        TIFFSetField(tif, TIFFTAG_TILELENGTH, (test_tifflong) test.chunk);
+    } else {
+        TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, (test_tifflong) test.chunk);
+    }
+
+    int size = test.bits / 8;
+    unsigned long rowsamples = (unsigned long) chunkwidth * test.samples;
+    unsigned char* buf = new unsigned char[rowsamples * test.chunk * size];
+    boolean ok = true;
+    seed = 1;
+
+    for (int cy = 0; ok && cy < down; ++cy) {
+        for (int cx = 0; ok && cx < across; ++cx) {
+            int rows = test.chunk;
+            if (!test.tiled && (cy + 1) * test.chunk > test.h) {
+                rows = test.h - cy * test.chunk;
+            }
+            for (unsigned long i = 0; i < rowsamples * rows; ++i) {
+                unsigned long x = cx * chunkwidth + i / test.samples % chunkwidth;
+                unsigned long y = cy * test.chunk + i / rowsamples;
+                unsigned long v = (x * 3 + y * 5) * 16 + random_value(test.noise);
+                switch (size) {
+                case 1: buf[i] = (unsigned char) v; break;
+                case 2: ((unsigned short*) buf)[i] = (unsigned short) v; break;
+                default: ((unsigned int*) buf)[i] = (unsigned int) (v * 65537); break;
+                }
+            }
+            unsigned long bytes = rowsamples * rows * size;
+            ok = (
+                test.tiled ?
+                TIFFWriteEncodedTile(tif, cy * across + cx, buf, bytes) :
+                TIFFWriteEncodedStrip(tif, cy, buf, bytes)
+            ) >= 0;
+        }
+    }
+    delete [] buf;
+    TIFFClose(tif);
+    return ok;
+}
+
+/* read_image is libtiff's decoding of the file, laid out as OverlayTIFF's */
+
+static unsigned char* read_image (TIFFTest& test) {
+    TIFF* tif = TIFFOpen((char*) test_file, (char*) "r");
+    if (tif == nil) {
+        return nil;
+    }
+    int size = test.bits / 8;
+    unsigned long pixelbytes = test.samples * size;
+    unsigned long rowbytes = test.w * pixelbytes;
+    unsigned char* image = new unsigned char[rowbytes * test.h];
+    memset(image, 0, rowbytes * test.h);
+
+    if (test.tiled) {
+        unsigned long tilerowbytes = test.chunk * pixelbytes;
+        unsigned long tilebytes = tilerowbytes * test.chunk;
+        unsigned char* tile = new unsigned char[tilebytes];
+        int across = (test.w + test.chunk - 1) / test.chunk;
+        int ntiles = TIFFNumberOfTiles(tif);
+        for (int t = 0; t < ntiles; ++t) {
+            TIFFReadEncodedTile(tif, t, tile, tilebytes);
+            unsigned long x0 = (t % across) * test.chunk;
+            unsigned long y0 = (t / across) * test.chunk;
+            unsigned long w = test.w - x0 < test.chunk ? test.w - x0 : test.chunk;
+            for (unsigned long r = 0; r < test.chunk && y0 + r < test.h; ++r) {
+                memcpy(
+                    image + (y0 + r) * rowbytes + x0 * pixelbytes,
+                    tile + r * tilerowbytes, w * pixelbytes
+                );
+            }
+        }
+        delete [] tile;
+    } else {
+        int nstrips = TIFFNumberOfStrips(tif);
+        for (int s = 0; s < nstrips; ++s) {
+            unsigned long y0 = (unsigned long) s * test.chunk;
+            unsigned long rows = test.h - y0 < test.chunk ? test.h - y0 : test.chunk;
+            TIFFReadEncodedStrip(tif, s, image + y0 * rowbytes, rows * rowbytes);
+        }
+    }
+    TIFFClose(tif);
+    return image;
+}
+
+static const char* run_test (TIFFTest& test) {
+    static char err[BUFSIZ];
+    if (!write_image(test)) {
+        return "libtiff could not write the image";
+    }
+    unsigned char* expected = read_image(test);
+    if (expected == nil) {
+        return "libtiff could not read the image";
+    }
+    unsigned long bytes = (unsigned long) test.w * test.h * test.samples * (test.bits / 8);
+    const char* result = nil;
+
+    int njobs = sizeof(jobs) / sizeof(jobs[0]);
+    for (int j = 0; result == nil && j < njobs; ++j) {
+        OverlayTIFF::Jobs(jobs[j]);
+        OverlayTIFF tiff(test_file);
+
+        if (!tiff.Decode()) {
+            sprintf(err, "not decoded with %d threads", jobs[j]);
+            result = err;
+        } else if (
+            tiff.Width() != test.w || tiff.Height() != test.h ||
+            tiff.Samples() != test.samples || tiff.Tiled() != test.tiled
+        ) {
+            sprintf(err, "wrong layout with %d threads", jobs[j]);
+            result = err;
+        } else if (memcmp(tiff.Data(), expected, bytes) != 0) {
+            sprintf(err, "differs from libtiff with %d threads", jobs[j]);
+            result = err;
+        }
+    }
+    delete [] expected;
+    unlink(test_file);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    OverlayTIFF::MinSize(1);
+
+    int failures = 0;
+    for (TIFFTest* test = tests; test->name; test++) {
+        if (argc > 1 && strcmp(argv[1], test->name) != 0)
+	    continue;
+	const char* err = run_test(*test);
+	if (!err)
+	    printf("PASS %s\n", test->name);
+	else {
+	    printf("FAIL %s\n  %s\n", test->name, err);
+	    failures++;
+	}
+    }
+    return failures;
+}